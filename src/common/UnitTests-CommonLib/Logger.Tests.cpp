@@ -0,0 +1,207 @@
+#include "pch.h"
+#include <logger/async_log_sink.h>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/details/os.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsLogger
+{
+    // Sink which records the payloads of the messages. If release is set, it waits for it before recording a message
+    class RecordingSink : public spdlog::sinks::base_sink<std::mutex>
+    {
+    public:
+        std::vector<std::string> payloads;
+        HANDLE release = nullptr;
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override
+        {
+            if (release)
+            {
+                WaitForSingleObject(release, INFINITE);
+            }
+            payloads.emplace_back(msg.payload.data(), msg.payload.size());
+        }
+
+        void flush_() override
+        {
+        }
+    };
+
+    TEST_CLASS (AsyncLogSinkTests)
+    {
+    public:
+        TEST_METHOD (AsyncLogSink_ShouldWriteAllMessagesInOrder_WhenQueueDoesNotOverflow)
+        {
+            auto recordingSink = std::make_shared<RecordingSink>();
+            {
+                auto asyncSink = std::make_shared<AsyncLogSink>("test", recordingSink, AsyncOverflowPolicy::Drop);
+                spdlog::logger logger("test", asyncSink);
+                for (int i = 0; i < 100; i++)
+                {
+                    logger.info("message {}", i);
+                }
+
+                // Stopping the sink writes the queued messages
+                asyncSink->stop();
+            }
+
+            Assert::AreEqual(size_t{ 100 }, recordingSink->payloads.size());
+            for (int i = 0; i < 100; i++)
+            {
+                Assert::AreEqual("message " + std::to_string(i), recordingSink->payloads[i]);
+            }
+        }
+
+        TEST_METHOD (AsyncLogSink_ShouldDropAndCountMessages_WhenQueueIsFullAndPolicyIsDrop)
+        {
+            auto recordingSink = std::make_shared<RecordingSink>();
+            recordingSink->release = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            {
+                auto asyncSink = std::make_shared<AsyncLogSink>("test", recordingSink, AsyncOverflowPolicy::Drop);
+                spdlog::logger logger("test", asyncSink);
+
+                // The writer thread is blocked by the wrapped sink, so only Capacity messages fit
+                for (size_t i = 0; i < AsyncLogSink::Capacity + 10; i++)
+                {
+                    logger.info("message {}", i);
+                }
+                Assert::AreEqual(size_t{ 10 }, asyncSink->dropped_count());
+                SetEvent(recordingSink->release);
+                asyncSink->stop();
+            }
+            CloseHandle(recordingSink->release);
+
+            Assert::AreEqual(AsyncLogSink::Capacity + 1, recordingSink->payloads.size());
+            Assert::AreEqual(std::string("10 log messages were dropped because the queue was full"), recordingSink->payloads.back());
+        }
+
+        TEST_METHOD (AsyncLogSink_ShouldTruncateMessage_WhenMessageIsLongerThanMaxPayloadSize)
+        {
+            auto recordingSink = std::make_shared<RecordingSink>();
+            {
+                auto asyncSink = std::make_shared<AsyncLogSink>("test", recordingSink, AsyncOverflowPolicy::Drop);
+                spdlog::logger logger("test", asyncSink);
+                logger.info(std::string(AsyncLogSink::MaxPayloadSize * 2, 'a'));
+                asyncSink->stop();
+            }
+
+            Assert::AreEqual(size_t{ 1 }, recordingSink->payloads.size());
+            Assert::AreEqual(std::string(AsyncLogSink::MaxPayloadSize, 'a'), recordingSink->payloads[0]);
+        }
+
+        TEST_METHOD (AsyncLogSink_ShouldDumpLastEntries_WhenDumpRecentEntriesIsCalled)
+        {
+            const auto dumpPath = std::filesystem::temp_directory_path() / L"async-log-sink-dump-test.txt";
+            auto recordingSink = std::make_shared<RecordingSink>();
+            {
+                auto asyncSink = std::make_shared<AsyncLogSink>("test", recordingSink, AsyncOverflowPolicy::Drop);
+                spdlog::logger logger("test", asyncSink);
+                logger.set_pattern("%v");
+                for (int i = 0; i < 10; i++)
+                {
+                    logger.info("message {}", i);
+                }
+
+                asyncSink->dump_recent_entries(dumpPath.wstring(), 3);
+                asyncSink->stop();
+            }
+
+            std::ifstream dump(dumpPath);
+            std::stringstream content;
+            content << dump.rdbuf();
+            dump.close();
+            std::filesystem::remove(dumpPath);
+
+            const auto eol = std::string(spdlog::details::os::default_eol);
+            Assert::AreEqual("message 7" + eol + "message 8" + eol + "message 9" + eol, content.str());
+        }
+
+        TEST_METHOD (AsyncLogSink_ShouldWriteSynchronously_WhenStopped)
+        {
+            auto recordingSink = std::make_shared<RecordingSink>();
+            auto asyncSink = std::make_shared<AsyncLogSink>("test", recordingSink, AsyncOverflowPolicy::Drop);
+            spdlog::logger logger("test", asyncSink);
+            logger.info("before stop");
+            asyncSink->stop();
+            Assert::AreEqual(size_t{ 1 }, recordingSink->payloads.size());
+
+            logger.info("after stop");
+            Assert::AreEqual(size_t{ 2 }, recordingSink->payloads.size());
+            Assert::AreEqual(std::string("after stop"), recordingSink->payloads[1]);
+        }
+
+        // Prints the cost of a log call on the logging thread with the synchronous and the async file sink, and checks that
+        // the async sink doesn't drop messages. The messages are logged in bursts which fit in the queue, like the bursts of
+        // window events in FancyZones. It takes several seconds, so it's ignored unless it's run on purpose.
+        BEGIN_TEST_METHOD_ATTRIBUTE(AsyncLogSink_Benchmark)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (AsyncLogSink_Benchmark)
+        {
+            const size_t bursts = 20;
+            const size_t burstSize = 1000;
+            const auto tempFolder = std::filesystem::temp_directory_path();
+
+            auto measure = [&](spdlog::logger& logger) {
+                std::chrono::nanoseconds total{ 0 };
+                for (size_t burst = 0; burst < bursts; burst++)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    for (size_t i = 0; i < burstSize; i++)
+                    {
+                        logger.info("Window {} moved to zone {}", i, burst);
+                    }
+                    total += std::chrono::steady_clock::now() - start;
+
+                    // Let the writer thread drain the queue
+                    Sleep(static_cast<DWORD>(AsyncLogSink::MaxBatchLatency.count() * 2));
+                }
+                return total.count() / (bursts * burstSize);
+            };
+
+            const auto syncPath = tempFolder / L"logger-benchmark-sync.txt";
+            const auto asyncPath = tempFolder / L"logger-benchmark-async.txt";
+            long long syncCost = 0;
+            long long asyncCost = 0;
+            size_t droppedCount = 0;
+            {
+                spdlog::logger logger("sync", std::make_shared<spdlog::sinks::basic_file_sink_mt>(syncPath.wstring(), true));
+                syncCost = measure(logger);
+            }
+            {
+                auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(asyncPath.wstring(), true);
+                auto asyncSink = std::make_shared<AsyncLogSink>("async", fileSink, AsyncOverflowPolicy::Drop);
+                spdlog::logger logger("async", asyncSink);
+                asyncCost = measure(logger);
+                asyncSink->stop();
+                droppedCount = asyncSink->dropped_count();
+            }
+
+            size_t asyncLines = 0;
+            {
+                std::ifstream asyncFile(asyncPath);
+                for (std::string line; std::getline(asyncFile, line);)
+                {
+                    asyncLines++;
+                }
+            }
+            std::filesystem::remove(syncPath);
+            std::filesystem::remove(asyncPath);
+
+            Logger::WriteMessage(("Synchronous file sink: " + std::to_string(syncCost) + " ns per log call\n").c_str());
+            Logger::WriteMessage(("Async sink: " + std::to_string(asyncCost) + " ns per log call\n").c_str());
+
+            Assert::AreEqual(size_t{ 0 }, droppedCount);
+            Assert::AreEqual(bursts * burstSize, asyncLines);
+        }
+    };
+}
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include <process_path_cache.h>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsProcessPathCache
+{
+    TEST_CLASS (ProcessPathCacheTests)
+    {
+        // Start a process which doesn't run, so it only exits when the test terminates it
+        static PROCESS_INFORMATION StartSuspendedProcess()
+        {
+            wchar_t commandLine[] = L"cmd.exe /c exit";
+            STARTUPINFOW startupInfo{ sizeof(startupInfo) };
+            PROCESS_INFORMATION processInfo{};
+            Assert::IsTrue(CreateProcessW(nullptr, commandLine, nullptr, nullptr, FALSE, CREATE_SUSPENDED | CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo));
+            return processInfo;
+        }
+
+    public:
+        TEST_METHOD (GetProcessPath_ShouldReturnExecutablePath_WhenProcessIsRunning)
+        {
+            std::wstring expected(MAX_PATH, L'\0');
+            expected.resize(GetModuleFileNameW(nullptr, expected.data(), MAX_PATH));
+
+            const auto actual = ProcessPathCache::get_process_path(GetCurrentProcessId());
+
+            Assert::AreEqual(0, _wcsicmp(expected.c_str(), actual.c_str()));
+        }
+
+        TEST_METHOD (GetProcessPath_ShouldReturnEmptyPath_WhenProcessDoesNotExist)
+        {
+            // The System Idle Process can't be opened
+            Assert::IsTrue(ProcessPathCache::get_process_path(DWORD{ 0 }).empty());
+        }
+
+        TEST_METHOD (GetProcessPath_ShouldHitCache_WhenCalledTwice)
+        {
+            const auto processInfo = StartSuspendedProcess();
+
+            const auto before = ProcessPathCache::get_stats();
+            const auto first = ProcessPathCache::get_process_path(processInfo.dwProcessId);
+            const auto second = ProcessPathCache::get_process_path(processInfo.dwProcessId);
+            const auto after = ProcessPathCache::get_stats();
+
+            TerminateProcess(processInfo.hProcess, 0);
+            CloseHandle(processInfo.hThread);
+            CloseHandle(processInfo.hProcess);
+
+            Assert::IsFalse(first.empty());
+            Assert::AreEqual(first, second);
+            Assert::AreEqual(before.processMisses + 1, after.processMisses);
+            Assert::AreEqual(before.processHits + 1, after.processHits);
+        }
+
+        TEST_METHOD (GetProcessPath_ShouldMissCache_WhenProcessHasExited)
+        {
+            const auto processInfo = StartSuspendedProcess();
+            ProcessPathCache::get_process_path(processInfo.dwProcessId);
+
+            TerminateProcess(processInfo.hProcess, 0);
+            WaitForSingleObject(processInfo.hProcess, INFINITE);
+
+            // The entry is removed by a thread pool callback, give it some time
+            bool missed = false;
+            for (int i = 0; i < 100 && !missed; i++)
+            {
+                const auto before = ProcessPathCache::get_stats();
+                ProcessPathCache::get_process_path(processInfo.dwProcessId);
+                missed = ProcessPathCache::get_stats().processMisses != before.processMisses;
+                Sleep(10);
+            }
+
+            CloseHandle(processInfo.hThread);
+            CloseHandle(processInfo.hProcess);
+            Assert::IsTrue(missed);
+        }
+
+        TEST_METHOD (GetProcessPath_ShouldMissCache_AfterShutdown)
+        {
+            const auto processInfo = StartSuspendedProcess();
+            ProcessPathCache::get_process_path(processInfo.dwProcessId);
+
+            ProcessPathCache::shutdown();
+            const auto before = ProcessPathCache::get_stats();
+            const auto path = ProcessPathCache::get_process_path(processInfo.dwProcessId);
+            const auto after = ProcessPathCache::get_stats();
+
+            // The process exits after the cache was shut down, with the wait of the new entry still registered
+            TerminateProcess(processInfo.hProcess, 0);
+            WaitForSingleObject(processInfo.hProcess, INFINITE);
+            ProcessPathCache::shutdown();
+            CloseHandle(processInfo.hThread);
+            CloseHandle(processInfo.hProcess);
+
+            Assert::IsFalse(path.empty());
+            Assert::AreEqual(before.processMisses + 1, after.processMisses);
+        }
+    };
+}
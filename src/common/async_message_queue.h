@@ -4,6 +4,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <string>
+#include <vector>
 
 class AsyncMessageQueue
 {
@@ -44,6 +45,28 @@ public:
         this->message_queue.pop();
         return message;
     }
+    // Waits for at least one message and returns all the queued messages, so that they can be handled in one go.
+    // Returns an empty vector if the queue was interrupted.
+    std::vector<std::wstring> pop_messages()
+    {
+        std::unique_lock<std::mutex> lock(this->queue_mutex);
+        while (message_queue.empty() && !this->interrupted)
+        {
+            this->message_ready.wait(lock);
+        }
+        std::vector<std::wstring> messages;
+        if (this->interrupted)
+        {
+            return messages;
+        }
+        messages.reserve(message_queue.size());
+        while (!message_queue.empty())
+        {
+            messages.push_back(std::move(message_queue.front()));
+            message_queue.pop();
+        }
+        return messages;
+    }
     void interrupt()
     {
         this->queue_mutex.lock();
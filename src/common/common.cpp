@@ -5,6 +5,7 @@
 #include <strsafe.h>
 #include <sddl.h>
 #include "version.h"
+#include "process_path_cache.h"
 
 #include <wil/resource.h>
 
@@ -214,20 +215,7 @@ bool drop_elevated_privileges()
 
 std::wstring get_process_path(DWORD pid) noexcept
 {
-    auto process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, TRUE, pid);
-    std::wstring name;
-    if (process != INVALID_HANDLE_VALUE)
-    {
-        name.resize(MAX_PATH);
-        DWORD name_length = static_cast<DWORD>(name.length());
-        if (QueryFullProcessImageNameW(process, 0, (LPWSTR)name.data(), &name_length) == 0)
-        {
-            name_length = 0;
-        }
-        name.resize(name_length);
-        CloseHandle(process);
-    }
-    return name;
+    return ProcessPathCache::get_process_path(pid);
 }
 
 HANDLE run_elevated(const std::wstring& file, const std::wstring& params)
@@ -369,39 +357,7 @@ bool run_same_elevation(const std::wstring& file, const std::wstring& params, DW
 
 std::wstring get_process_path(HWND window) noexcept
 {
-    const static std::wstring app_frame_host = L"ApplicationFrameHost.exe";
-    DWORD pid{};
-    GetWindowThreadProcessId(window, &pid);
-    auto name = get_process_path(pid);
-    if (name.length() >= app_frame_host.length() &&
-        name.compare(name.length() - app_frame_host.length(), app_frame_host.length(), app_frame_host) == 0)
-    {
-        // It is a UWP app. We will enumerate the windows and look for one created
-        // by something with a different PID
-        DWORD new_pid = pid;
-        EnumChildWindows(
-            window, [](HWND hwnd, LPARAM param) -> BOOL {
-                auto new_pid_ptr = reinterpret_cast<DWORD*>(param);
-                DWORD pid;
-                GetWindowThreadProcessId(hwnd, &pid);
-                if (pid != *new_pid_ptr)
-                {
-                    *new_pid_ptr = pid;
-                    return FALSE;
-                }
-                else
-                {
-                    return TRUE;
-                }
-            },
-            reinterpret_cast<LPARAM>(&new_pid));
-        // If we have a new pid, get the new name.
-        if (new_pid != pid)
-        {
-            return get_process_path(new_pid);
-        }
-    }
-    return name;
+    return ProcessPathCache::get_process_path(window);
 }
 
 std::wstring get_product_version()
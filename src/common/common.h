@@ -55,9 +55,9 @@ bool check_user_is_admin();
 // Returns true when one or more strings from vector found in string
 bool find_app_name_in_path(const std::wstring& where, const std::vector<std::wstring>& what);
 
-// Get the executable path or module name for modern apps
+// Get the executable path or module name for modern apps. The result is cached, see process_path_cache.h
 std::wstring get_process_path(DWORD pid) noexcept;
-// Get the executable path or module name for modern apps
+// Get the executable path or module name for modern apps. The result is cached, see process_path_cache.h
 std::wstring get_process_path(HWND hwnd) noexcept;
 
 std::wstring get_product_version();
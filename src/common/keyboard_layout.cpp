@@ -39,10 +39,9 @@ std::wstring LayoutMap::LayoutMapImpl::GetKeyName(DWORD key)
     std::lock_guard<std::mutex> lock(keyboardLayoutMap_mutex);
     UpdateLayout();
 
-    auto it = keyboardLayoutMap.find(key);
-    if (it != keyboardLayoutMap.end())
+    if (key < KeyNameTableSize && keyboardLayoutMap->keyNameTypes[key] != KeyNameType::None)
     {
-        result = it->second;
+        result = keyboardLayoutMap->keyNames[key];
     }
     return result;
 }
@@ -61,17 +60,45 @@ void LayoutMap::LayoutMapImpl::UpdateLayout()
 {
     // Get keyboard layout for current thread
     const HKL layout = GetKeyboardLayout(0);
-    if (layout == previousLayout)
+    if (layout == previousLayout && keyboardLayoutMap)
     {
         return;
     }
     previousLayout = layout;
-    if (!isKeyCodeListGenerated)
+    keyboardLayoutMap = GetKeyNameTable(layout);
+}
+
+// Function to return the key name table of a layout. Tables are built on first use and cached for the lifetime of the process, so switching back to a layout which was used before does not rebuild it
+std::shared_ptr<const LayoutMap::LayoutMapImpl::KeyNameTable> LayoutMap::LayoutMapImpl::GetKeyNameTable(HKL layout)
+{
+    // The cache is shared by all the LayoutMap objects. The number of layouts installed on a machine is small, so entries are never evicted
+    static std::mutex keyNameTableCache_mutex;
+    static std::map<HKL, std::shared_ptr<const KeyNameTable>> keyNameTableCache;
+
+    std::lock_guard<std::mutex> lock(keyNameTableCache_mutex);
+    auto it = keyNameTableCache.find(layout);
+    if (it != keyNameTableCache.end())
     {
-        unicodeKeys.clear();
-        unknownKeys.clear();
+        return it->second;
     }
 
+    auto table = CreateKeyNameTable(layout);
+    keyNameTableCache[layout] = table;
+    return table;
+}
+
+static void SetSpecialKeyName(LayoutMap::LayoutMapImpl::KeyNameTable& table, DWORD key, const wchar_t* name)
+{
+    table.keyNames[key] = name;
+    table.keyNameTypes[key] = LayoutMap::LayoutMapImpl::KeyNameType::Special;
+}
+
+// Function to build the key name table of a layout
+std::shared_ptr<const LayoutMap::LayoutMapImpl::KeyNameTable> LayoutMap::LayoutMapImpl::CreateKeyNameTable(HKL layout)
+{
+    auto tablePtr = std::make_shared<KeyNameTable>();
+    KeyNameTable& table = *tablePtr;
+
     std::array<BYTE, 256> btKeys = { 0 };
     // Only set the Caps Lock key to on for the key names in uppercase
     btKeys[VK_CAPITAL] = 1;
@@ -82,141 +109,137 @@ void LayoutMap::LayoutMapImpl::UpdateLayout()
         std::array<wchar_t, 3> szBuffer = { 0 };
         if (mapKeycodeToUnicode(i, layout, btKeys.data(), szBuffer))
         {
-            keyboardLayoutMap[i] = szBuffer.data();
-            if (!isKeyCodeListGenerated)
-            {
-                unicodeKeys[i] = szBuffer.data();
-            }
+            table.keyNames[i] = szBuffer.data();
+            table.keyNameTypes[i] = KeyNameType::Unicode;
             continue;
         }
 
         // Store the virtual key code as string
         std::wstring vk = L"VK ";
         vk += std::to_wstring(i);
-        keyboardLayoutMap[i] = vk;
-        if (!isKeyCodeListGenerated)
-        {
-            unknownKeys[i] = vk;
-        }
+        table.keyNames[i] = vk;
+        table.keyNameTypes[i] = KeyNameType::Unknown;
     }
 
     // Override special key names like Shift, Ctrl etc because they don't have unicode mappings and key names like Enter, Space as they appear as "\r", " "
     // To do: localization
-    keyboardLayoutMap[VK_CANCEL] = L"Break";
-    keyboardLayoutMap[VK_BACK] = L"Backspace";
-    keyboardLayoutMap[VK_TAB] = L"Tab";
-    keyboardLayoutMap[VK_CLEAR] = L"Clear";
-    keyboardLayoutMap[VK_RETURN] = L"Enter";
-    keyboardLayoutMap[VK_SHIFT] = L"Shift";
-    keyboardLayoutMap[VK_CONTROL] = L"Ctrl";
-    keyboardLayoutMap[VK_MENU] = L"Alt";
-    keyboardLayoutMap[VK_PAUSE] = L"Pause";
-    keyboardLayoutMap[VK_CAPITAL] = L"Caps Lock";
-    keyboardLayoutMap[VK_ESCAPE] = L"Esc";
-    keyboardLayoutMap[VK_SPACE] = L"Space";
-    keyboardLayoutMap[VK_PRIOR] = L"PgUp";
-    keyboardLayoutMap[VK_NEXT] = L"PgDn";
-    keyboardLayoutMap[VK_END] = L"End";
-    keyboardLayoutMap[VK_HOME] = L"Home";
-    keyboardLayoutMap[VK_LEFT] = L"Left";
-    keyboardLayoutMap[VK_UP] = L"Up";
-    keyboardLayoutMap[VK_RIGHT] = L"Right";
-    keyboardLayoutMap[VK_DOWN] = L"Down";
-    keyboardLayoutMap[VK_SELECT] = L"Select";
-    keyboardLayoutMap[VK_PRINT] = L"Print";
-    keyboardLayoutMap[VK_EXECUTE] = L"Execute";
-    keyboardLayoutMap[VK_SNAPSHOT] = L"Print Screen";
-    keyboardLayoutMap[VK_INSERT] = L"Insert";
-    keyboardLayoutMap[VK_DELETE] = L"Delete";
-    keyboardLayoutMap[VK_HELP] = L"Help";
-    keyboardLayoutMap[VK_LWIN] = L"Win (Left)";
-    keyboardLayoutMap[VK_RWIN] = L"Win (Right)";
-    keyboardLayoutMap[VK_APPS] = L"Apps/Menu";
-    keyboardLayoutMap[VK_SLEEP] = L"Sleep";
-    keyboardLayoutMap[VK_NUMPAD0] = L"NumPad 0";
-    keyboardLayoutMap[VK_NUMPAD1] = L"NumPad 1";
-    keyboardLayoutMap[VK_NUMPAD2] = L"NumPad 2";
-    keyboardLayoutMap[VK_NUMPAD3] = L"NumPad 3";
-    keyboardLayoutMap[VK_NUMPAD4] = L"NumPad 4";
-    keyboardLayoutMap[VK_NUMPAD5] = L"NumPad 5";
-    keyboardLayoutMap[VK_NUMPAD6] = L"NumPad 6";
-    keyboardLayoutMap[VK_NUMPAD7] = L"NumPad 7";
-    keyboardLayoutMap[VK_NUMPAD8] = L"NumPad 8";
-    keyboardLayoutMap[VK_NUMPAD9] = L"NumPad 9";
-    keyboardLayoutMap[VK_SEPARATOR] = L"Separator";
-    keyboardLayoutMap[VK_F1] = L"F1";
-    keyboardLayoutMap[VK_F2] = L"F2";
-    keyboardLayoutMap[VK_F3] = L"F3";
-    keyboardLayoutMap[VK_F4] = L"F4";
-    keyboardLayoutMap[VK_F5] = L"F5";
-    keyboardLayoutMap[VK_F6] = L"F6";
-    keyboardLayoutMap[VK_F7] = L"F7";
-    keyboardLayoutMap[VK_F8] = L"F8";
-    keyboardLayoutMap[VK_F9] = L"F9";
-    keyboardLayoutMap[VK_F10] = L"F10";
-    keyboardLayoutMap[VK_F11] = L"F11";
-    keyboardLayoutMap[VK_F12] = L"F12";
-    keyboardLayoutMap[VK_F13] = L"F13";
-    keyboardLayoutMap[VK_F14] = L"F14";
-    keyboardLayoutMap[VK_F15] = L"F15";
-    keyboardLayoutMap[VK_F16] = L"F16";
-    keyboardLayoutMap[VK_F17] = L"F17";
-    keyboardLayoutMap[VK_F18] = L"F18";
-    keyboardLayoutMap[VK_F19] = L"F19";
-    keyboardLayoutMap[VK_F20] = L"F20";
-    keyboardLayoutMap[VK_F21] = L"F21";
-    keyboardLayoutMap[VK_F22] = L"F22";
-    keyboardLayoutMap[VK_F23] = L"F23";
-    keyboardLayoutMap[VK_F24] = L"F24";
-    keyboardLayoutMap[VK_NUMLOCK] = L"Num Lock";
-    keyboardLayoutMap[VK_SCROLL] = L"Scroll Lock";
-    keyboardLayoutMap[VK_LSHIFT] = L"Shift (Left)";
-    keyboardLayoutMap[VK_RSHIFT] = L"Shift (Right)";
-    keyboardLayoutMap[VK_LCONTROL] = L"Ctrl (Left)";
-    keyboardLayoutMap[VK_RCONTROL] = L"Ctrl (Right)";
-    keyboardLayoutMap[VK_LMENU] = L"Alt (Left)";
-    keyboardLayoutMap[VK_RMENU] = L"Alt (Right)";
-    keyboardLayoutMap[VK_BROWSER_BACK] = L"Browser Back";
-    keyboardLayoutMap[VK_BROWSER_FORWARD] = L"Browser Forward";
-    keyboardLayoutMap[VK_BROWSER_REFRESH] = L"Browser Refresh";
-    keyboardLayoutMap[VK_BROWSER_STOP] = L"Browser Stop";
-    keyboardLayoutMap[VK_BROWSER_SEARCH] = L"Browser Search";
-    keyboardLayoutMap[VK_BROWSER_FAVORITES] = L"Browser Favorites";
-    keyboardLayoutMap[VK_BROWSER_HOME] = L"Browser Home";
-    keyboardLayoutMap[VK_VOLUME_MUTE] = L"Volume Mute";
-    keyboardLayoutMap[VK_VOLUME_DOWN] = L"Volume Down";
-    keyboardLayoutMap[VK_VOLUME_UP] = L"Volume Up";
-    keyboardLayoutMap[VK_MEDIA_NEXT_TRACK] = L"Next Track";
-    keyboardLayoutMap[VK_MEDIA_PREV_TRACK] = L"Previous Track";
-    keyboardLayoutMap[VK_MEDIA_STOP] = L"Stop Media";
-    keyboardLayoutMap[VK_MEDIA_PLAY_PAUSE] = L"Play/Pause Media";
-    keyboardLayoutMap[VK_LAUNCH_MAIL] = L"Start Mail";
-    keyboardLayoutMap[VK_LAUNCH_MEDIA_SELECT] = L"Select Media";
-    keyboardLayoutMap[VK_LAUNCH_APP1] = L"Start App 1";
-    keyboardLayoutMap[VK_LAUNCH_APP2] = L"Start App 2";
-    keyboardLayoutMap[VK_PACKET] = L"Packet";
-    keyboardLayoutMap[VK_ATTN] = L"Attn";
-    keyboardLayoutMap[VK_CRSEL] = L"CrSel";
-    keyboardLayoutMap[VK_EXSEL] = L"ExSel";
-    keyboardLayoutMap[VK_EREOF] = L"Erase EOF";
-    keyboardLayoutMap[VK_PLAY] = L"Play";
-    keyboardLayoutMap[VK_ZOOM] = L"Zoom";
-    keyboardLayoutMap[VK_PA1] = L"PA1";
-    keyboardLayoutMap[VK_OEM_CLEAR] = L"Clear";
-    keyboardLayoutMap[0xFF] = L"Undefined";
-    keyboardLayoutMap[CommonSharedConstants::VK_WIN_BOTH] = L"Win";
-    keyboardLayoutMap[VK_KANA] = L"IME Kana";
-    keyboardLayoutMap[VK_HANGEUL] = L"IME Hangeul";
-    keyboardLayoutMap[VK_HANGUL] = L"IME Hangul";
-    keyboardLayoutMap[VK_JUNJA] = L"IME Junja";
-    keyboardLayoutMap[VK_FINAL] = L"IME Final";
-    keyboardLayoutMap[VK_HANJA] = L"IME Hanja";
-    keyboardLayoutMap[VK_KANJI] = L"IME Kanji";
-    keyboardLayoutMap[VK_CONVERT] = L"IME Convert";
-    keyboardLayoutMap[VK_NONCONVERT] = L"IME Non-Convert";
-    keyboardLayoutMap[VK_ACCEPT] = L"IME Kana";
-    keyboardLayoutMap[VK_MODECHANGE] = L"IME Mode Change";
-    keyboardLayoutMap[CommonSharedConstants::VK_DISABLED] = L"Disable";
+    SetSpecialKeyName(table, VK_CANCEL, L"Break");
+    SetSpecialKeyName(table, VK_BACK, L"Backspace");
+    SetSpecialKeyName(table, VK_TAB, L"Tab");
+    SetSpecialKeyName(table, VK_CLEAR, L"Clear");
+    SetSpecialKeyName(table, VK_RETURN, L"Enter");
+    SetSpecialKeyName(table, VK_SHIFT, L"Shift");
+    SetSpecialKeyName(table, VK_CONTROL, L"Ctrl");
+    SetSpecialKeyName(table, VK_MENU, L"Alt");
+    SetSpecialKeyName(table, VK_PAUSE, L"Pause");
+    SetSpecialKeyName(table, VK_CAPITAL, L"Caps Lock");
+    SetSpecialKeyName(table, VK_ESCAPE, L"Esc");
+    SetSpecialKeyName(table, VK_SPACE, L"Space");
+    SetSpecialKeyName(table, VK_PRIOR, L"PgUp");
+    SetSpecialKeyName(table, VK_NEXT, L"PgDn");
+    SetSpecialKeyName(table, VK_END, L"End");
+    SetSpecialKeyName(table, VK_HOME, L"Home");
+    SetSpecialKeyName(table, VK_LEFT, L"Left");
+    SetSpecialKeyName(table, VK_UP, L"Up");
+    SetSpecialKeyName(table, VK_RIGHT, L"Right");
+    SetSpecialKeyName(table, VK_DOWN, L"Down");
+    SetSpecialKeyName(table, VK_SELECT, L"Select");
+    SetSpecialKeyName(table, VK_PRINT, L"Print");
+    SetSpecialKeyName(table, VK_EXECUTE, L"Execute");
+    SetSpecialKeyName(table, VK_SNAPSHOT, L"Print Screen");
+    SetSpecialKeyName(table, VK_INSERT, L"Insert");
+    SetSpecialKeyName(table, VK_DELETE, L"Delete");
+    SetSpecialKeyName(table, VK_HELP, L"Help");
+    SetSpecialKeyName(table, VK_LWIN, L"Win (Left)");
+    SetSpecialKeyName(table, VK_RWIN, L"Win (Right)");
+    SetSpecialKeyName(table, VK_APPS, L"Apps/Menu");
+    SetSpecialKeyName(table, VK_SLEEP, L"Sleep");
+    SetSpecialKeyName(table, VK_NUMPAD0, L"NumPad 0");
+    SetSpecialKeyName(table, VK_NUMPAD1, L"NumPad 1");
+    SetSpecialKeyName(table, VK_NUMPAD2, L"NumPad 2");
+    SetSpecialKeyName(table, VK_NUMPAD3, L"NumPad 3");
+    SetSpecialKeyName(table, VK_NUMPAD4, L"NumPad 4");
+    SetSpecialKeyName(table, VK_NUMPAD5, L"NumPad 5");
+    SetSpecialKeyName(table, VK_NUMPAD6, L"NumPad 6");
+    SetSpecialKeyName(table, VK_NUMPAD7, L"NumPad 7");
+    SetSpecialKeyName(table, VK_NUMPAD8, L"NumPad 8");
+    SetSpecialKeyName(table, VK_NUMPAD9, L"NumPad 9");
+    SetSpecialKeyName(table, VK_SEPARATOR, L"Separator");
+    SetSpecialKeyName(table, VK_F1, L"F1");
+    SetSpecialKeyName(table, VK_F2, L"F2");
+    SetSpecialKeyName(table, VK_F3, L"F3");
+    SetSpecialKeyName(table, VK_F4, L"F4");
+    SetSpecialKeyName(table, VK_F5, L"F5");
+    SetSpecialKeyName(table, VK_F6, L"F6");
+    SetSpecialKeyName(table, VK_F7, L"F7");
+    SetSpecialKeyName(table, VK_F8, L"F8");
+    SetSpecialKeyName(table, VK_F9, L"F9");
+    SetSpecialKeyName(table, VK_F10, L"F10");
+    SetSpecialKeyName(table, VK_F11, L"F11");
+    SetSpecialKeyName(table, VK_F12, L"F12");
+    SetSpecialKeyName(table, VK_F13, L"F13");
+    SetSpecialKeyName(table, VK_F14, L"F14");
+    SetSpecialKeyName(table, VK_F15, L"F15");
+    SetSpecialKeyName(table, VK_F16, L"F16");
+    SetSpecialKeyName(table, VK_F17, L"F17");
+    SetSpecialKeyName(table, VK_F18, L"F18");
+    SetSpecialKeyName(table, VK_F19, L"F19");
+    SetSpecialKeyName(table, VK_F20, L"F20");
+    SetSpecialKeyName(table, VK_F21, L"F21");
+    SetSpecialKeyName(table, VK_F22, L"F22");
+    SetSpecialKeyName(table, VK_F23, L"F23");
+    SetSpecialKeyName(table, VK_F24, L"F24");
+    SetSpecialKeyName(table, VK_NUMLOCK, L"Num Lock");
+    SetSpecialKeyName(table, VK_SCROLL, L"Scroll Lock");
+    SetSpecialKeyName(table, VK_LSHIFT, L"Shift (Left)");
+    SetSpecialKeyName(table, VK_RSHIFT, L"Shift (Right)");
+    SetSpecialKeyName(table, VK_LCONTROL, L"Ctrl (Left)");
+    SetSpecialKeyName(table, VK_RCONTROL, L"Ctrl (Right)");
+    SetSpecialKeyName(table, VK_LMENU, L"Alt (Left)");
+    SetSpecialKeyName(table, VK_RMENU, L"Alt (Right)");
+    SetSpecialKeyName(table, VK_BROWSER_BACK, L"Browser Back");
+    SetSpecialKeyName(table, VK_BROWSER_FORWARD, L"Browser Forward");
+    SetSpecialKeyName(table, VK_BROWSER_REFRESH, L"Browser Refresh");
+    SetSpecialKeyName(table, VK_BROWSER_STOP, L"Browser Stop");
+    SetSpecialKeyName(table, VK_BROWSER_SEARCH, L"Browser Search");
+    SetSpecialKeyName(table, VK_BROWSER_FAVORITES, L"Browser Favorites");
+    SetSpecialKeyName(table, VK_BROWSER_HOME, L"Browser Home");
+    SetSpecialKeyName(table, VK_VOLUME_MUTE, L"Volume Mute");
+    SetSpecialKeyName(table, VK_VOLUME_DOWN, L"Volume Down");
+    SetSpecialKeyName(table, VK_VOLUME_UP, L"Volume Up");
+    SetSpecialKeyName(table, VK_MEDIA_NEXT_TRACK, L"Next Track");
+    SetSpecialKeyName(table, VK_MEDIA_PREV_TRACK, L"Previous Track");
+    SetSpecialKeyName(table, VK_MEDIA_STOP, L"Stop Media");
+    SetSpecialKeyName(table, VK_MEDIA_PLAY_PAUSE, L"Play/Pause Media");
+    SetSpecialKeyName(table, VK_LAUNCH_MAIL, L"Start Mail");
+    SetSpecialKeyName(table, VK_LAUNCH_MEDIA_SELECT, L"Select Media");
+    SetSpecialKeyName(table, VK_LAUNCH_APP1, L"Start App 1");
+    SetSpecialKeyName(table, VK_LAUNCH_APP2, L"Start App 2");
+    SetSpecialKeyName(table, VK_PACKET, L"Packet");
+    SetSpecialKeyName(table, VK_ATTN, L"Attn");
+    SetSpecialKeyName(table, VK_CRSEL, L"CrSel");
+    SetSpecialKeyName(table, VK_EXSEL, L"ExSel");
+    SetSpecialKeyName(table, VK_EREOF, L"Erase EOF");
+    SetSpecialKeyName(table, VK_PLAY, L"Play");
+    SetSpecialKeyName(table, VK_ZOOM, L"Zoom");
+    SetSpecialKeyName(table, VK_PA1, L"PA1");
+    SetSpecialKeyName(table, VK_OEM_CLEAR, L"Clear");
+    SetSpecialKeyName(table, 0xFF, L"Undefined");
+    SetSpecialKeyName(table, CommonSharedConstants::VK_WIN_BOTH, L"Win");
+    SetSpecialKeyName(table, VK_KANA, L"IME Kana");
+    SetSpecialKeyName(table, VK_HANGEUL, L"IME Hangeul");
+    SetSpecialKeyName(table, VK_HANGUL, L"IME Hangul");
+    SetSpecialKeyName(table, VK_JUNJA, L"IME Junja");
+    SetSpecialKeyName(table, VK_FINAL, L"IME Final");
+    SetSpecialKeyName(table, VK_HANJA, L"IME Hanja");
+    SetSpecialKeyName(table, VK_KANJI, L"IME Kanji");
+    SetSpecialKeyName(table, VK_CONVERT, L"IME Convert");
+    SetSpecialKeyName(table, VK_NONCONVERT, L"IME Non-Convert");
+    SetSpecialKeyName(table, VK_ACCEPT, L"IME Kana");
+    SetSpecialKeyName(table, VK_MODECHANGE, L"IME Mode Change");
+    SetSpecialKeyName(table, CommonSharedConstants::VK_DISABLED, L"Disable");
+
+    return tablePtr;
 }
 
 // Function to return the list of key codes in the order for the drop down. It creates it if it doesn't exist
@@ -227,13 +250,14 @@ std::vector<DWORD> LayoutMap::LayoutMapImpl::GetKeyCodeList(const bool isShortcu
     std::vector<DWORD> keyCodes;
     if (!isKeyCodeListGenerated)
     {
+        const KeyNameTable& table = *keyboardLayoutMap;
+
         // Add character keys
-        for (auto& it : unicodeKeys)
+        for (DWORD i = 1; i < 256; i++)
         {
-            // If it was not renamed with a special name
-            if (it.second == keyboardLayoutMap[it.first])
+            if (table.keyNameTypes[i] == KeyNameType::Unicode)
             {
-                keyCodes.push_back(it.first);
+                keyCodes.push_back(i);
             }
         }
 
@@ -253,27 +277,18 @@ std::vector<DWORD> LayoutMap::LayoutMapImpl::GetKeyCodeList(const bool isShortcu
 
         // Add all other special keys
         std::vector<DWORD> specialKeys;
-        for (int i = 1; i < 256; i++)
+        for (DWORD i = 1; i < 256; i++)
         {
-            // If it is not already been added (i.e. it was either a modifier or had a unicode representation)
-            if (std::find(keyCodes.begin(), keyCodes.end(), i) == keyCodes.end())
+            // If it is not already been added (i.e. it was either a modifier or had a unicode representation) and it is not named as VK #
+            if (table.keyNameTypes[i] == KeyNameType::Special && std::find(keyCodes.begin(), keyCodes.end(), i) == keyCodes.end())
             {
-                // If it is any other key but it is not named as VK #
-                auto it = unknownKeys.find(i);
-                if (it == unknownKeys.end())
-                {
-                    specialKeys.push_back(i);
-                }
-                else if (unknownKeys[i] != keyboardLayoutMap[i])
-                {
-                    specialKeys.push_back(i);
-                }
+                specialKeys.push_back(i);
             }
         }
 
         // Sort the special keys in alphabetical order
         std::sort(specialKeys.begin(), specialKeys.end(), [&](const DWORD& lhs, const DWORD& rhs) {
-            return keyboardLayoutMap[lhs] < keyboardLayoutMap[rhs];
+            return table.keyNames[lhs] < table.keyNames[rhs];
         });
         for (int i = 0; i < specialKeys.size(); i++)
         {
@@ -281,12 +296,11 @@ std::vector<DWORD> LayoutMap::LayoutMapImpl::GetKeyCodeList(const bool isShortcu
         }
 
         // Add unknown keys
-        for (auto& it : unknownKeys)
+        for (DWORD i = 1; i < 256; i++)
         {
-            // If it was not renamed with a special name
-            if (it.second == keyboardLayoutMap[it.first])
+            if (table.keyNameTypes[i] == KeyNameType::Unknown)
             {
-                keyCodes.push_back(it.first);
+                keyCodes.push_back(i);
             }
         }
         keyCodeList = keyCodes;
@@ -311,20 +325,23 @@ std::vector<std::pair<DWORD, std::wstring>> LayoutMap::LayoutMapImpl::GetKeyName
     std::vector<std::pair<DWORD, std::wstring>> keyNames;
     std::vector<DWORD> keyCodes = GetKeyCodeList(isShortcut);
     std::lock_guard<std::mutex> lock(keyboardLayoutMap_mutex);
+    const KeyNameTable& table = *keyboardLayoutMap;
+    keyNames.reserve(keyCodes.size());
+
     // If it is a key list for the shortcut control then we add a "None" key at the start
     if (isShortcut)
     {
         keyNames.push_back({ 0, L"None" });
         for (int i = 1; i < keyCodes.size(); i++)
         {
-            keyNames.push_back({ keyCodes[i], keyboardLayoutMap[keyCodes[i]] });
+            keyNames.push_back({ keyCodes[i], table.keyNames[keyCodes[i]] });
         }
     }
     else
     {
         for (int i = 0; i < keyCodes.size(); i++)
         {
-            keyNames.push_back({ keyCodes[i], keyboardLayoutMap[keyCodes[i]] });
+            keyNames.push_back({ keyCodes[i], table.keyNames[keyCodes[i]] });
         }
     }
 
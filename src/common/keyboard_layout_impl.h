@@ -1,7 +1,10 @@
 #pragma once
 #include "keyboard_layout.h"
+#include "shared_constants.h"
 #include <string>
+#include <array>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <winrt/Windows.UI.Core.h>
 
@@ -10,6 +13,30 @@ using namespace winrt;
 // Wrapper class to handle keyboard layout
 class LayoutMap::LayoutMapImpl
 {
+public:
+    // The key name tables are indexed by virtual key code, and also hold the names of the custom key codes used by PowerToys
+    static constexpr size_t KeyNameTableSize = (CommonSharedConstants::VK_WIN_BOTH > CommonSharedConstants::VK_DISABLED ? CommonSharedConstants::VK_WIN_BOTH : CommonSharedConstants::VK_DISABLED) + 1;
+
+    // Stores where the name of a key comes from
+    enum class KeyNameType
+    {
+        // The key does not exist (i.e. virtual key 0)
+        None,
+        // The name is the unicode representation of the key in the layout
+        Unicode,
+        // The key has no unicode representation, the name is the virtual key code
+        Unknown,
+        // The key has a fixed name, like Shift or Enter
+        Special
+    };
+
+    // Flat table of the key names of a keyboard layout. A table is never modified after it has been built, so it can be shared by all the LayoutMap objects
+    struct KeyNameTable
+    {
+        std::array<std::wstring, KeyNameTableSize> keyNames;
+        std::array<KeyNameType, KeyNameTableSize> keyNameTypes = {};
+    };
+
 private:
     // Stores mappings for all the virtual key codes to the name of the key
     std::mutex keyboardLayoutMap_mutex;
@@ -17,20 +44,21 @@ private:
     // Stores the previous layout
     HKL previousLayout = 0;
 
-    // Stores the keys which have a unicode representation
-    std::map<DWORD, std::wstring> unicodeKeys;
-
-    // Stores the keys which do not have a name
-    std::map<DWORD, std::wstring> unknownKeys;
-
     // Stores true if the fixed ordering key code list has already been set
     bool isKeyCodeListGenerated = false;
 
     // Stores a fixed order key code list for the drop down menus. It is kept fixed to change in ordering due to languages
     std::vector<DWORD> keyCodeList;
 
+    // Function to return the key name table of a layout. Tables are built on first use and cached for the lifetime of the process, so switching back to a layout which was used before does not rebuild it
+    static std::shared_ptr<const KeyNameTable> GetKeyNameTable(HKL layout);
+
+    // Function to build the key name table of a layout
+    static std::shared_ptr<const KeyNameTable> CreateKeyNameTable(HKL layout);
+
 public:
-    std::map<DWORD, std::wstring> keyboardLayoutMap;
+    // Stores the key names of the current layout
+    std::shared_ptr<const KeyNameTable> keyboardLayoutMap;
 
     // Update Keyboard layout according to input locale identifier
     void UpdateLayout();
@@ -48,4 +76,4 @@ public:
 
     // Function to return the list of key name pairs in the order for the drop down based on the key codes
     std::vector<std::pair<DWORD, std::wstring>> GetKeyNameList(const bool isShortcut);
-};
\ No newline at end of file
+};
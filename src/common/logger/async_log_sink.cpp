@@ -0,0 +1,264 @@
+#include "pch.h"
+#include "async_log_sink.h"
+#include <spdlog/pattern_formatter.h>
+#include <algorithm>
+
+AsyncLogSink::AsyncLogSink(std::string loggerName, std::shared_ptr<spdlog::sinks::sink> sink, AsyncOverflowPolicy overflowPolicy) :
+    loggerName(std::move(loggerName)),
+    sink(std::move(sink)),
+    overflowPolicy(overflowPolicy),
+    slots(std::make_unique<Slot[]>(Capacity)),
+    formatter(std::make_unique<spdlog::pattern_formatter>())
+{
+    for (size_t i = 0; i < Capacity; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    writer = std::thread([this] { writer_loop(); });
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    // Does nothing if the sink was already stopped. The DLLs stop it before they are unloaded, so the writer thread
+    // isn't joined under the loader lock.
+    stop();
+    CloseHandle(wakeEvent);
+}
+
+void AsyncLogSink::stop()
+{
+    if (stopping.exchange(true))
+    {
+        return;
+    }
+
+    SetEvent(wakeEvent);
+    writer.join();
+    stopped = true;
+
+    // A producer which checked the flag before it was set may still be queueing its message, the ones which come
+    // after see the flag and write synchronously
+    while (inFlightProducers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    write_pending();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+{
+    // The wrapped sink is thread safe
+    inFlightProducers++;
+    if (stopped)
+    {
+        inFlightProducers--;
+        write_to_sink(msg);
+        return;
+    }
+
+    while (!try_push(msg))
+    {
+        if (overflowPolicy == AsyncOverflowPolicy::Drop || stopping)
+        {
+            droppedCount++;
+            inFlightProducers--;
+            return;
+        }
+
+        wake_writer();
+        std::this_thread::yield();
+    }
+    inFlightProducers--;
+
+    // Wake up the writer thread if it's waiting for the first message of a batch, or if the batch is complete.
+    // Warnings and errors are written right away, since they may precede a crash.
+    const size_t queued = enqueuePos.load() - dequeuePos.load(std::memory_order_relaxed);
+    if ((writerIdle.load() && writerIdle.exchange(false)) || queued >= BatchSize || msg.level >= spdlog::level::warn)
+    {
+        wake_writer();
+    }
+}
+
+void AsyncLogSink::flush()
+{
+    if (stopped)
+    {
+        sink->flush();
+        return;
+    }
+
+    // The writer thread flushes the wrapped sink after each batch
+    wake_writer();
+}
+
+void AsyncLogSink::set_pattern(const std::string& pattern)
+{
+    formatter = std::make_unique<spdlog::pattern_formatter>(pattern);
+    sink->set_pattern(pattern);
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    formatter = sink_formatter->clone();
+    sink->set_formatter(std::move(sink_formatter));
+}
+
+size_t AsyncLogSink::dropped_count() const
+{
+    return droppedCount.load();
+}
+
+void AsyncLogSink::dump_recent_entries(const std::wstring& filePath, size_t count)
+{
+    HANDLE file = CreateFileW(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    const size_t end = enqueuePos.load();
+    const size_t begin = end - (std::min)({ count, end, Capacity });
+    for (size_t pos = begin; pos < end; pos++)
+    {
+        const Slot& slot = slots[pos & (Capacity - 1)];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        // Skip the entry if it's being overwritten
+        if (sequence != pos + 1 && sequence != pos + Capacity)
+        {
+            continue;
+        }
+
+        spdlog::memory_buf_t buffer;
+        formatter->format(to_log_msg(slot.entry), buffer);
+        DWORD written = 0;
+        WriteFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &written, nullptr);
+    }
+
+    CloseHandle(file);
+}
+
+bool AsyncLogSink::try_push(const spdlog::details::log_msg& msg)
+{
+    size_t pos = enqueuePos.load();
+    Slot* slot;
+    for (;;)
+    {
+        slot = &slots[pos & (Capacity - 1)];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (difference == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The writer thread hasn't written the entry which was queued Capacity messages ago
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos.load();
+        }
+    }
+
+    Entry& entry = slot->entry;
+    entry.level = msg.level;
+    entry.time = msg.time;
+    entry.threadId = msg.thread_id;
+    entry.payloadSize = (std::min)(msg.payload.size(), MaxPayloadSize);
+    std::copy_n(msg.payload.data(), entry.payloadSize, entry.payload);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLogSink::wake_writer()
+{
+    SetEvent(wakeEvent);
+}
+
+void AsyncLogSink::writer_loop()
+{
+    while (!stopping)
+    {
+        // The queue is checked after the flag is set, so a message which is queued in the meantime isn't missed
+        writerIdle = true;
+        if (enqueuePos.load() == dequeuePos.load())
+        {
+            WaitForSingleObject(wakeEvent, INFINITE);
+        }
+        writerIdle = false;
+
+        // Give the producers the time to fill the batch
+        if (!stopping && enqueuePos.load() - dequeuePos.load() < BatchSize)
+        {
+            WaitForSingleObject(wakeEvent, static_cast<DWORD>(MaxBatchLatency.count()));
+        }
+
+        write_pending();
+    }
+}
+
+size_t AsyncLogSink::write_pending()
+{
+    size_t written = 0;
+    for (;;)
+    {
+        const size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+        {
+            break;
+        }
+
+        write_to_sink(to_log_msg(slot.entry));
+        slot.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeuePos.store(pos + 1);
+        written++;
+    }
+
+    const size_t dropped = droppedCount.load();
+    if (dropped != reportedDroppedCount)
+    {
+        const auto message = fmt::format("{} log messages were dropped because the queue was full", dropped - reportedDroppedCount);
+        reportedDroppedCount = dropped;
+        write_to_sink(spdlog::details::log_msg(spdlog::log_clock::now(), spdlog::source_loc{}, loggerName, spdlog::level::warn, message));
+    }
+
+    if (written != 0)
+    {
+        try
+        {
+            sink->flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    return written;
+}
+
+void AsyncLogSink::write_to_sink(const spdlog::details::log_msg& msg)
+{
+    try
+    {
+        sink->log(msg);
+    }
+    catch (...)
+    {
+        // The file can't be written, the message is lost
+    }
+}
+
+spdlog::details::log_msg AsyncLogSink::to_log_msg(const Entry& entry) const
+{
+    spdlog::details::log_msg msg(entry.time, spdlog::source_loc{}, loggerName, entry.level, spdlog::string_view_t(entry.payload, entry.payloadSize));
+    msg.thread_id = entry.threadId;
+    return msg;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <spdlog/sinks/sink.h>
+#include <spdlog/details/log_msg.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <Windows.h>
+
+// What to do when a message is logged and the queue of the async sink is full
+enum class AsyncOverflowPolicy
+{
+    // Drop the message. The number of dropped messages is logged when the queue has room again
+    Drop,
+    // Wait until the writer thread has made room
+    Block
+};
+
+// Sink which hands the messages over to a single writer thread, which writes them to the wrapped sink in batches.
+// The messages are copied into a preallocated lock-free ring buffer, so logging never allocates, never takes a lock
+// and never touches the file. Messages longer than MaxPayloadSize are truncated.
+// The writer thread is woken up once per batch: when the first message is queued it waits at most MaxBatchLatency for
+// more messages, unless BatchSize messages are already queued or a warning or an error is logged.
+// The sink is stopped when it's destroyed, but a DLL must call stop() before it's unloaded.
+class AsyncLogSink : public spdlog::sinks::sink
+{
+public:
+    static constexpr size_t Capacity = 2048;
+    static constexpr size_t BatchSize = 256;
+    static constexpr size_t MaxPayloadSize = 512;
+    static constexpr std::chrono::milliseconds MaxBatchLatency{ 100 };
+
+    AsyncLogSink(std::string loggerName, std::shared_ptr<spdlog::sinks::sink> sink, AsyncOverflowPolicy overflowPolicy);
+    ~AsyncLogSink();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    // Writes the queued messages and joins the writer thread, the messages logged afterwards are written synchronously.
+    // Must not be called while the loader lock is held, e.g. from DllMain or the static destructors of a DLL.
+    void stop();
+
+    // Number of messages which were dropped since the sink was created
+    size_t dropped_count() const;
+
+    // Writes the last count messages to the file, including the ones which have already been written to the wrapped sink.
+    // Meant to be called when the process crashes, so it doesn't wait for the writer thread nor use the wrapped sink.
+    void dump_recent_entries(const std::wstring& filePath, size_t count);
+
+private:
+    struct Entry
+    {
+        spdlog::level::level_enum level;
+        spdlog::log_clock::time_point time;
+        size_t threadId;
+        size_t payloadSize;
+        char payload[MaxPayloadSize];
+    };
+
+    struct Slot
+    {
+        // Equal to the position of the slot when it's free, to the position + 1 when it holds a queued entry and
+        // to the position + Capacity when the entry has been written
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    bool try_push(const spdlog::details::log_msg& msg);
+    void wake_writer();
+    void writer_loop();
+
+    // Writes the queued entries to the wrapped sink, returns the number of entries
+    size_t write_pending();
+    void write_to_sink(const spdlog::details::log_msg& msg);
+    spdlog::details::log_msg to_log_msg(const Entry& entry) const;
+
+    const std::string loggerName;
+    std::shared_ptr<spdlog::sinks::sink> sink;
+    const AsyncOverflowPolicy overflowPolicy;
+    std::unique_ptr<Slot[]> slots;
+
+    // Copy of the formatter of the wrapped sink, used by dump_recent_entries
+    std::unique_ptr<spdlog::formatter> formatter;
+
+    alignas(64) std::atomic<size_t> enqueuePos{ 0 };
+    alignas(64) std::atomic<size_t> dequeuePos{ 0 };
+    alignas(64) std::atomic<size_t> droppedCount{ 0 };
+
+    // Only used by the writer thread
+    size_t reportedDroppedCount = 0;
+
+    // Set by the writer thread before it waits without a timeout, the producer which clears it wakes it up
+    std::atomic<bool> writerIdle{ false };
+    std::atomic<bool> stopping{ false };
+    // Set once the writer thread is gone
+    std::atomic<bool> stopped{ false };
+    // Number of log() calls which may still queue a message, stop() waits for them before the last write
+    std::atomic<size_t> inFlightProducers{ 0 };
+    HANDLE wakeEvent;
+    std::thread writer;
+};
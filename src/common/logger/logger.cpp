@@ -3,7 +3,9 @@
 #include "pch.h"
 #include "framework.h"
 #include "logger.h"
+#include "async_log_sink.h"
 #include <map>
+#include <filesystem>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog\sinks\stdout_color_sinks-inl.h>
 #include <iostream>
@@ -22,9 +24,8 @@ map<wstring, spdlog::level::level_enum> logLevelMapping = {
     { L"off", level::off },
 };
 
-level::level_enum getLogLevel(std::wstring_view logSettingsPath)
+level::level_enum getLogLevel(const std::wstring& logLevel)
 {
-    auto logLevel = get_log_settings(logSettingsPath).logLevel;
     level::level_enum result = logLevelMapping[LogSettings::defaultLogLevel];
     if (logLevelMapping.find(logLevel) != logLevelMapping.end())
     {
@@ -34,6 +35,21 @@ level::level_enum getLogLevel(std::wstring_view logSettingsPath)
     return result;
 }
 
+namespace
+{
+    // Set if async logging is enabled
+    std::shared_ptr<AsyncLogSink> asyncSink;
+    std::wstring crashLogPath;
+    bool crashHandlerInstalled = false;
+    LPTOP_LEVEL_EXCEPTION_FILTER previousExceptionFilter = nullptr;
+
+    LONG WINAPI dumpOnCrash(PEXCEPTION_POINTERS info)
+    {
+        Logger::dumpRecentEntries();
+        return previousExceptionFilter ? previousExceptionFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+    }
+}
+
 std::shared_ptr<spdlog::logger> Logger::logger;
 
 bool Logger::wasLogFailedShown()
@@ -47,10 +63,18 @@ bool Logger::wasLogFailedShown()
 
 void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
 {
-    auto logLevel = getLogLevel(logSettingsPath);
+    auto settings = get_log_settings(logSettingsPath);
+    auto logLevel = getLogLevel(settings.logLevel);
     try
     {
-        auto sink = make_shared<sinks::daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+        std::shared_ptr<sinks::sink> sink = make_shared<sinks::daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+        if (settings.asyncLogging)
+        {
+            auto overflowPolicy = settings.asyncOverflowPolicy == LogSettings::asyncOverflowPolicyBlock ? AsyncOverflowPolicy::Block : AsyncOverflowPolicy::Drop;
+            asyncSink = make_shared<AsyncLogSink>(loggerName, sink, overflowPolicy);
+            crashLogPath = std::filesystem::path(logFilePath).replace_extension().wstring() + LogSettings::crashLogSuffix;
+            sink = asyncSink;
+        }
         logger = make_shared<spdlog::logger>(loggerName, sink);
     }
     catch (...)
@@ -73,6 +97,43 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
     logger->set_level(logLevel);
     logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [p-%P] [t-%t] [%l] %v");
     spdlog::register_logger(logger);
-    spdlog::flush_every(std::chrono::seconds(3));
+
+    // The async sink flushes the file after each batch
+    if (!asyncSink)
+    {
+        spdlog::flush_every(std::chrono::seconds(3));
+    }
     logger->info("{} logger is initialized", loggerName);
 }
+
+void Logger::installCrashHandler()
+{
+    if (asyncSink && !crashHandlerInstalled)
+    {
+        previousExceptionFilter = SetUnhandledExceptionFilter(dumpOnCrash);
+        crashHandlerInstalled = true;
+    }
+}
+
+void Logger::shutdown()
+{
+    if (crashHandlerInstalled)
+    {
+        SetUnhandledExceptionFilter(previousExceptionFilter);
+        crashHandlerInstalled = false;
+    }
+
+    if (asyncSink)
+    {
+        asyncSink->stop();
+    }
+}
+
+void Logger::dumpRecentEntries()
+{
+    if (asyncSink)
+    {
+        asyncSink->dump_recent_entries(crashLogPath, LogSettings::crashLogEntries);
+    }
+}
+
@@ -14,6 +14,18 @@ public:
 
     static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath);
 
+    // Writes the last messages to the crash log when the process crashes. Only the executable should call it, since
+    // the exception filter is process wide and must not point into a DLL which may be unloaded.
+    static void installCrashHandler();
+
+    // Writes the queued messages and stops the async logging thread, the messages logged afterwards are written
+    // synchronously. Must be called before the module which called init is unloaded, and not from DllMain.
+    static void shutdown();
+
+    // Writes the last messages to the crash log. Does nothing unless async logging is enabled, since the messages are
+    // already in the log file otherwise
+    static void dumpRecentEntries();
+
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void trace(const FormatString& fmt, const Args&... args)
@@ -10,6 +10,8 @@ using namespace winrt::Windows::Data::Json;
 LogSettings::LogSettings()
 {
     this->logLevel = LogSettings::defaultLogLevel;
+    this->asyncLogging = false;
+    this->asyncOverflowPolicy = LogSettings::asyncOverflowPolicyDrop;
 }
 
 std::optional<JsonObject> from_file(std::wstring_view file_name)
@@ -47,6 +49,8 @@ JsonObject to_json(LogSettings settings)
 {
     JsonObject result;
     result.SetNamedValue(LogSettings::logLevelOption, JsonValue::CreateStringValue(settings.logLevel));
+    result.SetNamedValue(LogSettings::asyncLoggingOption, JsonValue::CreateBooleanValue(settings.asyncLogging));
+    result.SetNamedValue(LogSettings::asyncOverflowPolicyOption, JsonValue::CreateStringValue(settings.asyncOverflowPolicy));
 
     return result;
 }
@@ -62,7 +66,19 @@ LogSettings to_settings(JsonObject jobject)
     {
         result.logLevel = LogSettings::defaultLogLevel;
     }
-    
+
+    // The async options were added later, settings files which don't have them keep the defaults
+    try
+    {
+        result.asyncLogging = jobject.GetNamedBoolean(LogSettings::asyncLoggingOption, result.asyncLogging);
+        result.asyncOverflowPolicy = jobject.GetNamedString(LogSettings::asyncOverflowPolicyOption, result.asyncOverflowPolicy);
+    }
+    catch (...)
+    {
+        result.asyncLogging = false;
+        result.asyncOverflowPolicy = LogSettings::asyncOverflowPolicyDrop;
+    }
+
     return result;
 }
 
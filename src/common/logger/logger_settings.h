@@ -6,6 +6,11 @@ struct LogSettings
     // The following strings are not localizable
     inline const static std::wstring defaultLogLevel = L"warn";
     inline const static std::wstring logLevelOption = L"logLevel";
+    inline const static std::wstring asyncLoggingOption = L"asyncLogging";
+    inline const static std::wstring asyncOverflowPolicyOption = L"asyncOverflowPolicy";
+    inline const static std::wstring asyncOverflowPolicyDrop = L"drop";
+    inline const static std::wstring asyncOverflowPolicyBlock = L"block";
+    inline const static std::wstring crashLogSuffix = L"-crash.txt";
     inline const static std::string runnerLoggerName = "runner";
     inline const static std::wstring runnerLogPath = L"RunnerLogs\\runner-log.txt";
     inline const static std::string launcherLoggerName = "launcher";
@@ -15,7 +20,13 @@ struct LogSettings
     inline const static std::string shortcutGuideLoggerName = "shortcut-guide";
     inline const static std::wstring shortcutGuideLogPath = L"ShortcutGuideLogs\\shortcut-guide-log.txt";
     inline const static int retention = 30;
+    // Number of the last messages which are written to the crash log when async logging is enabled
+    inline const static size_t crashLogEntries = 256;
     std::wstring logLevel;
+    // Messages are written to the file by a background thread instead of the thread which logs them
+    bool asyncLogging;
+    // What to do when the async logging queue is full, either asyncOverflowPolicyDrop or asyncOverflowPolicyBlock
+    std::wstring asyncOverflowPolicy;
     LogSettings();
 };
 
@@ -0,0 +1,345 @@
+#include "pch.h"
+#include "process_path_cache.h"
+#include <atomic>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace
+{
+    const std::wstring_view app_frame_host = L"ApplicationFrameHost.exe";
+
+    struct ProcessEntry
+    {
+        std::wstring path;
+        // Opened with SYNCHRONIZE, the wait is signaled when the process exits
+        HANDLE process;
+        HANDLE wait;
+        // Tells the exit notification of the entry apart from the one of a previous entry of the same (reused) pid
+        uint32_t generation;
+        std::list<DWORD>::iterator lru_position;
+    };
+
+    struct WindowEntry
+    {
+        // Process of ApplicationFrameHost.exe which owns the window, a different owner means the handle was reused
+        DWORD host_pid;
+        // Process of the UWP app hosted in the window
+        DWORD app_pid;
+        std::list<HWND>::iterator lru_position;
+    };
+
+    struct Cache
+    {
+        std::mutex mutex;
+
+        std::unordered_map<DWORD, ProcessEntry> processes;
+        // Most recently used first
+        std::list<DWORD> processes_lru;
+        uint32_t next_generation = 0;
+
+        std::unordered_map<HWND, WindowEntry> windows;
+        std::list<HWND> windows_lru;
+
+        std::atomic<uint64_t> process_hits{ 0 };
+        std::atomic<uint64_t> process_misses{ 0 };
+        std::atomic<uint64_t> window_hits{ 0 };
+        std::atomic<uint64_t> window_misses{ 0 };
+    };
+
+    // Never destroyed, since exit notifications may still arrive while the process is terminating
+    Cache& cache()
+    {
+        static Cache* instance = new Cache();
+        return *instance;
+    }
+
+    PVOID to_wait_context(DWORD pid, uint32_t generation)
+    {
+        return reinterpret_cast<PVOID>((static_cast<uintptr_t>(generation) << 32) | pid);
+    }
+
+    bool ends_with_app_frame_host(const std::wstring& path)
+    {
+        return path.length() >= app_frame_host.length() &&
+               path.compare(path.length() - app_frame_host.length(), app_frame_host.length(), app_frame_host) == 0;
+    }
+
+    std::wstring query_process_path(HANDLE process)
+    {
+        std::wstring name;
+        name.resize(MAX_PATH);
+        DWORD name_length = static_cast<DWORD>(name.length());
+        if (QueryFullProcessImageNameW(process, 0, name.data(), &name_length) == 0)
+        {
+            name_length = 0;
+        }
+        name.resize(name_length);
+        return name;
+    }
+
+    // Must be called with the lock held
+    void erase_windows_of_process(Cache& c, DWORD pid)
+    {
+        for (auto it = c.windows.begin(); it != c.windows.end();)
+        {
+            if (it->second.app_pid == pid || it->second.host_pid == pid)
+            {
+                c.windows_lru.erase(it->second.lru_position);
+                it = c.windows.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void CALLBACK on_process_exit(PVOID context, BOOLEAN)
+    {
+        const auto value = reinterpret_cast<uintptr_t>(context);
+        const auto pid = static_cast<DWORD>(value & 0xFFFFFFFF);
+        const auto generation = static_cast<uint32_t>(value >> 32);
+
+        auto& c = cache();
+        HANDLE process = nullptr;
+        HANDLE wait = nullptr;
+        {
+            std::unique_lock lock{ c.mutex };
+            auto it = c.processes.find(pid);
+
+            // The entry was evicted, the evicting thread unregisters the wait
+            if (it == c.processes.end() || it->second.generation != generation)
+            {
+                return;
+            }
+
+            process = it->second.process;
+            wait = it->second.wait;
+            c.processes_lru.erase(it->second.lru_position);
+            c.processes.erase(it);
+            erase_windows_of_process(c, pid);
+        }
+
+        // Doesn't wait for the callback, so it can be called from it
+        UnregisterWait(wait);
+        CloseHandle(process);
+    }
+
+    void add_process(DWORD pid, const std::wstring& path, HANDLE process)
+    {
+        auto& c = cache();
+        std::vector<ProcessEntry> evicted;
+        bool added = false;
+        {
+            std::unique_lock lock{ c.mutex };
+
+            // Another thread may have added it in the meantime
+            if (c.processes.find(pid) == c.processes.end())
+            {
+                const uint32_t generation = ++c.next_generation;
+                HANDLE wait = nullptr;
+                if (RegisterWaitForSingleObject(&wait, process, on_process_exit, to_wait_context(pid, generation), INFINITE, WT_EXECUTEONLYONCE))
+                {
+                    c.processes_lru.push_front(pid);
+                    c.processes[pid] = { .path = path, .process = process, .wait = wait, .generation = generation, .lru_position = c.processes_lru.begin() };
+                    added = true;
+
+                    while (c.processes.size() > ProcessPathCache::MaxProcesses)
+                    {
+                        auto oldest = c.processes.find(c.processes_lru.back());
+                        c.processes_lru.pop_back();
+                        evicted.push_back(std::move(oldest->second));
+                        c.processes.erase(oldest);
+                    }
+                }
+            }
+        }
+
+        if (!added)
+        {
+            CloseHandle(process);
+        }
+
+        // Outside of the lock, since a running exit notification of the entry may be waiting for it
+        for (const auto& entry : evicted)
+        {
+            UnregisterWaitEx(entry.wait, INVALID_HANDLE_VALUE);
+            CloseHandle(entry.process);
+        }
+    }
+
+    void add_window(HWND window, DWORD host_pid, DWORD app_pid)
+    {
+        auto& c = cache();
+        std::unique_lock lock{ c.mutex };
+        if (c.windows.find(window) != c.windows.end())
+        {
+            return;
+        }
+
+        c.windows_lru.push_front(window);
+        c.windows[window] = { .host_pid = host_pid, .app_pid = app_pid, .lru_position = c.windows_lru.begin() };
+        if (c.windows.size() > ProcessPathCache::MaxWindows)
+        {
+            c.windows.erase(c.windows_lru.back());
+            c.windows_lru.pop_back();
+        }
+    }
+
+    // Returns the process of the UWP app hosted in the window, if it's cached
+    std::optional<DWORD> find_window(HWND window, DWORD host_pid)
+    {
+        auto& c = cache();
+        std::unique_lock lock{ c.mutex };
+        auto it = c.windows.find(window);
+        if (it == c.windows.end())
+        {
+            return std::nullopt;
+        }
+
+        if (it->second.host_pid != host_pid)
+        {
+            c.windows_lru.erase(it->second.lru_position);
+            c.windows.erase(it);
+            return std::nullopt;
+        }
+
+        c.windows_lru.splice(c.windows_lru.begin(), c.windows_lru, it->second.lru_position);
+        return it->second.app_pid;
+    }
+}
+
+namespace ProcessPathCache
+{
+    std::wstring get_process_path(DWORD pid) noexcept
+    {
+        auto& c = cache();
+        {
+            std::unique_lock lock{ c.mutex };
+            auto it = c.processes.find(pid);
+            if (it != c.processes.end())
+            {
+                c.processes_lru.splice(c.processes_lru.begin(), c.processes_lru, it->second.lru_position);
+                c.process_hits++;
+                return it->second.path;
+            }
+        }
+
+        c.process_misses++;
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, pid);
+        if (!process)
+        {
+            return {};
+        }
+
+        auto path = query_process_path(process);
+        if (path.empty())
+        {
+            CloseHandle(process);
+            return path;
+        }
+
+        try
+        {
+            add_process(pid, path, process);
+        }
+        catch (...)
+        {
+            // The path is still valid, it's just not cached
+        }
+        return path;
+    }
+
+    std::wstring get_process_path(HWND window) noexcept
+    {
+        auto& c = cache();
+        DWORD pid{};
+        GetWindowThreadProcessId(window, &pid);
+
+        if (auto app_pid = find_window(window, pid))
+        {
+            c.window_hits++;
+            return get_process_path(*app_pid);
+        }
+
+        auto name = get_process_path(pid);
+        if (!ends_with_app_frame_host(name))
+        {
+            return name;
+        }
+
+        // It is a UWP app. We will enumerate the windows and look for one created
+        // by something with a different PID
+        c.window_misses++;
+        DWORD new_pid = pid;
+        EnumChildWindows(
+            window, [](HWND hwnd, LPARAM param) -> BOOL {
+                auto new_pid_ptr = reinterpret_cast<DWORD*>(param);
+                DWORD pid;
+                GetWindowThreadProcessId(hwnd, &pid);
+                if (pid != *new_pid_ptr)
+                {
+                    *new_pid_ptr = pid;
+                    return FALSE;
+                }
+                else
+                {
+                    return TRUE;
+                }
+            },
+            reinterpret_cast<LPARAM>(&new_pid));
+
+        // If we have a new pid, get the new name. The app window may not have been created yet, so only the app is cached
+        if (new_pid != pid)
+        {
+            try
+            {
+                add_window(window, pid, new_pid);
+            }
+            catch (...)
+            {
+            }
+            return get_process_path(new_pid);
+        }
+        return name;
+    }
+
+    void invalidate_window(HWND window) noexcept
+    {
+        auto& c = cache();
+        std::unique_lock lock{ c.mutex };
+        auto it = c.windows.find(window);
+        if (it != c.windows.end())
+        {
+            c.windows_lru.erase(it->second.lru_position);
+            c.windows.erase(it);
+        }
+    }
+
+    Stats get_stats() noexcept
+    {
+        auto& c = cache();
+        return { c.process_hits.load(), c.process_misses.load(), c.window_hits.load(), c.window_misses.load() };
+    }
+
+    void shutdown() noexcept
+    {
+        auto& c = cache();
+        std::unordered_map<DWORD, ProcessEntry> processes;
+        {
+            std::unique_lock lock{ c.mutex };
+            processes.swap(c.processes);
+            c.processes_lru.clear();
+            c.windows.clear();
+            c.windows_lru.clear();
+        }
+
+        // Outside of the lock, since a running exit notification may be waiting for it. It doesn't find its entry anymore.
+        for (const auto& [pid, entry] : processes)
+        {
+            UnregisterWaitEx(entry.wait, INVALID_HANDLE_VALUE);
+            CloseHandle(entry.process);
+        }
+    }
+}
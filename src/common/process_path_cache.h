@@ -0,0 +1,41 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+#include <string>
+
+// Thread-safe cache behind get_process_path. Each binary which links common has its own cache, shared by all its threads.
+// A process path is cached until the process exits, the process is notified of that by a wait on the process handle.
+// The process which owns a window hosted by ApplicationFrameHost.exe (i.e. a UWP app) is found by enumerating the child
+// windows, the result is cached until the window is destroyed or the app exits.
+// Both caches are bounded, the least recently used entries are evicted first.
+// Only FancyZones calls invalidate_window, in the other binaries a window entry is dropped when the app or its host
+// exits, when its handle is reused by another host, or when it's evicted.
+// The exit notifications run code of the binary which linked common, so a module DLL must call shutdown() before it's unloaded.
+namespace ProcessPathCache
+{
+    constexpr size_t MaxProcesses = 128;
+    constexpr size_t MaxWindows = 256;
+
+    struct Stats
+    {
+        uint64_t processHits;
+        uint64_t processMisses;
+        uint64_t windowHits;
+        uint64_t windowMisses;
+    };
+
+    // Get the executable path of the process, empty if it can't be queried
+    std::wstring get_process_path(DWORD pid) noexcept;
+
+    // Get the executable path of the process which owns the window, or of the app it hosts for UWP apps
+    std::wstring get_process_path(HWND window) noexcept;
+
+    // Should be called when a window is destroyed, so a handle which is reused doesn't get the path of the previous window
+    void invalidate_window(HWND window) noexcept;
+
+    Stats get_stats() noexcept;
+
+    // Stops the exit notifications, waiting for the ones which are running, and empties the caches.
+    // Must not be called from an exit notification or while the loader lock is held.
+    void shutdown() noexcept;
+}
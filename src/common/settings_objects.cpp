@@ -262,6 +262,13 @@ namespace PowerToysSettings
         }
     }
 
+    bool Settings::serialize_to_writer(ConfigWriter writer, void* context)
+    {
+        const auto result = m_json.Stringify();
+        writer(context, result.c_str(), result.size());
+        return true;
+    }
+
     // Resource helper.
     std::wstring Settings::get_resource(UINT resource_id)
     {
@@ -6,6 +6,9 @@ namespace PowerToysSettings
 {
     class HotkeyObject;
 
+    // Same signature as PowertoyModuleIface::ConfigWriter.
+    typedef void(__cdecl* ConfigWriter)(void* context, const wchar_t* config, size_t length);
+
     class Settings
     {
     public:
@@ -55,6 +58,8 @@ namespace PowerToysSettings
         std::wstring serialize();
         // Serialize the internal json to the input buffer.
         bool serialize_to_buffer(wchar_t* buffer, int* buffer_size);
+        // Serialize the internal json once and pass it to the writer, see PowertoyModuleIface::write_config.
+        bool serialize_to_writer(ConfigWriter writer, void* context);
 
     private:
         json::JsonObject m_json;
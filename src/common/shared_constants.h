@@ -6,6 +6,9 @@ namespace CommonSharedConstants
     // Flag that can be set on an input event so that it is ignored by Keyboard Manager
     const ULONG_PTR KEYBOARDMANAGER_INJECTED_FLAG = 0x1;
 
+    // Flag set on the key events sent by the runner keyboard hook to replace a key, they are not dispatched to the keyboard event subscribers again
+    const ULONG_PTR RUNNER_REPLACEMENT_KEY_FLAG = 0x1000;
+
     // Fake key code to represent VK_WIN.
     inline const DWORD VK_WIN_BOTH = 0x104;
 
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+// SpscQueue is a fixed capacity, lock-free queue for exactly one producer thread and one consumer thread.
+// It never allocates and never blocks, which makes it suitable for handing events over from a low level
+// hook to a worker thread. push fails when the queue is full, pop returns std::nullopt when it is empty.
+
+template<typename T, size_t Capacity>
+class SpscQueue final
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Must only be called from the producer thread
+    bool push(const T& item) noexcept
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        _items[tail & (Capacity - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Must only be called from the consumer thread
+    std::optional<T> pop() noexcept
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return std::nullopt;
+        }
+
+        T item = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    bool empty() const noexcept
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> _items{};
+
+    // Head and tail are kept on separate cache lines so the producer and the consumer do not contend
+    alignas(64) std::atomic<size_t> _head{ 0 };
+    alignas(64) std::atomic<size_t> _tail{ 0 };
+};
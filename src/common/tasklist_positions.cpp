@@ -1,5 +1,65 @@
 #include "pch.h"
 #include "tasklist_positions.h"
+#include <atomic>
+
+namespace
+{
+    // Time to wait for more events once the tasklist changed, the buttons are moved one by one when a button is added
+    const std::chrono::milliseconds change_coalescing_delay(50);
+    // How often to look for the tasklist while Explorer isn't running, and to check that it hasn't been restarted
+    const DWORD tasklist_check_interval_ms = 1000;
+
+    class TasklistChangeHandler : public IUIAutomationStructureChangedEventHandler, public IUIAutomationPropertyChangedEventHandler
+    {
+    public:
+        TasklistChangeHandler(HANDLE changed_event) :
+            changed_event(changed_event)
+        {
+        }
+
+        HRESULT __stdcall QueryInterface(const IID& riid, void** ppv) override
+        {
+            static const QITAB qit[] = {
+                QITABENT(TasklistChangeHandler, IUIAutomationStructureChangedEventHandler),
+                QITABENT(TasklistChangeHandler, IUIAutomationPropertyChangedEventHandler),
+                { 0 }
+            };
+            return QISearch(this, qit, riid, ppv);
+        }
+
+        ULONG __stdcall AddRef() override
+        {
+            return ++ref_count;
+        }
+
+        ULONG __stdcall Release() override
+        {
+            ULONG count = --ref_count;
+            if (count == 0)
+            {
+                delete this;
+            }
+            return count;
+        }
+
+        // Called on a UI Automation thread, so it only wakes up the tracker thread
+        HRESULT __stdcall HandleStructureChangedEvent(IUIAutomationElement*, StructureChangeType, SAFEARRAY*) override
+        {
+            SetEvent(changed_event);
+            return S_OK;
+        }
+
+        HRESULT __stdcall HandlePropertyChangedEvent(IUIAutomationElement*, PROPERTYID, VARIANT) override
+        {
+            SetEvent(changed_event);
+            return S_OK;
+        }
+
+    private:
+        std::atomic<ULONG> ref_count = 1;
+        HANDLE changed_event;
+    };
+}
 
 void Tasklist::update()
 {
@@ -26,7 +86,48 @@ void Tasklist::update()
         winrt::check_hresult(automation->CreateTrueCondition(true_condition.put()));
     }
     element = nullptr;
+    this->tasklist_hwnd = nullptr;
     winrt::check_hresult(automation->ElementFromHandle(tasklist_hwnd, element.put()));
+    this->tasklist_hwnd = tasklist_hwnd;
+}
+
+bool Tasklist::watch_changes(HANDLE changed_event)
+{
+    stop_watching();
+    if (!automation || !element)
+    {
+        return false;
+    }
+    winrt::com_ptr<TasklistChangeHandler> handler;
+    handler.attach(new TasklistChangeHandler(changed_event));
+    const auto scope = static_cast<TreeScope>(TreeScope_Element | TreeScope_Children);
+    if (automation->AddStructureChangedEventHandler(element.get(), scope, nullptr, handler.get()) < 0)
+    {
+        return false;
+    }
+    PROPERTYID properties[] = { UIA_BoundingRectanglePropertyId };
+    if (automation->AddPropertyChangedEventHandlerNativeArray(element.get(), scope, nullptr, handler.get(), properties, ARRAYSIZE(properties)) < 0)
+    {
+        automation->RemoveAllEventHandlers();
+        return false;
+    }
+    change_handler.copy_from(static_cast<IUIAutomationStructureChangedEventHandler*>(handler.get()));
+    return true;
+}
+
+void Tasklist::stop_watching()
+{
+    if (change_handler)
+    {
+        // Waits for the handlers which are running
+        automation->RemoveAllEventHandlers();
+        change_handler = nullptr;
+    }
+}
+
+bool Tasklist::is_valid() const
+{
+    return tasklist_hwnd && IsWindow(tasklist_hwnd);
 }
 
 bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
@@ -113,4 +214,99 @@ std::vector<TasklistButton> Tasklist::get_buttons()
     std::vector<TasklistButton> buttons;
     update_buttons(buttons);
     return buttons;
+}
+
+TasklistTracker::TasklistTracker()
+{
+    stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    changed_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    tracker_thread = std::thread([this] { tracker_loop(); });
+}
+
+TasklistTracker::~TasklistTracker()
+{
+    SetEvent(stop_event);
+    tracker_thread.join();
+    CloseHandle(stop_event);
+    CloseHandle(changed_event);
+}
+
+bool TasklistTracker::get_buttons(std::vector<TasklistButton>& buttons, uint64_t& version)
+{
+    std::unique_lock lock(mutex);
+    if (version == buttons_version)
+    {
+        return false;
+    }
+    buttons = this->buttons;
+    version = buttons_version;
+    return true;
+}
+
+void TasklistTracker::tracker_loop()
+{
+    if (FAILED(CoInitializeEx(nullptr, COINIT_MULTITHREADED)))
+    {
+        return;
+    }
+
+    {
+        Tasklist tasklist;
+        bool watching = false;
+        for (;;)
+        {
+            if (!watching)
+            {
+                try
+                {
+                    tasklist.update();
+                    watching = tasklist.watch_changes(changed_event);
+                }
+                catch (...)
+                {
+                    watching = false;
+                }
+            }
+
+            std::vector<TasklistButton> found_buttons;
+            if (watching && !tasklist.update_buttons(found_buttons))
+            {
+                tasklist.stop_watching();
+                watching = false;
+            }
+            {
+                std::unique_lock lock(mutex);
+                buttons.swap(found_buttons);
+                buttons_version++;
+            }
+
+            HANDLE events[] = { stop_event, changed_event };
+            auto wait_result = WaitForMultipleObjects(ARRAYSIZE(events), events, FALSE, tasklist_check_interval_ms);
+            while (wait_result == WAIT_TIMEOUT && watching && tasklist.is_valid())
+            {
+                wait_result = WaitForMultipleObjects(ARRAYSIZE(events), events, FALSE, tasklist_check_interval_ms);
+            }
+
+            if (wait_result == WAIT_OBJECT_0)
+            {
+                break;
+            }
+            if (wait_result == WAIT_OBJECT_0 + 1)
+            {
+                if (WaitForSingleObject(stop_event, static_cast<DWORD>(change_coalescing_delay.count())) == WAIT_OBJECT_0)
+                {
+                    break;
+                }
+                ResetEvent(changed_event);
+            }
+            else if (!tasklist.is_valid())
+            {
+                tasklist.stop_watching();
+                watching = false;
+            }
+        }
+        tasklist.stop_watching();
+    }
+
+    CoUninitialize();
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <vector>
 #include <unordered_set>
 #include <string>
+#include <mutex>
+#include <thread>
 #include <Windows.h>
 #include <UIAutomationClient.h>
 
@@ -18,8 +20,44 @@ public:
     std::vector<TasklistButton> get_buttons();
     bool update_buttons(std::vector<TasklistButton>& buttons);
 
+    // Signals the event when buttons are added, removed or moved. Must be called after update().
+    bool watch_changes(HANDLE changed_event);
+    void stop_watching();
+
+    // False if the tasklist window found by update() has been destroyed, e.g. when Explorer restarts
+    bool is_valid() const;
+
 private:
+    HWND tasklist_hwnd = nullptr;
     winrt::com_ptr<IUIAutomation> automation;
     winrt::com_ptr<IUIAutomationElement> element;
     winrt::com_ptr<IUIAutomationCondition> true_condition;
+    winrt::com_ptr<IUnknown> change_handler;
+};
+
+// Keeps the tasklist buttons up to date on a background thread, from the UI Automation events of the tasklist.
+// Reading the buttons doesn't walk the UI Automation tree, so it's cheap enough to be done on every frame.
+class TasklistTracker
+{
+public:
+    TasklistTracker();
+    ~TasklistTracker();
+
+    TasklistTracker(const TasklistTracker&) = delete;
+    TasklistTracker& operator=(const TasklistTracker&) = delete;
+
+    // Copies the buttons if they changed since version was returned, returns true if they were copied.
+    // Pass 0 as the version to always get the buttons.
+    bool get_buttons(std::vector<TasklistButton>& buttons, uint64_t& version);
+
+private:
+    void tracker_loop();
+
+    std::mutex mutex;
+    std::vector<TasklistButton> buttons;
+    uint64_t buttons_version = 1;
+
+    HANDLE stop_event;
+    HANDLE changed_event;
+    std::thread tracker_thread;
 };
@@ -43,6 +43,21 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
     input_pipe_name = _input_pipe_name;
     output_pipe_name = _output_pipe_name;
     dispatch_inc_message_function = p_func;
+    stop_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    output_pipe_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::~TwoWayPipeMessageIPCImpl()
+{
+    close_output_pipe();
+    if (output_pipe_event != NULL)
+    {
+        CloseHandle(output_pipe_event);
+    }
+    if (stop_event != NULL)
+    {
+        CloseHandle(stop_event);
+    }
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
@@ -60,32 +75,51 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pi
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
 {
     closed = true;
+    // Cancels the pipe waiting for a connection, the reads of the connected clients and the pending write.
+    SetEvent(stop_event);
     input_queue.interrupt();
     input_queue_thread.join();
     output_queue.interrupt();
     output_queue_thread.join();
-    pipe_connect_handle_mutex.lock();
-    if (current_connect_pipe_handle != NULL)
+    input_pipe_thread.join();
     {
-        //Cancels the Pipe currently waiting for a connection.
-        CancelIoEx(current_connect_pipe_handle, NULL);
+        std::unique_lock lock(connection_threads_mutex);
+        for (auto& connection_thread : connection_threads)
+        {
+            connection_thread.join();
+        }
+        connection_threads.clear();
     }
-    pipe_connect_handle_mutex.unlock();
-    input_pipe_thread.join();
+    close_output_pipe();
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
+// Waits for an overlapped operation on the pipe to complete. Returns false if it failed or if it was cancelled by end().
+bool TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::wait_for_pipe_operation(HANDLE pipe_handle, OVERLAPPED& overlapped, DWORD& bytes_transferred)
+{
+    HANDLE wait_handles[] = { overlapped.hEvent, stop_event };
+    if (WaitForMultipleObjects(2, wait_handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+    {
+        CancelIoEx(pipe_handle, &overlapped);
+        GetOverlappedResult(pipe_handle, &overlapped, &bytes_transferred, TRUE);
+        return false;
+    }
+
+    return GetOverlappedResult(pipe_handle, &overlapped, &bytes_transferred, FALSE);
+}
+
+bool TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::connect_output_pipe()
 {
     // Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/named-pipe-client
-    HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
-    BOOL fSuccess = FALSE;
-    DWORD cbToWrite, cbWritten, dwMode;
+    if (output_pipe_handle != INVALID_HANDLE_VALUE)
+    {
+        return true;
+    }
+
     const wchar_t* lpszPipename = output_pipe_name.c_str();
 
     // Try to open a named pipe; wait for it, if necessary.
 
-    while (1)
+    while (!closed)
     {
         output_pipe_handle = CreateFile(
             lpszPipename, // pipe name
@@ -94,67 +128,109 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstr
             0, // no sharing
             NULL, // default security attributes
             OPEN_EXISTING, // opens existing pipe
-            0, // default attributes
+            FILE_FLAG_OVERLAPPED, // overlapped, so that end() can cancel a pending write
             NULL); // no template file
 
         // Break if the pipe handle is valid.
 
         if (output_pipe_handle != INVALID_HANDLE_VALUE)
-            break;
+        {
+            return true;
+        }
 
         // Exit if an error other than ERROR_PIPE_BUSY occurs.
-        DWORD curr_error = 0;
-        if ((curr_error = GetLastError()) != ERROR_PIPE_BUSY)
+        if (GetLastError() != ERROR_PIPE_BUSY)
         {
-            return;
+            return false;
         }
 
         // All pipe instances are busy, so wait for 20 seconds.
 
         if (!WaitNamedPipe(lpszPipename, 20000))
         {
-            return;
+            return false;
         }
     }
-    dwMode = PIPE_READMODE_MESSAGE;
-    fSuccess = SetNamedPipeHandleState(
-        output_pipe_handle, // pipe handle
-        &dwMode, // new pipe mode
-        NULL, // don't set maximum bytes
-        NULL); // don't set maximum time
-    if (!fSuccess)
+
+    return false;
+}
+
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::close_output_pipe()
+{
+    if (output_pipe_handle != INVALID_HANDLE_VALUE)
     {
-        return;
+        CloseHandle(output_pipe_handle);
+        output_pipe_handle = INVALID_HANDLE_VALUE;
     }
+}
+
+bool TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::write_output_pipe(const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = output_pipe_event;
+        ResetEvent(output_pipe_event);
+
+        DWORD cbWritten = 0;
+        const DWORD cbToWrite = static_cast<DWORD>(std::min(size, static_cast<size_t>(MAXDWORD)));
+        if (!WriteFile(output_pipe_handle, data, cbToWrite, &cbWritten, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+        {
+            return false;
+        }
+
+        if (!wait_for_pipe_operation(output_pipe_handle, overlapped, cbWritten))
+        {
+            return false;
+        }
 
-    // Send a message to the pipe server.
+        data += cbWritten;
+        size -= cbWritten;
+    }
 
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
+    return true;
+}
 
-    fSuccess = WriteFile(
-        output_pipe_handle, // pipe handle
-        message_send, // message
-        cbToWrite, // message length
-        &cbWritten, // bytes written
-        NULL); // not overlapped
-    if (!fSuccess)
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_messages(const std::vector<std::wstring>& messages)
+{
+    // All the queued messages are written with a single write.
+    write_buffer.clear();
+    for (const auto& message : messages)
     {
-        return;
+        const uint32_t message_size = static_cast<uint32_t>(message.size() * sizeof(wchar_t));
+        const uint8_t* header = reinterpret_cast<const uint8_t*>(&message_size);
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.data());
+        write_buffer.insert(write_buffer.end(), header, header + sizeof(message_size));
+        write_buffer.insert(write_buffer.end(), payload, payload + message_size);
+    }
+
+    // If the connection was broken, e.g. because the other process was restarted, reconnect once.
+    for (int attempt = 0; attempt < 2 && !closed; attempt++)
+    {
+        if (!connect_output_pipe())
+        {
+            return;
+        }
+
+        if (write_output_pipe(write_buffer.data(), write_buffer.size()))
+        {
+            return;
+        }
+
+        close_output_pipe();
     }
-    CloseHandle(output_pipe_handle);
-    return;
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
     while (!closed)
     {
-        std::wstring message = output_queue.pop_message();
-        if (message.length() == 0)
+        std::vector<std::wstring> messages = output_queue.pop_messages();
+        if (messages.empty())
         {
             break;
         }
-        send_pipe_message(message);
+        send_pipe_messages(messages);
     }
 }
 
@@ -348,125 +424,159 @@ HANDLE TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::create_medium_integrity_t
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HANDLE input_pipe_handle)
 {
-    //Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/multithreaded-pipe-server
-    HANDLE hHeap = GetProcessHeap();
-    uint8_t* pchRequest = (uint8_t*)HeapAlloc(hHeap, 0, BUFSIZE * sizeof(uint8_t));
-
-    DWORD cbBytesRead = 0, cbReplyBytes = 0, cbWritten = 0;
-    BOOL fSuccess = FALSE;
-
-    // Do some extra error checking since the app will keep running even if this thread fails.
-    std::list<std::vector<uint8_t>> message_parts;
-
+    // The client keeps the connection open, so the frames are read until it disconnects.
+    // Reads go straight into a single buffer, which grows to fit the largest frame.
     if (input_pipe_handle == NULL)
     {
-        if (pchRequest != NULL)
-            HeapFree(hHeap, 0, pchRequest);
         return;
     }
 
-    if (pchRequest == NULL)
+    HANDLE read_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (read_event == NULL)
     {
+        CloseHandle(input_pipe_handle);
         return;
     }
 
-    // Loop until done reading
-    do
+    std::vector<uint8_t> read_buffer(BUFSIZE);
+    size_t buffered_size = 0;
+
+    while (!closed)
     {
-        // Read client requests from the pipe. This simplistic code only allows messages
-        // up to BUFSIZE characters in length.
-        ZeroMemory(pchRequest, BUFSIZE * sizeof(uint8_t));
-        fSuccess = ReadFile(
-            input_pipe_handle, // handle to pipe
-            pchRequest, // buffer to receive data
-            BUFSIZE * sizeof(uint8_t), // size of buffer
-            &cbBytesRead, // number of bytes read
-            NULL); // not overlapped I/O
-
-        if (!fSuccess && GetLastError() != ERROR_MORE_DATA)
+        // Make room for the rest of the current frame if its size is already known, or for at least BUFSIZE more bytes.
+        size_t needed_size = buffered_size + BUFSIZE;
+        if (buffered_size >= sizeof(uint32_t))
+        {
+            uint32_t message_size;
+            memcpy(&message_size, read_buffer.data(), sizeof(message_size));
+            needed_size = std::max(needed_size, sizeof(message_size) + message_size);
+        }
+        if (read_buffer.size() < needed_size)
+        {
+            read_buffer.resize(std::max(needed_size, read_buffer.size() * 2));
+        }
+
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = read_event;
+        ResetEvent(read_event);
+
+        DWORD cbBytesRead = 0;
+        if (!ReadFile(
+                input_pipe_handle, // handle to pipe
+                read_buffer.data() + buffered_size, // buffer to receive data
+                static_cast<DWORD>(read_buffer.size() - buffered_size), // size of buffer
+                &cbBytesRead, // number of bytes read
+                &overlapped) &&
+            GetLastError() != ERROR_IO_PENDING)
         {
             break;
         }
-        std::vector<uint8_t> part_vector;
-        part_vector.reserve(cbBytesRead);
-        std::copy(pchRequest, pchRequest + cbBytesRead, std::back_inserter(part_vector));
-        message_parts.push_back(part_vector);
-    } while (!fSuccess);
 
-    if (fSuccess)
-    {
-        // Reconstruct the total_message.
-        std::vector<uint8_t> reconstructed_message;
-        size_t total_size = 0;
-        for (auto& part_vector : message_parts)
+        if (!wait_for_pipe_operation(input_pipe_handle, overlapped, cbBytesRead))
         {
-            total_size += part_vector.size();
+            break;
         }
-        reconstructed_message.reserve(total_size);
-        for (auto& part_vector : message_parts)
+        buffered_size += cbBytesRead;
+
+        // Dispatch all the complete frames and move the partial frame, if any, to the start of the buffer.
+        size_t offset = 0;
+        bool invalid_frame = false;
+        while (buffered_size - offset >= sizeof(uint32_t))
         {
-            std::move(part_vector.begin(), part_vector.end(), std::back_inserter(reconstructed_message));
+            uint32_t message_size;
+            memcpy(&message_size, read_buffer.data() + offset, sizeof(message_size));
+            if (message_size > MAX_MESSAGE_SIZE || message_size % sizeof(wchar_t) != 0)
+            {
+                invalid_frame = true;
+                break;
+            }
+            if (buffered_size - offset - sizeof(message_size) < message_size)
+            {
+                break;
+            }
+
+            const wchar_t* message = reinterpret_cast<const wchar_t*>(read_buffer.data() + offset + sizeof(message_size));
+            // An empty message would interrupt the input queue
+            if (message_size > 0)
+            {
+                input_queue.queue_message(std::wstring(message, message_size / sizeof(wchar_t)));
+            }
+            offset += sizeof(message_size) + message_size;
+        }
+
+        if (invalid_frame)
+        {
+            break;
         }
-        std::wstring unicode_msg;
-        unicode_msg.assign(reinterpret_cast<std::wstring::const_pointer>(reconstructed_message.data()), reconstructed_message.size() / sizeof(std::wstring::value_type));
-        input_queue.queue_message(unicode_msg);
-    }
 
-    // Flush the pipe to allow the client to read the pipe's contents
-    // before disconnecting. Then disconnect the pipe, and close the
-    // handle to this pipe instance.
+        if (offset > 0)
+        {
+            memmove(read_buffer.data(), read_buffer.data() + offset, buffered_size - offset);
+            buffered_size -= offset;
+        }
+    }
 
-    FlushFileBuffers(input_pipe_handle);
+    CloseHandle(read_event);
     DisconnectNamedPipe(input_pipe_handle);
     CloseHandle(input_pipe_handle);
-
-    HeapFree(hHeap, 0, pchRequest);
-
-    printf("InstanceThread exiting.\n");
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HANDLE token)
 {
     // Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/multithreaded-pipe-server
     const wchar_t* pipe_name = input_pipe_name.c_str();
-    BOOL connected = FALSE;
-    HANDLE connect_pipe_handle = INVALID_HANDLE_VALUE;
+    HANDLE connect_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (connect_event == NULL)
+    {
+        return;
+    }
+
     while (!closed)
     {
+        HANDLE connect_pipe_handle = CreateNamedPipe(
+            pipe_name,
+            PIPE_ACCESS_DUPLEX |
+                WRITE_DAC |
+                FILE_FLAG_OVERLAPPED,
+            PIPE_TYPE_BYTE |
+                PIPE_READMODE_BYTE |
+                PIPE_WAIT,
+            PIPE_UNLIMITED_INSTANCES,
+            BUFSIZE,
+            BUFSIZE,
+            0,
+            NULL);
+
+        if (connect_pipe_handle == INVALID_HANDLE_VALUE)
         {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            connect_pipe_handle = CreateNamedPipe(
-                pipe_name,
-                PIPE_ACCESS_DUPLEX |
-                    WRITE_DAC,
-                PIPE_TYPE_MESSAGE |
-                    PIPE_READMODE_MESSAGE |
-                    PIPE_WAIT,
-                PIPE_UNLIMITED_INSTANCES,
-                BUFSIZE,
-                BUFSIZE,
-                0,
-                NULL);
-
-            if (connect_pipe_handle == INVALID_HANDLE_VALUE)
-            {
-                return;
-            }
+            break;
+        }
 
-            if (token != NULL)
-            {
-                int err = change_pipe_security_allow_restricted_token(connect_pipe_handle, token);
-            }
-            current_connect_pipe_handle = connect_pipe_handle;
+        if (token != NULL)
+        {
+            int err = change_pipe_security_allow_restricted_token(connect_pipe_handle, token);
         }
-        connected = ConnectNamedPipe(connect_pipe_handle, NULL) ? TRUE : (GetLastError() == ERROR_PIPE_CONNECTED);
+
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = connect_event;
+        ResetEvent(connect_event);
+
+        BOOL connected = FALSE;
+        if (ConnectNamedPipe(connect_pipe_handle, &overlapped))
+        {
+            connected = TRUE;
+        }
+        else
         {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            current_connect_pipe_handle = NULL;
+            DWORD error = GetLastError();
+            DWORD unused = 0;
+            connected = error == ERROR_PIPE_CONNECTED || (error == ERROR_IO_PENDING && wait_for_pipe_operation(connect_pipe_handle, overlapped, unused));
         }
+
         if (connected)
         {
-            std::thread(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle).detach();
+            std::unique_lock lock(connection_threads_mutex);
+            connection_threads.emplace_back(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle);
         }
         else
         {
@@ -474,6 +584,8 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HAN
             CloseHandle(connect_pipe_handle);
         }
     }
+
+    CloseHandle(connect_event);
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread()
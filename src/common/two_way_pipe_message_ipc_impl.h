@@ -4,7 +4,8 @@
 #include <WinSafer.h>
 #include <accctrl.h>
 #include <aclapi.h>
-#include <list>
+#include <atomic>
+#include <vector>
 #include "two_way_pipe_message_ipc.h"
 
 class TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl
@@ -12,6 +13,7 @@ class TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl
 public:
     void send(std::wstring msg);
     TwoWayPipeMessageIPCImpl(std::wstring _input_pipe_name, std::wstring _output_pipe_name, callback_function p_func);
+    ~TwoWayPipeMessageIPCImpl();
     void start(HANDLE _restricted_pipe_token);
     void end();
 
@@ -23,15 +25,27 @@ private:
     std::thread input_queue_thread;
     std::thread output_queue_thread;
     std::thread input_pipe_thread;
-    std::mutex pipe_connect_handle_mutex; // For manipulating the current_connect_pipe
+    std::mutex connection_threads_mutex; // For manipulating the connection_threads
+    std::vector<std::thread> connection_threads; // One thread per connected client, they read until the client disconnects
     std::wstring outgoing_message; // Store the updated json settings.
 
-    HANDLE current_connect_pipe_handle = NULL;
-    bool closed = false;
+    // Messages are sent over a single persistent connection to the output pipe. Each message is a frame made of its size in bytes
+    // as a 32-bit integer followed by the UTF-16 message, so the pipes are in byte mode and a read may contain several frames.
+    HANDLE output_pipe_handle = INVALID_HANDLE_VALUE;
+    HANDLE output_pipe_event = NULL;
+    std::vector<uint8_t> write_buffer; // Reused for the frames of the messages which are sent together
+
+    HANDLE stop_event = NULL; // Signaled by end() to cancel the pending pipe operations
+    std::atomic_bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
     const DWORD BUFSIZE = 1024;
+    const uint32_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
 
-    void send_pipe_message(std::wstring message);
+    bool wait_for_pipe_operation(HANDLE pipe_handle, OVERLAPPED& overlapped, DWORD& bytes_transferred);
+    bool connect_output_pipe();
+    void close_output_pipe();
+    bool write_output_pipe(const uint8_t* data, size_t size);
+    void send_pipe_messages(const std::vector<std::wstring>& messages);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
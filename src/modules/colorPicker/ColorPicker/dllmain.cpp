@@ -81,6 +81,17 @@ public:
     }
 
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -90,7 +101,7 @@ public:
 
         settings.set_overview_link(L"https://aka.ms/PowerToysOverview_ColorPicker");
 
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     virtual void call_custom_action(const wchar_t* action) override
@@ -160,3 +171,8 @@ extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new ColorPicker();
 }
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
+}
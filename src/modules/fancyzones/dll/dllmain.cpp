@@ -1,7 +1,7 @@
 #include "pch.h"
 #include <common/settings_objects.h>
 #include <common/common.h>
-#include <common/debug_control.h>
+#include <common/process_path_cache.h>
 #include <common/LowlevelKeyboardEvent.h>
 #include <interface/powertoy_module_interface.h>
 #include <lib/ZoneSet.h>
@@ -58,6 +58,11 @@ public:
         return m_settings->GetConfig(buffer, buffer_size);
     }
 
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return m_settings->WriteConfig(writer, context);
+    }
+
     // Passes JSON with the configuration settings for the powertoy.
     // This is called when the user hits Save on the settings page.
     virtual void set_config(PCWSTR config) override
@@ -82,30 +87,15 @@ public:
             InitializeWinhookEventIds();
             Trace::FancyZones::EnableFancyZones(true);
             m_app = MakeFancyZones(reinterpret_cast<HINSTANCE>(&__ImageBase), m_settings, std::bind(&FancyZonesModule::disable, this));
-#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
-            const bool hook_disabled = IsDebuggerPresent();
-#else
-            const bool hook_disabled = false;
-#endif
-            if (!hook_disabled)
-            {
-                s_llKeyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), NULL);
-                if (!s_llKeyboardHook)
-                {
-                    DWORD errorCode = GetLastError();
-                    show_last_error_message(L"SetWindowsHookEx", errorCode, GET_RESOURCE_STRING(IDS_POWERTOYS_FANCYZONES).c_str());
-                    auto errorMessage = get_last_error_message(errorCode);
-                    Trace::FancyZones::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"enable.SetWindowsHookEx");
-                }
-            }
 
-            std::array<DWORD, 6> events_to_subscribe = {
+            std::array<DWORD, 7> events_to_subscribe = {
                 EVENT_SYSTEM_MOVESIZESTART,
                 EVENT_SYSTEM_MOVESIZEEND,
                 EVENT_OBJECT_NAMECHANGE,
                 EVENT_OBJECT_UNCLOAKED,
                 EVENT_OBJECT_SHOW,
-                EVENT_OBJECT_CREATE
+                EVENT_OBJECT_CREATE,
+                EVENT_OBJECT_DESTROY
             };
             for (const auto event : events_to_subscribe)
             {
@@ -144,11 +134,30 @@ public:
         return m_app != nullptr;
     }
 
+    // The keyboard events come from the runner's hook, after Keyboard Manager and Shortcut Guide
+    virtual int get_keyboard_event_priority() override
+    {
+        return 10;
+    }
+
+    // Called by the runner's hook while the powertoy is enabled
+    virtual KeyboardEventDecision on_keyboard_event(LowlevelKeyboardEvent* event) override
+    {
+        if (event->wParam == WM_KEYDOWN && HandleKeyboardHookEvent(event) == 1)
+        {
+            return { KeyboardEventDecision::Type::Suppress };
+        }
+        return {};
+    }
+
     // Destroy the powertoy and free memory
     virtual void destroy() override
     {
         Disable(false);
         delete this;
+        // The DLL may be unloaded right after, while the logging thread and the exit notifications can't be stopped anymore
+        ProcessPathCache::shutdown();
+        Logger::shutdown();
     }
 
     FancyZonesModule()
@@ -176,14 +185,6 @@ private:
             m_app = nullptr;
             m_settings->ResetCallback();
 
-            if (s_llKeyboardHook)
-            {
-                if (UnhookWindowsHookEx(s_llKeyboardHook))
-                {
-                    s_llKeyboardHook = nullptr;
-                }
-            }
-
             m_staticWinEventHooks.erase(std::remove_if(begin(m_staticWinEventHooks),
                                                        end(m_staticWinEventHooks),
                                                        [](const HWINEVENTHOOK hook) {
@@ -210,29 +211,10 @@ private:
     std::wstring app_key;
 
     static inline FancyZonesModule* s_instance;
-    static inline HHOOK s_llKeyboardHook;
 
     std::vector<HWINEVENTHOOK> m_staticWinEventHooks;
     HWINEVENTHOOK m_objectLocationWinEventHook;
 
-    static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
-    {
-        LowlevelKeyboardEvent event;
-        if (nCode == HC_ACTION && wParam == WM_KEYDOWN)
-        {
-            event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-            event.wParam = wParam;
-            if (s_instance)
-            {
-                if (s_instance->HandleKeyboardHookEvent(&event) == 1)
-                {
-                    return 1;
-                }
-            }
-        }
-        return CallNextHookEx(NULL, nCode, wParam, lParam);
-    }
-
     static void CALLBACK WinHookProc(HWINEVENTHOOK winEventHook,
                                      DWORD event,
                                      HWND window,
@@ -310,6 +292,16 @@ void FancyZonesModule::HandleWinHookEvent(WinHookEvent* data) noexcept
     }
     break;
 
+    case EVENT_OBJECT_DESTROY:
+    {
+        // The handle may be reused by a window of another app
+        if (data->idObject == OBJID_WINDOW)
+        {
+            ProcessPathCache::invalidate_window(data->hwnd);
+        }
+    }
+    break;
+
     default:
         break;
     }
@@ -319,3 +311,8 @@ extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new FancyZonesModule();
 }
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
+}
@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "ExcludedAppsMatcher.h"
+
+#include <common/common.h>
+
+#include <algorithm>
+
+// Non-Localizable strings
+namespace NonLocalizable
+{
+    const wchar_t PowerToysAppPowerLauncher[] = L"POWERLAUNCHER.EXE";
+    const wchar_t PowerToysAppFZEditor[] = L"FANCYZONESEDITOR.EXE";
+}
+
+ExcludedAppsMatcher::ExcludedAppsMatcher() :
+    ExcludedAppsMatcher(std::vector<std::wstring>{})
+{
+}
+
+ExcludedAppsMatcher::ExcludedAppsMatcher(const std::vector<std::wstring>& excludedApps)
+{
+    m_names.reserve(excludedApps.size() + 2);
+    for (const auto& name : excludedApps)
+    {
+        if (name.empty())
+        {
+            continue;
+        }
+
+        if (name.find(L'\\') == std::wstring::npos)
+        {
+            m_names.push_back(name);
+        }
+        else
+        {
+            m_pathNames.push_back(name);
+        }
+    }
+    m_names.emplace_back(NonLocalizable::PowerToysAppPowerLauncher);
+    m_names.emplace_back(NonLocalizable::PowerToysAppFZEditor);
+
+    // m_names isn't modified anymore, so the views stay valid
+    for (const auto& name : m_names)
+    {
+        m_executableNamePrefixes.insert(name);
+        m_prefixLengths.push_back(name.length());
+    }
+    std::sort(m_prefixLengths.begin(), m_prefixLengths.end());
+    m_prefixLengths.erase(std::unique(m_prefixLengths.begin(), m_prefixLengths.end()), m_prefixLengths.end());
+}
+
+bool ExcludedAppsMatcher::IsExcluded(const std::wstring& processPath) const noexcept
+{
+    try
+    {
+        {
+            std::scoped_lock lock{ m_cacheMutex };
+            if (auto it = m_cache.find(processPath); it != m_cache.end())
+            {
+                return it->second;
+            }
+        }
+
+        auto uppercasePath = processPath;
+        CharUpperBuffW(uppercasePath.data(), static_cast<DWORD>(uppercasePath.length()));
+        const bool excluded = Match(uppercasePath);
+
+        std::scoped_lock lock{ m_cacheMutex };
+        if (m_cache.size() >= MaxCachedPaths)
+        {
+            m_cache.clear();
+        }
+        m_cache.emplace(processPath, excluded);
+        return excluded;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ExcludedAppsMatcher::Match(const std::wstring& uppercasePath) const
+{
+    if (find_app_name_in_path(uppercasePath, m_pathNames))
+    {
+        return true;
+    }
+
+    const auto lastSlash = uppercasePath.rfind(L'\\');
+    if (lastSlash == std::wstring::npos)
+    {
+        return false;
+    }
+
+    const std::wstring_view executableName = std::wstring_view(uppercasePath).substr(lastSlash + 1);
+    for (const auto length : m_prefixLengths)
+    {
+        if (length > executableName.length())
+        {
+            break;
+        }
+
+        const auto prefix = executableName.substr(0, length);
+        // The name must not occur again further in the executable name, since only the last occurrence counts
+        if (m_executableNamePrefixes.contains(prefix) && executableName.find(prefix, 1) == std::wstring_view::npos)
+        {
+            return true;
+        }
+    }
+    return false;
+}
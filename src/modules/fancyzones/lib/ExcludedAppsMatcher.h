@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Decides which apps FancyZones doesn't zone: the apps excluded by the user and the PowerToys apps which
+ * must never be zoned. Built once when the settings change, the answer is cached per process path.
+ *
+ * An app is excluded by the same rules as find_app_name_in_path, i.e. the last occurrence of the excluded
+ * name in the path must start at the beginning of the executable name, or span the last backslash.
+ * Since a name without a backslash can only match at the beginning of the executable name, those names
+ * are looked up in a hash set by the prefixes of the executable name, the others are checked one by one.
+ */
+class ExcludedAppsMatcher
+{
+public:
+    ExcludedAppsMatcher();
+
+    /**
+     * @param[in] excludedApps Upper case names of the excluded apps, as in Settings::excludedAppsArray.
+     */
+    explicit ExcludedAppsMatcher(const std::vector<std::wstring>& excludedApps);
+
+    ExcludedAppsMatcher(const ExcludedAppsMatcher&) = delete;
+    ExcludedAppsMatcher& operator=(const ExcludedAppsMatcher&) = delete;
+
+    bool IsExcluded(const std::wstring& processPath) const noexcept;
+
+private:
+    static constexpr size_t MaxCachedPaths = 256;
+
+    bool Match(const std::wstring& uppercasePath) const;
+
+    // Owns the names, the set points into it
+    std::vector<std::wstring> m_names;
+    std::unordered_set<std::wstring_view> m_executableNamePrefixes;
+    // Distinct lengths of the names in m_executableNamePrefixes, in ascending order
+    std::vector<size_t> m_prefixLengths;
+    // Names which contain a backslash
+    std::vector<std::wstring> m_pathNames;
+
+    mutable std::mutex m_cacheMutex;
+    mutable std::unordered_map<std::wstring, bool> m_cache;
+};
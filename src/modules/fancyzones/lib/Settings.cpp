@@ -54,11 +54,13 @@ public:
     IFACEMETHODIMP_(void) SetCallback(IFancyZonesCallback* callback) { m_callback = callback; }
     IFACEMETHODIMP_(void) ResetCallback() { m_callback = nullptr; }
     IFACEMETHODIMP_(bool) GetConfig(_Out_ PWSTR buffer, _Out_ int *buffer_sizeg) noexcept;
+    IFACEMETHODIMP_(bool) WriteConfig(PowerToysSettings::ConfigWriter writer, void* context) noexcept;
     IFACEMETHODIMP_(void) SetConfig(PCWSTR config) noexcept;
     IFACEMETHODIMP_(void) CallCustomAction(PCWSTR action) noexcept;
     IFACEMETHODIMP_(const Settings*) GetSettings() const noexcept { return &m_settings; }
 
 private:
+    PowerToysSettings::Settings BuildSettings() noexcept;
     void LoadSettings(PCWSTR config, bool fromFile) noexcept;
     void SaveSettings() noexcept;
 
@@ -97,6 +99,16 @@ private:
 };
 
 IFACEMETHODIMP_(bool) FancyZonesSettings::GetConfig(_Out_ PWSTR buffer, _Out_ int *buffer_size) noexcept
+{
+    return BuildSettings().serialize_to_buffer(buffer, buffer_size);
+}
+
+IFACEMETHODIMP_(bool) FancyZonesSettings::WriteConfig(PowerToysSettings::ConfigWriter writer, void* context) noexcept
+{
+    return BuildSettings().serialize_to_writer(writer, context);
+}
+
+PowerToysSettings::Settings FancyZonesSettings::BuildSettings() noexcept
 {
     PowerToysSettings::Settings settings(m_hinstance, m_moduleName);
 
@@ -129,7 +141,7 @@ IFACEMETHODIMP_(bool) FancyZonesSettings::GetConfig(_Out_ PWSTR buffer, _Out_ in
 
     settings.add_multiline_string(NonLocalizable::ExcludedAppsID, IDS_SETTING_EXCLUDED_APPS_DESCRIPTION, m_settings.excludedApps);
 
-    return settings.serialize_to_buffer(buffer, buffer_size);
+    return settings;
 }
 
 IFACEMETHODIMP_(void) FancyZonesSettings::SetConfig(PCWSTR serializedPowerToysSettingsJson) noexcept
@@ -225,6 +237,7 @@ void FancyZonesSettings::LoadSettings(PCWSTR config, bool fromFile) noexcept
                     view.remove_prefix(1);
                 }
             }
+            m_settings.excludedAppsMatcher = std::make_shared<const ExcludedAppsMatcher>(m_settings.excludedAppsArray);
         }
 
         if (auto val = values.get_int_value(NonLocalizable::ZoneHighlightOpacityID))
@@ -2,6 +2,8 @@
 
 #include <common/settings_objects.h>
 
+#include "ExcludedAppsMatcher.h"
+
 // Zoned window properties are not localized.
 namespace ZonedWindowProperties
 {
@@ -37,6 +39,8 @@ struct Settings
     PowerToysSettings::HotkeyObject editorHotkey = PowerToysSettings::HotkeyObject::from_settings(true, false, false, false, VK_OEM_3);
     std::wstring excludedApps = L"";
     std::vector<std::wstring> excludedAppsArray;
+    // Built from excludedAppsArray
+    std::shared_ptr<const ExcludedAppsMatcher> excludedAppsMatcher = std::make_shared<const ExcludedAppsMatcher>();
 };
 
 interface __declspec(uuid("{BA4E77C4-6F44-4C5D-93D3-CBDE880495C2}")) IFancyZonesSettings : public IUnknown
@@ -44,6 +48,7 @@ interface __declspec(uuid("{BA4E77C4-6F44-4C5D-93D3-CBDE880495C2}")) IFancyZones
     IFACEMETHOD_(void, SetCallback)(interface IFancyZonesCallback* callback) = 0;
     IFACEMETHOD_(void, ResetCallback)() = 0;
     IFACEMETHOD_(bool, GetConfig)(_Out_ PWSTR buffer, _Out_ int *buffer_size) = 0;
+    IFACEMETHOD_(bool, WriteConfig)(PowerToysSettings::ConfigWriter writer, void* context) = 0;
     IFACEMETHOD_(void, SetConfig)(PCWSTR serializedPowerToysSettingsJson) = 0;
     IFACEMETHOD_(void, CallCustomAction)(PCWSTR action) = 0;
     IFACEMETHOD_(const Settings*, GetSettings)() const = 0;
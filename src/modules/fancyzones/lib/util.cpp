@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "util.h"
 #include "Settings.h"
+#include "ExcludedAppsMatcher.h"
 
 #include <common/common.h>
 #include <common/dpi_aware.h>
@@ -11,35 +12,6 @@
 
 #include <fancyzones/lib/FancyZonesDataTypes.h>
 
-// Non-Localizable strings
-namespace NonLocalizable
-{
-    const wchar_t PowerToysAppPowerLauncher[] = L"POWERLAUNCHER.EXE";
-    const wchar_t PowerToysAppFZEditor[] = L"FANCYZONESEDITOR.EXE";
-}
-
-namespace
-{
-    bool IsZonableByProcessPath(const std::wstring& processPath, const std::vector<std::wstring>& excludedApps)
-    {
-        // Filter out user specified apps
-        CharUpperBuffW(const_cast<std::wstring&>(processPath).data(), (DWORD)processPath.length());
-        if (find_app_name_in_path(processPath, excludedApps))
-        {
-            return false;
-        }
-        if (find_app_name_in_path(processPath, { NonLocalizable::PowerToysAppPowerLauncher }))
-        {
-            return false;
-        }
-        if (find_app_name_in_path(processPath, { NonLocalizable::PowerToysAppFZEditor }))
-        {
-            return false;
-        }
-        return true;
-    }
-}
-
 namespace FancyZonesUtils
 {
     std::wstring TrimDeviceId(const std::wstring& deviceId)
@@ -384,7 +356,7 @@ namespace FancyZonesUtils
         return true;
     }
 
-    bool IsCandidateForLastKnownZone(HWND window, const std::vector<std::wstring>& excludedApps) noexcept
+    bool IsCandidateForLastKnownZone(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept
     {
         auto zonable = IsStandardWindow(window) && HasNoVisibleOwner(window);
         if (!zonable)
@@ -392,17 +364,17 @@ namespace FancyZonesUtils
             return false;
         }
 
-        return IsZonableByProcessPath(get_process_path(window), excludedApps);
+        return !excludedApps.IsExcluded(get_process_path(window));
     }
 
-    bool IsCandidateForZoning(HWND window, const std::vector<std::wstring>& excludedApps) noexcept
+    bool IsCandidateForZoning(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept
     {
         if (!IsStandardWindow(window))
         {
             return false;
         }
 
-        return IsZonableByProcessPath(get_process_path(window), excludedApps);
+        return !excludedApps.IsExcluded(get_process_path(window));
     }
 
     bool IsWindowMaximized(HWND window) noexcept
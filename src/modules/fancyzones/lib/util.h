@@ -9,6 +9,8 @@ namespace FancyZonesDataTypes
     struct DeviceIdData;
 }
 
+class ExcludedAppsMatcher;
+
 namespace FancyZonesUtils
 {
     struct Rect
@@ -149,8 +151,8 @@ namespace FancyZonesUtils
 
     bool HasNoVisibleOwner(HWND window) noexcept;
     bool IsStandardWindow(HWND window);
-    bool IsCandidateForLastKnownZone(HWND window, const std::vector<std::wstring>& excludedApps) noexcept;
-    bool IsCandidateForZoning(HWND window, const std::vector<std::wstring>& excludedApps) noexcept;
+    bool IsCandidateForLastKnownZone(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept;
+    bool IsCandidateForZoning(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept;
 
     bool IsWindowMaximized(HWND window) noexcept;
     void SaveWindowSizeAndOrigin(HWND window) noexcept;
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include <lib/ExcludedAppsMatcher.h>
+#include <common/common.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (ExcludedAppsMatcherUnitTests)
+    {
+        TEST_METHOD (EmptyList)
+        {
+            ExcludedAppsMatcher matcher;
+            Assert::IsFalse(matcher.IsExcluded(L"C:\\Windows\\notepad.exe"));
+        }
+
+        TEST_METHOD (PowerToysAppsAreExcluded)
+        {
+            ExcludedAppsMatcher matcher;
+            Assert::IsTrue(matcher.IsExcluded(L"C:\\Program Files\\PowerToys\\modules\\launcher\\PowerLauncher.exe"));
+            Assert::IsTrue(matcher.IsExcluded(L"C:\\Program Files\\PowerToys\\modules\\FancyZones\\FancyZonesEditor.exe"));
+        }
+
+        TEST_METHOD (MatchIsCaseInsensitive)
+        {
+            ExcludedAppsMatcher matcher({ L"NOTEPAD" });
+            Assert::IsTrue(matcher.IsExcluded(L"C:\\Windows\\notepad.exe"));
+            Assert::IsTrue(matcher.IsExcluded(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (CachedResultIsReturned)
+        {
+            ExcludedAppsMatcher matcher({ L"NOTEPAD" });
+            const std::wstring path = L"C:\\Windows\\notepad.exe";
+            Assert::IsTrue(matcher.IsExcluded(path));
+            Assert::IsTrue(matcher.IsExcluded(path));
+            Assert::IsFalse(matcher.IsExcluded(L"C:\\Windows\\explorer.exe"));
+            Assert::IsFalse(matcher.IsExcluded(L"C:\\Windows\\explorer.exe"));
+        }
+
+        TEST_METHOD (SameResultsAsFindAppNameInPath)
+        {
+            const std::vector<std::wstring> excludedApps{
+                L"TELEGRAM",
+                L"SUBLIME TEXT",
+                L"PROGRAM",
+                L"TEXT",
+                L"NOTEPAD",
+                L"A",
+                L"DESKTOP\\TELEGRAM",
+                L"\\CODE",
+            };
+            const std::vector<std::wstring> paths{
+                L"C:\\USERS\\GUEST\\APPDATA\\ROAMING\\TELEGRAM DESKTOP\\TELEGRAM.EXE",
+                L"C:\\PROGRAM FILES\\NOTEPAD++\\NOTEPAD++.EXE",
+                L"C:\\PROGRAM FILES\\SUBLIME TEXT 3\\SUBLIME_TEXT.EXE",
+                L"C:\\PROGRAM FILES\\PROGRAM.EXE",
+                L"C:\\PROGRAM FILES\\APP\\ABA.EXE",
+                L"C:\\PROGRAM FILES\\APP\\AB.EXE",
+                L"C:\\PROGRAM FILES\\MICROSOFT VS CODE\\CODE.EXE",
+                L"C:\\PROGRAM FILES\\TEXT EDITOR\\EDITOR.EXE",
+                L"C:\\WINDOWS\\EXPLORER.EXE",
+                L"TELEGRAM.EXE",
+            };
+
+            ExcludedAppsMatcher matcher(excludedApps);
+            for (const auto& path : paths)
+            {
+                Assert::AreEqual(find_app_name_in_path(path, excludedApps), matcher.IsExcluded(path), path.c_str());
+            }
+        }
+    };
+}
@@ -673,6 +673,21 @@ namespace FancyZonesUnitTests
                     Assert::AreEqual(expectedSize, actualBufferSize);
                 }
 
+                TEST_METHOD (WriteConfig)
+                {
+                    int size = 0;
+                    m_settings->GetConfig(nullptr, &size);
+                    std::wstring expected(size - 1, L'\0');
+                    Assert::IsTrue(m_settings->GetConfig(expected.data(), &size));
+
+                    std::wstring actual;
+                    auto writer = [](void* context, const wchar_t* config, size_t length) {
+                        static_cast<std::wstring*>(context)->assign(config, length);
+                    };
+                    Assert::IsTrue(m_settings->WriteConfig(writer, &actual));
+                    Assert::AreEqual(expected, actual);
+                }
+
                 TEST_METHOD (SetConfig)
                 {
                     //cleanup file before call set config
@@ -2,7 +2,9 @@
 
 #include "pch.h"
 #include "ContextMenuHandler.h"
+#include "FileListWriter.h"
 #include "HDropIterator.h"
+#include "ImageTypeCache.h"
 #include "Settings.h"
 #include "common/icon_helpers.h"
 #include "trace.h"
@@ -69,20 +71,12 @@ HRESULT CContextMenuHandler::QueryContextMenu(_In_ HMENU hmenu, UINT indexMenu,
     // NB: We just check the first item. We could iterate through more if the first one doesn't meet the criteria
     HDropIterator i(m_pdtobj);
     i.First();
-// Suppressing C26812 warning as the issue is in the shtypes.h library
-#pragma warning(suppress : 26812)
-    PERCEIVED type;
-    PERCEIVEDFLAG flag;
     LPTSTR pszPath = i.CurrentItem();
-    LPTSTR pszExt = PathFindExtension(pszPath);
-
-    // TODO: Instead, detect whether there's a WIC codec installed that can handle this file
-    AssocGetPerceivedType(pszExt, &type, &flag, NULL);
-
+    const bool isImage = ImageTypeCacheInstance().IsImage(pszPath);
     free(pszPath);
     bool dragDropFlag = false;
     // If selected file is an image...
-    if (type == PERCEIVED_TYPE_IMAGE)
+    if (isImage)
     {
         HRESULT hr = E_UNEXPECTED;
         wchar_t strResizePictures[64] = { 0 };
@@ -211,7 +205,7 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     std::wstring path = get_module_folderpath(g_hInst_imageResizer);
     path = path + L"\\ImageResizer.exe";
     LPTSTR lpApplicationName = (LPTSTR)path.c_str();
-    // Create an anonymous pipe to stream filenames
+    // Create an anonymous pipe to stream filenames, with a buffer large enough for a chunk of the list
     SECURITY_ATTRIBUTES sa;
     HANDLE hReadPipe;
     HANDLE hWritePipe;
@@ -219,18 +213,19 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     sa.lpSecurityDescriptor = NULL;
     sa.bInheritHandle = TRUE;
     HRESULT hr = E_FAIL;
-    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 0))
+    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 64 * 1024))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
         return hr;
     }
+    // Both ends are closed on every return, unless the write end has been handed over to the FileListWriter
+    ATL::CHandle readPipe(hReadPipe);
+    ATL::CHandle writePipe(hWritePipe);
     if (!SetHandleInformation(hWritePipe, HANDLE_FLAG_INHERIT, 0))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
         return hr;
     }
-    CAtlFile writePipe(hWritePipe);
-
     CString commandLine;
     commandLine.Format(_T("\"%s\""), lpApplicationName);
 
@@ -264,7 +259,7 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     PROCESS_INFORMATION processInformation;
 
     // Start the resizer
-    CreateProcess(
+    const BOOL processCreated = CreateProcess(
         NULL,
         lpszCommandLine,
         NULL,
@@ -275,7 +270,14 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
         NULL,
         &startupInfo,
         &processInformation);
+    hr = processCreated ? S_OK : HRESULT_FROM_WIN32(GetLastError());
     delete[] lpszCommandLine;
+    if (!processCreated)
+    {
+        return hr;
+    }
+    // The resizer has its own handle to the read end, closing ours lets the writes fail once it exits
+    readPipe.Close();
     if (!CloseHandle(processInformation.hProcess))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
@@ -288,17 +290,19 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     }
 
     // psiItemArray is NULL if called from InvokeCommand. This part is used for the MSI installer. It is not NULL if it is called from Invoke (MSIX).
+    // The paths are written to the pipe by a background thread, so this returns before the resizer has read them.
     if (!psiItemArray)
     {
         // Stream the input files
         HDropIterator i(m_pdtobj);
+        FileListWriter writer(writePipe.Detach(), i.Count());
         for (i.First(); !i.IsDone(); i.Next())
         {
-            CString fileName(i.CurrentItem());
-            fileName.Append(_T("\r\n"));
-
-            writePipe.Write(fileName, fileName.GetLength() * sizeof(TCHAR));
+            LPTSTR pszPath = i.CurrentItem();
+            writer.Append(pszPath);
+            free(pszPath);
         }
+        writer.Finish();
     }
     else
     {
@@ -306,22 +310,28 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
         DWORD fileCount = 0;
         // Gets the list of files currently selected using the IShellItemArray
         psiItemArray->GetCount(&fileCount);
+        FileListWriter writer(writePipe.Detach(), fileCount);
         // Iterate over the list of files
         for (DWORD i = 0; i < fileCount; i++)
         {
-            IShellItem* shellItem;
-            psiItemArray->GetItemAt(i, &shellItem);
-            LPWSTR itemName;
+            CComPtr<IShellItem> shellItem;
+            LPWSTR itemName = nullptr;
             // Retrieves the entire file system path of the file from its shell item
-            shellItem->GetDisplayName(SIGDN_FILESYSPATH, &itemName);
-            CString fileName(itemName);
-            fileName.Append(_T("\r\n"));
-            // Write the file path into the input stream for image resizer
-            writePipe.Write(fileName, fileName.GetLength() * sizeof(TCHAR));
+            if (SUCCEEDED(psiItemArray->GetItemAt(i, &shellItem)) && SUCCEEDED(shellItem->GetDisplayName(SIGDN_FILESYSPATH, &itemName)))
+            {
+                // Write the file path into the input stream for image resizer
+                writer.Append(itemName);
+                CoTaskMemFree(itemName);
+            }
+            else
+            {
+                // Keep the number of paths in sync with the count, the resizer skips the empty ones
+                writer.Append(L"");
+            }
         }
+        writer.Finish();
     }
 
-    writePipe.Close();
     hr = S_OK;
     return hr;
 }
@@ -361,26 +371,31 @@ HRESULT __stdcall CContextMenuHandler::GetState(IShellItemArray* psiItemArray, B
     }
     // Hide if the file is not an image
     *pCmdState = ECS_HIDDEN;
-    // Suppressing C26812 warning as the issue is in the shtypes.h library
-#pragma warning(suppress : 26812)
-    PERCEIVED type;
-    PERCEIVEDFLAG flag;
-    IShellItem* shellItem;
-    //Check extension of first item in the list (the item which is right-clicked on)
-    psiItemArray->GetItemAt(0, &shellItem);
-    LPTSTR pszPath;
-    // Retrieves the entire file system path of the file from its shell item
-    shellItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath);
-    LPTSTR pszExt = PathFindExtension(pszPath);
-
-    // TODO: Instead, detect whether there's a WIC codec installed that can handle this file
-    AssocGetPerceivedType(pszExt, &type, &flag, NULL);
-
-    CoTaskMemFree(pszPath);
-    // If selected file is an image...
-    if (type == PERCEIVED_TYPE_IMAGE)
+    // Check the extension of the first item in the list (the item which is right-clicked on).
+    // When the shell allows a slow check, look through the rest of the selection for an image as well.
+    DWORD count = 1;
+    if (fOkToBeSlow)
     {
-        *pCmdState = ECS_ENABLED;
+        psiItemArray->GetCount(&count);
+    }
+    for (DWORD i = 0; i < count; i++)
+    {
+        CComPtr<IShellItem> shellItem;
+        LPTSTR pszPath = nullptr;
+        // Retrieves the entire file system path of the file from its shell item
+        if (FAILED(psiItemArray->GetItemAt(i, &shellItem)) || FAILED(shellItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath)))
+        {
+            continue;
+        }
+
+        const bool isImage = ImageTypeCacheInstance().IsImage(pszPath);
+        CoTaskMemFree(pszPath);
+        // If selected file is an image...
+        if (isImage)
+        {
+            *pCmdState = ECS_ENABLED;
+            break;
+        }
     }
     return S_OK;
 }
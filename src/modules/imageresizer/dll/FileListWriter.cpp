@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "FileListWriter.h"
+#include <algorithm>
+
+namespace
+{
+    // Large enough for a few hundred paths, so the pipe is written a handful of times even for huge selections
+    constexpr size_t chunkSize = 64 * 1024;
+}
+
+FileListWriter::FileListWriter(HANDLE pipe, UINT32 count) :
+    state(std::make_shared<State>())
+{
+    state->pipe = pipe;
+    chunk.reserve(chunkSize);
+    AppendBytes(&count, sizeof(count));
+
+    // The thread holds a reference to the dll, since it can outlive the context menu handler which started it
+    HMODULE module = nullptr;
+    if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&FileListWriter::WriterThread), &module))
+    {
+        auto threadState = new std::shared_ptr<State>(state);
+        HANDLE thread = CreateThread(nullptr, 0, WriterThread, threadState, 0, nullptr);
+        if (thread)
+        {
+            CloseHandle(thread);
+            threadStarted = true;
+        }
+        else
+        {
+            delete threadState;
+            FreeLibrary(module);
+        }
+    }
+}
+
+FileListWriter::~FileListWriter()
+{
+    Finish();
+}
+
+void FileListWriter::Append(PCWSTR path)
+{
+    const UINT32 length = static_cast<UINT32>(wcslen(path));
+    AppendBytes(&length, sizeof(length));
+    AppendBytes(path, length * sizeof(wchar_t));
+}
+
+void FileListWriter::Finish()
+{
+    if (finished)
+    {
+        return;
+    }
+    finished = true;
+
+    FlushChunk();
+    if (threadStarted)
+    {
+        {
+            std::lock_guard lock(state->mutex);
+            state->finished = true;
+        }
+        state->cv.notify_one();
+    }
+    else
+    {
+        // Couldn't start the thread, write the list from the calling thread instead
+        state->finished = true;
+        state->WriteChunks();
+    }
+}
+
+DWORD WINAPI FileListWriter::WriterThread(LPVOID parameter)
+{
+    std::unique_ptr<std::shared_ptr<State>> state(static_cast<std::shared_ptr<State>*>(parameter));
+    (*state)->WriteChunks();
+    state.reset();
+
+    HMODULE module = nullptr;
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCWSTR>(&FileListWriter::WriterThread), &module);
+    FreeLibraryAndExitThread(module, 0);
+}
+
+void FileListWriter::AppendBytes(const void* data, size_t size)
+{
+    auto bytes = static_cast<const BYTE*>(data);
+    while (size > 0)
+    {
+        const size_t count = (std::min)(size, chunkSize - chunk.size());
+        chunk.insert(chunk.end(), bytes, bytes + count);
+        bytes += count;
+        size -= count;
+        if (chunk.size() == chunkSize)
+        {
+            FlushChunk();
+        }
+    }
+}
+
+void FileListWriter::FlushChunk()
+{
+    if (chunk.empty())
+    {
+        return;
+    }
+
+    std::vector<BYTE> full;
+    full.reserve(chunkSize);
+    full.swap(chunk);
+    {
+        std::lock_guard lock(state->mutex);
+        state->chunks.push_back(std::move(full));
+    }
+    state->cv.notify_one();
+}
+
+void FileListWriter::State::WriteChunks()
+{
+    bool broken = false;
+    for (;;)
+    {
+        std::vector<BYTE> next;
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this] { return !chunks.empty() || finished; });
+            if (chunks.empty())
+            {
+                break;
+            }
+            next = std::move(chunks.front());
+            chunks.pop_front();
+        }
+
+        // Once the resizer has exited, the rest of the list is dropped
+        DWORD offset = 0;
+        while (!broken && offset < next.size())
+        {
+            DWORD written = 0;
+            if (!WriteFile(pipe, next.data() + offset, static_cast<DWORD>(next.size()) - offset, &written, nullptr))
+            {
+                broken = true;
+            }
+            offset += written;
+        }
+    }
+
+    CloseHandle(pipe);
+    pipe = nullptr;
+}
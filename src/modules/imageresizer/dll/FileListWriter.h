@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Streams the list of files to resize to the standard input of ImageResizer.exe.
+// The list is framed as the number of files followed by each path, prefixed by its length in UTF-16 code units, so the
+// resizer knows how many files to expect and can read them as they arrive. The paths are buffered and written to the
+// pipe in large chunks by a background thread, so the shell doesn't wait for the resizer to drain the pipe.
+class FileListWriter
+{
+public:
+    // Takes the ownership of the write end of the pipe, which is closed once the whole list has been written
+    FileListWriter(HANDLE pipe, UINT32 count);
+    ~FileListWriter();
+
+    // Exactly count paths must be appended. An empty path can be appended for an item which can't be resized.
+    void Append(PCWSTR path);
+
+    // Hands the rest of the list to the background thread and returns without waiting for it to be written
+    void Finish();
+
+private:
+    struct State
+    {
+        HANDLE pipe = nullptr;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::vector<BYTE>> chunks;
+        bool finished = false;
+
+        void WriteChunks();
+    };
+
+    static DWORD WINAPI WriterThread(LPVOID parameter);
+    void AppendBytes(const void* data, size_t size);
+    void FlushChunk();
+
+    std::shared_ptr<State> state;
+    std::vector<BYTE> chunk;
+    bool threadStarted = false;
+    bool finished = false;
+};
@@ -38,6 +38,11 @@ bool HDropIterator::IsDone() const
     return _current >= _listCount;
 }
 
+UINT HDropIterator::Count() const
+{
+    return _listCount;
+}
+
 LPTSTR HDropIterator::CurrentItem() const
 {
     UINT cch = DragQueryFile((HDROP)m_medium.hGlobal, _current, NULL, 0) + 1;
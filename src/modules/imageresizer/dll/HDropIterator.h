@@ -8,6 +8,7 @@ public:
 	void First();
 	void Next();
 	bool IsDone() const;
+	UINT Count() const;
 	LPTSTR CurrentItem() const;
 
 private:
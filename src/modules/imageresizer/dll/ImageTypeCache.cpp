@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "ImageTypeCache.h"
+
+#include <algorithm>
+#include <mutex>
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+namespace
+{
+    std::wstring NormalizeExtension(PCWSTR extension)
+    {
+        std::wstring result(extension);
+        std::transform(result.begin(), result.end(), result.begin(), towlower);
+        return result;
+    }
+
+    bool IsPerceivedImage(const std::wstring& extension)
+    {
+        // Suppressing C26812 warning as the issue is in the shtypes.h library
+#pragma warning(suppress : 26812)
+        PERCEIVED type = PERCEIVED_TYPE_UNSPECIFIED;
+        PERCEIVEDFLAG flag = 0;
+        return SUCCEEDED(AssocGetPerceivedType(extension.c_str(), &type, &flag, NULL)) && type == PERCEIVED_TYPE_IMAGE;
+    }
+}
+
+bool ImageTypeCache::IsImage(PCWSTR path)
+{
+    const std::wstring extension = NormalizeExtension(PathFindExtension(path));
+    if (extension.empty())
+    {
+        return false;
+    }
+
+    {
+        std::shared_lock lock(mutex);
+        if (populated)
+        {
+            auto it = extensions.find(extension);
+            if (it != extensions.end())
+            {
+                return it->second;
+            }
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    if (!populated)
+    {
+        PopulateFromCodecs();
+    }
+
+    auto it = extensions.find(extension);
+    if (it == extensions.end())
+    {
+        it = extensions.emplace(extension, IsPerceivedImage(extension)).first;
+    }
+    return it->second;
+}
+
+void ImageTypeCache::Invalidate()
+{
+    std::unique_lock lock(mutex);
+    extensions.clear();
+    populated = false;
+}
+
+void ImageTypeCache::PopulateFromCodecs()
+{
+    // The attempt is recorded even if the enumeration fails, so a broken codec registry doesn't cost an enumeration per
+    // lookup. Invalidate() is the only way to retry.
+    populated = true;
+
+    CComPtr<IWICImagingFactory> factory;
+    CComPtr<IEnumUnknown> decoders;
+    HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+    if (SUCCEEDED(hr))
+    {
+        hr = factory->CreateComponentEnumerator(WICDecoder, WICComponentEnumerateDefault, &decoders);
+    }
+    if (FAILED(hr))
+    {
+        // Fall back on the perceived types
+        return;
+    }
+
+    CComPtr<IUnknown> component;
+    ULONG fetched = 0;
+    while (decoders->Next(1, &component, &fetched) == S_OK)
+    {
+        CComQIPtr<IWICBitmapCodecInfo> codecInfo(component);
+        component.Release();
+
+        // The extensions are a comma separated list, e.g. ".tiff,.tif"
+        UINT length = 0;
+        if (!codecInfo || FAILED(codecInfo->GetFileExtensions(0, nullptr, &length)) || length == 0)
+        {
+            continue;
+        }
+        std::wstring list(length, L'\0');
+        if (FAILED(codecInfo->GetFileExtensions(length, list.data(), &length)))
+        {
+            continue;
+        }
+        list.resize(wcsnlen(list.c_str(), list.size()));
+
+        size_t begin = 0;
+        while (begin < list.size())
+        {
+            size_t end = list.find(L',', begin);
+            if (end == std::wstring::npos)
+            {
+                end = list.size();
+            }
+            if (end > begin)
+            {
+                extensions[NormalizeExtension(list.substr(begin, end - begin).c_str())] = true;
+            }
+            begin = end + 1;
+        }
+    }
+}
+
+ImageTypeCache& ImageTypeCacheInstance()
+{
+    static ImageTypeCache instance;
+    return instance;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <shared_mutex>
+#include <unordered_map>
+
+// Process-wide cache of the file extensions which can be resized, so the shell can ask for the state of the command
+// without a registry lookup per item. An extension is an image when an installed WIC decoder lists it, or when the
+// shell perceives it as an image. The decoders are enumerated once, the perceived type the first time an extension is seen.
+class ImageTypeCache
+{
+public:
+    bool IsImage(PCWSTR path);
+
+    // Drops the classification, so it's rebuilt from the codec registry on the next lookup. This is also how a failed
+    // enumeration of the decoders is retried.
+    void Invalidate();
+
+private:
+    void PopulateFromCodecs();
+
+    std::shared_mutex mutex;
+    std::unordered_map<std::wstring, bool> extensions;
+    bool populated = false;
+};
+
+ImageTypeCache& ImageTypeCacheInstance();
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Settings.h"
+#include "ImageTypeCache.h"
 
 #include <common/json.h>
 #include <common/settings_helpers.h>
@@ -62,6 +63,9 @@ void CSettings::Save()
 
 void CSettings::Load()
 {
+    // Codecs may have been installed since the image types were cached
+    ImageTypeCacheInstance().Invalidate();
+
     if (!std::filesystem::exists(jsonFilePath))
     {
         MigrateFromRegistry();
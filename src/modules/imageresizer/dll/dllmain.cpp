@@ -65,6 +65,17 @@ public:
 
     // Return JSON with the configuration options.
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -74,7 +85,7 @@ public:
         settings.set_overview_link(L"https://aka.ms/PowerToysOverview_ImageResizer");
         settings.set_icon_key(L"pt-image-resizer");
         settings.add_header_szLarge(L"imageresizer_settingsheader", GET_RESOURCE_STRING(IDS_SETTINGS_HEADER_DESCRIPTION), GET_RESOURCE_STRING(IDS_SETTINGS_HEADER));
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     // Signal from the Settings editor to call a custom action.
@@ -110,4 +121,9 @@ public:
 extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new ImageResizerModule();
+}
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "pch.h"
+#include "BatchResizer.h"
+
+SIZE ComputeFitSize(UINT width, UINT height, UINT boxWidth, UINT boxHeight, bool shrinkOnly)
+{
+    if (width == 0 || height == 0 || boxWidth == 0 || boxHeight == 0)
+    {
+        return { 0, 0 };
+    }
+
+    double scale = (std::min)(static_cast<double>(boxWidth) / width, static_cast<double>(boxHeight) / height);
+    if (shrinkOnly)
+    {
+        scale = (std::min)(scale, 1.0);
+    }
+
+    // Don't round a side down to zero pixels
+    const LONG fitWidth = (std::max)(1L, std::lround(width * scale));
+    const LONG fitHeight = (std::max)(1L, std::lround(height * scale));
+    return { fitWidth, fitHeight };
+}
+
+BatchResizer::BatchResizer(BatchResizeOptions options) :
+    options(std::move(options))
+{
+}
+
+std::vector<HRESULT> BatchResizer::Run(const std::vector<ResizeJob>& jobs, const std::function<void(size_t done, size_t total)>& progress)
+{
+    std::vector<HRESULT> results(jobs.size(), HRESULT_FROM_WIN32(ERROR_CANCELLED));
+    nextJob = 0;
+    doneJobs = 0;
+    cancelled = false;
+
+    UINT workerCount = options.workerCount != 0 ? options.workerCount : std::thread::hardware_concurrency();
+    workerCount = (std::max)(1u, (std::min)(workerCount, static_cast<UINT>(jobs.size())));
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (UINT i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back([&] { Worker(jobs, results, progress); });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    return results;
+}
+
+void BatchResizer::Cancel()
+{
+    cancelled = true;
+}
+
+void BatchResizer::Worker(const std::vector<ResizeJob>& jobs, std::vector<HRESULT>& results, const std::function<void(size_t, size_t)>& progress)
+{
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    const bool uninitialize = SUCCEEDED(hr);
+
+    // Each worker has its own factory, so the workers don't share any WIC object
+    winrt::com_ptr<IWICImagingFactory> factory;
+    if (SUCCEEDED(hr))
+    {
+        hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put()));
+    }
+
+    for (size_t job = nextJob++; job < jobs.size() && !cancelled; job = nextJob++)
+    {
+        results[job] = SUCCEEDED(hr) ? ResizeImage(factory.get(), jobs[job]) : hr;
+        const size_t done = ++doneJobs;
+        if (progress)
+        {
+            progress(done, jobs.size());
+        }
+    }
+
+    factory = nullptr;
+    if (uninitialize)
+    {
+        CoUninitialize();
+    }
+}
+
+HRESULT BatchResizer::ResizeImage(IWICImagingFactory* factory, const ResizeJob& job)
+{
+    winrt::com_ptr<IWICBitmapDecoder> decoder;
+    HRESULT hr = factory->CreateDecoderFromFilename(job.sourcePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.put());
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    winrt::com_ptr<IWICBitmapFrameDecode> frame;
+    hr = decoder->GetFrame(0, frame.put());
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    GUID containerFormat{};
+    decoder->GetContainerFormat(&containerFormat);
+
+    UINT sourceWidth = 0;
+    UINT sourceHeight = 0;
+    double dpiX = 96.0;
+    double dpiY = 96.0;
+    frame->GetSize(&sourceWidth, &sourceHeight);
+    frame->GetResolution(&dpiX, &dpiY);
+
+    // The resampler works on premultiplied alpha, so transparent pixels don't bleed into their neighbors
+    winrt::com_ptr<IWICFormatConverter> converter;
+    hr = factory->CreateFormatConverter(converter.put());
+    if (SUCCEEDED(hr))
+    {
+        hr = converter->Initialize(frame.get(), GUID_WICPixelFormat32bppPBGRA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+    }
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    const SIZE size = ComputeFitSize(sourceWidth, sourceHeight, options.width, options.height, options.shrinkOnly);
+    if (size.cx == 0 || size.cy == 0)
+    {
+        return E_INVALIDARG;
+    }
+
+    const UINT width = static_cast<UINT>(size.cx);
+    const UINT height = static_cast<UINT>(size.cy);
+    const UINT stride = width * 4;
+    winrt::com_ptr<IWICBitmap> resized;
+    hr = factory->CreateBitmap(width, height, GUID_WICPixelFormat32bppPBGRA, WICBitmapCacheOnLoad, resized.put());
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    {
+        const WICRect all{ 0, 0, static_cast<INT>(width), static_cast<INT>(height) };
+        winrt::com_ptr<IWICBitmapLock> lock;
+        hr = resized->Lock(&all, WICBitmapLockWrite, lock.put());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        UINT bufferSize = 0;
+        BYTE* buffer = nullptr;
+        UINT lockStride = 0;
+        lock->GetDataPointer(&bufferSize, &buffer);
+        lock->GetStride(&lockStride);
+
+        // The decoder is asked for one strip of rows at a time, so huge images are never decoded at once
+        auto readRows = [&](UINT firstRow, UINT rowCount, BYTE* rows, UINT rowStride) {
+            if (cancelled)
+            {
+                return HRESULT_FROM_WIN32(ERROR_CANCELLED);
+            }
+            const WICRect rect{ 0, static_cast<INT>(firstRow), static_cast<INT>(sourceWidth), static_cast<INT>(rowCount) };
+            return converter->CopyPixels(&rect, rowStride, rowStride * rowCount, rows);
+        };
+        hr = ResampleImage(readRows, sourceWidth, sourceHeight, buffer, width, height, lockStride != 0 ? lockStride : stride, options.resample);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+    }
+
+    return EncodeImage(factory, containerFormat, job, resized.get(), dpiX, dpiY);
+}
+
+HRESULT BatchResizer::EncodeImage(IWICImagingFactory* factory, const GUID& containerFormat, const ResizeJob& job, IWICBitmapSource* image, double dpiX, double dpiY)
+{
+    GUID format = containerFormat;
+    winrt::com_ptr<IWICBitmapEncoder> encoder;
+    HRESULT hr = factory->CreateEncoder(format, nullptr, encoder.put());
+    if (FAILED(hr))
+    {
+        format = GUID_ContainerFormatJpeg;
+        hr = factory->CreateEncoder(format, nullptr, encoder.put());
+    }
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    winrt::com_ptr<IWICStream> stream;
+    hr = factory->CreateStream(stream.put());
+    if (SUCCEEDED(hr))
+    {
+        hr = stream->InitializeFromFilename(job.destinationPath.c_str(), GENERIC_WRITE);
+    }
+    const bool created = SUCCEEDED(hr);
+    if (SUCCEEDED(hr))
+    {
+        hr = encoder->Initialize(stream.get(), WICBitmapEncoderNoCache);
+    }
+
+    winrt::com_ptr<IWICBitmapFrameEncode> frame;
+    winrt::com_ptr<IPropertyBag2> properties;
+    if (SUCCEEDED(hr))
+    {
+        hr = encoder->CreateNewFrame(frame.put(), properties.put());
+    }
+    if (SUCCEEDED(hr) && format == GUID_ContainerFormatJpeg && properties)
+    {
+        PROPBAG2 option{};
+        option.pstrName = const_cast<LPOLESTR>(L"ImageQuality");
+        VARIANT value{};
+        value.vt = VT_R4;
+        value.fltVal = (std::clamp)(options.jpegQuality, 0.0f, 1.0f);
+        properties->Write(1, &option, &value);
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->Initialize(properties.get());
+    }
+
+    UINT width = 0;
+    UINT height = 0;
+    image->GetSize(&width, &height);
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->SetSize(width, height);
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->SetResolution(dpiX, dpiY);
+    }
+
+    // WriteSource converts the pixels to the format the encoder picks, e.g. 24bpp BGR for JPEG
+    WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat32bppPBGRA;
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->SetPixelFormat(&pixelFormat);
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->WriteSource(image, nullptr);
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = frame->Commit();
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = encoder->Commit();
+    }
+
+    // Don't leave a truncated image behind
+    if (FAILED(hr) && created)
+    {
+        frame = nullptr;
+        encoder = nullptr;
+        stream = nullptr;
+        DeleteFileW(job.destinationPath.c_str());
+    }
+    return hr;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "ImageResampler.h"
+
+struct ResizeJob
+{
+    std::wstring sourcePath;
+    std::wstring destinationPath;
+};
+
+struct BatchResizeOptions
+{
+    // The images are scaled to fit in width x height, keeping their aspect ratio
+    UINT width = 1920;
+    UINT height = 1080;
+
+    // Don't enlarge the images which already fit
+    bool shrinkOnly = true;
+
+    ResampleOptions resample;
+
+    // Used when the destination is a JPEG, between 0 and 1
+    float jpegQuality = 0.9f;
+
+    // Number of images which are resized at the same time, 0 to use one thread per logical processor
+    UINT workerCount = 0;
+};
+
+// Size of a width x height image scaled to fit in boxWidth x boxHeight, keeping its aspect ratio
+SIZE ComputeFitSize(UINT width, UINT height, UINT boxWidth, UINT boxHeight, bool shrinkOnly);
+
+// Resizes images on a pool of worker threads, each of them decodes, resizes and encodes one image at a time with WIC.
+// The destination is encoded in the container format of the source, or as a JPEG when there is no encoder for it (e.g. RAW files).
+class BatchResizer
+{
+public:
+    explicit BatchResizer(BatchResizeOptions options);
+
+    // Blocks until all the jobs are done. Returns the result of each job, in the order of the jobs.
+    // progress is called from the worker threads with the number of jobs done so far.
+    std::vector<HRESULT> Run(const std::vector<ResizeJob>& jobs, const std::function<void(size_t done, size_t total)>& progress = nullptr);
+
+    // Can be called from any thread while Run is in progress, the jobs which haven't started fail with
+    // HRESULT_FROM_WIN32(ERROR_CANCELLED). The next call to Run starts over.
+    void Cancel();
+
+private:
+    void Worker(const std::vector<ResizeJob>& jobs, std::vector<HRESULT>& results, const std::function<void(size_t, size_t)>& progress);
+    HRESULT ResizeImage(IWICImagingFactory* factory, const ResizeJob& job);
+    HRESULT EncodeImage(IWICImagingFactory* factory, const GUID& containerFormat, const ResizeJob& job, IWICBitmapSource* image, double dpiX, double dpiY);
+
+    BatchResizeOptions options;
+    std::atomic<size_t> nextJob = 0;
+    std::atomic<size_t> doneJobs = 0;
+    std::atomic<bool> cancelled = false;
+};
@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "ImageResampler.h"
+#include "ResampleRowKernels.h"
+#include <intrin.h>
+#include <emmintrin.h>
+
+namespace ResampleRowKernels
+{
+    void HorizontalScalar(const float* source, float* destination, const unsigned* first, const float* weights, unsigned taps, unsigned destinationWidth)
+    {
+        for (unsigned x = 0; x < destinationWidth; x++, weights += taps)
+        {
+            const float* pixel = source + static_cast<size_t>(first[x]) * 4;
+            float sum[4] = {};
+            for (unsigned k = 0; k < taps; k++, pixel += 4)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    sum[c] += weights[k] * pixel[c];
+                }
+            }
+            std::copy_n(sum, 4, destination + static_cast<size_t>(x) * 4);
+        }
+    }
+
+    void HorizontalSse2(const float* source, float* destination, const unsigned* first, const float* pixelWeights, unsigned taps, unsigned destinationWidth)
+    {
+        for (unsigned x = 0; x < destinationWidth; x++, pixelWeights += taps * 4)
+        {
+            const float* pixel = source + static_cast<size_t>(first[x]) * 4;
+            __m128 sum = _mm_setzero_ps();
+            for (unsigned k = 0; k < taps; k++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixelWeights + k * 4), _mm_loadu_ps(pixel + k * 4)));
+            }
+            _mm_storeu_ps(destination + static_cast<size_t>(x) * 4, sum);
+        }
+    }
+
+    void VerticalScalar(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length)
+    {
+        std::fill_n(destination, length, 0.0f);
+        for (unsigned k = 0; k < count; k++)
+        {
+            const float* row = rows[k];
+            for (unsigned i = 0; i < length; i++)
+            {
+                destination[i] += weights[k] * row[i];
+            }
+        }
+    }
+
+    void VerticalSse2(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length)
+    {
+        for (unsigned i = 0; i < length; i += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (unsigned k = 0; k < count; k++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+            }
+            _mm_storeu_ps(destination + i, sum);
+        }
+    }
+}
+
+namespace
+{
+    struct Kernels
+    {
+        decltype(&ResampleRowKernels::HorizontalSse2) horizontal;
+        decltype(&ResampleRowKernels::VerticalSse2) vertical;
+        bool pixelWeights;
+    };
+
+    Kernels SelectKernels(SimdLevel requested)
+    {
+        const SimdLevel supported = DetectSimdLevel();
+        const SimdLevel level = requested == SimdLevel::Auto ? supported : (std::min)(requested, supported);
+        switch (level)
+        {
+        case SimdLevel::Scalar:
+            return { ResampleRowKernels::HorizontalScalar, ResampleRowKernels::VerticalScalar, false };
+        case SimdLevel::Avx2:
+            return { ResampleRowKernels::HorizontalAvx2, ResampleRowKernels::VerticalAvx2, true };
+        default:
+            return { ResampleRowKernels::HorizontalSse2, ResampleRowKernels::VerticalSse2, true };
+        }
+    }
+
+    void ToFloat(const BYTE* source, float* destination, UINT width)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(width) * 4; i++)
+        {
+            destination[i] = source[i];
+        }
+    }
+
+    // Rounds and clamps the channels, the colors can't exceed the alpha since they are premultiplied
+    void ToBytes(const float* source, BYTE* destination, UINT width)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maxValue = _mm_set1_ps(255.0f);
+        for (UINT x = 0; x < width; x++)
+        {
+            __m128 pixel = _mm_loadu_ps(source + static_cast<size_t>(x) * 4);
+            __m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_min_ps(_mm_max_ps(alpha, zero), maxValue);
+            pixel = _mm_min_ps(_mm_max_ps(pixel, zero), alpha);
+
+            __m128i values = _mm_cvtps_epi32(pixel);
+            values = _mm_packs_epi32(values, values);
+            values = _mm_packus_epi16(values, values);
+            const int packed = _mm_cvtsi128_si32(values);
+            std::memcpy(destination + static_cast<size_t>(x) * 4, &packed, 4);
+        }
+    }
+}
+
+SimdLevel DetectSimdLevel()
+{
+    static const SimdLevel level = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return SimdLevel::Sse2;
+        }
+
+        // AVX and FMA, and the OS saves the YMM registers
+        __cpuid(info, 1);
+        constexpr int fma = 1 << 12;
+        constexpr int osxsave = 1 << 27;
+        constexpr int avx = 1 << 28;
+        if ((info[2] & (fma | osxsave | avx)) != (fma | osxsave | avx) || (_xgetbv(0) & 6) != 6)
+        {
+            return SimdLevel::Sse2;
+        }
+
+        __cpuidex(info, 7, 0);
+        constexpr int avx2 = 1 << 5;
+        return (info[1] & avx2) ? SimdLevel::Avx2 : SimdLevel::Sse2;
+    }();
+    return level;
+}
+
+HRESULT ResampleImage(const ResampleRowReader& readRows,
+                      UINT sourceWidth,
+                      UINT sourceHeight,
+                      BYTE* destination,
+                      UINT destinationWidth,
+                      UINT destinationHeight,
+                      UINT destinationStride,
+                      const ResampleOptions& options)
+{
+    if (sourceWidth == 0 || sourceHeight == 0 || destinationWidth == 0 || destinationHeight == 0 || !destination ||
+        destinationStride < destinationWidth * 4 || options.stripHeight == 0)
+    {
+        return E_INVALIDARG;
+    }
+
+    try
+    {
+        const Kernels kernels = SelectKernels(options.simd);
+        const ResampleWeights horizontal = ComputeResampleWeights(options.filter, sourceWidth, destinationWidth);
+        const ResampleWeights vertical = ComputeResampleWeights(options.filter, sourceHeight, destinationHeight);
+        const float* horizontalWeights = kernels.pixelWeights ? horizontal.pixelWeights.data() : horizontal.weights.data();
+
+        // Source rows [begin, end) needed by the destination rows of a strip
+        auto stripSourceRows = [&](UINT stripBegin) {
+            const UINT stripEnd = (std::min)(stripBegin + options.stripHeight, destinationHeight);
+            const UINT begin = vertical.first[stripBegin];
+            const UINT end = (std::min)(vertical.first[stripEnd - 1] + vertical.taps, sourceHeight);
+            return std::make_pair(begin, end);
+        };
+
+        // The horizontally filtered source rows of the current strip. Source row r is kept in slot r % windowRows, the
+        // rows of a strip are contiguous and the strips move down, so the rows which are still needed are never overwritten.
+        UINT windowRows = 0;
+        for (UINT y = 0; y < destinationHeight; y += options.stripHeight)
+        {
+            const auto [begin, end] = stripSourceRows(y);
+            windowRows = (std::max)(windowRows, end - begin);
+        }
+
+        const size_t filteredRowLength = static_cast<size_t>(destinationWidth) * 4;
+        std::vector<float> window(windowRows * filteredRowLength);
+        auto windowRow = [&](UINT row) {
+            return window.data() + (row % windowRows) * filteredRowLength;
+        };
+
+        // Rows are read in chunks, so a strip of a huge image which is downscaled a lot doesn't need a huge buffer
+        constexpr UINT maxChunkRows = 64;
+        const UINT sourceStride = sourceWidth * 4;
+        std::vector<BYTE> chunk(static_cast<size_t>(sourceStride) * (std::min)(maxChunkRows, sourceHeight));
+        std::vector<float> sourceRow((static_cast<size_t>(sourceWidth) + horizontal.taps) * 4, 0.0f);
+        std::vector<float> destinationRow(filteredRowLength);
+        std::vector<const float*> rows(vertical.taps);
+
+        UINT nextSourceRow = 0;
+        for (UINT stripBegin = 0; stripBegin < destinationHeight; stripBegin += options.stripHeight)
+        {
+            const auto [begin, end] = stripSourceRows(stripBegin);
+            for (UINT chunkBegin = (std::max)(begin, nextSourceRow); chunkBegin < end; chunkBegin += maxChunkRows)
+            {
+                const UINT chunkRows = (std::min)(maxChunkRows, end - chunkBegin);
+                const HRESULT hr = readRows(chunkBegin, chunkRows, chunk.data(), sourceStride);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                for (UINT i = 0; i < chunkRows; i++)
+                {
+                    ToFloat(chunk.data() + static_cast<size_t>(i) * sourceStride, sourceRow.data(), sourceWidth);
+                    kernels.horizontal(sourceRow.data(), windowRow(chunkBegin + i), horizontal.first.data(), horizontalWeights, horizontal.taps, destinationWidth);
+                }
+            }
+            nextSourceRow = (std::max)(nextSourceRow, end);
+
+            const UINT stripEnd = (std::min)(stripBegin + options.stripHeight, destinationHeight);
+            for (UINT y = stripBegin; y < stripEnd; y++)
+            {
+                const UINT first = vertical.first[y];
+                const UINT count = (std::min)(vertical.taps, sourceHeight - first);
+                for (UINT k = 0; k < count; k++)
+                {
+                    rows[k] = windowRow(first + k);
+                }
+
+                kernels.vertical(rows.data(), &vertical.weights[static_cast<size_t>(y) * vertical.taps], count, destinationRow.data(), static_cast<unsigned>(filteredRowLength));
+                ToBytes(destinationRow.data(), destination + static_cast<size_t>(y) * destinationStride, destinationWidth);
+            }
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    return S_OK;
+}
+
+HRESULT ResampleImage(const BYTE* source,
+                      UINT sourceWidth,
+                      UINT sourceHeight,
+                      UINT sourceStride,
+                      BYTE* destination,
+                      UINT destinationWidth,
+                      UINT destinationHeight,
+                      UINT destinationStride,
+                      const ResampleOptions& options)
+{
+    if (!source || sourceStride < sourceWidth * 4)
+    {
+        return E_INVALIDARG;
+    }
+
+    auto readRows = [&](UINT firstRow, UINT rowCount, BYTE* buffer, UINT stride) {
+        for (UINT i = 0; i < rowCount; i++)
+        {
+            std::memcpy(buffer + static_cast<size_t>(i) * stride, source + static_cast<size_t>(firstRow + i) * sourceStride, static_cast<size_t>(sourceWidth) * 4);
+        }
+        return S_OK;
+    };
+    return ResampleImage(readRows, sourceWidth, sourceHeight, destination, destinationWidth, destinationHeight, destinationStride, options);
+}
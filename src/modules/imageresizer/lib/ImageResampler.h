@@ -0,0 +1,50 @@
+#pragma once
+#include "ResampleKernel.h"
+
+// Instruction set used by ResampleImage. A level which isn't supported by the processor falls back to the best one which is.
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+    Auto
+};
+
+struct ResampleOptions
+{
+    ResampleFilter filter = ResampleFilter::Lanczos3;
+    SimdLevel simd = SimdLevel::Auto;
+
+    // Number of destination rows produced from each batch of source rows. Only the source rows of one batch are kept in
+    // memory, so huge images don't have to be decoded at once.
+    UINT stripHeight = 64;
+};
+
+// Copies rowCount rows of the source image, starting at firstRow, into buffer. The rows are requested from top to bottom.
+using ResampleRowReader = std::function<HRESULT(UINT firstRow, UINT rowCount, BYTE* buffer, UINT stride)>;
+
+// Best instruction set supported by the processor
+SimdLevel DetectSimdLevel();
+
+// Resizes a 32bpp image with premultiplied alpha (e.g. GUID_WICPixelFormat32bppPBGRA) with a separable filter.
+// The source rows are read in strips through readRows and filtered horizontally, then the destination rows of the strip
+// are filtered vertically and written to destination. The destination must hold destinationHeight rows of destinationStride bytes.
+HRESULT ResampleImage(const ResampleRowReader& readRows,
+                      UINT sourceWidth,
+                      UINT sourceHeight,
+                      BYTE* destination,
+                      UINT destinationWidth,
+                      UINT destinationHeight,
+                      UINT destinationStride,
+                      const ResampleOptions& options = {});
+
+// Same as above, for a source image which is already in memory
+HRESULT ResampleImage(const BYTE* source,
+                      UINT sourceWidth,
+                      UINT sourceHeight,
+                      UINT sourceStride,
+                      BYTE* destination,
+                      UINT destinationWidth,
+                      UINT destinationHeight,
+                      UINT destinationStride,
+                      const ResampleOptions& options = {});
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "ResampleKernel.h"
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    double FilterRadius(ResampleFilter filter)
+    {
+        return filter == ResampleFilter::Lanczos3 ? 3.0 : 2.0;
+    }
+
+    double Sinc(double x)
+    {
+        if (x == 0.0)
+        {
+            return 1.0;
+        }
+        x *= pi;
+        return std::sin(x) / x;
+    }
+
+    double FilterValue(ResampleFilter filter, double x)
+    {
+        x = std::abs(x);
+        if (filter == ResampleFilter::Lanczos3)
+        {
+            return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+        }
+
+        // Catmull-Rom spline, the cubic convolution with a = -0.5
+        constexpr double a = -0.5;
+        if (x < 1.0)
+        {
+            return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+        }
+        if (x < 2.0)
+        {
+            return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+        }
+        return 0.0;
+    }
+}
+
+ResampleWeights ComputeResampleWeights(ResampleFilter filter, UINT sourceSize, UINT destinationSize)
+{
+    ResampleWeights result;
+    if (sourceSize == 0 || destinationSize == 0)
+    {
+        return result;
+    }
+
+    const double scale = static_cast<double>(destinationSize) / sourceSize;
+    const double filterScale = (std::max)(1.0, 1.0 / scale);
+    const double support = FilterRadius(filter) * filterScale;
+
+    UINT taps = static_cast<UINT>(std::ceil(support)) * 2 + 1;
+    taps += taps % 2;
+
+    result.taps = taps;
+    result.first.resize(destinationSize);
+    result.weights.assign(static_cast<size_t>(destinationSize) * taps, 0.0f);
+
+    std::vector<double> values(taps);
+    for (UINT i = 0; i < destinationSize; i++)
+    {
+        // Pixel centers are at half-integer positions
+        const double center = (i + 0.5) / scale;
+        const int left = (std::max)(0, static_cast<int>(std::ceil(center - support - 0.5)));
+        const int right = (std::min)(static_cast<int>(sourceSize) - 1, static_cast<int>(std::floor(center + support - 0.5)));
+        const int count = (std::min)(right - left + 1, static_cast<int>(taps));
+
+        double total = 0.0;
+        for (int k = 0; k < count; k++)
+        {
+            values[k] = FilterValue(filter, (left + k + 0.5 - center) / filterScale);
+            total += values[k];
+        }
+
+        float* weights = &result.weights[static_cast<size_t>(i) * taps];
+        if (count <= 0 || total == 0.0)
+        {
+            // Can't happen with the supported filters, but don't divide by zero
+            weights[0] = 1.0f;
+        }
+        else
+        {
+            for (int k = 0; k < count; k++)
+            {
+                weights[k] = static_cast<float>(values[k] / total);
+            }
+        }
+        result.first[i] = static_cast<UINT>((std::max)(left, 0));
+    }
+
+    result.pixelWeights.resize(result.weights.size() * 4);
+    for (size_t i = 0; i < result.weights.size(); i++)
+    {
+        std::fill_n(&result.pixelWeights[i * 4], 4, result.weights[i]);
+    }
+
+    return result;
+}
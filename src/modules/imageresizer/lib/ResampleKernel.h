@@ -0,0 +1,28 @@
+#pragma once
+
+enum class ResampleFilter
+{
+    Bicubic,
+    Lanczos3
+};
+
+// Weights of the source pixels which contribute to each destination pixel of a one dimensional resize.
+// Each destination pixel has the same number of weights, the weights past the contributing source pixels are zero.
+struct ResampleWeights
+{
+    // Number of weights per destination pixel, always even so the AVX2 code can handle two of them at once
+    UINT taps = 0;
+
+    // Index of the first contributing source pixel of each destination pixel
+    std::vector<UINT> first;
+
+    // taps weights per destination pixel, they add up to 1
+    std::vector<float> weights;
+
+    // Same as weights, but each weight is repeated for the 4 channels of a pixel
+    std::vector<float> pixelWeights;
+};
+
+// Computes the weights of a resize from sourceSize to destinationSize pixels. When downscaling, the filter is stretched
+// over the source pixels which map to a destination pixel, so they all contribute.
+ResampleWeights ComputeResampleWeights(ResampleFilter filter, UINT sourceSize, UINT destinationSize);
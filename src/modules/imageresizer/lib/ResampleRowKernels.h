@@ -0,0 +1,17 @@
+#pragma once
+
+// Inner loops of ResampleImage, one set per instruction set. The AVX2 ones are in their own file, which is compiled
+// with /arch:AVX2 and only called when the processor supports it.
+// The pixels have 4 float channels. A source row passed to the horizontal kernels must be followed by taps zeroed pixels.
+namespace ResampleRowKernels
+{
+    // destination[x] = sum of pixelWeights[x][k] * source[first[x] + k]
+    void HorizontalScalar(const float* source, float* destination, const unsigned* first, const float* weights, unsigned taps, unsigned destinationWidth);
+    void HorizontalSse2(const float* source, float* destination, const unsigned* first, const float* pixelWeights, unsigned taps, unsigned destinationWidth);
+    void HorizontalAvx2(const float* source, float* destination, const unsigned* first, const float* pixelWeights, unsigned taps, unsigned destinationWidth);
+
+    // destination[i] = sum of weights[k] * rows[k][i], length is a multiple of 4
+    void VerticalScalar(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length);
+    void VerticalSse2(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length);
+    void VerticalAvx2(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length);
+}
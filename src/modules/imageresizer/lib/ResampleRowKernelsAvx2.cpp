@@ -0,0 +1,47 @@
+// Compiled with /arch:AVX2 and without the precompiled header, see ResampleRowKernels.h
+#include <cstddef>
+#include <immintrin.h>
+#include "ResampleRowKernels.h"
+
+namespace ResampleRowKernels
+{
+    void HorizontalAvx2(const float* source, float* destination, const unsigned* first, const float* pixelWeights, unsigned taps, unsigned destinationWidth)
+    {
+        for (unsigned x = 0; x < destinationWidth; x++, pixelWeights += taps * 4)
+        {
+            // Two source pixels per iteration, taps is even
+            const float* pixel = source + static_cast<size_t>(first[x]) * 4;
+            __m256 sum = _mm256_setzero_ps();
+            for (unsigned k = 0; k < taps; k += 2)
+            {
+                sum = _mm256_fmadd_ps(_mm256_loadu_ps(pixelWeights + k * 4), _mm256_loadu_ps(pixel + k * 4), sum);
+            }
+            _mm_storeu_ps(destination + static_cast<size_t>(x) * 4, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+        }
+    }
+
+    void VerticalAvx2(const float* const* rows, const float* weights, unsigned count, float* destination, unsigned length)
+    {
+        unsigned i = 0;
+        for (; i + 8 <= length; i += 8)
+        {
+            __m256 sum = _mm256_setzero_ps();
+            for (unsigned k = 0; k < count; k++)
+            {
+                sum = _mm256_fmadd_ps(_mm256_broadcast_ss(weights + k), _mm256_loadu_ps(rows[k] + i), sum);
+            }
+            _mm256_storeu_ps(destination + i, sum);
+        }
+
+        // The last pixel of a row with an odd width
+        if (i < length)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (unsigned k = 0; k < count; k++)
+            {
+                sum = _mm_fmadd_ps(_mm_broadcast_ss(weights + k), _mm_loadu_ps(rows[k] + i), sum);
+            }
+            _mm_storeu_ps(destination + i, sum);
+        }
+    }
+}
@@ -7,6 +7,7 @@ using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
+using System.Text;
 using System.Threading;
 using Moq;
 using Moq.Protected;
@@ -16,14 +17,10 @@ namespace ImageResizer.Models
 {
     public class ResizeBatchTests
     {
-        private static readonly string EOL = Environment.NewLine;
-
         [Fact]
         public void FromCommandLineWorks()
         {
-            var standardInput =
-                "Image1.jpg" + EOL +
-                "Image2.jpg";
+            var standardInput = CreateFileList(3, "Image1.jpg", string.Empty, "Image2.jpg");
             var args = new[]
             {
                 "/d", "OutputDir",
@@ -31,7 +28,7 @@ namespace ImageResizer.Models
             };
 
             var result = ResizeBatch.FromCommandLine(
-                new StringReader(standardInput),
+                standardInput,
                 args);
 
             Assert.Equal(new List<string> { "Image1.jpg", "Image2.jpg", "Image3.jpg" }, result.Files);
@@ -39,6 +36,16 @@ namespace ImageResizer.Models
             Assert.Equal("OutputDir", result.DestinationDirectory);
         }
 
+        [Fact]
+        public void FromCommandLineKeepsFilesReadBeforeEndOfInput()
+        {
+            var result = ResizeBatch.FromCommandLine(CreateFileList(3, "Image1.jpg"), Array.Empty<string>());
+
+            Assert.Equal(new List<string> { "Image1.jpg" }, result.Files);
+
+            Assert.Empty(ResizeBatch.FromCommandLine(Stream.Null, Array.Empty<string>()).Files);
+        }
+
         /*[Fact]
         public void Process_executes_in_parallel()
         {
@@ -103,5 +110,22 @@ namespace ImageResizer.Models
 
             return mock.Object;
         }
+
+        private static Stream CreateFileList(uint count, params string[] files)
+        {
+            var stream = new MemoryStream();
+            using (var writer = new BinaryWriter(stream, Encoding.Unicode, leaveOpen: true))
+            {
+                writer.Write(count);
+                foreach (var file in files)
+                {
+                    writer.Write(file.Length);
+                    writer.Write(Encoding.Unicode.GetBytes(file));
+                }
+            }
+
+            stream.Position = 0;
+            return stream;
+        }
     }
 }
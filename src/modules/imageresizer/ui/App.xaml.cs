@@ -3,7 +3,6 @@
 // See the LICENSE file in the project root for more information.  Code forked from Brice Lambson's https://github.com/bricelam/ImageResizer/
 
 using System;
-using System.Text;
 using System.Windows;
 using ImageResizer.Models;
 using ImageResizer.Properties;
@@ -18,14 +17,9 @@ namespace ImageResizer
         private ThemeManager _themeManager;
         private bool _isDisposed;
 
-        static App()
-        {
-            Console.InputEncoding = Encoding.Unicode;
-        }
-
         protected override void OnStartup(StartupEventArgs e)
         {
-            var batch = ResizeBatch.FromCommandLine(Console.In, e?.Args);
+            var batch = ResizeBatch.FromCommandLine(Console.OpenStandardInput(), e?.Args);
 
             // TODO: Add command-line parameters that can be used in lieu of the input page (issue #14)
             var mainWindow = new MainWindow(new MainViewModel(batch, Settings.Default));
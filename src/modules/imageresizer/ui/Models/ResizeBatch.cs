@@ -7,6 +7,7 @@ using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.IO.Abstractions;
+using System.Text;
 using System.Threading;
 using System.Threading.Tasks;
 using ImageResizer.Properties;
@@ -16,25 +17,26 @@ namespace ImageResizer.Models
     public class ResizeBatch
     {
         private readonly IFileSystem _fileSystem = new FileSystem();
+        private readonly List<string> _files = new List<string>();
 
-        public string DestinationDirectory { get; set; }
+        // Reads the files passed on the command line, it completes before Files is returned
+        private Task _readFiles = Task.CompletedTask;
 
-        public ICollection<string> Files { get; } = new List<string>();
+        public string DestinationDirectory { get; set; }
 
-        public static ResizeBatch FromCommandLine(TextReader standardInput, string[] args)
+        public ICollection<string> Files
         {
-            var batch = new ResizeBatch();
-
-            // NB: We read these from stdin since there are limits on the number of args you can have
-            string file;
-            if (standardInput != null)
+            get
             {
-                while ((file = standardInput.ReadLine()) != null)
-                {
-                    batch.Files.Add(file);
-                }
+                _readFiles.Wait();
+                return _files;
             }
+        }
 
+        public static ResizeBatch FromCommandLine(Stream standardInput, string[] args)
+        {
+            var batch = new ResizeBatch();
+            var argFiles = new List<string>();
             for (var i = 0; i < args?.Length; i++)
             {
                 if (args[i] == "/d")
@@ -43,12 +45,55 @@ namespace ImageResizer.Models
                     continue;
                 }
 
-                batch.Files.Add(args[i]);
+                argFiles.Add(args[i]);
             }
 
+            // NB: We read these from stdin since there are limits on the number of args you can have.
+            // The list can be long, so it's read in the background while the window is created.
+            batch._readFiles = Task.Run(() =>
+            {
+                if (standardInput != null)
+                {
+                    ReadFiles(standardInput, batch._files);
+                }
+
+                batch._files.AddRange(argFiles);
+            });
+
             return batch;
         }
 
+        // The list is framed by ImageResizerExt as the number of files, followed by each path prefixed by its length in
+        // UTF-16 code units. Empty paths stand for the selected items which aren't files.
+        private static void ReadFiles(Stream standardInput, ICollection<string> files)
+        {
+            using (var reader = new BinaryReader(standardInput, Encoding.Unicode, leaveOpen: true))
+            {
+                try
+                {
+                    var count = reader.ReadUInt32();
+                    for (var i = 0u; i < count; i++)
+                    {
+                        var length = reader.ReadInt32() * sizeof(char);
+                        var bytes = reader.ReadBytes(length);
+                        if (bytes.Length < length)
+                        {
+                            break;
+                        }
+
+                        if (length != 0)
+                        {
+                            files.Add(Encoding.Unicode.GetString(bytes));
+                        }
+                    }
+                }
+                catch (EndOfStreamException)
+                {
+                    // Nothing was piped in, or the list was cut short. Keep the files read so far.
+                }
+            }
+        }
+
         public IEnumerable<ResizeError> Process(Action<int, double> reportProgress, CancellationToken cancellationToken)
         {
             double total = Files.Count;
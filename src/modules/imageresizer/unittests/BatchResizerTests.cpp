@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "lib/BatchResizer.h"
+#include <filesystem>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ImageResizerLibUnitTests
+{
+    namespace
+    {
+        void WritePng(IWICImagingFactory* factory, const std::wstring& path, UINT width, UINT height)
+        {
+            std::vector<BYTE> pixels(static_cast<size_t>(width) * height * 4, 0xFF);
+            winrt::com_ptr<IWICBitmap> bitmap;
+            winrt::check_hresult(factory->CreateBitmapFromMemory(width, height, GUID_WICPixelFormat32bppPBGRA, width * 4, static_cast<UINT>(pixels.size()), pixels.data(), bitmap.put()));
+
+            winrt::com_ptr<IWICStream> stream;
+            winrt::check_hresult(factory->CreateStream(stream.put()));
+            winrt::check_hresult(stream->InitializeFromFilename(path.c_str(), GENERIC_WRITE));
+
+            winrt::com_ptr<IWICBitmapEncoder> encoder;
+            winrt::check_hresult(factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, encoder.put()));
+            winrt::check_hresult(encoder->Initialize(stream.get(), WICBitmapEncoderNoCache));
+
+            winrt::com_ptr<IWICBitmapFrameEncode> frame;
+            winrt::check_hresult(encoder->CreateNewFrame(frame.put(), nullptr));
+            winrt::check_hresult(frame->Initialize(nullptr));
+            winrt::check_hresult(frame->WriteSource(bitmap.get(), nullptr));
+            winrt::check_hresult(frame->Commit());
+            winrt::check_hresult(encoder->Commit());
+        }
+
+        SIZE ReadSize(IWICImagingFactory* factory, const std::wstring& path)
+        {
+            winrt::com_ptr<IWICBitmapDecoder> decoder;
+            winrt::check_hresult(factory->CreateDecoderFromFilename(path.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.put()));
+            winrt::com_ptr<IWICBitmapFrameDecode> frame;
+            winrt::check_hresult(decoder->GetFrame(0, frame.put()));
+            UINT width = 0;
+            UINT height = 0;
+            winrt::check_hresult(frame->GetSize(&width, &height));
+            return { static_cast<LONG>(width), static_cast<LONG>(height) };
+        }
+    }
+
+    TEST_CLASS (BatchResizerTests)
+    {
+        std::filesystem::path folder;
+        winrt::com_ptr<IWICImagingFactory> factory;
+
+    public:
+        TEST_METHOD_INITIALIZE(Initialize)
+        {
+            winrt::check_hresult(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+            winrt::check_hresult(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put())));
+            folder = std::filesystem::temp_directory_path() / L"ImageResizerLibUnitTests";
+            std::filesystem::create_directories(folder);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            factory = nullptr;
+            std::filesystem::remove_all(folder);
+            CoUninitialize();
+        }
+
+        TEST_METHOD (ComputeFitSize_ShouldKeepAspectRatio)
+        {
+            const SIZE landscape = ComputeFitSize(4000, 3000, 1920, 1080, true);
+            Assert::AreEqual(1440L, landscape.cx);
+            Assert::AreEqual(1080L, landscape.cy);
+
+            const SIZE portrait = ComputeFitSize(3000, 4000, 1920, 1080, true);
+            Assert::AreEqual(810L, portrait.cx);
+            Assert::AreEqual(1080L, portrait.cy);
+
+            // A thin image doesn't get a side of zero pixels
+            const SIZE thin = ComputeFitSize(10000, 1, 100, 100, true);
+            Assert::AreEqual(100L, thin.cx);
+            Assert::AreEqual(1L, thin.cy);
+        }
+
+        TEST_METHOD (ComputeFitSize_ShouldNotEnlarge_WhenShrinkOnly)
+        {
+            const SIZE shrinkOnly = ComputeFitSize(640, 480, 1920, 1080, true);
+            Assert::AreEqual(640L, shrinkOnly.cx);
+            Assert::AreEqual(480L, shrinkOnly.cy);
+
+            const SIZE enlarged = ComputeFitSize(640, 480, 1920, 1080, false);
+            Assert::AreEqual(1440L, enlarged.cx);
+            Assert::AreEqual(1080L, enlarged.cy);
+        }
+
+        TEST_METHOD (Run_ShouldResizeAllImages_AndReportFailuresPerImage)
+        {
+            std::vector<ResizeJob> jobs;
+            for (int i = 0; i < 6; i++)
+            {
+                const auto source = (folder / (L"image" + std::to_wstring(i) + L".png")).wstring();
+                WritePng(factory.get(), source, 400 + i * 10, 300);
+                jobs.push_back({ source, (folder / (L"image" + std::to_wstring(i) + L"_small.png")).wstring() });
+            }
+            jobs.push_back({ (folder / L"missing.png").wstring(), (folder / L"missing_small.png").wstring() });
+
+            BatchResizeOptions options;
+            options.width = 100;
+            options.height = 100;
+            options.workerCount = 3;
+            BatchResizer resizer(options);
+
+            // Called from the worker threads, where a failed assertion can't be reported
+            std::atomic<size_t> progressCalls = 0;
+            std::atomic<size_t> maxDone = 0;
+            const auto results = resizer.Run(jobs, [&](size_t done, size_t) {
+                progressCalls++;
+                size_t current = maxDone;
+                while (done > current && !maxDone.compare_exchange_weak(current, done))
+                {
+                }
+            });
+
+            Assert::AreEqual(jobs.size(), results.size());
+            Assert::AreEqual(jobs.size(), progressCalls.load());
+            Assert::AreEqual(jobs.size(), maxDone.load());
+            for (int i = 0; i < 6; i++)
+            {
+                Assert::AreEqual(S_OK, results[i]);
+                const SIZE size = ReadSize(factory.get(), jobs[i].destinationPath);
+                Assert::AreEqual(100L, size.cx);
+                Assert::AreEqual(std::lround(300 * 100.0 / (400 + i * 10)), size.cy);
+            }
+            Assert::IsTrue(FAILED(results.back()));
+            Assert::IsFalse(std::filesystem::exists(jobs.back().destinationPath));
+        }
+
+        TEST_METHOD (Run_ShouldNotStartJobs_WhenCancelled)
+        {
+            const auto source = (folder / L"image.png").wstring();
+            WritePng(factory.get(), source, 50, 50);
+            std::vector<ResizeJob> jobs;
+            for (int i = 0; i < 3; i++)
+            {
+                jobs.push_back({ source, (folder / (L"image" + std::to_wstring(i) + L"_small.png")).wstring() });
+            }
+
+            BatchResizeOptions options;
+            options.workerCount = 1;
+            BatchResizer resizer(options);
+            const auto results = resizer.Run(jobs, [&](size_t, size_t) { resizer.Cancel(); });
+
+            Assert::AreEqual(S_OK, results[0]);
+            Assert::AreEqual(HRESULT_FROM_WIN32(ERROR_CANCELLED), results[1]);
+            Assert::AreEqual(HRESULT_FROM_WIN32(ERROR_CANCELLED), results[2]);
+        }
+
+        TEST_METHOD (Run_ShouldResizeImages_AfterPreviousRunWasCancelled)
+        {
+            const auto source = (folder / L"image.png").wstring();
+            WritePng(factory.get(), source, 50, 50);
+            const std::vector<ResizeJob> jobs = { { source, (folder / L"image_small.png").wstring() } };
+
+            BatchResizer resizer({});
+            resizer.Run(jobs, [&](size_t, size_t) { resizer.Cancel(); });
+            const auto results = resizer.Run(jobs);
+
+            Assert::AreEqual(S_OK, results[0]);
+        }
+    };
+}
@@ -0,0 +1,279 @@
+#include "pch.h"
+#include "lib/ImageResampler.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ImageResizerLibUnitTests
+{
+    namespace
+    {
+        const SimdLevel simdLevels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+        const ResampleFilter filters[] = { ResampleFilter::Bicubic, ResampleFilter::Lanczos3 };
+
+        // Premultiplied BGRA gradients, with an opaque left half and a half transparent right half
+        std::vector<BYTE> CreateTestImage(UINT width, UINT height)
+        {
+            std::vector<BYTE> pixels(static_cast<size_t>(width) * height * 4);
+            for (UINT y = 0; y < height; y++)
+            {
+                for (UINT x = 0; x < width; x++)
+                {
+                    BYTE* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+                    const UINT alpha = x < width / 2 ? 255 : 128;
+                    pixel[0] = static_cast<BYTE>(x * 255 / width * alpha / 255);
+                    pixel[1] = static_cast<BYTE>(y * 255 / height * alpha / 255);
+                    pixel[2] = static_cast<BYTE>((x + y) % 256 * alpha / 255);
+                    pixel[3] = static_cast<BYTE>(alpha);
+                }
+            }
+            return pixels;
+        }
+
+        std::vector<BYTE> Resample(const std::vector<BYTE>& source, UINT sourceWidth, UINT sourceHeight, UINT width, UINT height, const ResampleOptions& options)
+        {
+            std::vector<BYTE> destination(static_cast<size_t>(width) * height * 4);
+            const HRESULT hr = ResampleImage(source.data(), sourceWidth, sourceHeight, sourceWidth * 4, destination.data(), width, height, width * 4, options);
+            Assert::AreEqual(S_OK, hr);
+            return destination;
+        }
+    }
+
+    TEST_CLASS (ResampleKernelTests)
+    {
+    public:
+        TEST_METHOD (ComputeResampleWeights_ShouldAddUpToOne)
+        {
+            const std::pair<UINT, UINT> sizes[] = { { 100, 37 }, { 37, 100 }, { 1000, 3 }, { 1, 10 } };
+            for (auto filter : filters)
+            {
+                for (auto [sourceSize, destinationSize] : sizes)
+                {
+                    const auto weights = ComputeResampleWeights(filter, sourceSize, destinationSize);
+                    Assert::AreEqual(size_t{ destinationSize }, weights.first.size());
+                    Assert::AreEqual(0u, weights.taps % 2);
+                    for (UINT i = 0; i < destinationSize; i++)
+                    {
+                        float total = 0.0f;
+                        for (UINT k = 0; k < weights.taps; k++)
+                        {
+                            total += weights.weights[static_cast<size_t>(i) * weights.taps + k];
+                        }
+                        Assert::AreEqual(1.0f, total, 1e-5f);
+                        Assert::IsTrue(weights.first[i] < sourceSize);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ComputeResampleWeights_ShouldCopyPixels_WhenSizeIsUnchanged)
+        {
+            for (auto filter : filters)
+            {
+                const auto weights = ComputeResampleWeights(filter, 50, 50);
+                for (UINT i = 0; i < 50; i++)
+                {
+                    for (UINT k = 0; k < weights.taps; k++)
+                    {
+                        const float expected = weights.first[i] + k == i ? 1.0f : 0.0f;
+                        Assert::AreEqual(expected, weights.weights[static_cast<size_t>(i) * weights.taps + k], 1e-6f);
+                    }
+                }
+            }
+        }
+    };
+
+    TEST_CLASS (ImageResamplerTests)
+    {
+    public:
+        TEST_METHOD (ResampleImage_ShouldKeepSolidColor)
+        {
+            const UINT width = 61;
+            const UINT height = 47;
+            std::vector<BYTE> source(width * height * 4);
+            for (size_t i = 0; i < source.size(); i += 4)
+            {
+                source[i] = 10;
+                source[i + 1] = 100;
+                source[i + 2] = 200;
+                source[i + 3] = 255;
+            }
+
+            const std::pair<UINT, UINT> sizes[] = { { 20, 15 }, { 150, 99 }, { 61, 47 } };
+            for (auto simd : simdLevels)
+            {
+                for (auto filter : filters)
+                {
+                    for (auto [destinationWidth, destinationHeight] : sizes)
+                    {
+                        const auto destination = Resample(source, width, height, destinationWidth, destinationHeight, { filter, simd });
+                        for (size_t i = 0; i < destination.size(); i += 4)
+                        {
+                            Assert::AreEqual(BYTE{ 10 }, destination[i]);
+                            Assert::AreEqual(BYTE{ 100 }, destination[i + 1]);
+                            Assert::AreEqual(BYTE{ 200 }, destination[i + 2]);
+                            Assert::AreEqual(BYTE{ 255 }, destination[i + 3]);
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ResampleImage_ShouldMatchScalar_WhenVectorized)
+        {
+            const UINT width = 333;
+            const UINT height = 211;
+            const auto source = CreateTestImage(width, height);
+            for (auto filter : filters)
+            {
+                const auto expected = Resample(source, width, height, 101, 77, { filter, SimdLevel::Scalar });
+                for (auto simd : { SimdLevel::Sse2, SimdLevel::Avx2 })
+                {
+                    const auto actual = Resample(source, width, height, 101, 77, { filter, simd });
+                    for (size_t i = 0; i < expected.size(); i++)
+                    {
+                        // The vector code adds the products in a different order
+                        Assert::IsTrue(std::abs(expected[i] - actual[i]) <= 1);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ResampleImage_ShouldNotDependOnStripHeight)
+        {
+            const UINT width = 300;
+            const UINT height = 200;
+            const auto source = CreateTestImage(width, height);
+            for (auto [destinationWidth, destinationHeight] : { std::pair<UINT, UINT>{ 97, 41 }, std::pair<UINT, UINT>{ 450, 410 } })
+            {
+                const auto expected = Resample(source, width, height, destinationWidth, destinationHeight, { ResampleFilter::Lanczos3, SimdLevel::Auto, 1000 });
+                for (UINT stripHeight : { 1u, 7u, 64u })
+                {
+                    const auto actual = Resample(source, width, height, destinationWidth, destinationHeight, { ResampleFilter::Lanczos3, SimdLevel::Auto, stripHeight });
+                    Assert::IsTrue(expected == actual);
+                }
+            }
+        }
+
+        TEST_METHOD (ResampleImage_ShouldReadSourceRowsOnce_FromTopToBottom)
+        {
+            const UINT width = 64;
+            const UINT height = 1000;
+            const auto source = CreateTestImage(width, height);
+            UINT nextRow = 0;
+            auto readRows = [&](UINT firstRow, UINT rowCount, BYTE* buffer, UINT stride) {
+                Assert::IsTrue(firstRow >= nextRow);
+                Assert::IsTrue(rowCount <= 64);
+                nextRow = firstRow + rowCount;
+                for (UINT i = 0; i < rowCount; i++)
+                {
+                    std::memcpy(buffer + static_cast<size_t>(i) * stride, &source[static_cast<size_t>(firstRow + i) * width * 4], width * 4);
+                }
+                return S_OK;
+            };
+
+            std::vector<BYTE> destination(16 * 250 * 4);
+            Assert::AreEqual(S_OK, ResampleImage(readRows, width, height, destination.data(), 16, 250, 16 * 4));
+            Assert::AreEqual(height, nextRow);
+        }
+
+        TEST_METHOD (ResampleImage_ShouldKeepColorsBelowAlpha)
+        {
+            // Lanczos overshoots next to sharp edges
+            const UINT width = 40;
+            const UINT height = 4;
+            std::vector<BYTE> source(width * height * 4);
+            for (UINT y = 0; y < height; y++)
+            {
+                for (UINT x = 0; x < width; x++)
+                {
+                    BYTE* pixel = &source[(static_cast<size_t>(y) * width + x) * 4];
+                    const BYTE value = x % 4 < 2 ? 255 : 0;
+                    std::fill_n(pixel, 4, value);
+                }
+            }
+
+            const auto destination = Resample(source, width, height, 97, 9, { ResampleFilter::Lanczos3 });
+            for (size_t i = 0; i < destination.size(); i += 4)
+            {
+                for (size_t c = 0; c < 3; c++)
+                {
+                    Assert::IsTrue(destination[i + c] <= destination[i + 3]);
+                }
+            }
+        }
+
+        TEST_METHOD (ResampleImage_ShouldReturnError_WhenRowReaderFails)
+        {
+            auto readRows = [](UINT, UINT, BYTE*, UINT) {
+                return E_ACCESSDENIED;
+            };
+            std::vector<BYTE> destination(10 * 10 * 4);
+            Assert::AreEqual(E_ACCESSDENIED, ResampleImage(readRows, 100, 100, destination.data(), 10, 10, 10 * 4));
+            Assert::AreEqual(E_INVALIDARG, ResampleImage(readRows, 100, 100, destination.data(), 10, 10, 10));
+        }
+
+        // Not a correctness test, prints the time it takes to resize synthetic camera sized images with each instruction set,
+        // and the throughput of a batch of images resized on one thread and on all the logical processors. It takes a while
+        // and allocates large images, so it's ignored unless it's run on purpose.
+        BEGIN_TEST_METHOD_ATTRIBUTE(ResampleImage_Benchmark)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (ResampleImage_Benchmark)
+        {
+            const UINT width = 6000;
+            const UINT height = 4000;
+            const UINT destinationWidth = 1920;
+            const UINT destinationHeight = 1280;
+            const auto source = CreateTestImage(width, height);
+            std::vector<BYTE> destination(static_cast<size_t>(destinationWidth) * destinationHeight * 4);
+
+            const wchar_t* simdNames[] = { L"scalar", L"SSE2", L"AVX2" };
+            const wchar_t* filterNames[] = { L"bicubic", L"Lanczos3" };
+            for (size_t f = 0; f < std::size(filters); f++)
+            {
+                for (size_t s = 0; s < std::size(simdLevels); s++)
+                {
+                    if (simdLevels[s] > DetectSimdLevel())
+                    {
+                        continue;
+                    }
+
+                    const auto start = std::chrono::steady_clock::now();
+                    ResampleImage(source.data(), width, height, width * 4, destination.data(), destinationWidth, destinationHeight, destinationWidth * 4, { filters[f], simdLevels[s] });
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+                    const auto message = std::wstring(filterNames[f]) + L", " + simdNames[s] + L": " + std::to_wstring(elapsed.count()) + L" ms\n";
+                    Logger::WriteMessage(message.c_str());
+                }
+            }
+
+            const size_t images = 32;
+            auto resizeBatch = [&](UINT threads) {
+                std::atomic<size_t> next = 0;
+                std::vector<std::thread> workers;
+                const auto start = std::chrono::steady_clock::now();
+                for (UINT i = 0; i < threads; i++)
+                {
+                    workers.emplace_back([&] {
+                        std::vector<BYTE> output(static_cast<size_t>(destinationWidth / 2) * (destinationHeight / 2) * 4);
+                        while (next++ < images)
+                        {
+                            ResampleImage(source.data(), width, height, width * 4, output.data(), destinationWidth / 2, destinationHeight / 2, destinationWidth / 2 * 4);
+                        }
+                    });
+                }
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+                const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return images / elapsed;
+            };
+
+            const UINT threads = std::thread::hardware_concurrency();
+            Logger::WriteMessage((L"Batch, 1 thread: " + std::to_wstring(resizeBatch(1)) + L" images/s\n").c_str());
+            Logger::WriteMessage((L"Batch, " + std::to_wstring(threads) + L" threads: " + std::to_wstring(resizeBatch(threads)) + L" images/s\n").c_str());
+        }
+    };
+}
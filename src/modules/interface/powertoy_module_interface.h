@@ -20,19 +20,30 @@
   While running, the runner might call the following methods between create_powertoy()
   and destroy():
     - disable()/enable()/is_enabled() to change or get the PowerToy's enabled state,
-    - get_config() to get the available configuration settings,
+    - write_config(), or get_config() if the PowerToy doesn't implement it, to get the
+      available configuration settings,
     - set_config() to set various settings,
     - call_custom_action() when the user selects clicks a custom action in settings,
     - get_hotkeys() when the settings change, to make sure the hotkey(s) are up to date.
     - on_hotkey() when the corresponding hotkey is pressed.
+    - on_keyboard_event() for every low level keyboard event, if get_keyboard_event_priority()
+      is not negative and the PowerToy is enabled.
+
+  The methods appended to the interface after get_hotkeys() and on_hotkey() are only called
+  if the DLL reports an interface version that has them, see powertoy_interface_version_func.
 
   When terminating, the runner will:
     - call destroy() which should free all the memory and delete the PowerToy object,
     - unload the DLL.
 
   The runner will call on_hotkey() even if the module is disabled.
+
+  The runner owns the only low level keyboard hook of the process. PowerToys which need
+  the keyboard events subscribe to it instead of installing their own hook.
  */
 
+struct LowlevelKeyboardEvent;
+
 class PowertoyModuleIface
 {
 public:
@@ -48,6 +59,29 @@ public:
         std::strong_ordering operator<=>(const Hotkey&) const = default;
     };
 
+    /* Decision of a keyboard event subscriber, see on_keyboard_event() */
+    struct KeyboardEventDecision
+    {
+        enum class Type
+        {
+            /* Pass the event to the next subscriber */
+            Pass,
+            /* Swallow the event, the next subscribers and the applications don't get it */
+            Suppress,
+            /* Swallow the event and send replacement_key instead, with the same key up/down state.
+             * The replacement is injected for the applications only, it isn't dispatched to any subscriber. */
+            Replace
+        };
+
+        Type type = Type::Pass;
+        unsigned short replacement_key = 0;
+    };
+
+    /* Receives the configuration settings serialized by write_config(). The string is
+     * only valid during the call.
+     */
+    typedef void(__cdecl* ConfigWriter)(void* context, const wchar_t* config, size_t length);
+
     /* Returns the localized name of the PowerToy*/
     virtual const wchar_t* get_name() = 0;
     /* Returns non localized name of the PowerToy, this will be cached by the runner. */
@@ -82,8 +116,37 @@ public:
      * if the key press is to be swallowed.
      */
     virtual bool on_hotkey(size_t hotkeyId) { return false; }
+
+    /* Returns the priority of the PowerToy as a subscriber of the runner's low level keyboard
+     * hook. Subscribers with a higher priority get the events first. A negative value, which
+     * is the default, means the PowerToy doesn't get the events.
+     * This method is called once, when the PowerToy is loaded.
+     */
+    virtual int get_keyboard_event_priority() { return -1; }
+
+    /* Called on the runner's main thread for every low level keyboard event while the PowerToy
+     * is enabled, unless a subscriber with a higher priority swallowed it. Should return quickly
+     * since it runs in the hook.
+     */
+    virtual KeyboardEventDecision on_keyboard_event(LowlevelKeyboardEvent* event) { return {}; }
+
+    /* Builds and serializes the configuration settings once and passes them to writer, instead
+     * of the two calls the runner needs with get_config(). Should return false if the PowerToy
+     * doesn't implement it, which is the default, the runner then falls back to get_config().
+     * See PowerToysSettings::Settings::serialize_to_writer() in common/settings_objects.h.
+     */
+    virtual bool write_config(ConfigWriter writer, void* context) { return false; }
 };
 
+/*
+  Version of the interface the PowerToy DLL is built against. Increment it when appending
+  methods to PowertoyModuleIface, a DLL built against an older version doesn't have them
+  in its vtable.
+    0 - DLLs which don't export powertoy_interface_version(), up to on_hotkey(),
+    1 - get_keyboard_event_priority(), on_keyboard_event() and write_config().
+*/
+const int POWERTOY_INTERFACE_VERSION = 1;
+
 /*
   Typedef of the factory function that creates the PowerToy object.
 
@@ -100,3 +163,18 @@ public:
   In case of errors return nullptr.
 */
 typedef PowertoyModuleIface*(__cdecl* powertoy_create_func)();
+
+/*
+  Typedef of the function that returns the interface version the PowerToy is built against.
+
+  Should be exported by the DLL as powertoy_interface_version(), e.g.:
+
+  extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+  {
+      return POWERTOY_INTERFACE_VERSION;
+  }
+
+  Called by the PowerToys runner before powertoy_create(). If the DLL doesn't export it
+  the runner treats it as version 0.
+*/
+typedef int(__cdecl* powertoy_interface_version_func)();
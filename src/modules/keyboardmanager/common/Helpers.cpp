@@ -179,6 +179,12 @@ namespace KeyboardManagerHelper
             return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_MAXSHORTCUTSIZE).c_str();
         case ErrorType::ShortcutDisableAsActionKey:
             return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_DISABLEASACTIONKEY).c_str();
+        case ErrorType::KeySequenceInvalid:
+            return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_KEYSEQUENCEINVALID).c_str();
+        case ErrorType::ConflictingKeySequence:
+            return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_CONFLICTINGKEYSEQUENCE).c_str();
+        case ErrorType::KeySequenceConflictsWithShortcut:
+            return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_KEYSEQUENCECONFLICTSWITHSHORTCUT).c_str();
         default:
             return GET_RESOURCE_STRING(IDS_ERRORMESSAGE_DEFAULT).c_str();
         }
@@ -201,6 +207,42 @@ namespace KeyboardManagerHelper
         keyEventArray[index].ki.wScan = (WORD)MapVirtualKey(keyCode, MAPVK_VK_TO_VSC);
     }
 
+    // Function to convert a low level hook event to the platform independent key event used by the remap engine
+    KeyboardManagerInput::KeyEvent ToKeyEvent(const LowlevelKeyboardEvent& data)
+    {
+        KeyboardManagerInput::KeyEvent keyEvent;
+        keyEvent.key = data.lParam->vkCode;
+        keyEvent.extraInfo = data.lParam->dwExtraInfo;
+        keyEvent.time = data.lParam->time;
+        switch (data.wParam)
+        {
+        case WM_KEYUP:
+            keyEvent.type = KeyboardManagerInput::KeyEventType::KeyUp;
+            break;
+        case WM_SYSKEYDOWN:
+            keyEvent.type = KeyboardManagerInput::KeyEventType::SysKeyDown;
+            break;
+        case WM_SYSKEYUP:
+            keyEvent.type = KeyboardManagerInput::KeyEventType::SysKeyUp;
+            break;
+        default:
+            keyEvent.type = KeyboardManagerInput::KeyEventType::KeyDown;
+            break;
+        }
+
+        return keyEvent;
+    }
+
+    // Function to convert a key input sent by the remap engine to the platform independent output key event
+    KeyboardManagerInput::OutputKeyEvent ToOutputKeyEvent(const INPUT& input)
+    {
+        KeyboardManagerInput::OutputKeyEvent outputEvent;
+        outputEvent.key = input.ki.wVk;
+        outputEvent.isKeyUp = (input.ki.dwFlags & KEYEVENTF_KEYUP) != 0;
+        outputEvent.extraInfo = input.ki.dwExtraInfo;
+        return outputEvent;
+    }
+
     // Function to set the dummy key events used for remapping shortcuts, required to ensure releasing a modifier doesn't trigger another action (For example, Win->Start Menu or Alt->Menu bar)
     void SetDummyKeyEvent(LPINPUT keyEventArray, int& index, ULONG_PTR extraInfo)
     {
@@ -1,5 +1,7 @@
 #pragma once
 #include "Shortcut.h"
+#include "KeyboardEvent.h"
+#include <common/LowlevelKeyboardEvent.h>
 
 namespace winrt
 {
@@ -49,7 +51,10 @@ namespace KeyboardManagerHelper
         ShortcutOneActionKey,
         ShortcutNotMoreThanOneActionKey,
         ShortcutMaxShortcutSizeOneActionKey,
-        ShortcutDisableAsActionKey
+        ShortcutDisableAsActionKey,
+        KeySequenceInvalid,
+        ConflictingKeySequence,
+        KeySequenceConflictsWithShortcut
     };
 
     // Enum type to store possible decision for input in the low level hook
@@ -87,6 +92,12 @@ namespace KeyboardManagerHelper
     // Function to set the value of a key event based on the arguments
     void SetKeyEvent(LPINPUT keyEventArray, int index, DWORD inputType, WORD keyCode, DWORD flags, ULONG_PTR extraInfo);
 
+    // Function to convert a low level hook event to the platform independent key event used by the remap engine
+    KeyboardManagerInput::KeyEvent ToKeyEvent(const LowlevelKeyboardEvent& data);
+
+    // Function to convert a key input sent by the remap engine to the platform independent output key event
+    KeyboardManagerInput::OutputKeyEvent ToOutputKeyEvent(const INPUT& input);
+
     // Function to set the dummy key events used for remapping shortcuts, required to ensure releasing a modifier doesn't trigger another action (For example, Win->Start Menu or Alt->Menu bar)
     void SetDummyKeyEvent(LPINPUT keyEventArray, int& index, ULONG_PTR extraInfo);
 
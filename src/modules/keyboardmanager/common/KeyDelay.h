@@ -1,10 +1,6 @@
 #pragma once
 #include <functional>
-#include <thread>
-#include <queue>
-#include <mutex>
 
-#include <LowlevelKeyboardEvent.h>
 // Available states for the KeyDelay state machine.
 enum class KeyDelayState
 {
@@ -20,9 +16,8 @@ struct KeyTimedEvent
     WPARAM message;
 };
 
-// Handles delayed key inputs.
-// Implemented as a state machine running on its own thread.
-// Thread stops on destruction.
+// Handles delayed key inputs for a single key.
+// Implemented as a state machine without a thread of its own, it is driven by the KeyDelayScheduler thread.
 class KeyDelay
 {
 public:
@@ -31,39 +26,35 @@ public:
         std::function<void(DWORD)> onShortPress,
         std::function<void(DWORD)> onLongPressDetected,
         std::function<void(DWORD)> onLongPressReleased) :
-        _quit(false),
         _state(KeyDelayState::RELEASED),
         _initialHoldKeyDown(0),
+        _pressId(0),
         _key(key),
         _onShortPress(onShortPress),
         _onLongPressDetected(onLongPressDetected),
-        _onLongPressReleased(onLongPressReleased),
-        _delayThread(&KeyDelay::DelayThread, this){};
+        _onLongPressReleased(onLongPressReleased){};
 
-    // Enque new KeyTimedEvent and notify the condition variable.
-    void KeyEvent(LowlevelKeyboardEvent* ev);
-    ~KeyDelay();
+    // Manage state transitions and trigger callbacks for a key event.
+    // Returns true if a long press timeout has to be scheduled for the current press.
+    bool KeyEvent(const KeyTimedEvent& ev);
 
-private:
-    // Runs the state machine, waits if there is no events to process.
-    // Checks for _quit condition.
-    void DelayThread();
-
-    // Manage state transitions and trigger callbacks on certain events.
-    // Returns whether or not the thread should wait on new events.
-    bool HandleRelease();
-    bool HandleOnHold(std::unique_lock<std::mutex>& cvLock);
-    bool HandleOnHoldTimeout();
+    // Called when the long press timeout of the press identified by <pressId> expires.
+    void LongPressTimeout(DWORD64 pressId);
 
-    // Get next key event in queue.
-    KeyTimedEvent NextEvent();
-    bool HasNextEvent();
+    // Identifies the current press, used to discard timeouts scheduled for earlier presses.
+    DWORD64 PressId() const;
 
     // Check if <duration> milliseconds passed since <first> millisecond.
     // Also checks for overflow conditions.
-    bool CheckIfMillisHaveElapsed(DWORD64 first, DWORD64 last, DWORD64 duration);
+    static bool CheckIfMillisHaveElapsed(DWORD64 first, DWORD64 last, DWORD64 duration);
+
+    static const DWORD64 LONG_PRESS_DELAY_MILLIS = 900;
+
+private:
+    bool HandleRelease(const KeyTimedEvent& ev);
+    void HandleOnHold(const KeyTimedEvent& ev);
+    void HandleOnHoldTimeout(const KeyTimedEvent& ev);
 
-    bool _quit;
     KeyDelayState _state;
 
     // Callback functions, the key provided in the constructor is passed as an argument.
@@ -71,23 +62,12 @@ private:
     std::function<void(DWORD)> _onLongPressReleased;
     std::function<void(DWORD)> _onShortPress;
 
-    // Queue holding key events that are not processed yet. Should be kept synchronized
-    // using _queueMutex
-    std::queue<KeyTimedEvent> _queue;
-    std::mutex _queueMutex;
-
-    // DelayThread waits on this condition variable when there is no events to process.
-    std::condition_variable _cv;
-
     // Keeps track of the time at which the initial KEY_DOWN event happened.
     DWORD64 _initialHoldKeyDown;
 
+    // Incremented on every initial KEY_DOWN event.
+    DWORD64 _pressId;
+
     // Virtual Key provided in the constructor. Passed to callback functions.
     DWORD _key;
-
-    // Declare _delayThread after all other members so that it is the last to be initialized by the constructor
-    std::thread _delayThread;
-
-    static const DWORD64 LONG_PRESS_DELAY_MILLIS = 900;
-    static const DWORD64 ON_HOLD_WAIT_TIMEOUT_MILLIS = 50;
 };
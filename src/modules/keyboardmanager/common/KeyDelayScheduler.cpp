@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "KeyDelayScheduler.h"
+
+KeyDelayScheduler::KeyDelayScheduler() :
+    _pendingTimers(0),
+    _lastTick(0),
+    _quit(false)
+{
+    for (auto& registeredKeys : _registeredKeys)
+    {
+        registeredKeys = 0;
+    }
+
+    _wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+}
+
+KeyDelayScheduler::~KeyDelayScheduler()
+{
+    _quit = true;
+    if (_wakeEvent)
+    {
+        SetEvent(_wakeEvent);
+    }
+
+    if (_schedulerThread.joinable())
+    {
+        _schedulerThread.join();
+    }
+
+    if (_wakeEvent)
+    {
+        CloseHandle(_wakeEvent);
+    }
+}
+
+void KeyDelayScheduler::RegisterKeyDelay(
+    DWORD key,
+    std::function<void(DWORD)> onShortPress,
+    std::function<void(DWORD)> onLongPressDetected,
+    std::function<void(DWORD)> onLongPressReleased)
+{
+    std::lock_guard l(_keyDelaysMutex);
+
+    if (_keyDelays.find(key) != _keyDelays.end())
+    {
+        throw std::invalid_argument("This key was already registered.");
+    }
+
+    _keyDelays[key] = std::make_unique<KeyDelay>(key, onShortPress, onLongPressDetected, onLongPressReleased);
+    SetRegistered(key, true);
+
+    if (!_schedulerThread.joinable())
+    {
+        _schedulerThread = std::thread(&KeyDelayScheduler::SchedulerThread, this);
+    }
+}
+
+void KeyDelayScheduler::UnregisterKeyDelay(DWORD key)
+{
+    std::lock_guard l(_keyDelaysMutex);
+
+    auto deleted = _keyDelays.erase(key);
+    if (deleted == 0)
+    {
+        throw std::invalid_argument("The key was not previously registered.");
+    }
+
+    SetRegistered(key, false);
+}
+
+void KeyDelayScheduler::ClearKeyDelays()
+{
+    std::lock_guard l(_keyDelaysMutex);
+
+    for (const auto& it : _keyDelays)
+    {
+        SetRegistered(it.first, false);
+    }
+    _keyDelays.clear();
+}
+
+bool KeyDelayScheduler::IsKeyDelayRegistered(DWORD key) const noexcept
+{
+    if (key >= _registeredKeys.size() * 64)
+    {
+        return false;
+    }
+
+    return (_registeredKeys[key / 64].load(std::memory_order_acquire) >> (key % 64)) & 1;
+}
+
+bool KeyDelayScheduler::QueueKeyEvent(DWORD key, const KeyTimedEvent& ev) noexcept
+{
+    if (!_queue.push({ key, ev }))
+    {
+        return false;
+    }
+
+    SetEvent(_wakeEvent);
+    return true;
+}
+
+void KeyDelayScheduler::SchedulerThread()
+{
+    while (!_quit)
+    {
+        DWORD timeout;
+        {
+            std::lock_guard l(_keyDelaysMutex);
+            ProcessKeyEvents();
+            ProcessTimers(GetTickCount64());
+            timeout = NextTimeout(GetTickCount64());
+        }
+
+        WaitForSingleObject(_wakeEvent, timeout);
+    }
+}
+
+void KeyDelayScheduler::ProcessKeyEvents()
+{
+    while (auto queued = _queue.pop())
+    {
+        auto it = _keyDelays.find(queued->key);
+        if (it == _keyDelays.end())
+        {
+            // The key was unregistered after the event was queued
+            continue;
+        }
+
+        if (it->second->KeyEvent(queued->ev))
+        {
+            DWORD64 deadline = GetTickCount64() + KeyDelay::LONG_PRESS_DELAY_MILLIS;
+            _timerWheel[(deadline / TIMER_TICK_MILLIS) % TIMER_WHEEL_SIZE].push_back({ queued->key, it->second->PressId(), deadline });
+            _pendingTimers++;
+        }
+    }
+}
+
+void KeyDelayScheduler::ProcessTimers(DWORD64 now)
+{
+    DWORD64 currentTick = now / TIMER_TICK_MILLIS;
+    if (_pendingTimers == 0)
+    {
+        _lastTick = currentTick;
+        return;
+    }
+
+    // Visit the slots of all the ticks since the last run, including the last one since it may contain timers which were not due yet. A full revolution visits every slot.
+    DWORD64 firstTick = currentTick - _lastTick >= TIMER_WHEEL_SIZE ? currentTick - TIMER_WHEEL_SIZE + 1 : _lastTick;
+    for (DWORD64 tick = firstTick; tick <= currentTick; tick++)
+    {
+        auto& slot = _timerWheel[tick % TIMER_WHEEL_SIZE];
+        for (size_t i = 0; i < slot.size();)
+        {
+            if (slot[i].deadline > now)
+            {
+                i++;
+                continue;
+            }
+
+            TimerEntry entry = slot[i];
+            slot[i] = slot.back();
+            slot.pop_back();
+            _pendingTimers--;
+
+            auto it = _keyDelays.find(entry.key);
+            if (it != _keyDelays.end())
+            {
+                it->second->LongPressTimeout(entry.pressId);
+            }
+        }
+    }
+
+    _lastTick = currentTick;
+}
+
+DWORD KeyDelayScheduler::NextTimeout(DWORD64 now) const
+{
+    if (_pendingTimers == 0)
+    {
+        return INFINITE;
+    }
+
+    // Wake up at the start of the next tick
+    return static_cast<DWORD>(TIMER_TICK_MILLIS - now % TIMER_TICK_MILLIS);
+}
+
+void KeyDelayScheduler::SetRegistered(DWORD key, bool registered) noexcept
+{
+    if (key >= _registeredKeys.size() * 64)
+    {
+        return;
+    }
+
+    const uint64_t mask = 1ull << (key % 64);
+    if (registered)
+    {
+        _registeredKeys[key / 64].fetch_or(mask, std::memory_order_release);
+    }
+    else
+    {
+        _registeredKeys[key / 64].fetch_and(~mask, std::memory_order_release);
+    }
+}
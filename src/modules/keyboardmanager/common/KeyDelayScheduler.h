@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <common/spsc_queue.h>
+#include "KeyDelay.h"
+
+// Services the KeyDelay state machines of all the registered keys on a single thread.
+// Key events are handed over from the low level hook through a lock-free single producer single consumer queue, and
+// long press timeouts are kept in a hashed timer wheel so the thread only wakes up when there is work to do.
+class KeyDelayScheduler
+{
+public:
+    KeyDelayScheduler();
+
+    // NOTE: The destructor should never be called on the scheduler thread, i.e. from any of the KeyDelay callbacks, as it joins the thread.
+    ~KeyDelayScheduler();
+
+    // Add a KeyDelay for the given virtual key. Starts the scheduler thread if it is not running yet.
+    // NOTE: this will throw an exception if a virtual key is registered twice.
+    void RegisterKeyDelay(
+        DWORD key,
+        std::function<void(DWORD)> onShortPress,
+        std::function<void(DWORD)> onLongPressDetected,
+        std::function<void(DWORD)> onLongPressReleased);
+
+    // Remove a KeyDelay.
+    // NOTE: this method will throw if the virtual key is not registered beforehand.
+    void UnregisterKeyDelay(DWORD key);
+
+    // Remove all the registered KeyDelays.
+    void ClearKeyDelays();
+
+    // Check if a KeyDelay is registered for the virtual key. Lock-free, can be called from the low level hook.
+    bool IsKeyDelayRegistered(DWORD key) const noexcept;
+
+    // Queue a key event for a registered virtual key. Must only be called from the low level hook thread.
+    // Returns false if the event could not be queued.
+    bool QueueKeyEvent(DWORD key, const KeyTimedEvent& ev) noexcept;
+
+private:
+    static const DWORD64 TIMER_TICK_MILLIS = 50;
+    static const size_t TIMER_WHEEL_SIZE = 32;
+
+    struct QueuedKeyEvent
+    {
+        DWORD key;
+        KeyTimedEvent ev;
+    };
+
+    struct TimerEntry
+    {
+        DWORD key;
+        DWORD64 pressId;
+        DWORD64 deadline;
+    };
+
+    // Runs the KeyDelay state machines, waits until the next key event or the next timer wheel tick.
+    void SchedulerThread();
+
+    // Run the queued key events through the KeyDelay state machines.
+    void ProcessKeyEvents();
+
+    // Fire all the long press timeouts which have expired by <now>.
+    void ProcessTimers(DWORD64 now);
+
+    // Number of milliseconds until the scheduler thread should wake up to process timers, or INFINITE.
+    DWORD NextTimeout(DWORD64 now) const;
+
+    void SetRegistered(DWORD key, bool registered) noexcept;
+
+    // Registered KeyDelay objects. Only accessed while holding _keyDelaysMutex.
+    std::map<DWORD, std::unique_ptr<KeyDelay>> _keyDelays;
+    std::mutex _keyDelaysMutex;
+
+    // Bitset of the registered virtual keys, read by the low level hook without taking _keyDelaysMutex.
+    std::array<std::atomic<uint64_t>, 4> _registeredKeys;
+
+    // Key events from the low level hook.
+    SpscQueue<QueuedKeyEvent, 256> _queue;
+
+    // Hashed timer wheel with TIMER_WHEEL_SIZE slots of TIMER_TICK_MILLIS. Entries further away than one revolution stay in their slot until their deadline is reached.
+    // Only accessed from the scheduler thread.
+    std::array<std::vector<TimerEntry>, TIMER_WHEEL_SIZE> _timerWheel;
+    size_t _pendingTimers;
+    DWORD64 _lastTick;
+
+    // Auto-reset event used to wake the scheduler thread up.
+    HANDLE _wakeEvent;
+    std::atomic_bool _quit;
+
+    // Started on the first registration.
+    std::thread _schedulerThread;
+};
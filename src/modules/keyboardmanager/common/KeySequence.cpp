@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "KeySequence.h"
+#include "Helpers.h"
+#include "KeyboardManagerConstants.h"
+#include "../common/shared_constants.h"
+
+KeySequence::KeySequence() :
+    timeoutMillis(KeyboardManagerConstants::DefaultKeySequenceTimeoutMillis)
+{
+}
+
+// Constructor to initialize the key sequence from it's virtual key code string representation. Steps are separated by "," and keys within a step by ";"
+KeySequence::KeySequence(const std::wstring& sequenceVK, DWORD timeoutMillis) :
+    timeoutMillis(timeoutMillis)
+{
+    auto stepsVK = KeyboardManagerHelper::splitwstring(sequenceVK, ',');
+    for (const auto& it : stepsVK)
+    {
+        steps.push_back(Shortcut(it));
+    }
+}
+
+// Function to return true if the key sequence is valid. A valid key sequence has at least 2 and at most MaxKeySequenceSteps steps, and every step has an action key
+bool KeySequence::IsValidSequence() const
+{
+    if (steps.size() < 2 || steps.size() > KeyboardManagerConstants::MaxKeySequenceSteps)
+    {
+        return false;
+    }
+
+    for (const auto& step : steps)
+    {
+        if (step.GetActionKey() == NULL || step.GetActionKey() == CommonSharedConstants::VK_DISABLED)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Function to check if the steps of the key sequence are the first steps (or all the steps) of the key sequence in the argument
+bool KeySequence::IsPrefixOf(const KeySequence& sequence) const
+{
+    if (steps.size() > sequence.steps.size())
+    {
+        return false;
+    }
+
+    return std::equal(steps.begin(), steps.end(), sequence.steps.begin());
+}
+
+// Function to return the string representation of the key sequence in virtual key codes, steps are separated by "," and keys within a step by ";"
+winrt::hstring KeySequence::ToHstringVK() const
+{
+    winrt::hstring output;
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        if (i != 0)
+        {
+            output = output + winrt::to_hstring(L",");
+        }
+
+        output = output + steps[i].ToHstringVK();
+    }
+
+    return output;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Shortcut.h"
+#include <vector>
+
+// This class stores a key sequence, i.e. "Ctrl+K, Ctrl+C" or "J, K".
+// Each step is either a shortcut or a single key without modifiers, and the key down of each step must happen within timeoutMillis of the key down of the previous step.
+class KeySequence
+{
+public:
+    std::vector<Shortcut> steps;
+    DWORD timeoutMillis;
+
+    KeySequence();
+
+    // Constructor to initialize the key sequence from it's virtual key code string representation. Steps are separated by "," and keys within a step by ";"
+    KeySequence(const std::wstring& sequenceVK, DWORD timeoutMillis);
+
+    inline bool operator==(const KeySequence& sequence) const
+    {
+        return steps == sequence.steps && timeoutMillis == sequence.timeoutMillis;
+    }
+
+    // Less than operator must be defined to use with std::map.
+    inline bool operator<(const KeySequence& sequence) const
+    {
+        if (steps == sequence.steps)
+        {
+            return timeoutMillis < sequence.timeoutMillis;
+        }
+
+        return steps < sequence.steps;
+    }
+
+    // Function to return true if the key sequence is valid. A valid key sequence has at least 2 and at most MaxKeySequenceSteps steps, and every step has an action key
+    bool IsValidSequence() const;
+
+    // Function to check if the steps of the key sequence are the first steps (or all the steps) of the key sequence in the argument
+    bool IsPrefixOf(const KeySequence& sequence) const;
+
+    // Function to return the string representation of the key sequence in virtual key codes, steps are separated by "," and keys within a step by ";"
+    winrt::hstring ToHstringVK() const;
+};
@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "KeySequenceTrie.h"
+#include "InputInterface.h"
+
+namespace
+{
+    // Flags used to represent the modifiers of a step
+    const DWORD WinFlag = 0x1;
+    const DWORD CtrlFlag = 0x2;
+    const DWORD AltFlag = 0x4;
+    const DWORD ShiftFlag = 0x8;
+}
+
+KeySequenceTrie::KeySequenceTrie() :
+    nodes(1)
+{
+}
+
+// Function to add a key sequence which maps to the remap at remapIndex. Returns false if the sequence is invalid, or if it is the same as or starts with a sequence which was added before (or the other way round)
+bool KeySequenceTrie::Insert(const KeySequence& sequence, size_t remapIndex)
+{
+    if (!sequence.IsValidSequence())
+    {
+        return false;
+    }
+
+    // Check for conflicts before modifying the trie
+    size_t node = 0;
+    for (size_t i = 0; i < sequence.steps.size(); i++)
+    {
+        auto it = nodes[node].children.find(GetStepCode(GetModifierFlags(sequence.steps[i]), sequence.steps[i].GetActionKey()));
+        if (it == nodes[node].children.end())
+        {
+            break;
+        }
+
+        // Either a shorter sequence ends here, or this sequence ends on an existing node
+        if (nodes[it->second].remapIndex || i == sequence.steps.size() - 1)
+        {
+            return false;
+        }
+
+        node = it->second;
+    }
+
+    node = 0;
+    for (size_t i = 0; i < sequence.steps.size(); i++)
+    {
+        DWORD64 stepCode = GetStepCode(GetModifierFlags(sequence.steps[i]), sequence.steps[i].GetActionKey());
+        auto it = nodes[node].children.find(stepCode);
+        if (it != nodes[node].children.end())
+        {
+            node = it->second;
+        }
+        else
+        {
+            nodes.emplace_back();
+            nodes[node].children[stepCode] = nodes.size() - 1;
+            node = nodes.size() - 1;
+        }
+
+        // Sequences which share steps use the largest timeout
+        nodes[node].timeoutMillis = max(nodes[node].timeoutMillis, sequence.timeoutMillis);
+    }
+
+    nodes[node].remapIndex = remapIndex;
+    return true;
+}
+
+// Function to remove all the key sequences
+void KeySequenceTrie::Clear()
+{
+    nodes.clear();
+    nodes.emplace_back();
+}
+
+// Function to check if no key sequences have been added
+bool KeySequenceTrie::IsEmpty() const
+{
+    return nodes[0].children.empty();
+}
+
+// Function to advance the match state on the key down of a non-modifier key
+std::optional<size_t> KeySequenceTrie::KeyDown(KeySequenceMatchState& state, DWORD key, DWORD modifierFlags, DWORD time) const
+{
+    // A state which was advanced on other tables may point past the end of the trie
+    if (state.currentNode >= nodes.size())
+    {
+        state.currentNode = 0;
+    }
+
+    // The hook timestamps wrap around, the unsigned difference handles that
+    if (state.currentNode != 0 && time - state.lastStepTime > nodes[state.currentNode].timeoutMillis)
+    {
+        state.currentNode = 0;
+    }
+
+    DWORD64 stepCode = GetStepCode(modifierFlags, key);
+    auto it = nodes[state.currentNode].children.find(stepCode);
+
+    // If the key does not continue the current sequence, it may still start a new one
+    if (it == nodes[state.currentNode].children.end() && state.currentNode != 0)
+    {
+        state.currentNode = 0;
+        it = nodes[0].children.find(stepCode);
+    }
+
+    if (it == nodes[state.currentNode].children.end())
+    {
+        return std::nullopt;
+    }
+
+    state.currentNode = it->second;
+    state.lastStepTime = time;
+
+    auto remapIndex = nodes[state.currentNode].remapIndex;
+    if (remapIndex)
+    {
+        state.currentNode = 0;
+    }
+
+    return remapIndex;
+}
+
+// Function to remember the key of the last step of a matched sequence, so that its key up is suppressed as well
+void KeySequenceMatchState::SuppressKeyUp(DWORD key)
+{
+    suppressedKeyUp = key;
+}
+
+// Function to check if the key up should be suppressed. The suppression is consumed by the call
+bool KeySequenceMatchState::ConsumeSuppressedKeyUp(DWORD key)
+{
+    if (suppressedKeyUp == NULL || suppressedKeyUp != key)
+    {
+        return false;
+    }
+
+    suppressedKeyUp = NULL;
+    return true;
+}
+
+// Function to get the modifier flags of a step of a key sequence
+DWORD KeySequenceTrie::GetModifierFlags(const Shortcut& step)
+{
+    DWORD flags = 0;
+    if (step.GetWinKey(ModifierKey::Both) != NULL)
+    {
+        flags |= WinFlag;
+    }
+    if (step.GetCtrlKey() != NULL)
+    {
+        flags |= CtrlFlag;
+    }
+    if (step.GetAltKey() != NULL)
+    {
+        flags |= AltFlag;
+    }
+    if (step.GetShiftKey() != NULL)
+    {
+        flags |= ShiftFlag;
+    }
+
+    return flags;
+}
+
+// Function to get the modifier flags of the modifiers which are currently held down
+DWORD KeySequenceTrie::GetModifierFlags(InputInterface& ii)
+{
+    DWORD flags = 0;
+    if (ii.GetVirtualKeyState(VK_LWIN) || ii.GetVirtualKeyState(VK_RWIN))
+    {
+        flags |= WinFlag;
+    }
+    if (ii.GetVirtualKeyState(VK_CONTROL))
+    {
+        flags |= CtrlFlag;
+    }
+    if (ii.GetVirtualKeyState(VK_MENU))
+    {
+        flags |= AltFlag;
+    }
+    if (ii.GetVirtualKeyState(VK_SHIFT))
+    {
+        flags |= ShiftFlag;
+    }
+
+    return flags;
+}
+
+DWORD64 KeySequenceTrie::GetStepCode(DWORD modifierFlags, DWORD key)
+{
+    return ((DWORD64)modifierFlags << 32) | key;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "KeySequence.h"
+
+class InputInterface;
+
+// Match state of the key sequence trie. It is owned by the hook thread and kept separately from the trie, which is part of the published remap tables.
+struct KeySequenceMatchState
+{
+    // Index of the trie node of the last matched step, 0 if no sequence is partially matched
+    size_t currentNode = 0;
+    DWORD lastStepTime = 0;
+
+    // Key of the last step of a matched sequence, its key up is suppressed as well
+    DWORD suppressedKeyUp = NULL;
+
+    // Function to remember the key of the last step of a matched sequence, so that its key up is suppressed as well
+    void SuppressKeyUp(DWORD key);
+
+    // Function to check if the key up should be suppressed. The suppression is consumed by the call
+    bool ConsumeSuppressedKeyUp(DWORD key);
+};
+
+// Trie of the remapped key sequences which is walked by the hook one key down at a time.
+// The edges are step codes which combine the modifiers held down (without distinguishing left and right) and the action key of a step, so every key event costs a single hash lookup.
+// The size of the trie is bounded by the number of remapped sequences times MaxKeySequenceSteps, and the match state is a single node index.
+// The trie itself is never modified by the hook, the match state is passed to KeyDown.
+// Sequences are matched on key downs only. The key events of the first steps are not suppressed, only the last step is replaced by the target of the remap.
+class KeySequenceTrie
+{
+public:
+    KeySequenceTrie();
+
+    // Function to add a key sequence which maps to the remap at remapIndex. Returns false if the sequence is invalid, or if it is the same as or starts with a sequence which was added before (or the other way round)
+    bool Insert(const KeySequence& sequence, size_t remapIndex);
+
+    // Function to remove all the key sequences
+    void Clear();
+
+    // Function to check if no key sequences have been added
+    bool IsEmpty() const;
+
+    // Function to advance the match state on the key down of a non-modifier key. modifierFlags should be obtained from GetModifierFlags, and time is the timestamp of the hook event.
+    // Returns the remap index of the sequence if the key down completes it.
+    std::optional<size_t> KeyDown(KeySequenceMatchState& state, DWORD key, DWORD modifierFlags, DWORD time) const;
+
+    // Function to get the modifier flags of a step of a key sequence
+    static DWORD GetModifierFlags(const Shortcut& step);
+
+    // Function to get the modifier flags of the modifiers which are currently held down
+    static DWORD GetModifierFlags(InputInterface& ii);
+
+private:
+    struct Node
+    {
+        // Maps step codes to the index of the child node
+        std::unordered_map<DWORD64, size_t> children;
+
+        // Maximum time between the key down of the step of this node and the next one
+        DWORD timeoutMillis = 0;
+
+        // Set if a sequence ends at this node. Such nodes never have children
+        std::optional<size_t> remapIndex;
+    };
+
+    static DWORD64 GetStepCode(DWORD modifierFlags, DWORD key);
+
+    // nodes[0] is the root
+    std::vector<Node> nodes;
+};
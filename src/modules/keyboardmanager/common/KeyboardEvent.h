@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+// Platform independent key event types used by the remap engine. These intentionally do not use any Win32 types so that recorded key traces can be fed through the engine in the same way as events from the low level hook.
+namespace KeyboardManagerInput
+{
+    // Type of a key event, mirrors the WM_KEYDOWN/WM_KEYUP/WM_SYSKEYDOWN/WM_SYSKEYUP messages
+    enum class KeyEventType : uint8_t
+    {
+        KeyDown,
+        KeyUp,
+        SysKeyDown,
+        SysKeyUp
+    };
+
+    // Key event received by the remap engine
+    struct KeyEvent
+    {
+        // Virtual key code of the key
+        uint32_t key = 0;
+
+        // Type of the key event
+        KeyEventType type = KeyEventType::KeyDown;
+
+        // Extra information associated with the event, used to identify events injected by Keyboard Manager
+        uint64_t extraInfo = 0;
+
+        // Time stamp of the event in milliseconds
+        uint32_t time = 0;
+
+        bool IsKeyDown() const
+        {
+            return type == KeyEventType::KeyDown || type == KeyEventType::SysKeyDown;
+        }
+
+        bool IsKeyUp() const
+        {
+            return type == KeyEventType::KeyUp || type == KeyEventType::SysKeyUp;
+        }
+    };
+
+    // Key event emitted by the remap engine
+    struct OutputKeyEvent
+    {
+        // Virtual key code of the key
+        uint16_t key = 0;
+
+        // True if the key is released, false if it is pressed
+        bool isKeyUp = false;
+
+        // Extra information associated with the event
+        uint64_t extraInfo = 0;
+
+        bool operator==(const OutputKeyEvent& other) const
+        {
+            return key == other.key && isKeyUp == other.isKeyUp && extraInfo == other.extraInfo;
+        }
+
+        bool operator!=(const OutputKeyEvent& other) const
+        {
+            return !(*this == other);
+        }
+    };
+}
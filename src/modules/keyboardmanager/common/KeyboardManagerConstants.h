@@ -28,6 +28,12 @@ namespace KeyboardManagerConstants
     // Name of the property use to store app specific shortcut remaps array.
     inline const std::wstring AppSpecificRemapShortcutsSettingName = L"appSpecific";
 
+    // Name of the property use to store key sequence remaps.
+    inline const std::wstring RemapSequencesSettingName = L"remapSequences";
+
+    // Name of the property use to store the maximum time between two steps of a key sequence.
+    inline const std::wstring SequenceTimeoutSettingName = L"timeout";
+
     // Name of the property use to store original keys.
     inline const std::wstring OriginalKeysSettingName = L"originalKeys";
 
@@ -106,6 +112,12 @@ namespace KeyboardManagerConstants
     // Number of key messages required while sending a dummy key event
     inline const size_t DUMMY_KEY_EVENT_SIZE = 2;
 
+    // Maximum number of steps in a key sequence, this bounds the depth of the key sequence trie
+    inline const size_t MaxKeySequenceSteps = 4;
+
+    // Default maximum time in milliseconds between the key downs of two steps of a key sequence
+    inline const DWORD DefaultKeySequenceTimeoutMillis = 1000;
+
     // String constant for the default app name in Remap shortcuts
     inline const std::wstring DefaultAppName = GET_RESOURCE_STRING(IDS_EDITSHORTCUTS_ALLAPPS);
 
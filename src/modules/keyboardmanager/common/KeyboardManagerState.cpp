@@ -3,12 +3,12 @@
 #include "Shortcut.h"
 #include "RemapShortcut.h"
 #include <../common/settings_helpers.h>
-#include "KeyDelay.h"
+#include "KeyDelayScheduler.h"
 #include "Helpers.h"
 
 // Constructor
 KeyboardManagerState::KeyboardManagerState() :
-    uiState(KeyboardManagerUIState::Deactivated), currentUIWindow(nullptr), currentShortcutUI1(nullptr), currentShortcutUI2(nullptr), currentSingleKeyUI(nullptr), detectedRemapKey(NULL), remappingsEnabled(true)
+    uiState(KeyboardManagerUIState::Deactivated), currentUIWindow(nullptr), detectedRemapKey(NULL), currentSingleKeyUI(nullptr), currentShortcutUI1(nullptr), currentShortcutUI2(nullptr), keyDelayScheduler(std::make_unique<KeyDelayScheduler>()), remapTables(new RemapTables()), pinnedRemapTables(nullptr), remapTablesPinCount(0), lastRemapTablesVersion(0), remapStatesVersion(0)
 {
     configFile_mutex = CreateMutex(
         NULL, // default security descriptor
@@ -23,6 +23,8 @@ KeyboardManagerState::~KeyboardManagerState()
     {
         CloseHandle(configFile_mutex);
     }
+
+    delete remapTables.load();
 }
 
 // Function to check the if the UI state matches the argument state. For states with detect windows it also checks if the window is in focus.
@@ -104,87 +106,120 @@ void KeyboardManagerState::ResetUIState()
 // Function to clear the OS Level shortcut remapping table
 void KeyboardManagerState::ClearOSLevelShortcuts()
 {
-    osLevelShortcutReMap.clear();
-    osLevelShortcutReMapSortedKeys.clear();
+    UpdateRemapTables([](RemapTables& tables) { tables.ClearOSLevelShortcuts(); });
 }
 
 // Function to clear the Keys remapping table.
 void KeyboardManagerState::ClearSingleKeyRemaps()
 {
-    singleKeyReMap.clear();
+    UpdateRemapTables([](RemapTables& tables) { tables.ClearSingleKeyRemaps(); });
 }
 
 // Function to clear the App specific shortcut remapping table
 void KeyboardManagerState::ClearAppSpecificShortcuts()
 {
-    appSpecificShortcutReMap.clear();
-    appSpecificShortcutReMapSortedKeys.clear();
+    UpdateRemapTables([](RemapTables& tables) { tables.ClearAppSpecificShortcuts(); });
+}
+
+// Function to clear the key sequence remapping table
+void KeyboardManagerState::ClearKeySequenceRemaps()
+{
+    UpdateRemapTables([](RemapTables& tables) { tables.ClearKeySequenceRemaps(); });
 }
 
 // Function to add a new OS level shortcut remapping
 bool KeyboardManagerState::AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC)
 {
-    // Check if the shortcut is already remapped
-    auto it = osLevelShortcutReMap.find(originalSC);
-    if (it != osLevelShortcutReMap.end())
-    {
-        return false;
-    }
-
-    osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
-    osLevelShortcutReMapSortedKeys.push_back(originalSC);
-    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(osLevelShortcutReMapSortedKeys);
-
-    return true;
+    bool result = false;
+    UpdateRemapTables([&](RemapTables& tables) { result = tables.AddOSLevelShortcut(originalSC, newSC); });
+    return result;
 }
 
 // Function to add a new single key to key/shortcut remapping
 bool KeyboardManagerState::AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey)
 {
-    // Check if the key is already remapped
-    auto it = singleKeyReMap.find(originalKey);
-    if (it != singleKeyReMap.end())
-    {
-        return false;
-    }
-
-    singleKeyReMap[originalKey] = newRemapKey;
-    return true;
+    bool result = false;
+    UpdateRemapTables([&](RemapTables& tables) { result = tables.AddSingleKeyRemap(originalKey, newRemapKey); });
+    return result;
 }
 
 // Function to add a new App specific shortcut remapping
 bool KeyboardManagerState::AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC)
 {
-    // Convert app name to lower case
-    std::wstring process_name;
-    process_name.resize(app.length());
-    std::transform(app.begin(), app.end(), process_name.begin(), towlower);
+    bool result = false;
+    UpdateRemapTables([&](RemapTables& tables) { result = tables.AddAppSpecificShortcut(app, originalSC, newSC); });
+    return result;
+}
+
+// Function to add a new key sequence remapping
+bool KeyboardManagerState::AddKeySequenceRemap(const KeySequence& originalSequence, const KeyShortcutUnion& newRemapKey)
+{
+    bool result = false;
+    UpdateRemapTables([&](RemapTables& tables) { result = tables.AddKeySequenceRemap(originalSequence, newRemapKey); });
+    return result;
+}
 
-    // Check if there are any app specific shortcuts for this app
-    auto appIt = appSpecificShortcutReMap.find(process_name);
-    if (appIt != appSpecificShortcutReMap.end())
+// Function to build a copy of the current remap tables, apply the update to it and publish the result with a single pointer swap.
+void KeyboardManagerState::UpdateRemapTables(const std::function<void(RemapTables&)>& update)
+{
+    std::lock_guard<std::mutex> lock(remapTables_mutex);
+
+    // The new tables are built completely before the hook can see them. Only the configuration is copied, the runtime state of the remappings is owned by the hook thread.
+    auto newTables = std::make_unique<RemapTables>(*remapTables.load());
+    update(*newTables);
+    newTables->version = ++lastRemapTablesVersion;
+
+    RemapTables* oldTables = remapTables.exchange(newTables.release());
+    retiredRemapTables.emplace_back(oldTables);
+
+    // Free the replaced tables which are not pinned by the hook. A hook event which pins the tables after this point re-checks the current pointer and uses the new tables.
+    RemapTables* pinnedTables = pinnedRemapTables.load();
+    retiredRemapTables.erase(std::remove_if(retiredRemapTables.begin(), retiredRemapTables.end(), [pinnedTables](const std::unique_ptr<RemapTables>& tables) { return tables.get() != pinnedTables; }), retiredRemapTables.end());
+}
+
+// Function to get a copy of the current remap tables.
+RemapTables KeyboardManagerState::GetRemapTablesCopy()
+{
+    // Tables are only freed while holding the mutex
+    std::lock_guard<std::mutex> lock(remapTables_mutex);
+    return *remapTables.load();
+}
+
+void KeyboardManagerState::PinRemapTables() noexcept
+{
+    if (remapTablesPinCount++ > 0)
     {
-        // Check if the shortcut is already remapped
-        auto shortcutIt = appSpecificShortcutReMap[process_name].find(originalSC);
-        if (shortcutIt != appSpecificShortcutReMap[process_name].end())
-        {
-            return false;
-        }
+        return;
     }
-    else
+
+    // Publish the pinned pointer, then check that the tables were not replaced in the meantime. If they were, the update may have missed the pin and freed them.
+    RemapTables* tables;
+    do
     {
-        appSpecificShortcutReMapSortedKeys[process_name] = std::vector<Shortcut>();
+        tables = remapTables.load();
+        pinnedRemapTables.store(tables);
+    } while (tables != remapTables.load());
+}
+
+void KeyboardManagerState::UnpinRemapTables() noexcept
+{
+    if (--remapTablesPinCount == 0)
+    {
+        pinnedRemapTables.store(nullptr);
     }
+}
 
-    appSpecificShortcutReMap[process_name][originalSC] = RemapShortcut(newSC);
-    appSpecificShortcutReMapSortedKeys[process_name].push_back(originalSC);
-    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(appSpecificShortcutReMapSortedKeys[process_name]);
-    return true;
+// Function to get the remap tables pinned by the hook, or the current ones if they are not pinned.
+RemapTables& KeyboardManagerState::GetActiveRemapTables() noexcept
+{
+    RemapTables* tables = pinnedRemapTables.load();
+    return tables ? *tables : *remapTables.load();
 }
 
 // Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
 std::optional<SingleKeyRemapTable::iterator> KeyboardManagerState::GetSingleKeyRemap(const DWORD& originalKey)
 {
+    auto& singleKeyReMap = GetActiveRemapTables().singleKeyReMap;
     auto it = singleKeyReMap.find(originalKey);
     if (it != singleKeyReMap.end())
     {
@@ -196,9 +231,9 @@ std::optional<SingleKeyRemapTable::iterator> KeyboardManagerState::GetSingleKeyR
 
 bool KeyboardManagerState::CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName)
 {
-    // Assumes appName exists in the app-specific remap table
-    ShortcutRemapTable& currentRemapTable = appName ? appSpecificShortcutReMap[*appName] : osLevelShortcutReMap;
-    for (auto& it : currentRemapTable)
+    SyncRemapStates();
+    const auto& states = appName && HasAppSpecificShortcutRemaps(*appName) ? appSpecificShortcutRemapStates[*appName] : osLevelShortcutRemapStates;
+    for (const auto& it : states)
     {
         if (it.second.isShortcutInvoked)
         {
@@ -209,25 +244,112 @@ bool KeyboardManagerState::CheckShortcutRemapInvoked(const std::optional<std::ws
     return false;
 }
 
-std::vector<Shortcut>& KeyboardManagerState::GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName)
+// Function to get the runtime state of a shortcut remap of the table returned by GetShortcutRemapTable.
+RemapShortcutState& KeyboardManagerState::GetShortcutRemapState(const std::optional<std::wstring>& appName, const Shortcut& originalSC)
+{
+    SyncRemapStates();
+    if (appName && HasAppSpecificShortcutRemaps(*appName))
+    {
+        return appSpecificShortcutRemapStates[*appName][originalSC];
+    }
+
+    return osLevelShortcutRemapStates[originalSC];
+}
+
+// Function to drop the runtime states of the remappings which are not in the active tables anymore, and to restart the key sequence matching if the trie was replaced.
+void KeyboardManagerState::SyncRemapStates()
+{
+    const RemapTables& tables = GetActiveRemapTables();
+    if (tables.version == remapStatesVersion)
+    {
+        return;
+    }
+
+    remapStatesVersion = tables.version;
+
+    // The states of the remappings which still exist are kept, so a shortcut which is held down while the tables are replaced is released correctly
+    const auto dropRemovedStates = [](std::map<Shortcut, RemapShortcutState>& states, const ShortcutRemapTable& table) {
+        for (auto it = states.begin(); it != states.end();)
+        {
+            it = table.find(it->first) == table.end() ? states.erase(it) : std::next(it);
+        }
+    };
+
+    dropRemovedStates(osLevelShortcutRemapStates, tables.osLevelShortcutReMap);
+    for (auto it = appSpecificShortcutRemapStates.begin(); it != appSpecificShortcutRemapStates.end();)
+    {
+        auto itTable = tables.appSpecificShortcutReMap.find(it->first);
+        if (itTable == tables.appSpecificShortcutReMap.end())
+        {
+            it = appSpecificShortcutRemapStates.erase(it);
+        }
+        else
+        {
+            dropRemovedStates(it->second, itTable->second);
+            it++;
+        }
+    }
+
+    // Node indices are only valid for the trie they were matched on. A pending key up suppression is kept as it doesn't depend on the trie.
+    keySequenceMatchState.currentNode = 0;
+}
+
+// Function to check if there are app-specific shortcut remappings for the given app
+bool KeyboardManagerState::HasAppSpecificShortcutRemaps(const std::wstring& appName)
 {
-    // Assumes appName exists in the app-specific remap table
-    return appName ? appSpecificShortcutReMapSortedKeys[*appName] : osLevelShortcutReMapSortedKeys;
+    auto& appSpecificShortcutReMap = GetActiveRemapTables().appSpecificShortcutReMap;
+    return appSpecificShortcutReMap.find(appName) != appSpecificShortcutReMap.end();
+}
+
+const std::vector<Shortcut>& KeyboardManagerState::GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName)
+{
+    RemapTables& tables = GetActiveRemapTables();
+    if (appName)
+    {
+        // The tables are shared with other threads so they must not be modified by a lookup
+        auto itSortedKeys = tables.appSpecificShortcutReMapSortedKeys.find(*appName);
+        if (itSortedKeys != tables.appSpecificShortcutReMapSortedKeys.end())
+        {
+            return itSortedKeys->second;
+        }
+    }
+
+    return tables.osLevelShortcutReMapSortedKeys;
 }
 
 // Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
-ShortcutRemapTable& KeyboardManagerState::GetShortcutRemapTable(const std::optional<std::wstring>& appName)
+const ShortcutRemapTable& KeyboardManagerState::GetShortcutRemapTable(const std::optional<std::wstring>& appName)
 {
+    RemapTables& tables = GetActiveRemapTables();
     if (appName)
     {
-        auto itTable = appSpecificShortcutReMap.find(*appName);
-        if (itTable != appSpecificShortcutReMap.end())
+        auto itTable = tables.appSpecificShortcutReMap.find(*appName);
+        if (itTable != tables.appSpecificShortcutReMap.end())
         {
             return itTable->second;
         }
     }
 
-    return osLevelShortcutReMap;
+    return tables.osLevelShortcutReMap;
+}
+
+// Function to get the trie used to match the key sequence remappings
+const KeySequenceTrie& KeyboardManagerState::GetKeySequenceTrie()
+{
+    return GetActiveRemapTables().keySequenceReMapTrie;
+}
+
+// Function to get the match state of the key sequence trie
+KeySequenceMatchState& KeyboardManagerState::GetKeySequenceMatchState()
+{
+    SyncRemapStates();
+    return keySequenceMatchState;
+}
+
+// Function to get the target of a key sequence remap given the remap index returned by the key sequence trie
+const KeyShortcutUnion& KeyboardManagerState::GetKeySequenceRemapTarget(size_t remapIndex)
+{
+    return GetActiveRemapTables().keySequenceReMap[remapIndex].second;
 }
 
 // Function to set the textblock of the detect shortcut UI so that it can be accessed by the hook
@@ -451,32 +573,18 @@ void KeyboardManagerState::RegisterKeyDelay(
     std::function<void(DWORD)> onLongPressDetected,
     std::function<void(DWORD)> onLongPressReleased)
 {
-    std::lock_guard l(keyDelays_mutex);
-
-    if (keyDelays.find(key) != keyDelays.end())
-    {
-        throw std::invalid_argument("This key was already registered.");
-    }
-
-    keyDelays[key] = std::make_unique<KeyDelay>(key, onShortPress, onLongPressDetected, onLongPressReleased);
+    keyDelayScheduler->RegisterKeyDelay(key, onShortPress, onLongPressDetected, onLongPressReleased);
 }
 
 void KeyboardManagerState::UnregisterKeyDelay(DWORD key)
 {
-    std::lock_guard l(keyDelays_mutex);
-
-    auto deleted = keyDelays.erase(key);
-    if (deleted == 0)
-    {
-        throw std::invalid_argument("The key was not previously registered.");
-    }
+    keyDelayScheduler->UnregisterKeyDelay(key);
 }
 
 // Function to clear all the registered key delays
 void KeyboardManagerState::ClearRegisteredKeyDelays()
 {
-    std::lock_guard l(keyDelays_mutex);
-    keyDelays.clear();
+    keyDelayScheduler->ClearKeyDelays();
 }
 
 bool KeyboardManagerState::HandleKeyDelayEvent(LowlevelKeyboardEvent* ev)
@@ -486,15 +594,19 @@ bool KeyboardManagerState::HandleKeyDelayEvent(LowlevelKeyboardEvent* ev)
         return false;
     }
 
-    std::lock_guard l(keyDelays_mutex);
-
-    if (keyDelays.find(ev->lParam->vkCode) == keyDelays.end())
+    // Lock-free check, the hook must not wait on the scheduler thread
+    if (!keyDelayScheduler->IsKeyDelayRegistered(ev->lParam->vkCode))
     {
         return false;
     }
 
-    keyDelays[ev->lParam->vkCode]->KeyEvent(ev);
-    return true;
+    return keyDelayScheduler->QueueKeyEvent(ev->lParam->vkCode, { ev->lParam->time, ev->wParam });
+}
+
+// Function to load the remappings from the JSON configuration. Malformed entries are skipped.
+void KeyboardManagerState::LoadConfigFromJson(const json::JsonObject& jsonData)
+{
+    UpdateRemapTables([&jsonData](RemapTables& tables) { tables.LoadFromJson(jsonData); });
 }
 
 // Save the updated configuration.
@@ -507,7 +619,10 @@ bool KeyboardManagerState::SaveConfigToFile()
     json::JsonArray inProcessRemapKeysArray;
     json::JsonArray appSpecificRemapShortcutsArray;
     json::JsonArray globalRemapShortcutsArray;
-    for (const auto& it : singleKeyReMap)
+    json::JsonObject remapSequences;
+    json::JsonArray globalRemapSequencesArray;
+    const RemapTables tables = GetRemapTablesCopy();
+    for (const auto& it : tables.singleKeyReMap)
     {
         json::JsonObject keys;
         keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(winrt::to_hstring((unsigned int)it.first)));
@@ -527,7 +642,7 @@ bool KeyboardManagerState::SaveConfigToFile()
         inProcessRemapKeysArray.Append(keys);
     }
 
-    for (const auto& it : osLevelShortcutReMap)
+    for (const auto& it : tables.osLevelShortcutReMap)
     {
         json::JsonObject keys;
         keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(it.first.ToHstringVK()));
@@ -547,7 +662,7 @@ bool KeyboardManagerState::SaveConfigToFile()
         globalRemapShortcutsArray.Append(keys);
     }
 
-    for (const auto& itApp : appSpecificShortcutReMap)
+    for (const auto& itApp : tables.appSpecificShortcutReMap)
     {
         // Iterate over apps
         for (const auto& itKeys : itApp.second)
@@ -573,11 +688,34 @@ bool KeyboardManagerState::SaveConfigToFile()
         }
     }
 
+    for (const auto& it : tables.keySequenceReMap)
+    {
+        json::JsonObject keys;
+        keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(it.first.ToHstringVK()));
+        keys.SetNamedValue(KeyboardManagerConstants::SequenceTimeoutSettingName, json::value(it.first.timeoutMillis));
+
+        // For key sequence to key remapping
+        if (it.second.index() == 0)
+        {
+            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(it.second))));
+        }
+
+        // For key sequence to shortcut remapping
+        else
+        {
+            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(it.second).ToHstringVK()));
+        }
+
+        globalRemapSequencesArray.Append(keys);
+    }
+
     remapShortcuts.SetNamedValue(KeyboardManagerConstants::GlobalRemapShortcutsSettingName, globalRemapShortcutsArray);
     remapShortcuts.SetNamedValue(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName, appSpecificRemapShortcutsArray);
     remapKeys.SetNamedValue(KeyboardManagerConstants::InProcessRemapKeysSettingName, inProcessRemapKeysArray);
     configJson.SetNamedValue(KeyboardManagerConstants::RemapKeysSettingName, remapKeys);
     configJson.SetNamedValue(KeyboardManagerConstants::RemapShortcutsSettingName, remapShortcuts);
+    remapSequences.SetNamedValue(KeyboardManagerConstants::GlobalRemapShortcutsSettingName, globalRemapSequencesArray);
+    configJson.SetNamedValue(KeyboardManagerConstants::RemapSequencesSettingName, remapSequences);
 
     // Set timeout of 1sec to wait for file to get free.
     DWORD timeout = 1000;
@@ -629,20 +767,3 @@ std::wstring KeyboardManagerState::GetActivatedApp()
 {
     return activatedAppSpecificShortcutTarget;
 }
-
-bool KeyboardManagerState::AreRemappingsEnabled()
-{
-    return remappingsEnabled;
-}
-
-void KeyboardManagerState::RemappingsDisabledWrapper(std::function<void()> method)
-{
-    // Disable keyboard remappings
-    remappingsEnabled = false;
-
-    // Run the method which requires the remappings to be disabled
-    method();
-
-    // Re-enable the keyboard remappings
-    remappingsEnabled = true;
-}
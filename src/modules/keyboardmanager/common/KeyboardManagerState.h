@@ -1,14 +1,17 @@
 #pragma once
 #include <mutex>
+#include <atomic>
 #include "KeyboardManagerConstants.h"
 #include "../common/keyboard_layout.h"
 #include "../common/LowlevelKeyboardEvent.h"
+#include "../common/json.h"
 #include <functional>
 #include <variant>
 #include "Shortcut.h"
 #include "RemapShortcut.h"
+#include "RemapTables.h"
 
-class KeyDelay;
+class KeyDelayScheduler;
 
 namespace KeyboardManagerHelper
 {
@@ -20,10 +23,6 @@ namespace winrt::Windows::UI::Xaml::Controls
     struct StackPanel;
 }
 
-using SingleKeyRemapTable = std::unordered_map<DWORD, KeyShortcutUnion>;
-using ShortcutRemapTable = std::map<Shortcut, RemapShortcut>;
-using AppSpecificShortcutRemapTable = std::map<std::wstring, ShortcutRemapTable>;
-
 // Enum type to store different states of the UI
 enum class KeyboardManagerUIState
 {
@@ -81,39 +80,54 @@ private:
     // Handle of named mutex used for configuration file.
     HANDLE configFile_mutex;
 
-    // Registered KeyDelay objects, used to notify delayed key events.
-    std::map<DWORD, std::unique_ptr<KeyDelay>> keyDelays;
-    std::mutex keyDelays_mutex;
+    // Services the registered KeyDelay objects, used to notify delayed key events.
+    std::unique_ptr<KeyDelayScheduler> keyDelayScheduler;
 
     // Stores the activated target application in app-specific shortcut
     std::wstring activatedAppSpecificShortcutTarget;
 
-    // Thread safe boolean value to check if remappings are currently enabled. This is used to disable remappings while the remap tables are being updated by the UI thread
-    std::atomic_bool remappingsEnabled;
+    // Current remap tables. They are never modified in place, updates build a new RemapTables object and publish it with a single atomic pointer swap so the hook always sees either the old or the new tables.
+    std::atomic<RemapTables*> remapTables;
+
+    // Remap tables used by the hook event which is currently being handled. Replaced tables are not freed while they are pinned.
+    std::atomic<RemapTables*> pinnedRemapTables;
+    int remapTablesPinCount;
+
+    // Replaced remap tables which might still be used by the hook. They are freed on the next update once they are not pinned anymore.
+    std::vector<std::unique_ptr<RemapTables>> retiredRemapTables;
+
+    // Serializes the updates of the remap tables. Tables can only be freed while holding this mutex, so it also makes it safe to read the current tables outside of the hook.
+    std::mutex remapTables_mutex;
+
+    // Version of the last published remap tables, only accessed while holding remapTables_mutex
+    uint64_t lastRemapTablesVersion;
+
+    // Runtime state of the shortcut remappings, keyed by the original shortcut. Only accessed by the hook thread, so it is carried over when the tables are replaced.
+    std::map<Shortcut, RemapShortcutState> osLevelShortcutRemapStates;
+    std::map<std::wstring, std::map<Shortcut, RemapShortcutState>> appSpecificShortcutRemapStates;
+
+    // Match state of the key sequence trie. Only accessed by the hook thread.
+    KeySequenceMatchState keySequenceMatchState;
+
+    // Version of the remap tables the runtime states were last synchronized with
+    uint64_t remapStatesVersion;
+
+    // Function to get the remap tables pinned by the hook, or the current ones if they are not pinned.
+    RemapTables& GetActiveRemapTables() noexcept;
+
+    // Function to drop the runtime states of the remappings which are not in the active tables anymore, and to restart the key sequence matching if the trie was replaced. Only called by the hook thread.
+    void SyncRemapStates();
 
     // Display a key by appending a border Control as a child of the panel.
     void AddKeyToLayout(const winrt::Windows::UI::Xaml::Controls::StackPanel& panel, const winrt::hstring& key);
 
 public:
-    // The map members and their mutexes are left as public since the maps are used extensively in dllmain.cpp.
-    // Maps which store the remappings for each of the features. The bool fields should be initialized to false. They are used to check the current state of the shortcut (i.e is that particular shortcut currently pressed down or not).
-    // Stores single key remappings
-    std::unordered_map<DWORD, KeyShortcutUnion> singleKeyReMap;
-
     /* This feature has not been enabled (code from proof of concept stage)
     * 
     // Stores keys which need to be changed from toggle behavior to modifier behavior. Eg. Caps Lock
     std::unordered_map<DWORD, bool> singleKeyToggleToMod;
     */
 
-    // Stores the os level shortcut remappings
-    ShortcutRemapTable osLevelShortcutReMap;
-    std::vector<Shortcut> osLevelShortcutReMapSortedKeys;
-
-    // Stores the app-specific shortcut remappings. Maps application name to the shortcut map
-    AppSpecificShortcutRemapTable appSpecificShortcutReMap;
-    std::map<std::wstring, std::vector<Shortcut>> appSpecificShortcutReMapSortedKeys;
-
     // Stores the keyboard layout
     LayoutMap keyboardMap;
 
@@ -135,6 +149,9 @@ public:
     // Function to set the UI state. When a window is activated, the handle to the window can be passed in the windowHandle argument.
     void SetUIState(KeyboardManagerUIState state, HWND windowHandle = nullptr);
 
+    // The Clear and Add functions below copy and publish all the remap tables for each call, they are meant for the tests.
+    // Code which changes several remappings must batch them in a single UpdateRemapTables call.
+
     // Function to clear the OS Level shortcut remapping table
     void ClearOSLevelShortcuts();
 
@@ -144,6 +161,9 @@ public:
     // Function to clear the App specific shortcut remapping table
     void ClearAppSpecificShortcuts();
 
+    // Function to clear the key sequence remapping table
+    void ClearKeySequenceRemaps();
+
     // Function to add a new single key to key remapping
     bool AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey);
 
@@ -153,15 +173,47 @@ public:
     // Function to add a new App specific level shortcut remapping
     bool AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC);
 
+    // Function to add a new key sequence remapping
+    bool AddKeySequenceRemap(const KeySequence& originalSequence, const KeyShortcutUnion& newRemapKey);
+
+    // Function to build a copy of the current remap tables, apply the update to it and publish the result with a single pointer swap.
+    // NOTE: this should never be called from the hook thread.
+    void UpdateRemapTables(const std::function<void(RemapTables&)>& update);
+
+    // Function to get a copy of the current remap tables.
+    RemapTables GetRemapTablesCopy();
+
+    // Functions to pin the current remap tables for the duration of a hook event, so that all the remap lookups of the event use the same tables. Pins can be nested.
+    // NOTE: these should only be called from the hook thread.
+    void PinRemapTables() noexcept;
+    void UnpinRemapTables() noexcept;
+
     // Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
     std::optional<SingleKeyRemapTable::iterator> GetSingleKeyRemap(const DWORD& originalKey);
 
     bool CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName);
 
-    std::vector<Shortcut>& GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName);
+    // Function to check if there are app-specific shortcut remappings for the given app
+    bool HasAppSpecificShortcutRemaps(const std::wstring& appName);
+
+    const std::vector<Shortcut>& GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName);
 
     // Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
-    ShortcutRemapTable& GetShortcutRemapTable(const std::optional<std::wstring>& appName);
+    const ShortcutRemapTable& GetShortcutRemapTable(const std::optional<std::wstring>& appName);
+
+    // Function to get the runtime state of a shortcut remap of the table returned by GetShortcutRemapTable.
+    // NOTE: this should only be called from the hook thread.
+    RemapShortcutState& GetShortcutRemapState(const std::optional<std::wstring>& appName, const Shortcut& originalSC);
+
+    // Function to get the trie used to match the key sequence remappings
+    const KeySequenceTrie& GetKeySequenceTrie();
+
+    // Function to get the match state of the key sequence trie.
+    // NOTE: this should only be called from the hook thread.
+    KeySequenceMatchState& GetKeySequenceMatchState();
+
+    // Function to get the target of a key sequence remap given the remap index returned by the key sequence trie
+    const KeyShortcutUnion& GetKeySequenceRemapTarget(size_t remapIndex);
 
     // Function to set the textblock of the detect shortcut UI so that it can be accessed by the hook
     void ConfigureDetectShortcutUI(const winrt::Windows::UI::Xaml::Controls::StackPanel& textBlock1, const winrt::Windows::UI::Xaml::Controls::StackPanel& textBlock2);
@@ -204,7 +256,7 @@ public:
     // Function to clear all the registered key delays
     void ClearRegisteredKeyDelays();
 
-    // Handle a key event, for a delayed key.
+    // Handle a key event, for a delayed key. The event is queued to the key delay scheduler thread.
     bool HandleKeyDelayEvent(LowlevelKeyboardEvent* ev);
 
     // Update the currently selected single key remap
@@ -216,6 +268,10 @@ public:
     // Reset the shortcut (backend) state after releasing a key.
     void ResetDetectedShortcutKey(DWORD key);
 
+    // Function to load the remappings from the JSON configuration. Malformed entries are skipped.
+    // The hook keeps using the previous remappings until all the new ones are loaded.
+    void LoadConfigFromJson(const json::JsonObject& jsonData);
+
     // Save the updated configuration.
     bool SaveConfigToFile();
 
@@ -230,8 +286,23 @@ public:
 
     // Gets the activated target application in app-specific shortcut
     std::wstring GetActivatedApp();
+};
 
-    bool AreRemappingsEnabled();
+// Pins the remap tables of a KeyboardManagerState for the scope of a hook event
+class RemapTablesPin
+{
+public:
+    RemapTablesPin(KeyboardManagerState& state) :
+        state(state)
+    {
+        state.PinRemapTables();
+    }
+
+    ~RemapTablesPin()
+    {
+        state.UnpinRemapTables();
+    }
 
-    void RemappingsDisabledWrapper(std::function<void()> method);
+private:
+    KeyboardManagerState& state;
 };
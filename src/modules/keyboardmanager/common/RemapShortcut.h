@@ -2,28 +2,33 @@
 #include "Shortcut.h"
 #include <variant>
 
-// This class stores all the variables associated with each shortcut remapping
+// This class stores the configuration of a shortcut remapping. It is part of the published remap tables, so it is never modified by the hook.
 class RemapShortcut
 {
 public:
     KeyShortcutUnion targetShortcut;
-    bool isShortcutInvoked;
-    ModifierKey winKeyInvoked;
-    // This bool value is only required for remapping shortcuts to Disable
-    bool isOriginalActionKeyPressed;
 
     RemapShortcut(const KeyShortcutUnion& sc) :
-        targetShortcut(sc), isShortcutInvoked(false), winKeyInvoked(ModifierKey::Disabled), isOriginalActionKeyPressed(false)
+        targetShortcut(sc)
     {
     }
 
     RemapShortcut() :
-        targetShortcut(Shortcut()), isShortcutInvoked(false), winKeyInvoked(ModifierKey::Disabled), isOriginalActionKeyPressed(false)
+        targetShortcut(Shortcut())
     {
     }
 
     inline bool operator==(const RemapShortcut& sc) const
     {
-        return targetShortcut == sc.targetShortcut && isShortcutInvoked == sc.isShortcutInvoked && winKeyInvoked == sc.winKeyInvoked;
+        return targetShortcut == sc.targetShortcut;
     }
 };
+
+// This struct stores the runtime state of a shortcut remapping, i.e. whether that particular shortcut is currently pressed down or not. It is owned by the hook thread and kept by KeyboardManagerState separately from the remap tables.
+struct RemapShortcutState
+{
+    bool isShortcutInvoked = false;
+    ModifierKey winKeyInvoked = ModifierKey::Disabled;
+    // This bool value is only required for remapping shortcuts to Disable
+    bool isOriginalActionKeyPressed = false;
+};
@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "RemapTables.h"
+#include "KeyboardManagerConstants.h"
+#include "Helpers.h"
+
+// Function to clear the OS Level shortcut remapping table
+void RemapTables::ClearOSLevelShortcuts()
+{
+    osLevelShortcutReMap.clear();
+    osLevelShortcutReMapSortedKeys.clear();
+}
+
+// Function to clear the Keys remapping table.
+void RemapTables::ClearSingleKeyRemaps()
+{
+    singleKeyReMap.clear();
+}
+
+// Function to clear the App specific shortcut remapping table
+void RemapTables::ClearAppSpecificShortcuts()
+{
+    appSpecificShortcutReMap.clear();
+    appSpecificShortcutReMapSortedKeys.clear();
+}
+
+// Function to clear the key sequence remapping table
+void RemapTables::ClearKeySequenceRemaps()
+{
+    keySequenceReMap.clear();
+    keySequenceReMapTrie.Clear();
+}
+
+// Function to add a new OS level shortcut remapping
+bool RemapTables::AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC)
+{
+    // Check if the shortcut is already remapped
+    auto it = osLevelShortcutReMap.find(originalSC);
+    if (it != osLevelShortcutReMap.end())
+    {
+        return false;
+    }
+
+    osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
+    osLevelShortcutReMapSortedKeys.push_back(originalSC);
+    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(osLevelShortcutReMapSortedKeys);
+
+    return true;
+}
+
+// Function to add a new single key to key/shortcut remapping
+bool RemapTables::AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey)
+{
+    // Check if the key is already remapped
+    auto it = singleKeyReMap.find(originalKey);
+    if (it != singleKeyReMap.end())
+    {
+        return false;
+    }
+
+    singleKeyReMap[originalKey] = newRemapKey;
+    return true;
+}
+
+// Function to add a new App specific shortcut remapping
+bool RemapTables::AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC)
+{
+    // Convert app name to lower case
+    std::wstring process_name;
+    process_name.resize(app.length());
+    std::transform(app.begin(), app.end(), process_name.begin(), towlower);
+
+    // Check if there are any app specific shortcuts for this app
+    auto appIt = appSpecificShortcutReMap.find(process_name);
+    if (appIt != appSpecificShortcutReMap.end())
+    {
+        // Check if the shortcut is already remapped
+        auto shortcutIt = appSpecificShortcutReMap[process_name].find(originalSC);
+        if (shortcutIt != appSpecificShortcutReMap[process_name].end())
+        {
+            return false;
+        }
+    }
+    else
+    {
+        appSpecificShortcutReMapSortedKeys[process_name] = std::vector<Shortcut>();
+    }
+
+    appSpecificShortcutReMap[process_name][originalSC] = RemapShortcut(newSC);
+    appSpecificShortcutReMapSortedKeys[process_name].push_back(originalSC);
+    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(appSpecificShortcutReMapSortedKeys[process_name]);
+    return true;
+}
+
+// Function to add a new key sequence remapping
+bool RemapTables::AddKeySequenceRemap(const KeySequence& originalSequence, const KeyShortcutUnion& newRemapKey)
+{
+    if (!keySequenceReMapTrie.Insert(originalSequence, keySequenceReMap.size()))
+    {
+        return false;
+    }
+
+    keySequenceReMap.push_back(std::make_pair(originalSequence, newRemapKey));
+    return true;
+}
+
+// Function to replace the remappings with the ones from the JSON configuration. Malformed entries are skipped.
+void RemapTables::LoadFromJson(const json::JsonObject& jsonData)
+{
+    // Load single key remaps
+    try
+    {
+        auto remapKeysData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapKeysSettingName);
+        ClearSingleKeyRemaps();
+
+        if (remapKeysData)
+        {
+            auto inProcessRemapKeys = remapKeysData.GetNamedArray(KeyboardManagerConstants::InProcessRemapKeysSettingName);
+            for (const auto& it : inProcessRemapKeys)
+            {
+                try
+                {
+                    auto originalKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                    auto newRemapKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+
+                    // If remapped to a shortcut
+                    if (std::wstring(newRemapKey).find(L";") != std::string::npos)
+                    {
+                        AddSingleKeyRemap(std::stoul(originalKey.c_str()), Shortcut(newRemapKey.c_str()));
+                    }
+
+                    // If remapped to a key
+                    else
+                    {
+                        AddSingleKeyRemap(std::stoul(originalKey.c_str()), std::stoul(newRemapKey.c_str()));
+                    }
+                }
+                catch (...)
+                {
+                    // Improper Key Data JSON. Try the next remap.
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        // Improper JSON format for single key remaps. Skip to next remap type
+    }
+
+    // Load shortcut remaps
+    try
+    {
+        auto remapShortcutsData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapShortcutsSettingName);
+        ClearOSLevelShortcuts();
+        ClearAppSpecificShortcuts();
+        if (remapShortcutsData)
+        {
+            // Load os level shortcut remaps
+            try
+            {
+                auto globalRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::GlobalRemapShortcutsSettingName);
+                for (const auto& it : globalRemapShortcuts)
+                {
+                    try
+                    {
+                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+
+                        // If remapped to a shortcut
+                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
+                        {
+                            AddOSLevelShortcut(Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
+                        }
+
+                        // If remapped to a key
+                        else
+                        {
+                            AddOSLevelShortcut(Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
+                        }
+                    }
+                    catch (...)
+                    {
+                        // Improper Key Data JSON. Try the next shortcut.
+                    }
+                }
+            }
+            catch (...)
+            {
+                // Improper JSON format for os level shortcut remaps. Skip to next remap type
+            }
+
+            // Load app specific shortcut remaps
+            try
+            {
+                auto appSpecificRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName);
+                for (const auto& it : appSpecificRemapShortcuts)
+                {
+                    try
+                    {
+                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+                        auto targetApp = it.GetObjectW().GetNamedString(KeyboardManagerConstants::TargetAppSettingName);
+
+                        // If remapped to a shortcut
+                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
+                        {
+                            AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
+                        }
+
+                        // If remapped to a key
+                        else
+                        {
+                            AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
+                        }
+                    }
+                    catch (...)
+                    {
+                        // Improper Key Data JSON. Try the next shortcut.
+                    }
+                }
+            }
+            catch (...)
+            {
+                // Improper JSON format for os level shortcut remaps. Skip to next remap type
+            }
+        }
+    }
+    catch (...)
+    {
+        // Improper JSON format for shortcut remaps. Skip to next remap type
+    }
+
+    // Load key sequence remaps
+    try
+    {
+        auto remapSequencesData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapSequencesSettingName);
+        ClearKeySequenceRemaps();
+        if (remapSequencesData)
+        {
+            auto globalRemapSequences = remapSequencesData.GetNamedArray(KeyboardManagerConstants::GlobalRemapShortcutsSettingName);
+            for (const auto& it : globalRemapSequences)
+            {
+                try
+                {
+                    auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                    auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+                    auto timeout = (DWORD)it.GetObjectW().GetNamedNumber(KeyboardManagerConstants::SequenceTimeoutSettingName, KeyboardManagerConstants::DefaultKeySequenceTimeoutMillis);
+
+                    // If remapped to a shortcut
+                    if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
+                    {
+                        AddKeySequenceRemap(KeySequence(originalKeys.c_str(), timeout), Shortcut(newRemapKeys.c_str()));
+                    }
+
+                    // If remapped to a key
+                    else
+                    {
+                        AddKeySequenceRemap(KeySequence(originalKeys.c_str(), timeout), std::stoul(newRemapKeys.c_str()));
+                    }
+                }
+                catch (...)
+                {
+                    // Improper Key Data JSON. Try the next key sequence.
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        // Improper JSON format for key sequence remaps.
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include "../common/json.h"
+#include "Shortcut.h"
+#include "RemapShortcut.h"
+#include "KeySequence.h"
+#include "KeySequenceTrie.h"
+
+using SingleKeyRemapTable = std::unordered_map<DWORD, KeyShortcutUnion>;
+using ShortcutRemapTable = std::map<Shortcut, RemapShortcut>;
+using AppSpecificShortcutRemapTable = std::map<std::wstring, ShortcutRemapTable>;
+using KeySequenceRemapTable = std::vector<std::pair<KeySequence, KeyShortcutUnion>>;
+
+// Stores all the remap tables of the keyboard manager.
+// A RemapTables object is built completely before it is published by KeyboardManagerState, after that it is never modified.
+// The runtime state of the remappings (i.e. which shortcuts are invoked and the key sequence match state) is kept by KeyboardManagerState, so only the configuration is copied when the tables are replaced.
+class RemapTables
+{
+public:
+    // Version of the tables, every published RemapTables object gets a new one. Used by the hook to detect that the tables were replaced.
+    uint64_t version = 0;
+
+    // Maps which store the remappings for each of the features.
+    // Stores single key remappings
+    SingleKeyRemapTable singleKeyReMap;
+
+    // Stores the os level shortcut remappings
+    ShortcutRemapTable osLevelShortcutReMap;
+    std::vector<Shortcut> osLevelShortcutReMapSortedKeys;
+
+    // Stores the app-specific shortcut remappings. Maps application name to the shortcut map
+    AppSpecificShortcutRemapTable appSpecificShortcutReMap;
+    std::map<std::wstring, std::vector<Shortcut>> appSpecificShortcutReMapSortedKeys;
+
+    // Stores the key sequence remappings, and the trie used by the hook to match them
+    KeySequenceRemapTable keySequenceReMap;
+    KeySequenceTrie keySequenceReMapTrie;
+
+    // Function to clear the OS Level shortcut remapping table
+    void ClearOSLevelShortcuts();
+
+    // Function to clear the Keys remapping table
+    void ClearSingleKeyRemaps();
+
+    // Function to clear the App specific shortcut remapping table
+    void ClearAppSpecificShortcuts();
+
+    // Function to clear the key sequence remapping table
+    void ClearKeySequenceRemaps();
+
+    // Function to add a new single key to key remapping
+    bool AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey);
+
+    // Function to add a new OS level shortcut remapping
+    bool AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC);
+
+    // Function to add a new App specific level shortcut remapping
+    bool AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC);
+
+    // Function to add a new key sequence remapping. Returns false if the sequence is invalid or conflicts with a key sequence which is already remapped
+    bool AddKeySequenceRemap(const KeySequence& originalSequence, const KeyShortcutUnion& newRemapKey);
+
+    // Function to replace the remappings with the ones from the JSON configuration. Malformed entries are skipped.
+    void LoadFromJson(const json::JsonObject& jsonData);
+};
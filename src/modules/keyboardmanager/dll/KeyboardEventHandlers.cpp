@@ -7,16 +7,17 @@
 #include <keyboardmanager/common/InputInterface.h>
 #include <keyboardmanager/common/Helpers.h>
 #include <keyboardmanager/common/trace.h>
+#include <common/LowlevelKeyboardEvent.h>
 
 namespace KeyboardEventHandlers
 {
     // Function to a handle a single key remap
-    __declspec(dllexport) intptr_t HandleSingleKeyRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept
+    __declspec(dllexport) intptr_t HandleSingleKeyRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept
     {
         // Check if the key event was generated by KeyboardManager to avoid remapping events generated by us.
-        if (!(data->lParam->dwExtraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG))
+        if (!(data.extraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG))
         {
-            const auto remapping = keyboardManagerState.GetSingleKeyRemap(data->lParam->vkCode);
+            const auto remapping = keyboardManagerState.GetSingleKeyRemap(data.key);
             if (remapping)
             {
                 auto it = remapping.value();
@@ -57,14 +58,14 @@ namespace KeyboardEventHandlers
                 }
 
                 // If Ctrl/Alt/Shift is being remapped to Caps Lock, then reset the modifier key state to fix issues in certain IME keyboards where the IME shortcut gets invoked since it detects that the modifier and Caps Lock is pressed even though it is suppressed by the hook - More information at the GitHub issue https://github.com/microsoft/PowerToys/issues/3397
-                if (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN)
+                if (data.IsKeyDown())
                 {
                     ResetIfModifierKeyForLowerLevelKeyHandlers(ii, it->first, target);
                 }
 
                 if (remapToKey)
                 {
-                    if (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP)
+                    if (data.IsKeyUp())
                     {
                         KeyboardManagerHelper::SetKeyEvent(keyEventList, 0, INPUT_KEYBOARD, (WORD)target, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
                     }
@@ -77,7 +78,7 @@ namespace KeyboardEventHandlers
                 {
                     int i = 0;
                     Shortcut targetShortcut = std::get<Shortcut>(it->second);
-                    if (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP)
+                    if (data.IsKeyUp())
                     {
                         KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)targetShortcut.GetActionKey(), KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
                         i++;
@@ -96,7 +97,7 @@ namespace KeyboardEventHandlers
                 UINT res = ii.SendVirtualInput(key_count, keyEventList, sizeof(INPUT));
                 delete[] keyEventList;
 
-                if (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN)
+                if (data.IsKeyDown())
                 {
                     // Log telemetry event when the key remap is invoked
                     Trace::KeyRemapInvoked(remapToKey);
@@ -126,22 +127,22 @@ namespace KeyboardEventHandlers
     /* This feature has not been enabled (code from proof of concept stage)
     * 
     // Function to a change a key's behavior from toggle to modifier
-    __declspec(dllexport) intptr_t HandleSingleKeyToggleToModEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept
+    __declspec(dllexport) intptr_t HandleSingleKeyToggleToModEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept
     {
         // Check if the key event was generated by KeyboardManager to avoid remapping events generated by us.
-        if (!(data->lParam->dwExtraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG))
+        if (!(data.extraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG))
         {
             // The mutex should be unlocked before SendInput is called to avoid re-entry into the same mutex. More details can be found at https://github.com/microsoft/PowerToys/pull/1789#issuecomment-607555837
             std::unique_lock<std::mutex> lock(keyboardManagerState.singleKeyToggleToMod_mutex);
-            auto it = keyboardManagerState.singleKeyToggleToMod.find(data->lParam->vkCode);
+            auto it = keyboardManagerState.singleKeyToggleToMod.find(data.key);
             if (it != keyboardManagerState.singleKeyToggleToMod.end())
             {
                 // To avoid long presses (which leads to continuous keydown messages) from toggling the key on and off
-                if (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN)
+                if (data.IsKeyDown())
                 {
                     if (it->second == false)
                     {
-                        keyboardManagerState.singleKeyToggleToMod[data->lParam->vkCode] = true;
+                        keyboardManagerState.singleKeyToggleToMod[data.key] = true;
                     }
                     else
                     {
@@ -152,18 +153,18 @@ namespace KeyboardEventHandlers
                 int key_count = 2;
                 LPINPUT keyEventList = new INPUT[size_t(key_count)]();
                 memset(keyEventList, 0, sizeof(keyEventList));
-                KeyboardManagerHelper::SetKeyEvent(keyEventList, 0, INPUT_KEYBOARD, (WORD)data->lParam->vkCode, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
-                KeyboardManagerHelper::SetKeyEvent(keyEventList, 1, INPUT_KEYBOARD, (WORD)data->lParam->vkCode, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
+                KeyboardManagerHelper::SetKeyEvent(keyEventList, 0, INPUT_KEYBOARD, (WORD)data.key, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
+                KeyboardManagerHelper::SetKeyEvent(keyEventList, 1, INPUT_KEYBOARD, (WORD)data.key, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG);
 
                 lock.unlock();
                 UINT res = ii.SendVirtualInput(key_count, keyEventList, sizeof(INPUT));
                 delete[] keyEventList;
 
                 // Reset the long press flag when the key has been lifted.
-                if (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP)
+                if (data.IsKeyUp())
                 {
                     lock.lock();
-                    keyboardManagerState.singleKeyToggleToMod[data->lParam->vkCode] = false;
+                    keyboardManagerState.singleKeyToggleToMod[data.key] = false;
                     lock.unlock();
                 }
 
@@ -176,21 +177,24 @@ namespace KeyboardEventHandlers
     */
 
     // Function to a handle a shortcut remap
-    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState, const std::optional<std::wstring>& activatedApp) noexcept
+    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState, const std::optional<std::wstring>& activatedApp) noexcept
     {
         // Check if any shortcut is currently in the invoked state
         bool isShortcutInvoked = keyboardManagerState.CheckShortcutRemapInvoked(activatedApp);
 
         // Get shortcut table for given activatedApp
-        ShortcutRemapTable& reMap = keyboardManagerState.GetShortcutRemapTable(activatedApp);
+        const ShortcutRemapTable& reMap = keyboardManagerState.GetShortcutRemapTable(activatedApp);
 
         // Iterate through the shortcut remaps and apply whichever has been pressed
         for (auto& itShortcut : keyboardManagerState.GetSortedShortcutRemapVector(activatedApp))
         {
             const auto it = reMap.find(itShortcut);
 
+            // The runtime state of the remap is kept outside of the remap tables, which are shared with other threads
+            RemapShortcutState& remapState = keyboardManagerState.GetShortcutRemapState(activatedApp, it->first);
+
             // If a shortcut is currently in the invoked state then skip till the shortcut that is currently invoked
-            if (isShortcutInvoked && !it->second.isShortcutInvoked)
+            if (isShortcutInvoked && !remapState.isShortcutInvoked)
             {
                 continue;
             }
@@ -201,9 +205,9 @@ namespace KeyboardEventHandlers
             const size_t dest_size = remapToShortcut ? std::get<Shortcut>(it->second.targetShortcut).Size() : 1;
 
             // If the shortcut has been pressed down
-            if (!it->second.isShortcutInvoked && it->first.CheckModifiersKeyboardState(ii))
+            if (!remapState.isShortcutInvoked && it->first.CheckModifiersKeyboardState(ii))
             {
-                if (data->lParam->vkCode == it->first.GetActionKey() && (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN))
+                if (data.key == it->first.GetActionKey() && data.IsKeyDown())
                 {
                     // Check if any other keys have been pressed apart from the shortcut. If true, then check for the next shortcut. This is to be done only for shortcut to shortcut remaps
                     if (!it->first.IsKeyboardStateClearExceptShortcut(ii) && (remapToShortcut || std::get<DWORD>(it->second.targetShortcut) == CommonSharedConstants::VK_DISABLED))
@@ -217,11 +221,11 @@ namespace KeyboardEventHandlers
                     // Remember which win key was pressed initially
                     if (ii.GetVirtualKeyState(VK_RWIN))
                     {
-                        it->second.winKeyInvoked = ModifierKey::Right;
+                        remapState.winKeyInvoked = ModifierKey::Right;
                     }
                     else if (ii.GetVirtualKeyState(VK_LWIN))
                     {
-                        it->second.winKeyInvoked = ModifierKey::Left;
+                        remapState.winKeyInvoked = ModifierKey::Left;
                     }
 
                     if (remapToShortcut)
@@ -237,7 +241,7 @@ namespace KeyboardEventHandlers
                             keyEventList = new INPUT[key_count]();
                             memset(keyEventList, 0, sizeof(keyEventList));
                             int i = 0;
-                            KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
+                            KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
                             KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)std::get<Shortcut>(it->second.targetShortcut).GetActionKey(), 0, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                             i++;
                         }
@@ -253,10 +257,10 @@ namespace KeyboardEventHandlers
                             KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                             // Release original shortcut state (release in reverse order of shortcut to be accurate)
-                            KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut));
+                            KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut));
 
                             // Set new shortcut key down state
-                            KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
+                            KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
                             KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)std::get<Shortcut>(it->second.targetShortcut).GetActionKey(), 0, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                             i++;
                         }
@@ -267,7 +271,7 @@ namespace KeyboardEventHandlers
                             Shortcut temp = std::get<Shortcut>(it->second.targetShortcut);
                             for (auto keys : temp.GetKeyCodes())
                             {
-                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, keys, data->lParam->vkCode);
+                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, keys, data.key);
                             }
                         }
                     }
@@ -280,7 +284,7 @@ namespace KeyboardEventHandlers
                         {
                             key_count--;
                             // Since the original shortcut's action key is pressed, set it to true
-                            it->second.isOriginalActionKeyPressed = true;
+                            remapState.isOriginalActionKeyPressed = true;
                         }
 
                         keyEventList = new INPUT[key_count]();
@@ -291,7 +295,7 @@ namespace KeyboardEventHandlers
                         KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                         // Release original shortcut state (release in reverse order of shortcut to be accurate)
-                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                         // Set target key down state
                         if (std::get<DWORD>(it->second.targetShortcut) != CommonSharedConstants::VK_DISABLED)
@@ -303,11 +307,11 @@ namespace KeyboardEventHandlers
                         // Modifier state reset might be required for this key depending on the shortcut's action and target modifier - ex: Win+Caps -> Ctrl
                         if (it->first.GetCtrlKey() == NULL && it->first.GetAltKey() == NULL && it->first.GetShiftKey() == NULL)
                         {
-                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, (WORD)KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)), data->lParam->vkCode);
+                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, (WORD)KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)), data.key);
                         }
                     }
 
-                    it->second.isShortcutInvoked = true;
+                    remapState.isShortcutInvoked = true;
                     // If app specific shortcut is invoked, store the target application
                     if (activatedApp)
                     {
@@ -331,13 +335,13 @@ namespace KeyboardEventHandlers
             // 4. The user presses a modifier key in the original shortcut - suppress that key event since the original shortcut is already held down physically (This case can occur only if a user has a duplicated modifier key (possibly by remapping) or if user presses both L/R versions of a modifier remapped with "Both")
             // 5. The user presses any key apart from the action key or a modifier key in the original shortcut - revert the keyboard state to just the original modifiers being held down along with the current key press
             // 6. The user releases any key apart from original modifier or original action key - This can't happen since the key down would have to happen first, which is handled above
-            else if (it->second.isShortcutInvoked)
+            else if (remapState.isShortcutInvoked)
             {
                 // Get the common keys between the two shortcuts
                 int commonKeys = remapToShortcut ? it->first.GetCommonModifiersCount(std::get<Shortcut>(it->second.targetShortcut)) : 0;
 
                 // Case 1: If any of the modifier keys of the original shortcut are released before the action key
-                if ((it->first.CheckWinKey(data->lParam->vkCode) || it->first.CheckCtrlKey(data->lParam->vkCode) || it->first.CheckAltKey(data->lParam->vkCode) || it->first.CheckShiftKey(data->lParam->vkCode)) && (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP))
+                if ((it->first.CheckWinKey(data.key) || it->first.CheckCtrlKey(data.key) || it->first.CheckAltKey(data.key) || it->first.CheckShiftKey(data.key)) && data.IsKeyUp())
                 {
                     // Release new shortcut, and set original shortcut keys except the one released
                     size_t key_count;
@@ -345,7 +349,7 @@ namespace KeyboardEventHandlers
                     if (remapToShortcut)
                     {
                         // if the released key is present in both shortcuts' modifiers (i.e part of the common modifiers)
-                        if (std::get<Shortcut>(it->second.targetShortcut).CheckWinKey(data->lParam->vkCode) || std::get<Shortcut>(it->second.targetShortcut).CheckCtrlKey(data->lParam->vkCode) || std::get<Shortcut>(it->second.targetShortcut).CheckAltKey(data->lParam->vkCode) || std::get<Shortcut>(it->second.targetShortcut).CheckShiftKey(data->lParam->vkCode))
+                        if (std::get<Shortcut>(it->second.targetShortcut).CheckWinKey(data.key) || std::get<Shortcut>(it->second.targetShortcut).CheckCtrlKey(data.key) || std::get<Shortcut>(it->second.targetShortcut).CheckAltKey(data.key) || std::get<Shortcut>(it->second.targetShortcut).CheckShiftKey(data.key))
                         {
                             // release all new shortcut keys and the common released modifier except the other common modifiers, and add all original shortcut modifiers except the common ones, and dummy key
                             key_count = (dest_size - commonKeys) + (src_size - 1 - commonKeys) + KeyboardManagerConstants::DUMMY_KEY_EVENT_SIZE;
@@ -374,10 +378,10 @@ namespace KeyboardEventHandlers
                             KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)std::get<Shortcut>(it->second.targetShortcut).GetActionKey(), KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                             i++;
                         }
-                        KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), it->second.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first, data->lParam->vkCode);
+                        KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), remapState.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first, data.key);
 
                         // Set original shortcut key down state except the action key and the released modifier since the original action key may or may not be held down. If it is held down it will generate it's own key message
-                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut), data->lParam->vkCode);
+                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut), data.key);
 
                         // Send a dummy key event to prevent modifier press+release from being triggered. Example: Win+Ctrl+A->Ctrl+V, press Win+Ctrl+A and release A then Ctrl, since Win will be pressed here we need to send a dummy event after it
                         KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
@@ -415,16 +419,16 @@ namespace KeyboardEventHandlers
                         }
 
                         // Set original shortcut key down state except the action key and the released modifier since the original action key may or may not be held down. If it is held down it will generate it's own key message
-                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, Shortcut(), data->lParam->vkCode);
+                        KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, Shortcut(), data.key);
 
                         // Send a dummy key event to prevent modifier press+release from being triggered. Example: Win+Ctrl+A->V, press Win+Ctrl+A and release A then Ctrl, since Win will be pressed here we need to send a dummy event after it
                         KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                     }
 
                     // Reset the remap state
-                    it->second.isShortcutInvoked = false;
-                    it->second.winKeyInvoked = ModifierKey::Disabled;
-                    it->second.isOriginalActionKeyPressed = false;
+                    remapState.isShortcutInvoked = false;
+                    remapState.winKeyInvoked = ModifierKey::Disabled;
+                    remapState.isOriginalActionKeyPressed = false;
                     // If app specific shortcut has finished invoking, reset the target application
                     if (activatedApp)
                     {
@@ -444,13 +448,13 @@ namespace KeyboardEventHandlers
                 if (!remapToShortcut || std::get<Shortcut>(it->second.targetShortcut).CheckModifiersKeyboardState(ii))
                 {
                     // Case 2: If the original shortcut is still held down the keyboard will get a key down message of the action key in the original shortcut and the new shortcut's modifiers will be held down (keys held down send repeated keydown messages)
-                    if (data->lParam->vkCode == it->first.GetActionKey() && (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN))
+                    if (data.key == it->first.GetActionKey() && data.IsKeyDown())
                     {
                         // In case of mapping to disable do not send anything
                         if (!remapToShortcut && std::get<DWORD>(it->second.targetShortcut) == CommonSharedConstants::VK_DISABLED)
                         {
                             // Since the original shortcut's action key is pressed, set it to true
-                            it->second.isOriginalActionKeyPressed = true;
+                            remapState.isOriginalActionKeyPressed = true;
                             return 1;
                         }
 
@@ -472,7 +476,7 @@ namespace KeyboardEventHandlers
                     }
 
                     // Case 3: If the action key is released from the original shortcut, keep modifiers of the new shortcut until some other key event which doesn't apply to the original shortcut
-                    if (data->lParam->vkCode == it->first.GetActionKey() && (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP))
+                    if (data.key == it->first.GetActionKey() && data.IsKeyUp())
                     {
                         size_t key_count = 1;
                         LPINPUT keyEventList;
@@ -486,7 +490,7 @@ namespace KeyboardEventHandlers
                         else if (std::get<DWORD>(it->second.targetShortcut) == CommonSharedConstants::VK_DISABLED)
                         {
                             // Since the original shortcut's action key is released, set it to false
-                            it->second.isOriginalActionKeyPressed = false;
+                            remapState.isOriginalActionKeyPressed = false;
                             return 1;
                         }
                         else
@@ -515,15 +519,15 @@ namespace KeyboardEventHandlers
                                 i++;
 
                                 // Set original shortcut key down state except the action key
-                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                                 // Send a dummy key event to prevent modifier press+release from being triggered. Example: Win+A->V, press Shift+Win+A and release A, since Win will be pressed here we need to send a dummy event after it
                                 KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                                 // Reset the remap state
-                                it->second.isShortcutInvoked = false;
-                                it->second.winKeyInvoked = ModifierKey::Disabled;
-                                it->second.isOriginalActionKeyPressed = false;
+                                remapState.isShortcutInvoked = false;
+                                remapState.winKeyInvoked = ModifierKey::Disabled;
+                                remapState.isOriginalActionKeyPressed = false;
                                 // If app specific shortcut has finished invoking, reset the target application
                                 if (activatedApp != KeyboardManagerConstants::NoActivatedApp)
                                 {
@@ -538,21 +542,21 @@ namespace KeyboardEventHandlers
                     }
 
                     // Case 4: If a modifier key in the original shortcut is pressed then suppress that key event since the original shortcut is already held down physically - This case can occur only if a user has a duplicated modifier key (possibly by remapping) or if user presses both L/R versions of a modifier remapped with "Both"
-                    if ((it->first.CheckWinKey(data->lParam->vkCode) || it->first.CheckCtrlKey(data->lParam->vkCode) || it->first.CheckAltKey(data->lParam->vkCode) || it->first.CheckShiftKey(data->lParam->vkCode)) && (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN))
+                    if ((it->first.CheckWinKey(data.key) || it->first.CheckCtrlKey(data.key) || it->first.CheckAltKey(data.key) || it->first.CheckShiftKey(data.key)) && data.IsKeyDown())
                     {
                         if (remapToShortcut)
                         {
                             // Modifier state reset might be required for this key depending on the target shortcut action key - ex: Ctrl+A -> Win+Caps
                             if (std::get<Shortcut>(it->second.targetShortcut).GetCtrlKey() == NULL && std::get<Shortcut>(it->second.targetShortcut).GetAltKey() == NULL && std::get<Shortcut>(it->second.targetShortcut).GetShiftKey() == NULL)
                             {
-                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data->lParam->vkCode, std::get<Shortcut>(it->second.targetShortcut).GetActionKey());
+                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data.key, std::get<Shortcut>(it->second.targetShortcut).GetActionKey());
                             }
                         }
                         // If it is not remapped to Disable
                         else if (std::get<DWORD>(it->second.targetShortcut) != CommonSharedConstants::VK_DISABLED)
                         {
                             // Modifier state reset might be required for this key depending on the target key - ex: Ctrl+A -> Caps
-                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data->lParam->vkCode, KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)));
+                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data.key, KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)));
                         }
 
                         // Suppress the modifier as it is already physically pressed
@@ -560,14 +564,14 @@ namespace KeyboardEventHandlers
                     }
 
                     // Case 5: If any key apart from the action key or a modifier key in the original shortcut is pressed then revert the keyboard state to just the original modifiers being held down along with the current key press
-                    if (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN)
+                    if (data.IsKeyDown())
                     {
                         if (remapToShortcut)
                         {
                             // Modifier state reset might be required for this key depending on the target shortcut action key - ex: Ctrl+A -> Win+Caps, Shift is pressed. System should not see Shift and Caps pressed together
                             if (std::get<Shortcut>(it->second.targetShortcut).GetCtrlKey() == NULL && std::get<Shortcut>(it->second.targetShortcut).GetAltKey() == NULL && std::get<Shortcut>(it->second.targetShortcut).GetShiftKey() == NULL)
                             {
-                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data->lParam->vkCode, std::get<Shortcut>(it->second.targetShortcut).GetActionKey());
+                                ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data.key, std::get<Shortcut>(it->second.targetShortcut).GetActionKey());
                             }
 
                             size_t key_count;
@@ -595,7 +599,7 @@ namespace KeyboardEventHandlers
                                     KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)std::get<Shortcut>(it->second.targetShortcut).GetActionKey(), KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                                     i++;
                                 }
-                                KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), it->second.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
+                                KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), remapState.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
 
                                 // key down for original shortcut action key with shortcut flag so that we don't invoke the same shortcut remap again
                                 if (isActionKeyPressed)
@@ -605,7 +609,7 @@ namespace KeyboardEventHandlers
                                 }
 
                                 // Send current key pressed without shortcut flag so that it can be reprocessed in case the physical keys pressed are a different remapped shortcut
-                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data->lParam->vkCode, 0, 0);
+                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data.key, 0, 0);
                                 i++;
 
                                 // Do not send a dummy key as we want the current key press to behave as normal i.e. it can do press+release functionality if required. Required to allow a shortcut to Win key remap invoked directly after shortcut to shortcut is released to open start menu
@@ -633,10 +637,10 @@ namespace KeyboardEventHandlers
                                     KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)std::get<Shortcut>(it->second.targetShortcut).GetActionKey(), KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
                                     i++;
                                 }
-                                KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), it->second.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
+                                KeyboardManagerHelper::SetModifierKeyEvents(std::get<Shortcut>(it->second.targetShortcut), remapState.winKeyInvoked, keyEventList, i, false, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, it->first);
 
                                 // Set old shortcut key down state
-                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut));
+                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG, std::get<Shortcut>(it->second.targetShortcut));
 
                                 // key down for original shortcut action key with shortcut flag so that we don't invoke the same shortcut remap again
                                 if (isActionKeyPressed)
@@ -646,16 +650,16 @@ namespace KeyboardEventHandlers
                                 }
 
                                 // Send current key pressed without shortcut flag so that it can be reprocessed in case the physical keys pressed are a different remapped shortcut
-                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data->lParam->vkCode, 0, 0);
+                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data.key, 0, 0);
                                 i++;
 
                                 // Do not send a dummy key as we want the current key press to behave as normal i.e. it can do press+release functionality if required. Required to allow a shortcut to Win key remap invoked directly after shortcut to shortcut is released to open start menu
                             }
 
                             // Reset the remap state
-                            it->second.isShortcutInvoked = false;
-                            it->second.winKeyInvoked = ModifierKey::Disabled;
-                            it->second.isOriginalActionKeyPressed = false;
+                            remapState.isShortcutInvoked = false;
+                            remapState.winKeyInvoked = ModifierKey::Disabled;
+                            remapState.isOriginalActionKeyPressed = false;
                             // If app specific shortcut has finished invoking, reset the target application
                             if (activatedApp)
                             {
@@ -670,7 +674,7 @@ namespace KeyboardEventHandlers
                         else
                         {
                             // Modifier state reset might be required for this key depending on the target key - ex: Ctrl+A -> Caps, Shift is pressed. System should not see Shift and Caps pressed together
-                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data->lParam->vkCode, KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)));
+                            ResetIfModifierKeyForLowerLevelKeyHandlers(ii, data.key, KeyboardManagerHelper::FilterArtificialKeys(std::get<DWORD>(it->second.targetShortcut)));
 
                             // If the shortcut is remapped to Disable then we have to revert the keyboard state to the physical keys
                             bool isRemapToDisable = (std::get<DWORD>(it->second.targetShortcut) == CommonSharedConstants::VK_DISABLED);
@@ -686,7 +690,7 @@ namespace KeyboardEventHandlers
                             }
                             else
                             {
-                                isOriginalActionKeyPressed = it->second.isOriginalActionKeyPressed;
+                                isOriginalActionKeyPressed = remapState.isOriginalActionKeyPressed;
                             }
 
                             if (isRemapToDisable || !isOriginalActionKeyPressed)
@@ -699,7 +703,7 @@ namespace KeyboardEventHandlers
 
                                 // Set original shortcut key down state
                                 int i = 0;
-                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, it->second.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+                                KeyboardManagerHelper::SetModifierKeyEvents(it->first, remapState.winKeyInvoked, keyEventList, i, true, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
 
                                 // Send the original action key only if it is physically pressed. For remappings to keys other than disabled we already check earlier that it is not pressed in this scenario. For remap to disable
                                 if (isRemapToDisable && isOriginalActionKeyPressed)
@@ -714,15 +718,15 @@ namespace KeyboardEventHandlers
                                 }
 
                                 // Send current key pressed without shortcut flag so that it can be reprocessed in case the physical keys pressed are a different remapped shortcut
-                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data->lParam->vkCode, 0, 0);
+                                KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)data.key, 0, 0);
                                 i++;
 
                                 // Do not send a dummy key as we want the current key press to behave as normal i.e. it can do press+release functionality if required. Required to allow a shortcut to Win key remap invoked directly after another shortcut to key remap is released to open start menu
 
                                 // Reset the remap state
-                                it->second.isShortcutInvoked = false;
-                                it->second.winKeyInvoked = ModifierKey::Disabled;
-                                it->second.isOriginalActionKeyPressed = false;
+                                remapState.isShortcutInvoked = false;
+                                remapState.winKeyInvoked = ModifierKey::Disabled;
+                                remapState.isOriginalActionKeyPressed = false;
                                 // If app specific shortcut has finished invoking, reset the target application
                                 if (activatedApp != KeyboardManagerConstants::NoActivatedApp)
                                 {
@@ -748,10 +752,10 @@ namespace KeyboardEventHandlers
     }
 
     // Function to a handle an os-level shortcut remap
-    __declspec(dllexport) intptr_t HandleOSLevelShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept
+    __declspec(dllexport) intptr_t HandleOSLevelShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept
     {
         // Check if the key event was generated by KeyboardManager to avoid remapping events generated by us.
-        if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
+        if (data.extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
         {
             bool result = HandleShortcutRemapEvent(ii, data, keyboardManagerState);
             return result;
@@ -761,10 +765,10 @@ namespace KeyboardEventHandlers
     }
 
     // Function to a handle an app-specific shortcut remap
-    __declspec(dllexport) intptr_t HandleAppSpecificShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept
+    __declspec(dllexport) intptr_t HandleAppSpecificShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept
     {
         // Check if the key event was generated by KeyboardManager to avoid remapping events generated by us.
-        if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
+        if (data.extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
         {
             std::wstring process_name;
 
@@ -785,29 +789,29 @@ namespace KeyboardEventHandlers
 
             std::wstring query_string;
 
-            AppSpecificShortcutRemapTable::iterator it;
+            bool hasRemaps;
             // Check if an app-specific shortcut is already activated
             if (keyboardManagerState.GetActivatedApp() == KeyboardManagerConstants::NoActivatedApp)
             {
                 query_string = process_name;
-                it = keyboardManagerState.appSpecificShortcutReMap.find(query_string);
+                hasRemaps = keyboardManagerState.HasAppSpecificShortcutRemaps(query_string);
 
                 // If no entry is found, search for the process name without it's file extension
-                if (it == keyboardManagerState.appSpecificShortcutReMap.end())
+                if (!hasRemaps)
                 {
                     // Find index of the file extension
                     size_t extensionIndex = process_name.find_last_of(L".");
                     query_string = process_name.substr(0, extensionIndex);
-                    it = keyboardManagerState.appSpecificShortcutReMap.find(query_string);
+                    hasRemaps = keyboardManagerState.HasAppSpecificShortcutRemaps(query_string);
                 }
             }
             else
             {
                 query_string = keyboardManagerState.GetActivatedApp();
-                it = keyboardManagerState.appSpecificShortcutReMap.find(query_string);
+                hasRemaps = keyboardManagerState.HasAppSpecificShortcutRemaps(query_string);
             }
 
-            if (it != keyboardManagerState.appSpecificShortcutReMap.end())
+            if (hasRemaps)
             {
                 bool result = HandleShortcutRemapEvent(ii, data, keyboardManagerState, query_string);
                 return result;
@@ -817,6 +821,111 @@ namespace KeyboardEventHandlers
         return 0;
     }
 
+    // Function to a handle a key sequence remap
+    __declspec(dllexport) intptr_t HandleKeySequenceRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept
+    {
+        // Only physical key events are matched against the key sequences, to avoid matching events generated by us.
+        if (data.extraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG)
+        {
+            return 0;
+        }
+
+        const KeySequenceTrie& trie = keyboardManagerState.GetKeySequenceTrie();
+        if (trie.IsEmpty())
+        {
+            return 0;
+        }
+
+        KeySequenceMatchState& matchState = keyboardManagerState.GetKeySequenceMatchState();
+
+        // Suppress the key up of the last step of a matched sequence
+        if (data.IsKeyUp())
+        {
+            return matchState.ConsumeSuppressedKeyUp(data.key) ? 1 : 0;
+        }
+
+        // Modifiers are part of the steps, they do not advance the sequence on their own
+        if (KeyboardManagerHelper::IsModifierKey(data.key))
+        {
+            return 0;
+        }
+
+        const auto remapIndex = trie.KeyDown(matchState, data.key, KeySequenceTrie::GetModifierFlags(ii), data.time);
+        if (!remapIndex)
+        {
+            return 0;
+        }
+
+        matchState.SuppressKeyUp(data.key);
+        const KeyShortcutUnion& target = keyboardManagerState.GetKeySequenceRemapTarget(*remapIndex);
+
+        // If mapped to VK_DISABLED then the sequence is only suppressed
+        if (target.index() == 0 && std::get<DWORD>(target) == CommonSharedConstants::VK_DISABLED)
+        {
+            return 1;
+        }
+
+        std::vector<DWORD> targetKeys;
+        if (target.index() == 0)
+        {
+            targetKeys.push_back(std::get<DWORD>(target));
+        }
+        else
+        {
+            targetKeys = Shortcut(std::get<Shortcut>(target)).GetKeyCodes();
+        }
+
+        // Modifiers of the last step which are still held down are released while the target is sent and pressed again afterwards
+        std::vector<DWORD> heldModifiers;
+        for (DWORD modifier : { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT })
+        {
+            if (ii.GetVirtualKeyState(modifier))
+            {
+                heldModifiers.push_back(modifier);
+            }
+        }
+
+        // Dummy key, key up for the held modifiers, key down and key up for the target keys, and key down for the held modifiers
+        size_t key_count = (heldModifiers.empty() ? 0 : KeyboardManagerConstants::DUMMY_KEY_EVENT_SIZE) + 2 * heldModifiers.size() + 2 * targetKeys.size();
+        LPINPUT keyEventList = new INPUT[key_count]();
+        memset(keyEventList, 0, sizeof(keyEventList));
+
+        int i = 0;
+        if (!heldModifiers.empty())
+        {
+            // Send a dummy key event to prevent modifier press+release from being triggered. Example: releasing Win would open the start menu
+            KeyboardManagerHelper::SetDummyKeyEvent(keyEventList, i, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+        }
+
+        for (auto it = heldModifiers.rbegin(); it != heldModifiers.rend(); it++)
+        {
+            KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)*it, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+            i++;
+        }
+
+        for (DWORD key : targetKeys)
+        {
+            KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)key, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+            i++;
+        }
+
+        for (auto it = targetKeys.rbegin(); it != targetKeys.rend(); it++)
+        {
+            KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)*it, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+            i++;
+        }
+
+        for (DWORD modifier : heldModifiers)
+        {
+            KeyboardManagerHelper::SetKeyEvent(keyEventList, i, INPUT_KEYBOARD, (WORD)modifier, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+            i++;
+        }
+
+        UINT res = ii.SendVirtualInput((UINT)key_count, keyEventList, sizeof(INPUT));
+        delete[] keyEventList;
+        return 1;
+    }
+
     // Function to ensure Num Lock state does not change when it is suppressed by the low level hook
     void SetNumLockToPreviousState(InputInterface& ii)
     {
@@ -853,4 +962,88 @@ namespace KeyboardEventHandlers
             }
         }
     }
+
+    // Function to run a low level keyboard event through the remap UI and the remap handlers, in the order of the Keyboard Manager hook. Returns 1 if the event is suppressed
+    __declspec(dllexport) intptr_t HandleKeyboardHookEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept
+    {
+        // If key has suppress flag, then suppress it
+        if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+        {
+            return 1;
+        }
+
+        // If the Detect Key Window is currently activated, then suppress the keyboard event
+        KeyboardManagerHelper::KeyboardHookDecision singleKeyRemapUIDetected = keyboardManagerState.DetectSingleRemapKeyUIBackend(data);
+        if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
+        {
+            return 1;
+        }
+        else if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
+        {
+            return 0;
+        }
+
+        // If the Detect Shortcut Window from Remap Keys is currently activated, then suppress the keyboard event
+        KeyboardManagerHelper::KeyboardHookDecision remapKeyShortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, true);
+        if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
+        {
+            return 1;
+        }
+        else if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
+        {
+            return 0;
+        }
+
+        // The remap handlers work on the platform independent key event
+        const KeyboardManagerInput::KeyEvent keyEvent = KeyboardManagerHelper::ToKeyEvent(*data);
+
+        // Use the same remap tables for the whole event even if they are replaced by a config reload in the meantime
+        RemapTablesPin remapTablesPin(keyboardManagerState);
+
+        // Remap a key
+        intptr_t SingleKeyRemapResult = KeyboardEventHandlers::HandleSingleKeyRemapEvent(ii, keyEvent, keyboardManagerState);
+
+        // Single key remaps have priority. If a key is remapped, only the remapped version should be visible to the shortcuts and hence the event should be suppressed here.
+        if (SingleKeyRemapResult == 1)
+        {
+            return 1;
+        }
+
+        // If the Detect Shortcut Window is currently activated, then suppress the keyboard event
+        KeyboardManagerHelper::KeyboardHookDecision shortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, false);
+        if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
+        {
+            return 1;
+        }
+        else if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
+        {
+            return 0;
+        }
+
+        /* This feature has not been enabled (code from proof of concept stage)
+        * 
+        //// Remap a key to behave like a modifier instead of a toggle
+        //intptr_t SingleKeyToggleToModResult = KeyboardEventHandlers::HandleSingleKeyToggleToModEvent(ii, keyEvent, keyboardManagerState);
+        */
+
+        // Handle a key sequence remapping. Sequences are handled before shortcuts so the last step of a sequence is not remapped as a shortcut as well.
+        intptr_t KeySequenceRemapResult = KeyboardEventHandlers::HandleKeySequenceRemapEvent(ii, keyEvent, keyboardManagerState);
+
+        if (KeySequenceRemapResult == 1)
+        {
+            return 1;
+        }
+
+        // Handle an app-specific shortcut remapping
+        intptr_t AppSpecificShortcutRemapResult = KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(ii, keyEvent, keyboardManagerState);
+
+        // If an app-specific shortcut is remapped then the os-level shortcut remapping should be suppressed.
+        if (AppSpecificShortcutRemapResult == 1)
+        {
+            return 1;
+        }
+
+        // Handle an os-level shortcut remapping
+        return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(ii, keyEvent, keyboardManagerState);
+    }
 }
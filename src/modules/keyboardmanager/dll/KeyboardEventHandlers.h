@@ -3,32 +3,39 @@
 #include <mutex>
 #include "keyboardmanager/common/KeyboardManagerConstants.h"
 
-#include <common/LowlevelKeyboardEvent.h>
+#include "keyboardmanager/common/KeyboardEvent.h"
 
 class InputInterface;
 class KeyboardManagerState;
 class Shortcut;
 class RemapShortcut;
+struct LowlevelKeyboardEvent;
 
 namespace KeyboardEventHandlers
 {
     // Function to a handle a single key remap
-    __declspec(dllexport) intptr_t HandleSingleKeyRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
+    __declspec(dllexport) intptr_t HandleSingleKeyRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept;
 
     /* This feature has not been enabled (code from proof of concept stage)
     * 
     // Function to a change a key's behavior from toggle to modifier
-    __declspec(dllexport) intptr_t HandleSingleKeyToggleToModEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
+    __declspec(dllexport) intptr_t HandleSingleKeyToggleToModEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept;
     */
 
     // Function to a handle a shortcut remap
-    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState, const std::optional<std::wstring>& activatedApp = std::nullopt) noexcept;
+    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState, const std::optional<std::wstring>& activatedApp = std::nullopt) noexcept;
 
     // Function to a handle an os-level shortcut remap
-    __declspec(dllexport) intptr_t HandleOSLevelShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
+    __declspec(dllexport) intptr_t HandleOSLevelShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept;
 
     // Function to a handle an app-specific shortcut remap
-    __declspec(dllexport) intptr_t HandleAppSpecificShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
+    __declspec(dllexport) intptr_t HandleAppSpecificShortcutRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept;
+
+    // Function to a handle a key sequence remap
+    __declspec(dllexport) intptr_t HandleKeySequenceRemapEvent(InputInterface& ii, const KeyboardManagerInput::KeyEvent& data, KeyboardManagerState& keyboardManagerState) noexcept;
+
+    // Function to run a low level keyboard event through the remap UI and the remap handlers, in the order of the Keyboard Manager hook. Returns 1 if the event is suppressed
+    __declspec(dllexport) intptr_t HandleKeyboardHookEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
 
     // Function to ensure Num Lock state does not change when it is suppressed by the low level hook
     void SetNumLockToPreviousState(InputInterface& ii);
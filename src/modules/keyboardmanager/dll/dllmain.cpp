@@ -2,6 +2,7 @@
 #include <interface/powertoy_module_interface.h>
 #include <common/settings_objects.h>
 #include <common/shared_constants.h>
+#include <common/process_path_cache.h>
 #include "Generated Files/resource.h"
 #include <keyboardmanager/ui/EditKeyboardWindow.h>
 #include <keyboardmanager/ui/EditShortcutsWindow.h>
@@ -10,11 +11,11 @@
 #include <keyboardmanager/common/RemapShortcut.h>
 #include <keyboardmanager/common/KeyboardManagerConstants.h>
 #include <common/settings_helpers.h>
-#include <common/debug_control.h>
 #include <keyboardmanager/common/trace.h>
 #include <keyboardmanager/common/Helpers.h>
 #include "KeyboardEventHandlers.h"
 #include "Input.h"
+#include <filesystem>
 
 extern "C" IMAGE_DOS_HEADER __ImageBase;
 
@@ -48,30 +49,23 @@ private:
     //contains the non localized key of the powertoy
     std::wstring app_key = KeyboardManagerConstants::ModuleName;
 
-    // Low level hook handles
-    static HHOOK hook_handle;
-
-    // Required for Unhook in old versions of Windows
-    static HHOOK hook_handle_copy;
-
-    // Static pointer to the current keyboardmanager object required for accessing the HandleKeyboardHookEvent function in the hook procedure (Only global or static variables can be accessed in a hook procedure CALLBACK)
-    static KeyboardManager* keyboardmanager_object_ptr;
-
     // Variable which stores all the state information to be shared between the UI and back-end
     KeyboardManagerState keyboardManagerState;
 
     // Object of class which implements InputInterface. Required for calling library functions while enabling testing
     Input inputHandler;
 
+    // Parsed JSON of the last loaded configuration file. It is reused when the configuration is reloaded and the file has not been modified in the meantime
+    std::wstring loadedConfigPath;
+    std::filesystem::file_time_type loadedConfigWriteTime;
+    std::optional<json::JsonObject> loadedConfigJson;
+
 public:
     // Constructor
     KeyboardManager()
     {
         // Load the initial configuration.
         load_config();
-
-        // Set the static pointer to the newest object of the class
-        keyboardmanager_object_ptr = this;
     };
 
     // Load config from the saved settings.
@@ -85,136 +79,7 @@ public:
 
             if (current_config)
             {
-                keyboardManagerState.SetCurrentConfigName(*current_config);
-                // Read the config file and load the remaps.
-                auto configFile = json::from_file(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + *current_config + L".json");
-                if (configFile)
-                {
-                    auto jsonData = *configFile;
-
-                    // Load single key remaps
-                    try
-                    {
-                        auto remapKeysData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapKeysSettingName);
-                        keyboardManagerState.ClearSingleKeyRemaps();
-
-                        if (remapKeysData)
-                        {
-                            auto inProcessRemapKeys = remapKeysData.GetNamedArray(KeyboardManagerConstants::InProcessRemapKeysSettingName);
-                            for (const auto& it : inProcessRemapKeys)
-                            {
-                                try
-                                {
-                                    auto originalKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                    auto newRemapKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-
-                                    // If remapped to a shortcut
-                                    if (std::wstring(newRemapKey).find(L";") != std::string::npos)
-                                    {
-                                        keyboardManagerState.AddSingleKeyRemap(std::stoul(originalKey.c_str()), Shortcut(newRemapKey.c_str()));
-                                    }
-
-                                    // If remapped to a key
-                                    else
-                                    {
-                                        keyboardManagerState.AddSingleKeyRemap(std::stoul(originalKey.c_str()), std::stoul(newRemapKey.c_str()));
-                                    }
-                                }
-                                catch (...)
-                                {
-                                    // Improper Key Data JSON. Try the next remap.
-                                }
-                            }
-                        }
-                    }
-                    catch (...)
-                    {
-                        // Improper JSON format for single key remaps. Skip to next remap type
-                    }
-
-                    // Load shortcut remaps
-                    try
-                    {
-                        auto remapShortcutsData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapShortcutsSettingName);
-                        keyboardManagerState.ClearOSLevelShortcuts();
-                        keyboardManagerState.ClearAppSpecificShortcuts();
-                        if (remapShortcutsData)
-                        {
-                            // Load os level shortcut remaps
-                            try
-                            {
-                                auto globalRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::GlobalRemapShortcutsSettingName);
-                                for (const auto& it : globalRemapShortcuts)
-                                {
-                                    try
-                                    {
-                                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-
-                                        // If remapped to a shortcut
-                                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
-                                        {
-                                            keyboardManagerState.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
-                                        }
-
-                                        // If remapped to a key
-                                        else
-                                        {
-                                            keyboardManagerState.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
-                                        }
-                                    }
-                                    catch (...)
-                                    {
-                                        // Improper Key Data JSON. Try the next shortcut.
-                                    }
-                                }
-                            }
-                            catch (...)
-                            {
-                                // Improper JSON format for os level shortcut remaps. Skip to next remap type
-                            }
-
-                            // Load app specific shortcut remaps
-                            try
-                            {
-                                auto appSpecificRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName);
-                                for (const auto& it : appSpecificRemapShortcuts)
-                                {
-                                    try
-                                    {
-                                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-                                        auto targetApp = it.GetObjectW().GetNamedString(KeyboardManagerConstants::TargetAppSettingName);
-
-                                        // If remapped to a shortcut
-                                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
-                                        {
-                                            keyboardManagerState.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
-                                        }
-
-                                        // If remapped to a key
-                                        else
-                                        {
-                                            keyboardManagerState.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
-                                        }
-                                    }
-                                    catch (...)
-                                    {
-                                        // Improper Key Data JSON. Try the next shortcut.
-                                    }
-                                }
-                            }
-                            catch (...)
-                            {
-                                // Improper JSON format for os level shortcut remaps. Skip to next remap type
-                            }
-                        }
-                    }
-                    catch (...)
-                    {
-                        // Improper JSON format for shortcut remaps. Skip to next remap type
-                    }
-                }
+                load_remap_config(*current_config);
             }
         }
         catch (...)
@@ -223,11 +88,41 @@ public:
         }
     }
 
+    // Load the remaps of the given configuration. The new remap tables are built on the calling thread and replace the current ones at once, so the hook keeps remapping during the reload.
+    void load_remap_config(const std::wstring& configName)
+    {
+        keyboardManagerState.SetCurrentConfigName(configName);
+        std::wstring configPath = PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + configName + L".json";
+
+        std::error_code err;
+        auto writeTime = std::filesystem::last_write_time(configPath, err);
+        if (err)
+        {
+            // The config file does not exist
+            return;
+        }
+
+        // Only read the config file if it was not parsed yet or if it has been modified since
+        if (!loadedConfigJson || configPath != loadedConfigPath || writeTime != loadedConfigWriteTime)
+        {
+            loadedConfigJson = json::from_file(configPath);
+            loadedConfigPath = configPath;
+            loadedConfigWriteTime = writeTime;
+        }
+
+        if (loadedConfigJson)
+        {
+            keyboardManagerState.LoadConfigFromJson(*loadedConfigJson);
+        }
+    }
+
     // Destroy the powertoy and free memory
     virtual void destroy() override
     {
-        stop_lowlevel_keyboard_hook();
+        // The hook is owned by the runner, which unsubscribes the module before destroying it
         delete this;
+        // The exit notifications of the processes of the foreground windows would run after the DLL is unloaded
+        ProcessPathCache::shutdown();
     }
 
     // Return the localized display name of the powertoy
@@ -244,6 +139,17 @@ public:
 
     // Return JSON with the configuration options.
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -252,7 +158,7 @@ public:
         settings.set_description(IDS_SETTINGS_DESCRIPTION);
         settings.set_overview_link(L"https://aka.ms/PowerToysOverview_KeyboardManager");
 
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     // Signal from the Settings editor to call a custom action.
@@ -300,6 +206,13 @@ public:
             // If you don't need to do any custom processing of the settings, proceed
             // to persists the values calling:
             values.save_to_settings_file();
+
+            // Reload the remaps if the active configuration changed
+            auto current_config = values.get_string_value(KeyboardManagerConstants::ActiveConfigurationSettingName);
+            if (current_config && *current_config != keyboardManagerState.GetCurrentConfigName())
+            {
+                load_remap_config(*current_config);
+            }
         }
         catch (std::exception&)
         {
@@ -313,8 +226,6 @@ public:
         m_enabled = true;
         // Log telemetry
         Trace::EnableKeyboardManager(true);
-        // Start keyboard hook
-        start_lowlevel_keyboard_hook();
     }
 
     // Disable the powertoy
@@ -326,8 +237,6 @@ public:
         // Close active windows
         CloseActiveEditKeyboardWindow();
         CloseActiveEditShortcutsWindow();
-        // Stop keyboard hook
-        stop_lowlevel_keyboard_hook();
     }
 
     // Returns if the powertoys is enabled
@@ -336,142 +245,34 @@ public:
         return m_enabled;
     }
 
-    // Hook procedure definition
-    static LRESULT CALLBACK hook_proc(int nCode, WPARAM wParam, LPARAM lParam)
+    // The keyboard events come from the runner's hook. The remapping runs before the other PowerToys, so they see the remapped keys
+    virtual int get_keyboard_event_priority() override
     {
-        LowlevelKeyboardEvent event;
-        if (nCode == HC_ACTION)
-        {
-            event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-            event.wParam = wParam;
-            if (keyboardmanager_object_ptr->HandleKeyboardHookEvent(&event) == 1)
-            {
-                // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
-                if (event.lParam->vkCode == VK_NUMLOCK && (event.wParam == WM_KEYDOWN || event.wParam == WM_SYSKEYDOWN) && event.lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
-                {
-                    KeyboardEventHandlers::SetNumLockToPreviousState(keyboardmanager_object_ptr->inputHandler);
-                }
-                return 1;
-            }
-        }
-        return CallNextHookEx(hook_handle_copy, nCode, wParam, lParam);
+        return 100;
     }
 
-    void start_lowlevel_keyboard_hook()
+    // Called by the runner's hook while the PowerToy is enabled
+    virtual KeyboardEventDecision on_keyboard_event(LowlevelKeyboardEvent* event) override
     {
-#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
-        if (IsDebuggerPresent())
-        {
-            return;
-        }
-#endif
-
-        if (!hook_handle)
+        if (KeyboardEventHandlers::HandleKeyboardHookEvent(inputHandler, event, keyboardManagerState) == 1)
         {
-            hook_handle = SetWindowsHookEx(WH_KEYBOARD_LL, hook_proc, GetModuleHandle(NULL), NULL);
-            hook_handle_copy = hook_handle;
-            if (!hook_handle)
+            // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
+            if (event->lParam->vkCode == VK_NUMLOCK && (event->wParam == WM_KEYDOWN || event->wParam == WM_SYSKEYDOWN) && event->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
             {
-                DWORD errorCode = GetLastError();
-                show_last_error_message(L"SetWindowsHookEx", errorCode, L"PowerToys - Keyboard Manager");
-                auto errorMessage = get_last_error_message(errorCode);
-                Trace::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"start_lowlevel_keyboard_hook.SetWindowsHookEx");
+                KeyboardEventHandlers::SetNumLockToPreviousState(inputHandler);
             }
+            return { KeyboardEventDecision::Type::Suppress };
         }
-    }
-
-    // Function to terminate the low level hook
-    void stop_lowlevel_keyboard_hook()
-    {
-        if (hook_handle)
-        {
-            UnhookWindowsHookEx(hook_handle);
-            hook_handle = nullptr;
-        }
-    }
-
-    // Function called by the hook procedure to handle the events. This is the starting point function for remapping
-    intptr_t HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept
-    {
-        // If remappings are disabled (due to the remap tables getting updated) skip the rest of the hook
-        if (!keyboardManagerState.AreRemappingsEnabled())
-        {
-            return 0;
-        }
-
-        // If key has suppress flag, then suppress it
-        if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
-        {
-            return 1;
-        }
-
-        // If the Detect Key Window is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision singleKeyRemapUIDetected = keyboardManagerState.DetectSingleRemapKeyUIBackend(data);
-        if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
-
-        // If the Detect Shortcut Window from Remap Keys is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision remapKeyShortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, true);
-        if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
-
-        // Remap a key
-        intptr_t SingleKeyRemapResult = KeyboardEventHandlers::HandleSingleKeyRemapEvent(inputHandler, data, keyboardManagerState);
-
-        // Single key remaps have priority. If a key is remapped, only the remapped version should be visible to the shortcuts and hence the event should be suppressed here.
-        if (SingleKeyRemapResult == 1)
-        {
-            return 1;
-        }
-
-        // If the Detect Shortcut Window is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision shortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, false);
-        if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
-
-        /* This feature has not been enabled (code from proof of concept stage)
-        * 
-        //// Remap a key to behave like a modifier instead of a toggle
-        //intptr_t SingleKeyToggleToModResult = KeyboardEventHandlers::HandleSingleKeyToggleToModEvent(inputHandler, data, keyboardManagerState);
-        */
-
-        // Handle an app-specific shortcut remapping
-        intptr_t AppSpecificShortcutRemapResult = KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(inputHandler, data, keyboardManagerState);
-
-        // If an app-specific shortcut is remapped then the os-level shortcut remapping should be suppressed.
-        if (AppSpecificShortcutRemapResult == 1)
-        {
-            return 1;
-        }
-
-        // Handle an os-level shortcut remapping
-        return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(inputHandler, data, keyboardManagerState);
+        return {};
     }
 };
 
-HHOOK KeyboardManager::hook_handle = nullptr;
-HHOOK KeyboardManager::hook_handle_copy = nullptr;
-KeyboardManager* KeyboardManager::keyboardmanager_object_ptr = nullptr;
-
 extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new KeyboardManager();
+}
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
 }
\ No newline at end of file
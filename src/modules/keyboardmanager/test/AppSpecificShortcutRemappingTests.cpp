@@ -26,7 +26,7 @@ namespace RemappingLogicTests
             TestHelpers::ResetTestEnv(mockedInputHandler, testState);
 
             // Set HandleOSLevelShortcutRemapEvent as the hook procedure
-            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
             mockedInputHandler.SetHookProc(currentHookProc);
         }
 
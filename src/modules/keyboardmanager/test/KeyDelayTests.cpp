@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/KeyDelay.h>
+#include <keyboardmanager/common/KeyDelayScheduler.h>
+#include <future>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the KeyDelay state machine and the KeyDelayScheduler
+    TEST_CLASS (KeyDelayTests)
+    {
+    private:
+        int shortPressCount = 0;
+        int longPressDetectedCount = 0;
+        int longPressReleasedCount = 0;
+
+        KeyDelay CreateKeyDelay()
+        {
+            return KeyDelay(
+                VK_RETURN,
+                [this](DWORD) { shortPressCount++; },
+                [this](DWORD) { longPressDetectedCount++; },
+                [this](DWORD) { longPressReleasedCount++; });
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            shortPressCount = 0;
+            longPressDetectedCount = 0;
+            longPressReleasedCount = 0;
+        }
+
+        // Test if a short press is detected when the key is released before the long press delay
+        TEST_METHOD (KeyEvent_ShouldCallOnShortPress_WhenKeyIsReleasedBeforeLongPressDelay)
+        {
+            KeyDelay keyDelay = CreateKeyDelay();
+
+            // Only the initial key down should request a timeout
+            Assert::IsTrue(keyDelay.KeyEvent({ 1000, WM_KEYDOWN }));
+            Assert::IsFalse(keyDelay.KeyEvent({ 1030, WM_KEYDOWN }));
+            Assert::IsFalse(keyDelay.KeyEvent({ 1100, WM_KEYUP }));
+
+            Assert::AreEqual(1, shortPressCount);
+            Assert::AreEqual(0, longPressDetectedCount);
+            Assert::AreEqual(0, longPressReleasedCount);
+        }
+
+        // Test if a long press is detected from the event timestamps even if the timeout has not fired yet
+        TEST_METHOD (KeyEvent_ShouldCallOnLongPress_WhenKeyIsReleasedAfterLongPressDelay)
+        {
+            KeyDelay keyDelay = CreateKeyDelay();
+
+            keyDelay.KeyEvent({ 1000, WM_KEYDOWN });
+            keyDelay.KeyEvent({ 1000 + KeyDelay::LONG_PRESS_DELAY_MILLIS + 1, WM_KEYUP });
+
+            Assert::AreEqual(0, shortPressCount);
+            Assert::AreEqual(1, longPressDetectedCount);
+            Assert::AreEqual(1, longPressReleasedCount);
+        }
+
+        // Test if a timeout scheduled for an earlier press is ignored
+        TEST_METHOD (LongPressTimeout_ShouldBeIgnored_WhenItBelongsToAnEarlierPress)
+        {
+            KeyDelay keyDelay = CreateKeyDelay();
+
+            keyDelay.KeyEvent({ 1000, WM_KEYDOWN });
+            DWORD64 firstPressId = keyDelay.PressId();
+            keyDelay.KeyEvent({ 1100, WM_KEYUP });
+            keyDelay.KeyEvent({ 1200, WM_KEYDOWN });
+
+            keyDelay.LongPressTimeout(firstPressId);
+            Assert::AreEqual(0, longPressDetectedCount);
+
+            keyDelay.LongPressTimeout(keyDelay.PressId());
+            Assert::AreEqual(1, longPressDetectedCount);
+
+            keyDelay.KeyEvent({ 1300, WM_KEYUP });
+            Assert::AreEqual(1, shortPressCount);
+            Assert::AreEqual(1, longPressReleasedCount);
+        }
+
+        // Test if the scheduler fires the long press timeout while the key is still held
+        TEST_METHOD (KeyDelayScheduler_ShouldCallOnLongPressDetected_WhenKeyIsHeld)
+        {
+            std::promise<void> longPressDetected;
+            auto longPressDetectedFuture = longPressDetected.get_future();
+
+            KeyDelayScheduler scheduler;
+            scheduler.RegisterKeyDelay(
+                VK_ESCAPE,
+                nullptr,
+                [&longPressDetected](DWORD) { longPressDetected.set_value(); },
+                nullptr);
+            Assert::IsTrue(scheduler.IsKeyDelayRegistered(VK_ESCAPE));
+            Assert::IsFalse(scheduler.IsKeyDelayRegistered(VK_RETURN));
+
+            Assert::IsTrue(scheduler.QueueKeyEvent(VK_ESCAPE, { GetTickCount64(), WM_KEYDOWN }));
+            Assert::IsTrue(longPressDetectedFuture.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+            scheduler.UnregisterKeyDelay(VK_ESCAPE);
+            Assert::IsFalse(scheduler.IsKeyDelayRegistered(VK_ESCAPE));
+        }
+    };
+}
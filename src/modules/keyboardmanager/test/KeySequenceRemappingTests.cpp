@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/common/KeySequenceTrie.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include "../common/shared_constants.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for key sequence remapping logic
+    TEST_CLASS (KeySequenceRemappingTests)
+    {
+    private:
+        MockedInput mockedInputHandler;
+        KeyboardManagerState testState;
+
+        // Function to send a key down and key up for a key with the given timestamp
+        void SendKeyPress(WORD key, DWORD time)
+        {
+            const int nInputs = 2;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = key;
+            input[0].ki.time = time;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = key;
+            input[1].ki.dwFlags = KEYEVENTF_KEYUP;
+            input[1].ki.time = time;
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+        }
+
+        // Function to send a key down or key up for a modifier
+        void SendModifier(WORD key, bool keyUp)
+        {
+            const int nInputs = 1;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = key;
+            input[0].ki.dwFlags = keyUp ? KEYEVENTF_KEYUP : 0;
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+        }
+
+        // Function to count the key downs of a key sent by the remap
+        void CountKeyDowns(DWORD key)
+        {
+            mockedInputHandler.SetSendVirtualInputTestHandler([key](LowlevelKeyboardEvent* data) {
+                return data->lParam->vkCode == key && (data->wParam == WM_KEYDOWN || data->wParam == WM_SYSKEYDOWN) && data->lParam->dwExtraInfo != 0;
+            });
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set HandleKeySequenceRemapEvent as the hook procedure
+            std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleKeySequenceRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc(currentHookProc);
+        }
+
+        // Test if a key sequence of single keys is remapped when the steps are pressed within the timeout
+        TEST_METHOD (KeySequence_ShouldSendTargetKey_WhenStepsArePressedWithinTimeout)
+        {
+            // Remap J, K to Escape
+            testState.AddKeySequenceRemap(KeySequence(L"74,75", 1000), (DWORD)VK_ESCAPE);
+            CountKeyDowns(VK_ESCAPE);
+
+            SendKeyPress(0x4A, 1000);
+            SendKeyPress(0x4B, 1050);
+
+            // Escape should be sent once, and all the keys should be released
+            Assert::AreEqual(1, mockedInputHandler.GetSendVirtualInputCallCount());
+            Assert::IsFalse(mockedInputHandler.GetVirtualKeyState(0x4B));
+            Assert::IsFalse(mockedInputHandler.GetVirtualKeyState(VK_ESCAPE));
+        }
+
+        // Test if a key sequence is not remapped when the timeout between the steps is exceeded
+        TEST_METHOD (KeySequence_ShouldNotSendTargetKey_WhenTimeoutIsExceeded)
+        {
+            // Remap J, K to Escape with a 500ms timeout
+            testState.AddKeySequenceRemap(KeySequence(L"74,75", 500), (DWORD)VK_ESCAPE);
+            CountKeyDowns(VK_ESCAPE);
+
+            SendKeyPress(0x4A, 1000);
+            SendKeyPress(0x4B, 1501);
+
+            Assert::AreEqual(0, mockedInputHandler.GetSendVirtualInputCallCount());
+        }
+
+        // Test if a key sequence of shortcuts is remapped and the modifiers which are held down are restored
+        TEST_METHOD (KeySequenceOfShortcuts_ShouldSendTargetKeyAndRestoreModifiers_WhenCompleted)
+        {
+            // Remap Ctrl+K, Ctrl+C to F2
+            testState.AddKeySequenceRemap(KeySequence(std::to_wstring(VK_CONTROL) + L";75," + std::to_wstring(VK_CONTROL) + L";67", 1000), (DWORD)VK_F2);
+            CountKeyDowns(VK_F2);
+
+            SendModifier(VK_LCONTROL, false);
+            SendKeyPress(0x4B, 1000);
+            SendKeyPress(0x43, 1100);
+
+            // F2 should be sent once and Ctrl should still be held down
+            Assert::AreEqual(1, mockedInputHandler.GetSendVirtualInputCallCount());
+            Assert::IsTrue(mockedInputHandler.GetVirtualKeyState(VK_LCONTROL));
+            Assert::IsFalse(mockedInputHandler.GetVirtualKeyState(0x43));
+            Assert::IsFalse(mockedInputHandler.GetVirtualKeyState(VK_F2));
+
+            SendModifier(VK_LCONTROL, true);
+        }
+
+        // Test if a key sequence is matched when the first step is repeated before the sequence is completed
+        TEST_METHOD (KeySequence_ShouldRestartMatching_WhenFirstStepIsRepeated)
+        {
+            // Remap J, K to Escape
+            testState.AddKeySequenceRemap(KeySequence(L"74,75", 1000), (DWORD)VK_ESCAPE);
+            CountKeyDowns(VK_ESCAPE);
+
+            SendKeyPress(0x4A, 1000);
+            SendKeyPress(0x4A, 1050);
+            SendKeyPress(0x4B, 1100);
+
+            Assert::AreEqual(1, mockedInputHandler.GetSendVirtualInputCallCount());
+        }
+
+        // Test if a key sequence which conflicts with a key sequence that was added before is rejected
+        TEST_METHOD (KeySequenceTrieInsert_ShouldReturnFalse_WhenSequenceIsPrefixOfAnotherSequence)
+        {
+            KeySequenceTrie trie;
+            Assert::IsTrue(trie.Insert(KeySequence(L"74,75,76", 1000), 0));
+            Assert::IsFalse(trie.Insert(KeySequence(L"74,75", 1000), 1));
+            Assert::IsFalse(trie.Insert(KeySequence(L"74,75,76,77", 1000), 1));
+            Assert::IsFalse(trie.Insert(KeySequence(L"74,75,76", 1000), 1));
+            Assert::IsTrue(trie.Insert(KeySequence(L"74,76", 1000), 1));
+        }
+    };
+}
@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "KeyTraceReplay.h"
+#include <sstream>
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include <common/LowlevelKeyboardEvent.h>
+
+namespace KeyTraceReplay
+{
+    // Function to parse a recorded key trace. Each line has the format "<time in ms> <down|up> <virtual key code>", where the key code can be decimal or hexadecimal (0x prefix). Empty lines and lines starting with # are ignored
+    std::vector<KeyboardManagerInput::KeyEvent> ParseKeyTrace(const std::wstring& trace)
+    {
+        std::vector<KeyboardManagerInput::KeyEvent> events;
+        std::wistringstream traceStream(trace);
+        std::wstring line;
+        while (std::getline(traceStream, line))
+        {
+            std::wistringstream lineStream(line);
+            std::wstring time;
+            std::wstring action;
+            std::wstring key;
+            if (!(lineStream >> time) || time[0] == L'#')
+            {
+                continue;
+            }
+
+            if (!(lineStream >> action >> key))
+            {
+                throw std::invalid_argument("Key trace line is missing the action or the key code.");
+            }
+
+            KeyboardManagerInput::KeyEvent keyEvent;
+            keyEvent.time = std::stoul(time);
+            keyEvent.key = std::stoul(key, nullptr, 0);
+            if (action == L"down")
+            {
+                keyEvent.type = KeyboardManagerInput::KeyEventType::KeyDown;
+            }
+            else if (action == L"up")
+            {
+                keyEvent.type = KeyboardManagerInput::KeyEventType::KeyUp;
+            }
+            else
+            {
+                throw std::invalid_argument("Key trace action should be either down or up.");
+            }
+
+            events.push_back(keyEvent);
+        }
+
+        return events;
+    }
+
+    // Function to return the number of trace events processed per second
+    double ReplayResult::EventsPerSecond() const
+    {
+        if (duration.count() == 0)
+        {
+            return 0;
+        }
+
+        return (double)eventCount / std::chrono::duration<double>(duration).count();
+    }
+
+    // Function to run a key event through the same dispatch as the Keyboard Manager low level hook. Returns 1 if the event is suppressed
+    intptr_t TraceReplayInput::HandleKeyEvent(const KeyboardManagerInput::KeyEvent& data)
+    {
+        // Set only vkCode, dwExtraInfo and time since other values are unused
+        KBDLLHOOKSTRUCT lParam = {};
+        lParam.vkCode = data.key;
+        lParam.dwExtraInfo = (ULONG_PTR)data.extraInfo;
+        lParam.time = data.time;
+
+        LowlevelKeyboardEvent keyEvent;
+        keyEvent.lParam = &lParam;
+        switch (data.type)
+        {
+        case KeyboardManagerInput::KeyEventType::KeyUp:
+            keyEvent.wParam = WM_KEYUP;
+            break;
+        case KeyboardManagerInput::KeyEventType::SysKeyDown:
+            keyEvent.wParam = WM_SYSKEYDOWN;
+            break;
+        case KeyboardManagerInput::KeyEventType::SysKeyUp:
+            keyEvent.wParam = WM_SYSKEYUP;
+            break;
+        default:
+            keyEvent.wParam = WM_KEYDOWN;
+            break;
+        }
+
+        return KeyboardEventHandlers::HandleKeyboardHookEvent(*this, &keyEvent, keyboardManagerState);
+    }
+
+    // Function to deliver a key event to the remap handlers and update the keyboard state if it is not suppressed
+    void TraceReplayInput::DeliverKeyEvent(const KeyboardManagerInput::KeyEvent& data)
+    {
+        if (HandleKeyEvent(data) == 0)
+        {
+            SetKeyState(data.key, data.IsKeyDown());
+            if (recordOutput)
+            {
+                output.push_back({ (uint16_t)data.key, data.IsKeyUp(), data.extraInfo });
+            }
+        }
+    }
+
+    // Function to update the keyboard state, including the generic modifier key codes
+    void TraceReplayInput::SetKeyState(DWORD key, bool isKeyDown)
+    {
+        if (key >= keyboardState.size())
+        {
+            return;
+        }
+
+        keyboardState[key] = isKeyDown;
+        switch (key)
+        {
+        case VK_CONTROL:
+            if (!isKeyDown)
+            {
+                keyboardState[VK_LCONTROL] = false;
+                keyboardState[VK_RCONTROL] = false;
+            }
+            break;
+        case VK_LCONTROL:
+        case VK_RCONTROL:
+            keyboardState[VK_CONTROL] = isKeyDown;
+            break;
+        case VK_MENU:
+            if (!isKeyDown)
+            {
+                keyboardState[VK_LMENU] = false;
+                keyboardState[VK_RMENU] = false;
+            }
+            break;
+        case VK_LMENU:
+        case VK_RMENU:
+            keyboardState[VK_MENU] = isKeyDown;
+            break;
+        case VK_SHIFT:
+            if (!isKeyDown)
+            {
+                keyboardState[VK_LSHIFT] = false;
+                keyboardState[VK_RSHIFT] = false;
+            }
+            break;
+        case VK_LSHIFT:
+        case VK_RSHIFT:
+            keyboardState[VK_SHIFT] = isKeyDown;
+            break;
+        }
+    }
+
+    // Function to replay the given trace
+    ReplayResult TraceReplayInput::Replay(const std::vector<KeyboardManagerInput::KeyEvent>& trace, bool shouldRecordOutput)
+    {
+        recordOutput = shouldRecordOutput;
+        output.clear();
+        if (recordOutput)
+        {
+            output.reserve(trace.size());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto& keyEvent : trace)
+        {
+            // Distinguish between key and sys key in the same way as the system, i.e. if Alt is held down or the key is F10
+            KeyboardManagerInput::KeyEvent data = keyEvent;
+            if (keyboardState[VK_MENU] || (data.key == VK_F10 && data.IsKeyDown()))
+            {
+                data.type = data.IsKeyDown() ? KeyboardManagerInput::KeyEventType::SysKeyDown : KeyboardManagerInput::KeyEventType::SysKeyUp;
+            }
+
+            DeliverKeyEvent(data);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        ReplayResult result;
+        result.output = std::move(output);
+        result.eventCount = trace.size();
+        result.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        output.clear();
+        return result;
+    }
+
+    // Function to reset the keyboard state
+    void TraceReplayInput::ResetKeyboardState()
+    {
+        keyboardState.fill(false);
+    }
+
+    // Function to set the foreground process name used for app-specific remaps
+    void TraceReplayInput::SetForegroundProcess(const std::wstring& process)
+    {
+        currentProcess = process;
+    }
+
+    // Function to simulate input - key events are fed back through the remap handlers as the low level hook would receive them
+    UINT TraceReplayInput::SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize)
+    {
+        for (UINT i = 0; i < cInputs; i++)
+        {
+            KeyboardManagerInput::OutputKeyEvent sentEvent = KeyboardManagerHelper::ToOutputKeyEvent(pInputs[i]);
+            KeyboardManagerInput::KeyEvent data;
+            data.key = sentEvent.key;
+            data.extraInfo = sentEvent.extraInfo;
+            if (sentEvent.isKeyUp)
+            {
+                data.type = keyboardState[VK_MENU] ? KeyboardManagerInput::KeyEventType::SysKeyUp : KeyboardManagerInput::KeyEventType::KeyUp;
+            }
+            else
+            {
+                data.type = (keyboardState[VK_MENU] || data.key == VK_F10) ? KeyboardManagerInput::KeyEventType::SysKeyDown : KeyboardManagerInput::KeyEventType::KeyDown;
+            }
+
+            DeliverKeyEvent(data);
+        }
+
+        return cInputs;
+    }
+
+    // Function to get the state of a particular key
+    bool TraceReplayInput::GetVirtualKeyState(int key)
+    {
+        return keyboardState[key];
+    }
+
+    // Function to get the foreground process name
+    void TraceReplayInput::GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
+    {
+        foregroundProcess = currentProcess;
+    }
+}
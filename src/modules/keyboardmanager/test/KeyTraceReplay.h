@@ -0,0 +1,80 @@
+#pragma once
+#include <keyboardmanager/common/InputInterface.h>
+#include <keyboardmanager/common/KeyboardEvent.h>
+#include <array>
+#include <chrono>
+#include <vector>
+
+class KeyboardManagerState;
+
+namespace KeyTraceReplay
+{
+    // Function to parse a recorded key trace. Each line has the format "<time in ms> <down|up> <virtual key code>", where the key code can be decimal or hexadecimal (0x prefix). Empty lines and lines starting with # are ignored
+    std::vector<KeyboardManagerInput::KeyEvent> ParseKeyTrace(const std::wstring& trace);
+
+    // Result of replaying a key trace through the remap engine
+    struct ReplayResult
+    {
+        // Key events which were not suppressed by the remap engine, in the order in which an application would receive them
+        std::vector<KeyboardManagerInput::OutputKeyEvent> output;
+
+        // Number of trace events which were replayed
+        size_t eventCount = 0;
+
+        // Time taken to replay the trace
+        std::chrono::nanoseconds duration{};
+
+        // Function to return the number of trace events processed per second
+        double EventsPerSecond() const;
+    };
+
+    // Class which replays key traces through the remap handlers. Key events sent by the handlers are fed back through the handlers, in the same way as SendInput re-enters the low level hook, and the events which are not suppressed are recorded as the output.
+    class TraceReplayInput :
+        public InputInterface
+    {
+    private:
+        // Stores the states for all the keys - false for key up, and true for key down
+        std::array<bool, 256> keyboardState{};
+
+        KeyboardManagerState& keyboardManagerState;
+
+        std::wstring currentProcess;
+
+        // Output events. Only recorded if recordOutput is true
+        std::vector<KeyboardManagerInput::OutputKeyEvent> output;
+        bool recordOutput = true;
+
+        // Function to run a key event through the same dispatch as the Keyboard Manager low level hook. Returns 1 if the event is suppressed
+        intptr_t HandleKeyEvent(const KeyboardManagerInput::KeyEvent& data);
+
+        // Function to deliver a key event to the remap handlers and update the keyboard state if it is not suppressed
+        void DeliverKeyEvent(const KeyboardManagerInput::KeyEvent& data);
+
+        // Function to update the keyboard state, including the generic modifier key codes
+        void SetKeyState(DWORD key, bool isKeyDown);
+
+    public:
+        TraceReplayInput(KeyboardManagerState& state) :
+            keyboardManagerState(state)
+        {
+        }
+
+        // Function to replay the given trace
+        ReplayResult Replay(const std::vector<KeyboardManagerInput::KeyEvent>& trace, bool shouldRecordOutput = true);
+
+        // Function to reset the keyboard state
+        void ResetKeyboardState();
+
+        // Function to set the foreground process name used for app-specific remaps
+        void SetForegroundProcess(const std::wstring& process);
+
+        // Function to simulate input
+        UINT SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize) override;
+
+        // Function to get the state of a particular key
+        bool GetVirtualKeyState(int key) override;
+
+        // Function to get the foreground process name
+        void GetForegroundProcess(_Out_ std::wstring& foregroundProcess) override;
+    };
+}
@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "KeyTraceReplay.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include "../common/shared_constants.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for replaying recorded key traces through the remap handlers
+    TEST_CLASS (KeyTraceReplayTests)
+    {
+    private:
+        KeyboardManagerState testState;
+
+        // Remap configuration in the same format as the Keyboard Manager configuration file. Remaps A to B, Caps Lock to Ctrl, Ctrl+C to Ctrl+V and, in testprocess.exe, Ctrl+V to Ctrl+Shift+V
+        const std::wstring testConfig = LR"({
+            "remapKeys": { "inProcess": [
+                { "originalKeys": "65", "newRemapKeys": "66" },
+                { "originalKeys": "20", "newRemapKeys": "162" } ] },
+            "remapShortcuts": {
+                "global": [ { "originalKeys": "17;67", "newRemapKeys": "17;86" } ],
+                "appSpecific": [ { "originalKeys": "17;86", "newRemapKeys": "17;16;86", "targetApp": "testprocess.exe" } ] } })";
+
+        // Function to count the number of times a key event is present in the output
+        static size_t CountOutputEvents(const KeyTraceReplay::ReplayResult& result, uint16_t key, bool isKeyUp)
+        {
+            return (size_t)std::count_if(result.output.begin(), result.output.end(), [key, isKeyUp](const KeyboardManagerInput::OutputKeyEvent& keyEvent) {
+                return keyEvent.key == key && keyEvent.isKeyUp == isKeyUp;
+            });
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            testState.ClearSingleKeyRemaps();
+            testState.ClearOSLevelShortcuts();
+            testState.ClearAppSpecificShortcuts();
+
+            // Allocate memory for the keyboardManagerState activatedApp member to avoid CRT assert errors
+            std::wstring maxLengthString;
+            maxLengthString.resize(MAX_PATH);
+            testState.SetActivatedApp(maxLengthString);
+            testState.SetActivatedApp(KeyboardManagerConstants::NoActivatedApp);
+        }
+
+        // Test if key traces are parsed correctly
+        TEST_METHOD (ParseKeyTrace_ShouldReturnKeyEvents_OnValidTrace)
+        {
+            auto trace = KeyTraceReplay::ParseKeyTrace(L"# A key press\n10 down 0x41\n\n25 up 65\n");
+
+            Assert::AreEqual((size_t)2, trace.size());
+            Assert::AreEqual((uint32_t)0x41, trace[0].key);
+            Assert::AreEqual((uint32_t)10, trace[0].time);
+            Assert::IsTrue(trace[0].IsKeyDown());
+            Assert::AreEqual((uint32_t)0x41, trace[1].key);
+            Assert::AreEqual((uint32_t)25, trace[1].time);
+            Assert::IsTrue(trace[1].IsKeyUp());
+        }
+
+        // Test if an invalid key trace action throws an exception
+        TEST_METHOD (ParseKeyTrace_ShouldThrow_OnInvalidAction)
+        {
+            Assert::ExpectException<std::invalid_argument>([] { KeyTraceReplay::ParseKeyTrace(L"10 press 0x41"); });
+        }
+
+        // Test if replaying a trace with a single key remap outputs only the target key
+        TEST_METHOD (Replay_ShouldOutputTargetKey_OnSingleKeyRemap)
+        {
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, 0x42);
+            KeyTraceReplay::TraceReplayInput replayInput(testState);
+
+            auto result = replayInput.Replay(KeyTraceReplay::ParseKeyTrace(L"0 down 0x41\n50 up 0x41"));
+
+            Assert::AreEqual((size_t)2, result.output.size());
+            Assert::IsTrue(result.output[0] == KeyboardManagerInput::OutputKeyEvent{ 0x42, false, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG });
+            Assert::IsTrue(result.output[1] == KeyboardManagerInput::OutputKeyEvent{ 0x42, true, KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG });
+            Assert::AreEqual(false, replayInput.GetVirtualKeyState(0x41));
+            Assert::AreEqual(false, replayInput.GetVirtualKeyState(0x42));
+        }
+
+        // Test if replaying a trace against a configuration loaded from JSON applies the os-level shortcut remap
+        TEST_METHOD (Replay_ShouldApplyOSLevelShortcut_OnConfigLoadedFromJson)
+        {
+            testState.LoadConfigFromJson(json::JsonObject::Parse(testConfig));
+            KeyTraceReplay::TraceReplayInput replayInput(testState);
+
+            // Press Ctrl+C
+            auto result = replayInput.Replay(KeyTraceReplay::ParseKeyTrace(L"0 down 0xA2\n20 down 0x43"));
+
+            // Ctrl+V should be pressed and C should not be sent
+            Assert::AreEqual(true, replayInput.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, replayInput.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, replayInput.GetVirtualKeyState(0x43));
+            Assert::AreEqual((size_t)0, CountOutputEvents(result, 0x43, false));
+        }
+
+        // Test if replaying a trace against a configuration loaded from JSON applies the app-specific shortcut remap only for the target app
+        TEST_METHOD (Replay_ShouldApplyAppSpecificShortcut_OnConfigLoadedFromJsonAndTargetAppInForeground)
+        {
+            testState.LoadConfigFromJson(json::JsonObject::Parse(testConfig));
+            KeyTraceReplay::TraceReplayInput replayInput(testState);
+            replayInput.SetForegroundProcess(L"testprocess.exe");
+
+            // Press Ctrl+V
+            replayInput.Replay(KeyTraceReplay::ParseKeyTrace(L"0 down 0xA2\n20 down 0x56"));
+
+            // Ctrl+Shift+V should be pressed
+            Assert::AreEqual(true, replayInput.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, replayInput.GetVirtualKeyState(VK_SHIFT));
+            Assert::AreEqual(true, replayInput.GetVirtualKeyState(0x56));
+        }
+
+        // Test if replaying a large trace leaves the keyboard in a released state and report the throughput of the remap handlers
+        TEST_METHOD (Replay_ShouldReleaseAllKeys_OnLargeTrace)
+        {
+            testState.LoadConfigFromJson(json::JsonObject::Parse(testConfig));
+            KeyTraceReplay::TraceReplayInput replayInput(testState);
+
+            // Typing sequence which exercises unmapped keys, single key remaps and shortcut remaps
+            const std::vector<std::pair<DWORD, bool>> sequence = {
+                { 0x44, false }, { 0x44, true }, { 0x41, false }, { 0x41, true }, { VK_CAPITAL, false }, { 0x43, false }, { 0x43, true }, { VK_CAPITAL, true }, { VK_LCONTROL, false }, { 0x43, false }, { 0x43, true }, { VK_LCONTROL, true }
+            };
+            const size_t repetitions = 100000;
+            std::vector<KeyboardManagerInput::KeyEvent> trace;
+            trace.reserve(sequence.size() * repetitions);
+            uint32_t time = 0;
+            for (size_t i = 0; i < repetitions; i++)
+            {
+                for (const auto& it : sequence)
+                {
+                    KeyboardManagerInput::KeyEvent keyEvent;
+                    keyEvent.key = it.first;
+                    keyEvent.type = it.second ? KeyboardManagerInput::KeyEventType::KeyUp : KeyboardManagerInput::KeyEventType::KeyDown;
+                    keyEvent.time = time;
+                    time += 10;
+                    trace.push_back(keyEvent);
+                }
+            }
+
+            auto result = replayInput.Replay(trace, false);
+
+            Logger::WriteMessage((L"Replayed " + std::to_wstring(result.eventCount) + L" key events at " + std::to_wstring((uint64_t)result.EventsPerSecond()) + L" events per second\n").c_str());
+            Assert::AreEqual(trace.size(), result.eventCount);
+            for (int key = 0; key < 256; key++)
+            {
+                Assert::AreEqual(false, replayInput.GetVirtualKeyState(key));
+            }
+        }
+    };
+}
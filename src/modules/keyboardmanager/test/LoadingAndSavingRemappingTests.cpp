@@ -30,6 +30,45 @@ namespace RemappingUITests
             Assert::AreEqual(true, isSuccess);
         }
 
+        // Test if the CheckIfKeySequenceRemappingsAreValid method is successful when the sequences don't conflict
+        TEST_METHOD (CheckIfKeySequenceRemappingsAreValid_ShouldReturnNoError_OnPassingNonConflictingSequences)
+        {
+            KeySequenceRemapTable sequences;
+            sequences.push_back(std::make_pair(KeySequence(L"74,75", 1000), (DWORD)VK_ESCAPE));
+            sequences.push_back(std::make_pair(KeySequence(L"74,76", 1000), (DWORD)VK_F2));
+
+            Assert::IsTrue(LoadingAndSavingRemappingHelper::CheckIfKeySequenceRemappingsAreValid(sequences, RemapBuffer()) == KeyboardManagerHelper::ErrorType::NoError);
+        }
+
+        // Test if the CheckIfKeySequenceRemappingsAreValid method fails when a sequence starts with the steps of another sequence
+        TEST_METHOD (CheckIfKeySequenceRemappingsAreValid_ShouldReturnConflictingKeySequence_OnPassingPrefixSequence)
+        {
+            KeySequenceRemapTable sequences;
+            sequences.push_back(std::make_pair(KeySequence(L"74,75", 1000), (DWORD)VK_ESCAPE));
+            sequences.push_back(std::make_pair(KeySequence(L"74,75,76", 1000), (DWORD)VK_F2));
+
+            Assert::IsTrue(LoadingAndSavingRemappingHelper::CheckIfKeySequenceRemappingsAreValid(sequences, RemapBuffer()) == KeyboardManagerHelper::ErrorType::ConflictingKeySequence);
+        }
+
+        // Test if the CheckIfKeySequenceRemappingsAreValid method fails when a step before the last one is remapped as an os level shortcut
+        TEST_METHOD (CheckIfKeySequenceRemappingsAreValid_ShouldReturnKeySequenceConflictsWithShortcut_OnPassingShortcutRemapOfFirstStep)
+        {
+            KeySequenceRemapTable sequences;
+            sequences.push_back(std::make_pair(KeySequence(std::to_wstring(VK_CONTROL) + L";75," + std::to_wstring(VK_CONTROL) + L";67", 1000), (DWORD)VK_F2));
+
+            // Remap Ctrl+K to Ctrl+V
+            Shortcut s1;
+            s1.SetKey(VK_CONTROL);
+            s1.SetKey(0x4B);
+            Shortcut s2;
+            s2.SetKey(VK_CONTROL);
+            s2.SetKey(0x56);
+            RemapBuffer remapBuffer;
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ s1, s2 }), std::wstring()));
+
+            Assert::IsTrue(LoadingAndSavingRemappingHelper::CheckIfKeySequenceRemappingsAreValid(sequences, remapBuffer) == KeyboardManagerHelper::ErrorType::KeySequenceConflictsWithShortcut);
+        }
+
         // Test if the CheckIfRemappingsAreValid method is successful when valid key to key remaps are passed
         TEST_METHOD (CheckIfRemappingsAreValid_ShouldReturnNoError_OnPassingValidKeyToKeyRemaps)
         {
@@ -370,7 +409,7 @@ namespace RemappingUITests
             LoadingAndSavingRemappingHelper::ApplySingleKeyRemappings(testState, remapBuffer, false);
 
             // Assert that single key remapping in the kbm state variable is empty
-            Assert::AreEqual((size_t)0, testState.singleKeyReMap.size());
+            Assert::AreEqual((size_t)0, testState.GetRemapTablesCopy().singleKeyReMap.size());
         }
 
         // Test if the ApplySingleKeyRemappings method copies only the valid remappings to the keyboard manager state variable when some of the remappings are invalid
@@ -398,7 +437,7 @@ namespace RemappingUITests
             expectedTable[0x41] = 0x42;
             expectedTable[0x42] = s1;
 
-            bool areTablesEqual = (expectedTable == testState.singleKeyReMap);
+            bool areTablesEqual = (expectedTable == testState.GetRemapTablesCopy().singleKeyReMap);
             Assert::AreEqual(true, areTablesEqual);
         }
 
@@ -428,7 +467,7 @@ namespace RemappingUITests
             expectedTable[VK_LWIN] = 0x44;
             expectedTable[VK_RWIN] = 0x44;
 
-            bool areTablesEqual = (expectedTable == testState.singleKeyReMap);
+            bool areTablesEqual = (expectedTable == testState.GetRemapTablesCopy().singleKeyReMap);
             Assert::AreEqual(true, areTablesEqual);
         }
 
@@ -458,8 +497,8 @@ namespace RemappingUITests
             LoadingAndSavingRemappingHelper::ApplyShortcutRemappings(testState, remapBuffer, false);
 
             // Assert that shortcut remappings in the kbm state variable is empty
-            Assert::AreEqual((size_t)0, testState.osLevelShortcutReMap.size());
-            Assert::AreEqual((size_t)0, testState.appSpecificShortcutReMap.size());
+            Assert::AreEqual((size_t)0, testState.GetRemapTablesCopy().osLevelShortcutReMap.size());
+            Assert::AreEqual((size_t)0, testState.GetRemapTablesCopy().appSpecificShortcutReMap.size());
         }
 
         // Test if the ApplyShortcutRemappings method copies only the valid remappings to the keyboard manager state variable when some of the remappings are invalid
@@ -512,10 +551,48 @@ namespace RemappingUITests
             expectedAppSpecificLevelTable[testApp1][src3] = RemapShortcut(dest2);
             expectedAppSpecificLevelTable[testApp1][src4] = RemapShortcut(dest1);
 
-            bool areOSLevelTablesEqual = (expectedOSLevelTable == testState.osLevelShortcutReMap);
-            bool areAppSpecificTablesEqual = (expectedAppSpecificLevelTable == testState.appSpecificShortcutReMap);
+            bool areOSLevelTablesEqual = (expectedOSLevelTable == testState.GetRemapTablesCopy().osLevelShortcutReMap);
+            bool areAppSpecificTablesEqual = (expectedAppSpecificLevelTable == testState.GetRemapTablesCopy().appSpecificShortcutReMap);
             Assert::AreEqual(true, areOSLevelTablesEqual);
             Assert::AreEqual(true, areAppSpecificTablesEqual);
         }
+
+        // Test if the LoadConfigFromJson method replaces the single key remappings while keeping the other remappings
+        TEST_METHOD (LoadConfigFromJson_ShouldReplaceSingleKeyRemappings_OnPassingConfigWithOnlySingleKeyRemappings)
+        {
+            KeyboardManagerState testState;
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+            testState.AddOSLevelShortcut(Shortcut(L"17;65"), Shortcut(L"17;66"));
+
+            // A->C
+            testState.LoadConfigFromJson(json::JsonObject::Parse(LR"({"remapKeys":{"inProcess":[{"originalKeys":"65","newRemapKeys":"67"}]}})"));
+
+            RemapTables tables = testState.GetRemapTablesCopy();
+            Assert::AreEqual((size_t)1, tables.singleKeyReMap.size());
+            Assert::AreEqual((DWORD)0x43, std::get<DWORD>(tables.singleKeyReMap[0x41]));
+            Assert::AreEqual((size_t)1, tables.osLevelShortcutReMap.size());
+        }
+
+        // Test if the remap tables pinned by the hook stay unchanged when they are replaced, and if the new tables are used once they are unpinned
+        TEST_METHOD (PinRemapTables_ShouldKeepPinnedTables_WhenRemapTablesAreReplaced)
+        {
+            KeyboardManagerState testState;
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+
+            {
+                RemapTablesPin pin(testState);
+
+                // A->C
+                testState.LoadConfigFromJson(json::JsonObject::Parse(LR"({"remapKeys":{"inProcess":[{"originalKeys":"65","newRemapKeys":"67"}]}})"));
+
+                auto remapping = testState.GetSingleKeyRemap(0x41);
+                Assert::IsTrue(remapping.has_value());
+                Assert::AreEqual((DWORD)0x42, std::get<DWORD>(remapping.value()->second));
+            }
+
+            auto remapping = testState.GetSingleKeyRemap(0x41);
+            Assert::IsTrue(remapping.has_value());
+            Assert::AreEqual((DWORD)0x43, std::get<DWORD>(remapping.value()->second));
+        }
     };
 }
@@ -1,8 +1,9 @@
 #include "pch.h"
 #include "MockedInput.h"
+#include <keyboardmanager/common/Helpers.h>
 
 // Set the keyboard hook procedure to be tested
-void MockedInput::SetHookProc(std::function<intptr_t(LowlevelKeyboardEvent*)> hookProcedure)
+void MockedInput::SetHookProc(std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> hookProcedure)
 {
     hookProc = hookProcedure;
 }
@@ -40,9 +41,10 @@ UINT MockedInput::SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize)
         }
         KBDLLHOOKSTRUCT lParam = {};
 
-        // Set only vkCode and dwExtraInfo since other values are unused
+        // Set only vkCode, dwExtraInfo and time since other values are unused
         lParam.vkCode = pInputs[i].ki.wVk;
         lParam.dwExtraInfo = pInputs[i].ki.dwExtraInfo;
+        lParam.time = pInputs[i].ki.time;
         keyEvent.lParam = &lParam;
 
         // If the SendVirtualInput call condition is true, increment the count. If no condition is set then always increment the count
@@ -115,7 +117,7 @@ intptr_t MockedInput::MockedKeyboardHook(LowlevelKeyboardEvent* data)
     // If the hookProc is set to null, then skip the hook
     if (hookProc != nullptr)
     {
-        return hookProc(data);
+        return hookProc(KeyboardManagerHelper::ToKeyEvent(*data));
     }
     else
     {
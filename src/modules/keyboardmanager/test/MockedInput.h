@@ -4,6 +4,7 @@
 #include <functional>
 
 #include <common/LowlevelKeyboardEvent.h>
+#include <keyboardmanager/common/KeyboardEvent.h>
 
 // Class for mocked keyboard input
 class MockedInput :
@@ -14,7 +15,7 @@ private:
     std::vector<bool> keyboardState;
 
     // Function to be executed as a low level hook. By default it is nullptr so the hook is skipped
-    std::function<intptr_t(LowlevelKeyboardEvent*)> hookProc;
+    std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> hookProc;
 
     // Stores the count of sendVirtualInput calls given if the condition sendVirtualInputCallCondition is satisfied
     int sendVirtualInputCallCount = 0;
@@ -29,7 +30,7 @@ public:
     }
 
     // Set the keyboard hook procedure to be tested
-    void SetHookProc(std::function<intptr_t(LowlevelKeyboardEvent*)> hookProcedure);
+    void SetHookProc(std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> hookProcedure);
 
     // Function to simulate keyboard input
     UINT SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize);
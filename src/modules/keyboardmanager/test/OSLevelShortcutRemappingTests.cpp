@@ -24,9 +24,9 @@ namespace RemappingLogicTests
             TestHelpers::ResetTestEnv(mockedInputHandler, testState);
 
             // Set HandleOSLevelShortcutRemapEvent as the hook procedure
-            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
-            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
-                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+            std::function<intptr_t(const KeyboardManagerInput::KeyEvent&)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](const KeyboardManagerInput::KeyEvent& data) {
+                if (data.extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
                 {
                     return currentHookProc(data);
                 }
@@ -1318,7 +1318,56 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
+        }
+
+        // Test that the invoked state of a shortcut is kept when the remap tables are replaced while the shortcut is pressed
+        TEST_METHOD (RemappedShortcut_ShouldStayInvoked_OnReplacingRemapTablesWhileShortcutIsPressed)
+        {
+            // Remap Ctrl+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            const int nInputs = 2;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_CONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+
+            // Press Ctrl+A
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            // Remap Ctrl+B to Ctrl+C, which publishes new remap tables
+            Shortcut otherSrc;
+            otherSrc.SetKey(VK_CONTROL);
+            otherSrc.SetKey(0x42);
+            Shortcut otherDest;
+            otherDest.SetKey(VK_CONTROL);
+            otherDest.SetKey(0x43);
+            testState.AddOSLevelShortcut(otherSrc, otherDest);
+
+            // Shortcut invoked state should still be true
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
+
+            input[0].ki.wVk = 0x41;
+            input[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            input[1].ki.wVk = VK_CONTROL;
+            input[1].ki.dwFlags = KEYEVENTF_KEYUP;
+
+            // Release A, then Ctrl
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            // Ctrl, A, V should be false and the shortcut should not be invoked anymore
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if keyboard state is not reverted for a shortcut to a single key remap (target key is a modifier in the shortcut) on key down followed by releasing the action key
@@ -1347,7 +1396,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if keyboard state is not reverted for a shortcut to a single key remap (target key is the action key in the shortcut) on key down followed by releasing the action key
@@ -1376,7 +1425,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if keyboard state is reverted for a shortcut to a single key remap (target key is not a part of the shortcut) on key down followed by releasing the modifier key
@@ -1406,7 +1455,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if keyboard state is reverted for a shortcut to a single key remap (target key is a modifier in the shortcut) on key down followed by releasing the modifier key
@@ -1435,7 +1484,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if keyboard state is reverted for a shortcut to a single key remap (target key is the action key in the shortcut) on key down followed by releasing the modifier key
@@ -1523,7 +1572,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_MENU));
             Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test that remap is not invoked for a shortcut to a single key remap when a larger remapped shortcut to shortcut containing those shortcut keys is invoked
@@ -1620,7 +1669,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = 0x41;
@@ -1635,7 +1684,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if remap is invoked and then reverted to physical keys for a shortcut to a single key remap when the shortcut is invoked along with other keys pressed after it and modifier key is released
@@ -1665,7 +1714,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = VK_CONTROL;
@@ -1680,7 +1729,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if remap is invoked and then reverted to physical keys for a shortcut to a single key remap when the shortcut is invoked and action key is released and then other keys pressed after it
@@ -1710,7 +1759,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = 0x42;
@@ -1725,7 +1774,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test if Windows left key state is set when a shortcut remap to Win both is invoked
@@ -2176,7 +2225,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), true);
 
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Tests for shortcut disable remappings
@@ -2267,7 +2316,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(actionKey), true);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test that shortcut is not disabled if the shortcut which was remapped to Disable is pressed and the action key is released, followed by pressing another key
@@ -2298,7 +2347,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(actionKey), false);
             // Shortcut invoked state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = 0x42;
@@ -2310,7 +2359,7 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(actionKey), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), true);
             // Shortcut invoked state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isShortcutInvoked);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isShortcutInvoked);
         }
 
         // Test that the isOriginalActionKeyPressed flag is set to true on exact match of the shortcut
@@ -2335,7 +2384,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
         }
 
         // Test that the isOriginalActionKeyPressed flag is set to false on releasing the action key
@@ -2360,7 +2409,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = actionKey;
@@ -2370,7 +2419,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
         }
 
         // Test that the isOriginalActionKeyPressed flag is set to true on pressing the action key again after releasing the action key
@@ -2398,7 +2447,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = actionKey;
@@ -2408,7 +2457,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
         }
 
         // Test that the isOriginalActionKeyPressed flag is set to false on releasing the modifier key
@@ -2433,7 +2482,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = VK_CONTROL;
@@ -2443,7 +2492,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
         }
 
         // Test that the isOriginalActionKeyPressed flag is set to false on pressing another key
@@ -2468,7 +2517,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be true
-            Assert::AreEqual(true, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
 
             input[0].type = INPUT_KEYBOARD;
             input[0].ki.wVk = 0x42;
@@ -2478,7 +2527,7 @@ namespace RemappingLogicTests
             mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
 
             // IsOriginalActionKeyPressed state should be false
-            Assert::AreEqual(false, testState.osLevelShortcutReMap[src].isOriginalActionKeyPressed);
+            Assert::AreEqual(false, testState.GetShortcutRemapState(std::nullopt, src).isOriginalActionKeyPressed);
         }
 
         // Tests for dummy key events in shortcut remaps
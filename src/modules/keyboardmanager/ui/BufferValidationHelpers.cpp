@@ -302,4 +302,36 @@ namespace BufferValidationHelpers
 
         return std::make_pair(errorType, dropDownAction);
     }
+
+    // Function to validate a key sequence remapping against the other key sequences and the os level shortcuts in the shortcut remap buffer
+    KeyboardManagerHelper::ErrorType ValidateKeySequence(const KeySequence& keySequence, const std::vector<KeySequence>& otherSequences, const RemapBuffer& shortcutRemapBuffer)
+    {
+        if (!keySequence.IsValidSequence())
+        {
+            return KeyboardManagerHelper::ErrorType::KeySequenceInvalid;
+        }
+
+        // A sequence can't be matched if another sequence is the same or starts with the same steps
+        for (const auto& otherSequence : otherSequences)
+        {
+            if (keySequence.IsPrefixOf(otherSequence) || otherSequence.IsPrefixOf(keySequence))
+            {
+                return KeyboardManagerHelper::ErrorType::ConflictingKeySequence;
+            }
+        }
+
+        // The first steps of a sequence are passed through, so they would be remapped by an os level shortcut remap before the sequence completes
+        for (size_t i = 0; i + 1 < keySequence.steps.size(); i++)
+        {
+            for (const auto& row : shortcutRemapBuffer)
+            {
+                if (row.second == L"" && row.first[0].index() == 1 && std::get<Shortcut>(row.first[0]) == keySequence.steps[i])
+                {
+                    return KeyboardManagerHelper::ErrorType::KeySequenceConflictsWithShortcut;
+                }
+            }
+        }
+
+        return KeyboardManagerHelper::ErrorType::NoError;
+    }
 }
@@ -3,6 +3,7 @@
 #include <variant>
 #include <vector>
 #include "keyboardmanager/common/Shortcut.h"
+#include "keyboardmanager/common/KeySequence.h"
 
 namespace BufferValidationHelpers
 {
@@ -19,4 +20,7 @@ namespace BufferValidationHelpers
 
     // Function to validate an element of the shortcut remap buffer when the selection has changed
     std::pair<KeyboardManagerHelper::ErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound);
+
+    // Function to validate a key sequence remapping against the other key sequences and the os level shortcuts in the shortcut remap buffer
+    KeyboardManagerHelper::ErrorType ValidateKeySequence(const KeySequence& keySequence, const std::vector<KeySequence>& otherSequences, const RemapBuffer& shortcutRemapBuffer);
 }
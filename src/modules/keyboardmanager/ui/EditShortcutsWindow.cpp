@@ -44,6 +44,16 @@ static IAsyncAction OnClickAccept(
             co_return;
         }
     }
+
+    // Key sequences aren't edited in this window, but their steps can conflict with the new os level shortcut remappings
+    isSuccess = LoadingAndSavingRemappingHelper::CheckIfKeySequenceRemappingsAreValid(keyboardManagerState.GetRemapTablesCopy().keySequenceReMap, ShortcutControl::shortcutRemapBuffer);
+    if (isSuccess != KeyboardManagerHelper::ErrorType::NoError)
+    {
+        if (!co_await Dialog::PartialRemappingConfirmationDialog(root, std::wstring(KeyboardManagerHelper::GetErrorMessage(isSuccess))))
+        {
+            co_return;
+        }
+    }
     ApplyRemappings();
 }
 
@@ -198,21 +208,18 @@ void createEditShortcutsWindow(HINSTANCE hInst, KeyboardManagerState& keyboardMa
     // Set keyboard manager UI state so that shortcut remaps are not applied while on this window
     keyboardManagerState.SetUIState(KeyboardManagerUIState::EditShortcutsWindowActivated, _hWndEditShortcutsWindow);
 
-    // Load existing os level shortcuts into UI
     // Create copy of the remaps to avoid concurrent access
-    ShortcutRemapTable osLevelShortcutReMapCopy = keyboardManagerState.osLevelShortcutReMap;
+    RemapTables remapTablesCopy = keyboardManagerState.GetRemapTablesCopy();
 
-    for (const auto& it : osLevelShortcutReMapCopy)
+    // Load existing os level shortcuts into UI
+    for (const auto& it : remapTablesCopy.osLevelShortcutReMap)
     {
         ShortcutControl::AddNewShortcutControlRow(shortcutTable, keyboardRemapControlObjects, it.first, it.second.targetShortcut);
     }
 
     // Load existing app-specific shortcuts into UI
-    // Create copy of the remaps to avoid concurrent access
-    AppSpecificShortcutRemapTable appSpecificShortcutReMapCopy = keyboardManagerState.appSpecificShortcutReMap;
-
     // Iterate through all the apps
-    for (const auto& itApp : appSpecificShortcutReMapCopy)
+    for (const auto& itApp : remapTablesCopy.appSpecificShortcutReMap)
     {
         // Iterate through shortcuts for each app
         for (const auto& itShortcut : itApp.second)
@@ -231,13 +238,10 @@ void createEditShortcutsWindow(HINSTANCE hInst, KeyboardManagerState& keyboardMa
     header.SetLeftOf(applyButton, cancelButton);
 
     auto ApplyRemappings = [&keyboardManagerState, _hWndEditShortcutsWindow]() {
-        // Disable the remappings while the remapping table is updated
-        keyboardManagerState.RemappingsDisabledWrapper(
-            [&keyboardManagerState]() {
-                LoadingAndSavingRemappingHelper::ApplyShortcutRemappings(keyboardManagerState, ShortcutControl::shortcutRemapBuffer, true);
-                // Save the updated key remaps to file.
-                bool saveResult = keyboardManagerState.SaveConfigToFile();
-            });
+        // The new remap tables are published at once, the hook keeps using the previous ones until then
+        LoadingAndSavingRemappingHelper::ApplyShortcutRemappings(keyboardManagerState, ShortcutControl::shortcutRemapBuffer, true);
+        // Save the updated key remaps to file.
+        bool saveResult = keyboardManagerState.SaveConfigToFile();
         PostMessage(_hWndEditShortcutsWindow, WM_CLOSE, 0, 0);
     };
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/common/RemapTables.h>
 #include <variant>
 
 class KeyboardManagerState;
@@ -10,6 +11,9 @@ namespace LoadingAndSavingRemappingHelper
     // Function to check if the set of remappings in the buffer are valid
     KeyboardManagerHelper::ErrorType CheckIfRemappingsAreValid(const RemapBuffer& remappings);
 
+    // Function to check if the key sequence remappings are valid with each other and with the shortcut remappings in the buffer
+    KeyboardManagerHelper::ErrorType CheckIfKeySequenceRemappingsAreValid(const KeySequenceRemapTable& keySequenceRemappings, const RemapBuffer& shortcutRemappings);
+
     // Function to return the set of keys that have been orphaned from the remap buffer
     std::vector<DWORD> GetOrphanedKeys(const RemapBuffer& remappings);
 
@@ -111,6 +111,8 @@ public:
     virtual void destroy() override
     {
         delete this;
+        // Writes what the destructor logged and stops the logging thread before the DLL is unloaded
+        Logger::shutdown();
     }
 
     // Return the localized display name of the powertoy
@@ -127,6 +129,17 @@ public:
 
     // Return JSON with the configuration options.
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -135,7 +148,7 @@ public:
         settings.set_description(GET_RESOURCE_STRING(IDS_LAUNCHER_SETTINGS_DESC));
         settings.set_overview_link(L"https://aka.ms/PowerToysOverview_PowerToysRun");
 
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     // Signal from the Settings editor to call a custom action.
@@ -378,3 +391,8 @@ extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new Microsoft_Launcher();
 }
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
+}
@@ -195,6 +195,17 @@ public:
     // Return JSON with the configuration options.
     // These are the settings shown on the settings page along with their current values.
     virtual bool get_config(_Out_ PWSTR buffer, _Out_ int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -239,7 +250,7 @@ public:
             GET_RESOURCE_STRING(IDS_USE_BOOST_LIB),
             CSettingsInstance().GetUseBoostLib());
 
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     // Passes JSON with the configuration settings for the powertoy.
@@ -307,3 +318,8 @@ extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new PowerRenameModule();
 }
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
+}
@@ -0,0 +1,753 @@
+#include "pch.h"
+#include "StreamingPreviewHandler.h"
+#include <lib/PreviewPolicy.h>
+#include <powerpreview/CLSID.h>
+
+extern HINSTANCE g_hInst;
+
+namespace
+{
+    const wchar_t previewWindowClass[] = L"PowerToys_StreamingPreview";
+    constexpr UINT_PTR indexTimer = 1;
+    constexpr UINT indexTimerInterval = 15;
+
+    // The lines on screen are indexed before they are painted. The rest of the file is indexed in slices which are
+    // short enough to keep the preview pane responsive.
+    constexpr auto firstPageBudget = std::chrono::milliseconds(50);
+    constexpr auto indexSliceBudget = std::chrono::milliseconds(8);
+
+    constexpr int margin = 4;
+    constexpr int wheelLines = 3;
+
+    struct ManagedHandler
+    {
+        const wchar_t* extension;
+        const CLSID* clsid;
+        bool markdown;
+    };
+
+    const ManagedHandler managedHandlers[] = {
+        { L".md", &CLSID_MdPreviewHandler, true },
+        { L".svg", &CLSID_SvgPreviewHandler, false },
+    };
+
+    const wchar_t previewHandlersSubkey[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\PreviewHandlers";
+
+    // A previewer which is turned off in the settings is removed from the approved preview handlers, it must not get
+    // the small files either
+    bool IsApprovedPreviewHandler(const CLSID& clsid)
+    {
+        wchar_t clsidString[39];
+        if (StringFromGUID2(clsid, clsidString, ARRAYSIZE(clsidString)) == 0)
+        {
+            return false;
+        }
+        return RegGetValueW(HKEY_LOCAL_MACHINE, previewHandlersSubkey, clsidString, RRF_RT_REG_SZ, nullptr, nullptr, nullptr) == ERROR_SUCCESS;
+    }
+}
+
+CStreamingPreviewHandler::CStreamingPreviewHandler() :
+    m_backgroundColor(GetSysColor(COLOR_WINDOW)),
+    m_textColor(GetSysColor(COLOR_WINDOWTEXT))
+{
+    ModuleAddRef();
+}
+
+CStreamingPreviewHandler::~CStreamingPreviewHandler()
+{
+    Unload();
+    m_site = nullptr;
+    ModuleRelease();
+}
+
+HRESULT CStreamingPreviewHandler::s_CreateInstance(_In_opt_ IUnknown*, _In_ REFIID riid, _Outptr_ void** ppv)
+{
+    *ppv = nullptr;
+    HRESULT hr = E_OUTOFMEMORY;
+    CStreamingPreviewHandler* handler = new CStreamingPreviewHandler();
+    if (handler)
+    {
+        hr = handler->QueryInterface(riid, ppv);
+        handler->Release();
+    }
+    return hr;
+}
+
+// IInitializeWithFile
+HRESULT CStreamingPreviewHandler::Initialize(LPCWSTR pszFilePath, DWORD grfMode)
+{
+    if (!pszFilePath)
+    {
+        return E_INVALIDARG;
+    }
+    if (!m_filePath.empty())
+    {
+        return HRESULT_FROM_WIN32(ERROR_ALREADY_INITIALIZED);
+    }
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExW(pszFilePath, GetFileExInfoStandard, &attributes))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+    m_filePath = pszFilePath;
+    m_fileSize = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+
+    const CLSID* managedClsid = nullptr;
+    const PCWSTR extension = PathFindExtensionW(pszFilePath);
+    for (const auto& handler : managedHandlers)
+    {
+        if (_wcsicmp(extension, handler.extension) == 0)
+        {
+            managedClsid = handler.clsid;
+            m_markdown = handler.markdown;
+        }
+    }
+
+    // The file is streamed when the managed handler can't preview it or is turned off
+    const bool canDelegate = managedClsid != nullptr && IsApprovedPreviewHandler(*managedClsid);
+    if (ChoosePreviewMode(m_fileSize, canDelegate) == PreviewMode::Delegate)
+    {
+        CreateDelegate(*managedClsid, grfMode);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::CreateDelegate(const CLSID& clsid, DWORD grfMode)
+{
+    CComPtr<IPreviewHandler> handler;
+    HRESULT hr = CoCreateInstance(clsid, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&handler));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // The managed handlers are either file or stream based
+    CComQIPtr<IInitializeWithFile> initializeWithFile(handler.p);
+    CComQIPtr<IInitializeWithStream> initializeWithStream(handler.p);
+    if (initializeWithFile)
+    {
+        hr = initializeWithFile->Initialize(m_filePath.c_str(), grfMode);
+    }
+    else if (initializeWithStream)
+    {
+        CComPtr<IStream> stream;
+        hr = SHCreateStreamOnFileEx(m_filePath.c_str(), STGM_READ | STGM_SHARE_DENY_NONE, FILE_ATTRIBUTE_NORMAL, FALSE, nullptr, &stream);
+        if (SUCCEEDED(hr))
+        {
+            hr = initializeWithStream->Initialize(stream, grfMode);
+        }
+    }
+    else
+    {
+        hr = E_NOINTERFACE;
+    }
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    if (m_site)
+    {
+        CComQIPtr<IObjectWithSite> objectWithSite(handler.p);
+        if (objectWithSite)
+        {
+            objectWithSite->SetSite(m_site);
+        }
+    }
+    m_delegate = handler;
+    return S_OK;
+}
+
+// IObjectWithSite
+HRESULT CStreamingPreviewHandler::SetSite(_In_opt_ IUnknown* punkSite)
+{
+    m_site = punkSite;
+    CComQIPtr<IObjectWithSite> objectWithSite(m_delegate.p);
+    return objectWithSite ? objectWithSite->SetSite(punkSite) : S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::GetSite(_In_ REFIID riid, _COM_Outptr_ void** ppv)
+{
+    *ppv = nullptr;
+    return m_site ? m_site->QueryInterface(riid, ppv) : E_FAIL;
+}
+
+// IOleWindow
+HRESULT CStreamingPreviewHandler::GetWindow(_Out_ HWND* phwnd)
+{
+    CComQIPtr<IOleWindow> oleWindow(m_delegate.p);
+    if (oleWindow)
+    {
+        return oleWindow->GetWindow(phwnd);
+    }
+
+    *phwnd = m_hwndParent;
+    return m_hwndParent ? S_OK : E_FAIL;
+}
+
+// IPreviewHandler
+HRESULT CStreamingPreviewHandler::SetWindow(HWND hwnd, _In_ const RECT* prc)
+{
+    if (!hwnd || !prc)
+    {
+        return E_INVALIDARG;
+    }
+
+    m_hwndParent = hwnd;
+    m_rcParent = *prc;
+    if (m_delegate)
+    {
+        return m_delegate->SetWindow(hwnd, prc);
+    }
+
+    if (m_hwnd)
+    {
+        SetParent(m_hwnd, m_hwndParent);
+        SetRect(prc);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::SetRect(_In_ const RECT* prc)
+{
+    if (!prc)
+    {
+        return E_INVALIDARG;
+    }
+
+    m_rcParent = *prc;
+    if (m_delegate)
+    {
+        return m_delegate->SetRect(prc);
+    }
+
+    if (m_hwnd)
+    {
+        SetWindowPos(m_hwnd, nullptr, prc->left, prc->top, prc->right - prc->left, prc->bottom - prc->top, SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::DoPreview()
+{
+    if (m_delegate)
+    {
+        return m_delegate->DoPreview();
+    }
+    if (m_hwnd)
+    {
+        return S_OK;
+    }
+
+    HRESULT hr = OpenDocument();
+    if (SUCCEEDED(hr))
+    {
+        hr = CreatePreviewWindow();
+    }
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // Only the lines on screen are needed to show the preview
+    IndexVisibleLines(firstPageBudget);
+    UpdateScrollBars();
+    if (!m_document->IsComplete())
+    {
+        SetTimer(m_hwnd, indexTimer, indexTimerInterval, nullptr);
+    }
+
+    ShowWindow(m_hwnd, SW_SHOW);
+    UpdateWindow(m_hwnd);
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::Unload()
+{
+    if (m_delegate)
+    {
+        m_delegate->Unload();
+        m_delegate = nullptr;
+    }
+
+    if (m_hwnd)
+    {
+        KillTimer(m_hwnd, indexTimer);
+        DestroyWindow(m_hwnd);
+        m_hwnd = nullptr;
+    }
+    m_document.reset();
+    m_file.Close();
+
+    if (m_font)
+    {
+        DeleteObject(m_font);
+        m_font = nullptr;
+    }
+    if (m_boldFont)
+    {
+        DeleteObject(m_boldFont);
+        m_boldFont = nullptr;
+    }
+
+    // The handler can be initialized with another file
+    m_filePath.clear();
+    m_fileSize = 0;
+    m_markdown = false;
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::SetFocus()
+{
+    if (m_delegate)
+    {
+        return m_delegate->SetFocus();
+    }
+
+    if (m_hwnd)
+    {
+        ::SetFocus(m_hwnd);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::QueryFocus(_Out_ HWND* phwnd)
+{
+    if (m_delegate)
+    {
+        return m_delegate->QueryFocus(phwnd);
+    }
+
+    *phwnd = GetFocus();
+    return *phwnd ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+}
+
+HRESULT CStreamingPreviewHandler::TranslateAccelerator(_In_ MSG* pmsg)
+{
+    if (m_delegate)
+    {
+        return m_delegate->TranslateAccelerator(pmsg);
+    }
+
+    // The preview doesn't have accelerators, the host may have some
+    CComQIPtr<IPreviewHandlerFrame> frame(m_site.p);
+    return frame ? frame->TranslateAccelerator(pmsg) : S_FALSE;
+}
+
+// IPreviewHandlerVisuals
+HRESULT CStreamingPreviewHandler::SetBackgroundColor(COLORREF color)
+{
+    m_backgroundColor = color;
+    CComQIPtr<IPreviewHandlerVisuals> visuals(m_delegate.p);
+    if (visuals)
+    {
+        return visuals->SetBackgroundColor(color);
+    }
+
+    if (m_hwnd)
+    {
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::SetFont(_In_ const LOGFONTW* plf)
+{
+    if (!plf)
+    {
+        return E_INVALIDARG;
+    }
+
+    m_logFont = *plf;
+    CComQIPtr<IPreviewHandlerVisuals> visuals(m_delegate.p);
+    if (visuals)
+    {
+        return visuals->SetFont(plf);
+    }
+
+    if (m_hwnd)
+    {
+        UpdateFonts();
+        ScrollTo(m_topLine, m_left);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::SetTextColor(COLORREF color)
+{
+    m_textColor = color;
+    CComQIPtr<IPreviewHandlerVisuals> visuals(m_delegate.p);
+    if (visuals)
+    {
+        return visuals->SetTextColor(color);
+    }
+
+    if (m_hwnd)
+    {
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    }
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::OpenDocument()
+{
+    const HRESULT hr = m_file.Open(m_filePath, PreviewLimits{}.streamMaxSize);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    m_document = std::make_unique<StreamingDocument>(m_file.Data(), m_file.Size(), m_markdown);
+    return S_OK;
+}
+
+HRESULT CStreamingPreviewHandler::CreatePreviewWindow()
+{
+    WNDCLASSEXW wc = { sizeof(wc) };
+    wc.lpfnWndProc = s_WndProc;
+    wc.hInstance = g_hInst;
+    wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+    wc.lpszClassName = previewWindowClass;
+    if (!RegisterClassExW(&wc))
+    {
+        const DWORD error = GetLastError();
+        if (error != ERROR_CLASS_ALREADY_EXISTS)
+        {
+            return HRESULT_FROM_WIN32(error);
+        }
+    }
+
+    m_hwnd = CreateWindowExW(0,
+                             previewWindowClass,
+                             nullptr,
+                             WS_CHILD | WS_VSCROLL | WS_HSCROLL,
+                             m_rcParent.left,
+                             m_rcParent.top,
+                             m_rcParent.right - m_rcParent.left,
+                             m_rcParent.bottom - m_rcParent.top,
+                             m_hwndParent,
+                             nullptr,
+                             g_hInst,
+                             this);
+    if (!m_hwnd)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    UpdateFonts();
+    return S_OK;
+}
+
+void CStreamingPreviewHandler::UpdateFonts()
+{
+    if (m_font)
+    {
+        DeleteObject(m_font);
+    }
+    if (m_boldFont)
+    {
+        DeleteObject(m_boldFont);
+    }
+
+    HDC hdc = GetDC(m_hwnd);
+
+    // Keep the size of the font the host asks for, the lines are aligned with a fixed pitch font
+    LOGFONTW logFont = m_logFont;
+    if (logFont.lfHeight == 0)
+    {
+        logFont.lfHeight = -MulDiv(10, GetDeviceCaps(hdc, LOGPIXELSY), 72);
+    }
+    logFont.lfItalic = FALSE;
+    logFont.lfUnderline = FALSE;
+    logFont.lfStrikeOut = FALSE;
+    logFont.lfCharSet = DEFAULT_CHARSET;
+    logFont.lfPitchAndFamily = FIXED_PITCH | FF_MODERN;
+    wcscpy_s(logFont.lfFaceName, L"Consolas");
+
+    logFont.lfWeight = FW_NORMAL;
+    m_font = CreateFontIndirectW(&logFont);
+    logFont.lfWeight = FW_BOLD;
+    m_boldFont = CreateFontIndirectW(&logFont);
+
+    TEXTMETRICW metrics;
+    const HGDIOBJ oldFont = SelectObject(hdc, m_font);
+    if (GetTextMetricsW(hdc, &metrics))
+    {
+        m_lineHeight = (std::max)(1L, metrics.tmHeight + metrics.tmExternalLeading);
+        m_charWidth = (std::max)(1L, metrics.tmAveCharWidth);
+    }
+    SelectObject(hdc, oldFont);
+    ReleaseDC(m_hwnd, hdc);
+}
+
+size_t CStreamingPreviewHandler::VisibleLineCount() const
+{
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    return static_cast<size_t>(rc.bottom / m_lineHeight) + 1;
+}
+
+void CStreamingPreviewHandler::IndexVisibleLines(std::chrono::steady_clock::duration budget)
+{
+    const size_t needed = m_topLine + VisibleLineCount() + 1;
+    if (m_document->LineCount() < needed && !m_document->IsComplete())
+    {
+        m_document->Parse(needed, budget);
+    }
+}
+
+void CStreamingPreviewHandler::UpdateScrollBars()
+{
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    const size_t lineCount = m_document->LineCount();
+    const size_t fullLines = (std::max)(VisibleLineCount() - 1, size_t{ 1 });
+    m_linesPerScrollUnit = lineCount / INT_MAX + 1;
+
+    SCROLLINFO si = { sizeof(si) };
+    si.fMask = SIF_RANGE | SIF_PAGE | SIF_POS;
+    si.nMax = lineCount > 0 ? static_cast<int>((lineCount - 1) / m_linesPerScrollUnit) : 0;
+    si.nPage = static_cast<UINT>((std::max)(fullLines / m_linesPerScrollUnit, size_t{ 1 }));
+    si.nPos = static_cast<int>(m_topLine / m_linesPerScrollUnit);
+    SetScrollInfo(m_hwnd, SB_VERT, &si, TRUE);
+
+    // The lines are wrapped after StreamingDocument::MaxLineLength bytes
+    si.nMax = static_cast<int>(StreamingDocument::MaxLineLength) * m_charWidth + 2 * margin;
+    si.nPage = static_cast<UINT>(rc.right);
+    si.nPos = m_left;
+    SetScrollInfo(m_hwnd, SB_HORZ, &si, TRUE);
+}
+
+void CStreamingPreviewHandler::ScrollTo(size_t line, int left)
+{
+    // The scroll bar only covers the lines indexed so far
+    m_topLine = (std::min)(line, m_document->LineCount());
+    IndexVisibleLines(firstPageBudget);
+
+    const size_t lineCount = m_document->LineCount();
+    const size_t fullLines = (std::max)(VisibleLineCount() - 1, size_t{ 1 });
+    m_topLine = lineCount > fullLines ? (std::min)(m_topLine, lineCount - fullLines) : 0;
+
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    const int maxLeft = (std::max)(0, static_cast<int>(StreamingDocument::MaxLineLength) * m_charWidth + 2 * margin - static_cast<int>(rc.right));
+    m_left = (std::clamp)(left, 0, maxLeft);
+
+    UpdateScrollBars();
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+void CStreamingPreviewHandler::OnPaint()
+{
+    PAINTSTRUCT ps;
+    HDC hdc = BeginPaint(m_hwnd, &ps);
+
+    HBRUSH background = CreateSolidBrush(m_backgroundColor);
+    FillRect(hdc, &ps.rcPaint, background);
+    DeleteObject(background);
+
+    SetBkMode(hdc, TRANSPARENT);
+    const HGDIOBJ oldFont = SelectObject(hdc, m_font);
+
+    // Only the lines in the invalid part of the window are found and converted
+    const size_t firstRow = ps.rcPaint.top / m_lineHeight;
+    const size_t lastRow = (ps.rcPaint.bottom + m_lineHeight - 1) / m_lineHeight;
+    int y = static_cast<int>(firstRow) * m_lineHeight;
+    for (const auto& line : m_document->GetLines(m_topLine + firstRow, lastRow - firstRow))
+    {
+        const int length = MultiByteToWideChar(CP_UTF8, 0, line.text.data(), static_cast<int>(line.text.size()), nullptr, 0);
+        if (length > 0)
+        {
+            m_lineBuffer.resize(length);
+            MultiByteToWideChar(CP_UTF8, 0, line.text.data(), static_cast<int>(line.text.size()), m_lineBuffer.data(), length);
+
+            const bool dimmed = line.kind == LineKind::Quote || line.kind == LineKind::CodeFence;
+            SelectObject(hdc, line.kind == LineKind::Heading ? m_boldFont : m_font);
+            ::SetTextColor(hdc, dimmed ? GetSysColor(COLOR_GRAYTEXT) : m_textColor);
+            TabbedTextOutW(hdc, margin - m_left, y, m_lineBuffer.c_str(), length, 0, nullptr, margin - m_left);
+        }
+        y += m_lineHeight;
+    }
+
+    SelectObject(hdc, oldFont);
+    EndPaint(m_hwnd, &ps);
+}
+
+void CStreamingPreviewHandler::OnTimer()
+{
+    if (m_document->Parse(SIZE_MAX, indexSliceBudget))
+    {
+        KillTimer(m_hwnd, indexTimer);
+    }
+    UpdateScrollBars();
+}
+
+void CStreamingPreviewHandler::OnVScroll(WORD request)
+{
+    const size_t page = (std::max)(VisibleLineCount() - 1, size_t{ 1 });
+    size_t line = m_topLine;
+    switch (request)
+    {
+    case SB_LINEUP:
+        line -= (std::min)(line, size_t{ 1 });
+        break;
+    case SB_LINEDOWN:
+        line++;
+        break;
+    case SB_PAGEUP:
+        line -= (std::min)(line, page);
+        break;
+    case SB_PAGEDOWN:
+        line += page;
+        break;
+    case SB_TOP:
+        line = 0;
+        break;
+    case SB_BOTTOM:
+        line = SIZE_MAX;
+        break;
+    case SB_THUMBTRACK:
+    case SB_THUMBPOSITION:
+    {
+        SCROLLINFO si = { sizeof(si), SIF_TRACKPOS };
+        GetScrollInfo(m_hwnd, SB_VERT, &si);
+        line = static_cast<size_t>(si.nTrackPos) * m_linesPerScrollUnit;
+        break;
+    }
+    default:
+        return;
+    }
+    ScrollTo(line, m_left);
+}
+
+void CStreamingPreviewHandler::OnHScroll(WORD request)
+{
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    int left = m_left;
+    switch (request)
+    {
+    case SB_LINELEFT:
+        left -= m_charWidth;
+        break;
+    case SB_LINERIGHT:
+        left += m_charWidth;
+        break;
+    case SB_PAGELEFT:
+        left -= rc.right;
+        break;
+    case SB_PAGERIGHT:
+        left += rc.right;
+        break;
+    case SB_LEFT:
+        left = 0;
+        break;
+    case SB_RIGHT:
+        left = INT_MAX;
+        break;
+    case SB_THUMBTRACK:
+    case SB_THUMBPOSITION:
+    {
+        SCROLLINFO si = { sizeof(si), SIF_TRACKPOS };
+        GetScrollInfo(m_hwnd, SB_HORZ, &si);
+        left = si.nTrackPos;
+        break;
+    }
+    default:
+        return;
+    }
+    ScrollTo(m_topLine, left);
+}
+
+void CStreamingPreviewHandler::OnMouseWheel(short delta)
+{
+    const int lines = -delta * wheelLines / WHEEL_DELTA;
+    const size_t line = lines < 0 ? m_topLine - (std::min)(m_topLine, static_cast<size_t>(-lines)) : m_topLine + lines;
+    ScrollTo(line, m_left);
+}
+
+void CStreamingPreviewHandler::OnKeyDown(WPARAM key)
+{
+    switch (key)
+    {
+    case VK_UP:
+        OnVScroll(SB_LINEUP);
+        break;
+    case VK_DOWN:
+        OnVScroll(SB_LINEDOWN);
+        break;
+    case VK_PRIOR:
+        OnVScroll(SB_PAGEUP);
+        break;
+    case VK_NEXT:
+        OnVScroll(SB_PAGEDOWN);
+        break;
+    case VK_HOME:
+        OnVScroll(SB_TOP);
+        break;
+    case VK_END:
+        OnVScroll(SB_BOTTOM);
+        break;
+    case VK_LEFT:
+        OnHScroll(SB_LINELEFT);
+        break;
+    case VK_RIGHT:
+        OnHScroll(SB_LINERIGHT);
+        break;
+    }
+}
+
+LRESULT CALLBACK CStreamingPreviewHandler::s_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    if (msg == WM_NCCREATE)
+    {
+        const auto createStruct = reinterpret_cast<CREATESTRUCTW*>(lParam);
+        SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(createStruct->lpCreateParams));
+    }
+
+    auto handler = reinterpret_cast<CStreamingPreviewHandler*>(GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+    if (handler && handler->m_document)
+    {
+        switch (msg)
+        {
+        case WM_PAINT:
+            handler->OnPaint();
+            return 0;
+        case WM_ERASEBKGND:
+            // The whole window is painted in WM_PAINT
+            return 1;
+        case WM_SIZE:
+            handler->ScrollTo(handler->m_topLine, handler->m_left);
+            return 0;
+        case WM_VSCROLL:
+            handler->OnVScroll(LOWORD(wParam));
+            return 0;
+        case WM_HSCROLL:
+            handler->OnHScroll(LOWORD(wParam));
+            return 0;
+        case WM_MOUSEWHEEL:
+            handler->OnMouseWheel(GET_WHEEL_DELTA_WPARAM(wParam));
+            return 0;
+        case WM_KEYDOWN:
+            handler->OnKeyDown(wParam);
+            return 0;
+        case WM_GETDLGCODE:
+            return DLGC_WANTARROWS;
+        case WM_LBUTTONDOWN:
+            ::SetFocus(hwnd);
+            return 0;
+        case WM_TIMER:
+            if (wParam == indexTimer)
+            {
+                handler->OnTimer();
+                return 0;
+            }
+            break;
+        case WM_NCDESTROY:
+            SetWindowLongPtrW(hwnd, GWLP_USERDATA, 0);
+            break;
+        }
+    }
+    return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
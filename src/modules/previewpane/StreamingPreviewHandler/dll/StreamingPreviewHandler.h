@@ -0,0 +1,135 @@
+#pragma once
+#include "pch.h"
+#include <lib/MappedFile.h>
+#include <lib/StreamingDocument.h>
+
+// Preview handler for large text based files. Files which are small enough are previewed by the managed handler of
+// their type, which renders them fully. Larger files are mapped in memory and previewed as text: the lines on screen
+// are indexed and drawn first, and the rest of the file is indexed in short slices on a timer, so the preview pane
+// never waits for the whole file.
+class __declspec(uuid("7DA28B95-99A7-4077-9C25-EF2B4F709E3C")) CStreamingPreviewHandler :
+    public IInitializeWithFile,
+    public IObjectWithSite,
+    public IOleWindow,
+    public IPreviewHandler,
+    public IPreviewHandlerVisuals
+{
+public:
+    CStreamingPreviewHandler();
+
+    // IUnknown
+    IFACEMETHODIMP QueryInterface(_In_ REFIID riid, _COM_Outptr_ void** ppv)
+    {
+        static const QITAB qit[] = {
+            QITABENT(CStreamingPreviewHandler, IInitializeWithFile),
+            QITABENT(CStreamingPreviewHandler, IObjectWithSite),
+            QITABENT(CStreamingPreviewHandler, IOleWindow),
+            QITABENT(CStreamingPreviewHandler, IPreviewHandler),
+            QITABENT(CStreamingPreviewHandler, IPreviewHandlerVisuals),
+            { 0, 0 },
+        };
+        return QISearch(this, qit, riid, ppv);
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    Release()
+    {
+        LONG refCount = --m_refCount;
+        if (refCount == 0)
+        {
+            delete this;
+        }
+        return refCount;
+    }
+
+    // IInitializeWithFile
+    IFACEMETHODIMP Initialize(LPCWSTR pszFilePath, DWORD grfMode);
+
+    // IObjectWithSite
+    IFACEMETHODIMP SetSite(_In_opt_ IUnknown* punkSite);
+    IFACEMETHODIMP GetSite(_In_ REFIID riid, _COM_Outptr_ void** ppv);
+
+    // IOleWindow
+    IFACEMETHODIMP GetWindow(_Out_ HWND* phwnd);
+    IFACEMETHODIMP ContextSensitiveHelp(BOOL)
+    {
+        return E_NOTIMPL;
+    }
+
+    // IPreviewHandler
+    IFACEMETHODIMP SetWindow(HWND hwnd, _In_ const RECT* prc);
+    IFACEMETHODIMP SetRect(_In_ const RECT* prc);
+    IFACEMETHODIMP DoPreview();
+    IFACEMETHODIMP Unload();
+    IFACEMETHODIMP SetFocus();
+    IFACEMETHODIMP QueryFocus(_Out_ HWND* phwnd);
+    IFACEMETHODIMP TranslateAccelerator(_In_ MSG* pmsg);
+
+    // IPreviewHandlerVisuals
+    IFACEMETHODIMP SetBackgroundColor(COLORREF color);
+    IFACEMETHODIMP SetFont(_In_ const LOGFONTW* plf);
+    IFACEMETHODIMP SetTextColor(COLORREF color);
+
+    static HRESULT s_CreateInstance(_In_opt_ IUnknown* punkOuter, _In_ REFIID riid, _Outptr_ void** ppv);
+
+private:
+    ~CStreamingPreviewHandler();
+
+    HRESULT CreateDelegate(const CLSID& clsid, DWORD grfMode);
+    HRESULT OpenDocument();
+    HRESULT CreatePreviewWindow();
+    void UpdateFonts();
+    void UpdateScrollBars();
+    void ScrollTo(size_t line, int column);
+    void IndexVisibleLines(std::chrono::steady_clock::duration budget);
+    size_t VisibleLineCount() const;
+
+    void OnPaint();
+    void OnTimer();
+    void OnVScroll(WORD request);
+    void OnHScroll(WORD request);
+    void OnMouseWheel(short delta);
+    void OnKeyDown(WPARAM key);
+
+    static LRESULT CALLBACK s_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    std::atomic<long> m_refCount = 1;
+    std::wstring m_filePath;
+    uint64_t m_fileSize = 0;
+    bool m_markdown = false;
+
+    CComPtr<IUnknown> m_site;
+    HWND m_hwndParent = nullptr;
+    RECT m_rcParent = {};
+
+    // The managed handler the preview is forwarded to, when the file is small enough for it
+    CComPtr<IPreviewHandler> m_delegate;
+
+    MappedFile m_file;
+    std::unique_ptr<StreamingDocument> m_document;
+
+    HWND m_hwnd = nullptr;
+    HFONT m_font = nullptr;
+    HFONT m_boldFont = nullptr;
+    LOGFONTW m_logFont = {};
+    int m_lineHeight = 16;
+    int m_charWidth = 8;
+    COLORREF m_backgroundColor;
+    COLORREF m_textColor;
+
+    // The first line and the horizontal offset in pixels at the top left corner of the window
+    size_t m_topLine = 0;
+    int m_left = 0;
+
+    // A scroll bar position is an int, so a file with more lines than that scrolls by several lines per unit
+    size_t m_linesPerScrollUnit = 1;
+
+    // Reused to convert the visible lines to UTF-16
+    std::wstring m_lineBuffer;
+};
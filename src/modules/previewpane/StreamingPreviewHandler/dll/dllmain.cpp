@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "StreamingPreviewHandler.h"
+
+std::atomic<DWORD> g_dwModuleRefCount = 0;
+HINSTANCE g_hInst = 0;
+
+class CStreamingPreviewClassFactory : public IClassFactory
+{
+public:
+    CStreamingPreviewClassFactory(_In_ REFCLSID clsid) :
+        m_refCount(1),
+        m_clsid(clsid)
+    {
+        ModuleAddRef();
+    }
+
+    // IUnknown methods
+    IFACEMETHODIMP QueryInterface(_In_ REFIID riid, _COM_Outptr_ void** ppv)
+    {
+        static const QITAB qit[] = {
+            QITABENT(CStreamingPreviewClassFactory, IClassFactory),
+            { 0 }
+        };
+        return QISearch(this, qit, riid, ppv);
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    Release()
+    {
+        LONG refCount = --m_refCount;
+        if (refCount == 0)
+        {
+            delete this;
+        }
+        return refCount;
+    }
+
+    // IClassFactory methods
+    IFACEMETHODIMP CreateInstance(_In_opt_ IUnknown* punkOuter, _In_ REFIID riid, _Outptr_ void** ppv)
+    {
+        *ppv = NULL;
+        HRESULT hr;
+        if (punkOuter)
+        {
+            hr = CLASS_E_NOAGGREGATION;
+        }
+        else if (m_clsid == __uuidof(CStreamingPreviewHandler))
+        {
+            hr = CStreamingPreviewHandler::s_CreateInstance(punkOuter, riid, ppv);
+        }
+        else
+        {
+            hr = CLASS_E_CLASSNOTAVAILABLE;
+        }
+        return hr;
+    }
+
+    IFACEMETHODIMP LockServer(BOOL bLock)
+    {
+        if (bLock)
+        {
+            ModuleAddRef();
+        }
+        else
+        {
+            ModuleRelease();
+        }
+        return S_OK;
+    }
+
+private:
+    ~CStreamingPreviewClassFactory()
+    {
+        ModuleRelease();
+    }
+
+    std::atomic<long> m_refCount;
+    CLSID m_clsid;
+};
+
+BOOL WINAPI DllMain(HINSTANCE hInstance, DWORD dwReason, void*)
+{
+    if (dwReason == DLL_PROCESS_ATTACH)
+    {
+        g_hInst = hInstance;
+        DisableThreadLibraryCalls(hInstance);
+    }
+    return TRUE;
+}
+
+//
+// Checks if there are any external references to this module
+//
+STDAPI DllCanUnloadNow(void)
+{
+    return (g_dwModuleRefCount == 0) ? S_OK : S_FALSE;
+}
+
+//
+// DLL export for creating COM objects
+//
+STDAPI DllGetClassObject(_In_ REFCLSID clsid, _In_ REFIID riid, _Outptr_ void** ppv)
+{
+    *ppv = NULL;
+    CStreamingPreviewClassFactory* pClassFactory = new CStreamingPreviewClassFactory(clsid);
+    HRESULT hr = pClassFactory->QueryInterface(riid, ppv);
+    pClassFactory->Release();
+    return hr;
+}
+
+// The handler is registered by the installer, and enabled by the File Explorer module of PowerToys
+STDAPI DllRegisterServer()
+{
+    return S_OK;
+}
+
+STDAPI DllUnregisterServer()
+{
+    return S_OK;
+}
+
+void ModuleAddRef()
+{
+    g_dwModuleRefCount++;
+}
+
+void ModuleRelease()
+{
+    g_dwModuleRefCount--;
+}
@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+HRESULT MappedFile::Open(const std::wstring& path, uint64_t maxBytes)
+{
+    Close();
+
+    // Don't lock the file, a log which is being written can be previewed too
+    file.attach(CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!file)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    LARGE_INTEGER length{};
+    if (!GetFileSizeEx(file.get(), &length))
+    {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        Close();
+        return hr;
+    }
+    fileSize = static_cast<uint64_t>(length.QuadPart);
+
+    // An empty file can't be mapped, and there is nothing to preview anyway
+    if (fileSize == 0 || maxBytes == 0)
+    {
+        return S_OK;
+    }
+
+    mapping.attach(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!mapping)
+    {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        Close();
+        return hr;
+    }
+
+    const uint64_t mappedBytes = (std::min)(fileSize, maxBytes);
+    data = static_cast<const char*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(mappedBytes)));
+    if (!data)
+    {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        Close();
+        return hr;
+    }
+    size = static_cast<size_t>(mappedBytes);
+    return S_OK;
+}
+
+void MappedFile::Close()
+{
+    if (data)
+    {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+    size = 0;
+    fileSize = 0;
+    mapping.close();
+    file.close();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// A read-only view of a file mapped in memory, so a preview can parse the file in place instead of reading it into a buffer.
+// Only the first maxBytes of the file are mapped, the rest of a larger file is left out of the preview.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    HRESULT Open(const std::wstring& path, uint64_t maxBytes = UINT64_MAX);
+    void Close();
+
+    const char* Data() const
+    {
+        return data;
+    }
+
+    // Number of bytes mapped, which is less than the file size when the file is truncated
+    size_t Size() const
+    {
+        return size;
+    }
+
+    uint64_t FileSize() const
+    {
+        return fileSize;
+    }
+
+    bool IsTruncated() const
+    {
+        return size < fileSize;
+    }
+
+private:
+    winrt::file_handle file;
+    winrt::handle mapping;
+    const char* data = nullptr;
+    size_t size = 0;
+    uint64_t fileSize = 0;
+};
@@ -0,0 +1,7 @@
+#include "pch.h"
+#include "PreviewPolicy.h"
+
+PreviewMode ChoosePreviewMode(uint64_t fileSize, bool canDelegate, const PreviewLimits& limits)
+{
+    return canDelegate && fileSize <= limits.delegateMaxSize ? PreviewMode::Delegate : PreviewMode::Stream;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+enum class PreviewMode
+{
+    // The file is small enough for the managed preview handler of its type, which renders it fully
+    Delegate,
+
+    // The file is mapped in memory and its lines are indexed and displayed as the preview needs them
+    Stream,
+};
+
+struct PreviewLimits
+{
+    // Largest file which is previewed by the managed handler of its type
+    uint64_t delegateMaxSize = 2 * 1024 * 1024;
+
+    // Only this much of a larger file is mapped and previewed
+    uint64_t streamMaxSize = 16ull * 1024 * 1024 * 1024;
+};
+
+PreviewMode ChoosePreviewMode(uint64_t fileSize, bool canDelegate, const PreviewLimits& limits = {});
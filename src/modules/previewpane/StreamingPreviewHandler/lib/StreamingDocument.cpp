@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "StreamingDocument.h"
+
+namespace
+{
+    // The clock is only read every few lines, it costs more than finding a line
+    constexpr size_t linesPerClockCheck = 1024;
+
+    bool IsContinuationByte(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    bool StartsWith(std::string_view text, std::string_view prefix)
+    {
+        return text.substr(0, prefix.size()) == prefix;
+    }
+}
+
+StreamingDocument::StreamingDocument(const char* data, size_t size, bool markdown) :
+    data(data), size(size), markdown(markdown)
+{
+    // Skip the UTF-8 byte order mark
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+    {
+        cursor.offset = 3;
+    }
+}
+
+bool StreamingDocument::Parse(size_t targetLineCount, std::chrono::steady_clock::duration budget)
+{
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    while (!IsComplete() && lineCount < targetLineCount)
+    {
+        if (lineCount % CheckpointInterval == 0)
+        {
+            checkpoints.push_back(cursor);
+        }
+        ScanLine(cursor);
+        lineCount++;
+
+        if (lineCount % linesPerClockCheck == 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+    return IsComplete();
+}
+
+std::vector<DocumentLine> StreamingDocument::GetLines(size_t first, size_t count) const
+{
+    std::vector<DocumentLine> lines;
+    if (first >= lineCount)
+    {
+        return lines;
+    }
+    count = (std::min)(count, lineCount - first);
+    lines.reserve(count);
+
+    // Find the first line again from the closest checkpoint before it
+    Cursor position = checkpoints[first / CheckpointInterval];
+    for (size_t line = first / CheckpointInterval * CheckpointInterval; line < first; line++)
+    {
+        ScanLine(position);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        lines.push_back(ScanLine(position));
+    }
+    return lines;
+}
+
+DocumentLine StreamingDocument::ScanLine(Cursor& position) const
+{
+    const size_t begin = position.offset;
+    const size_t limit = (std::min)(size - begin, MaxLineLength);
+    const char* lineBreak = static_cast<const char*>(std::memchr(data + begin, '\n', limit));
+
+    size_t end;
+    size_t next;
+    bool wrapped = false;
+    if (lineBreak)
+    {
+        end = lineBreak - data;
+        next = end + 1;
+        if (end > begin && data[end - 1] == '\r')
+        {
+            end--;
+        }
+    }
+    else if (begin + limit == size)
+    {
+        end = size;
+        next = size;
+    }
+    else
+    {
+        // Wrap the line, without splitting a UTF-8 sequence
+        end = begin + limit;
+        while (end > begin && IsContinuationByte(data[end]))
+        {
+            end--;
+        }
+        if (end == begin)
+        {
+            end = begin + limit;
+        }
+        next = end;
+        wrapped = true;
+    }
+
+    const std::string_view text(data + begin, end - begin);
+    const LineKind kind = Classify(text, position);
+    position.offset = next;
+    position.continuation = wrapped;
+    return { text, kind };
+}
+
+LineKind StreamingDocument::Classify(std::string_view text, Cursor& position) const
+{
+    if (!markdown)
+    {
+        return LineKind::Text;
+    }
+    if (position.continuation)
+    {
+        return position.inCodeBlock ? LineKind::Code : LineKind::Text;
+    }
+
+    // Up to three spaces of indentation don't change the type of a block
+    size_t indent = 0;
+    while (indent < text.size() && indent < 4 && text[indent] == ' ')
+    {
+        indent++;
+    }
+    if (indent == 4 || StartsWith(text, "\t"))
+    {
+        return LineKind::Code;
+    }
+
+    const std::string_view block = text.substr(indent);
+    if (StartsWith(block, "```") || StartsWith(block, "~~~"))
+    {
+        position.inCodeBlock = !position.inCodeBlock;
+        return LineKind::CodeFence;
+    }
+    if (position.inCodeBlock)
+    {
+        return LineKind::Code;
+    }
+
+    if (StartsWith(block, "#"))
+    {
+        const size_t level = (std::min)(block.find_first_not_of('#'), block.size());
+        if (level <= 6 && (level == block.size() || block[level] == ' ' || block[level] == '\t'))
+        {
+            return LineKind::Heading;
+        }
+    }
+    if (StartsWith(block, ">"))
+    {
+        return LineKind::Quote;
+    }
+    if (StartsWith(block, "- ") || StartsWith(block, "* ") || StartsWith(block, "+ "))
+    {
+        return LineKind::ListItem;
+    }
+
+    const size_t digits = (std::min)(block.find_first_not_of("0123456789"), block.size());
+    if (digits > 0 && digits < 10 && digits + 1 < block.size() && (block[digits] == '.' || block[digits] == ')') && block[digits + 1] == ' ')
+    {
+        return LineKind::ListItem;
+    }
+    return LineKind::Text;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+enum class LineKind
+{
+    Text,
+    Heading,
+    Quote,
+    ListItem,
+    CodeFence,
+    Code,
+};
+
+struct DocumentLine
+{
+    // UTF-8 text of the line, without the line break. It points into the document.
+    std::string_view text;
+    LineKind kind;
+};
+
+// Splits a UTF-8 document which is mapped in memory into lines, incrementally, so a preview can show the first lines of a
+// huge file right away and index the rest of it in short time slices. The document is never copied, and only the start
+// of every CheckpointInterval-th line is kept, so the index of a file with millions of lines stays small. The lines in
+// between are found again when they are displayed. Lines longer than MaxLineLength bytes are wrapped, so a file without
+// line breaks, like a minified SVG, can be displayed too.
+class StreamingDocument
+{
+public:
+    static constexpr size_t CheckpointInterval = 64;
+    static constexpr size_t MaxLineLength = 1024;
+
+    // Markdown documents get their lines classified by block type, other documents are plain text
+    StreamingDocument(const char* data, size_t size, bool markdown);
+
+    // Indexes lines until lineCount lines are known, the whole document is indexed or the budget is spent.
+    // Returns true once the whole document is indexed.
+    bool Parse(size_t lineCount, std::chrono::steady_clock::duration budget);
+
+    // Number of lines indexed so far
+    size_t LineCount() const
+    {
+        return lineCount;
+    }
+
+    size_t ParsedBytes() const
+    {
+        return cursor.offset;
+    }
+
+    bool IsComplete() const
+    {
+        return cursor.offset >= size;
+    }
+
+    // Returns the indexed lines in [first, first + count)
+    std::vector<DocumentLine> GetLines(size_t first, size_t count) const;
+
+private:
+    // Parser state at the start of a line
+    struct Cursor
+    {
+        size_t offset = 0;
+        bool inCodeBlock = false;
+
+        // The previous line was wrapped, this one continues it
+        bool continuation = false;
+    };
+
+    DocumentLine ScanLine(Cursor& cursor) const;
+    LineKind Classify(std::string_view text, Cursor& cursor) const;
+
+    const char* data;
+    size_t size;
+    bool markdown;
+    std::vector<Cursor> checkpoints;
+    Cursor cursor;
+    size_t lineCount = 0;
+};
@@ -0,0 +1,102 @@
+#include "pch.h"
+#include "lib/MappedFile.h"
+#include "lib/PreviewPolicy.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace StreamingPreviewUnitTests
+{
+    TEST_CLASS (MappedFileTests)
+    {
+        std::filesystem::path folder;
+
+        std::wstring WriteFile(const std::wstring& name, const std::string& content)
+        {
+            const auto path = folder / name;
+            std::ofstream(path, std::ios::binary) << content;
+            return path.wstring();
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Initialize)
+        {
+            folder = std::filesystem::temp_directory_path() / L"StreamingPreviewUnitTests";
+            std::filesystem::create_directories(folder);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::filesystem::remove_all(folder);
+        }
+
+        TEST_METHOD (Open_ShouldMapWholeFile)
+        {
+            const auto path = WriteFile(L"file.txt", "first\nsecond\n");
+            MappedFile file;
+            Assert::AreEqual(S_OK, file.Open(path));
+            Assert::AreEqual(std::string("first\nsecond\n"), std::string(file.Data(), file.Size()));
+            Assert::IsFalse(file.IsTruncated());
+        }
+
+        TEST_METHOD (Open_ShouldMapFirstBytes_WhenFileIsLarger)
+        {
+            const auto path = WriteFile(L"file.txt", "first\nsecond\n");
+            MappedFile file;
+            Assert::AreEqual(S_OK, file.Open(path, 5));
+            Assert::AreEqual(std::string("first"), std::string(file.Data(), file.Size()));
+            Assert::AreEqual(uint64_t{ 13 }, file.FileSize());
+            Assert::IsTrue(file.IsTruncated());
+        }
+
+        TEST_METHOD (Open_ShouldSucceed_WhenFileIsEmpty)
+        {
+            const auto path = WriteFile(L"empty.txt", "");
+            MappedFile file;
+            Assert::AreEqual(S_OK, file.Open(path));
+            Assert::AreEqual(size_t{ 0 }, file.Size());
+            Assert::IsNull(file.Data());
+        }
+
+        TEST_METHOD (Open_ShouldFail_WhenFileIsMissing)
+        {
+            MappedFile file;
+            Assert::AreEqual(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), file.Open((folder / L"missing.txt").wstring()));
+            Assert::IsNull(file.Data());
+        }
+
+        TEST_METHOD (Open_ShouldNotLockFile)
+        {
+            const auto path = WriteFile(L"file.txt", "first\n");
+            MappedFile file;
+            Assert::AreEqual(S_OK, file.Open(path));
+
+            // A log which is previewed can still be written
+            std::ofstream writer(path, std::ios::binary | std::ios::app);
+            writer << "second\n";
+            Assert::IsTrue(writer.good());
+        }
+    };
+
+    TEST_CLASS (PreviewPolicyTests)
+    {
+    public:
+        TEST_METHOD (ChoosePreviewMode_ShouldDelegateSmallFiles)
+        {
+            const PreviewLimits limits;
+            Assert::IsTrue(ChoosePreviewMode(0, true) == PreviewMode::Delegate);
+            Assert::IsTrue(ChoosePreviewMode(limits.delegateMaxSize, true) == PreviewMode::Delegate);
+            Assert::IsTrue(ChoosePreviewMode(limits.delegateMaxSize + 1, true) == PreviewMode::Stream);
+        }
+
+        TEST_METHOD (ChoosePreviewMode_ShouldStream_WhenThereIsNoHandlerToDelegateTo)
+        {
+            Assert::IsTrue(ChoosePreviewMode(10, false) == PreviewMode::Stream);
+
+            PreviewLimits limits;
+            limits.delegateMaxSize = 0;
+            Assert::IsTrue(ChoosePreviewMode(10, true, limits) == PreviewMode::Stream);
+        }
+    };
+}
@@ -0,0 +1,270 @@
+#include "pch.h"
+#include "lib/MappedFile.h"
+#include "lib/StreamingDocument.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace StreamingPreviewUnitTests
+{
+    namespace
+    {
+        constexpr auto noBudget = std::chrono::hours(1);
+
+        std::vector<std::string> Lines(const StreamingDocument& document, size_t first, size_t count)
+        {
+            std::vector<std::string> lines;
+            for (const auto& line : document.GetLines(first, count))
+            {
+                lines.emplace_back(line.text);
+            }
+            return lines;
+        }
+
+        std::vector<LineKind> Kinds(const std::string& text)
+        {
+            StreamingDocument document(text.data(), text.size(), true);
+            document.Parse(SIZE_MAX, noBudget);
+            std::vector<LineKind> kinds;
+            for (const auto& line : document.GetLines(0, document.LineCount()))
+            {
+                kinds.push_back(line.kind);
+            }
+            return kinds;
+        }
+
+        // Writes size bytes made of chunk repeated, in chunks so the file is never held in memory
+        void WriteFile(const std::filesystem::path& path, const std::string& chunk, uint64_t size)
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (uint64_t written = 0; written < size; written += chunk.size())
+            {
+                file.write(chunk.data(), static_cast<std::streamsize>((std::min)(uint64_t{ chunk.size() }, size - written)));
+            }
+        }
+
+        // Deletes the folder and its content when it goes out of scope, including when an assertion fails
+        struct TemporaryFolder
+        {
+            const std::filesystem::path path;
+
+            explicit TemporaryFolder(const wchar_t* name) :
+                path(std::filesystem::temp_directory_path() / name)
+            {
+                std::filesystem::create_directories(path);
+            }
+
+            ~TemporaryFolder()
+            {
+                std::error_code error;
+                std::filesystem::remove_all(path, error);
+            }
+        };
+    }
+
+    TEST_CLASS (StreamingDocumentTests)
+    {
+    public:
+        TEST_METHOD (Parse_ShouldSplitLines)
+        {
+            const std::string text = "first\r\nsecond\n\nlast";
+            StreamingDocument document(text.data(), text.size(), false);
+            Assert::IsTrue(document.Parse(SIZE_MAX, noBudget));
+            Assert::AreEqual(size_t{ 4 }, document.LineCount());
+            Assert::IsTrue(Lines(document, 0, 10) == std::vector<std::string>{ "first", "second", "", "last" });
+        }
+
+        TEST_METHOD (Parse_ShouldSkipByteOrderMark)
+        {
+            const std::string text = "\xEF\xBB\xBF"
+                                     "first\n";
+            StreamingDocument document(text.data(), text.size(), false);
+            document.Parse(SIZE_MAX, noBudget);
+            Assert::IsTrue(Lines(document, 0, 10) == std::vector<std::string>{ "first" });
+        }
+
+        TEST_METHOD (Parse_ShouldHandleEmptyDocument)
+        {
+            StreamingDocument document(nullptr, 0, true);
+            Assert::IsTrue(document.Parse(SIZE_MAX, noBudget));
+            Assert::AreEqual(size_t{ 0 }, document.LineCount());
+            Assert::IsTrue(document.GetLines(0, 10).empty());
+        }
+
+        TEST_METHOD (Parse_ShouldStopAtRequestedLineCount)
+        {
+            std::string text;
+            for (int i = 0; i < 1000; i++)
+            {
+                text += "line " + std::to_string(i) + "\n";
+            }
+
+            StreamingDocument document(text.data(), text.size(), false);
+            Assert::IsFalse(document.Parse(100, noBudget));
+            Assert::AreEqual(size_t{ 100 }, document.LineCount());
+            Assert::IsTrue(document.ParsedBytes() < text.size());
+
+            Assert::IsTrue(document.Parse(SIZE_MAX, noBudget));
+            Assert::AreEqual(size_t{ 1000 }, document.LineCount());
+            Assert::AreEqual(text.size(), document.ParsedBytes());
+        }
+
+        TEST_METHOD (Parse_ShouldStop_WhenBudgetIsSpent)
+        {
+            const std::string text(10'000'000, '\n');
+            StreamingDocument document(text.data(), text.size(), false);
+            Assert::IsFalse(document.Parse(SIZE_MAX, std::chrono::steady_clock::duration::zero()));
+
+            // The clock is only checked every few lines, but the parser can resume where it stopped
+            Assert::IsTrue(document.LineCount() > 0 && document.LineCount() < text.size());
+            Assert::IsTrue(document.Parse(SIZE_MAX, noBudget));
+            Assert::AreEqual(text.size(), document.LineCount());
+        }
+
+        TEST_METHOD (GetLines_ShouldFindLinesBetweenCheckpoints)
+        {
+            std::string text;
+            for (int i = 0; i < 1000; i++)
+            {
+                text += "line " + std::to_string(i) + "\n";
+            }
+
+            StreamingDocument document(text.data(), text.size(), false);
+            document.Parse(SIZE_MAX, noBudget);
+            for (size_t first : { size_t{ 0 }, StreamingDocument::CheckpointInterval - 1, StreamingDocument::CheckpointInterval, size_t{ 777 }, size_t{ 998 } })
+            {
+                const auto lines = Lines(document, first, 3);
+                for (size_t i = 0; i < lines.size(); i++)
+                {
+                    Assert::AreEqual("line " + std::to_string(first + i), lines[i]);
+                }
+            }
+            Assert::AreEqual(size_t{ 2 }, Lines(document, 998, 3).size());
+            Assert::IsTrue(Lines(document, 1000, 3).empty());
+        }
+
+        TEST_METHOD (Parse_ShouldWrapLongLines_AtCharacterBoundary)
+        {
+            // A two byte character which crosses the wrapping column
+            std::string text(StreamingDocument::MaxLineLength * 2 + 10, 'a');
+            text.replace(StreamingDocument::MaxLineLength - 1, 2, "\xC3\xA9");
+
+            StreamingDocument document(text.data(), text.size(), false);
+            document.Parse(SIZE_MAX, noBudget);
+            const auto lines = Lines(document, 0, 10);
+            Assert::AreEqual(size_t{ 3 }, lines.size());
+            Assert::AreEqual(StreamingDocument::MaxLineLength - 1, lines[0].size());
+            Assert::AreEqual(text, lines[0] + lines[1] + lines[2]);
+        }
+
+        TEST_METHOD (Parse_ShouldClassifyMarkdownBlocks)
+        {
+            const auto kinds = Kinds("# Title\n"
+                                     "###### Small title\n"
+                                     "#hashtag\n"
+                                     "> quote\n"
+                                     "- item\n"
+                                     "* item\n"
+                                     "12. item\n"
+                                     "    indented code\n"
+                                     "text\n");
+            const std::vector<LineKind> expected = {
+                LineKind::Heading,
+                LineKind::Heading,
+                LineKind::Text,
+                LineKind::Quote,
+                LineKind::ListItem,
+                LineKind::ListItem,
+                LineKind::ListItem,
+                LineKind::Code,
+                LineKind::Text,
+            };
+            Assert::IsTrue(expected == kinds);
+        }
+
+        TEST_METHOD (Parse_ShouldKeepCodeBlocks_AcrossCheckpoints)
+        {
+            std::string text = "```\n";
+            for (size_t i = 0; i < StreamingDocument::CheckpointInterval * 2; i++)
+            {
+                text += "# not a heading\n";
+            }
+            text += "```\n# heading\n";
+
+            StreamingDocument document(text.data(), text.size(), true);
+            document.Parse(SIZE_MAX, noBudget);
+            const auto lines = document.GetLines(StreamingDocument::CheckpointInterval + 1, SIZE_MAX);
+            Assert::IsTrue(lines[0].kind == LineKind::Code);
+            Assert::IsTrue(lines[lines.size() - 2].kind == LineKind::CodeFence);
+            Assert::IsTrue(lines.back().kind == LineKind::Heading);
+        }
+
+        TEST_METHOD (Parse_ShouldNotClassifyPlainText)
+        {
+            const std::string text = "# Title\n> quote\n";
+            StreamingDocument document(text.data(), text.size(), false);
+            document.Parse(SIZE_MAX, noBudget);
+            for (const auto& line : document.GetLines(0, 10))
+            {
+                Assert::IsTrue(line.kind == LineKind::Text);
+            }
+        }
+
+        // Not a correctness test, prints the time it takes to index synthetic 1 GB files: a markdown document and a file
+        // without line breaks. Only the time to the first page is checked, it must not depend on the size of the file.
+        // It writes 2 GB to the temp folder, so it's ignored unless it's run on purpose.
+        BEGIN_TEST_METHOD_ATTRIBUTE(StreamingDocument_Benchmark)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (StreamingDocument_Benchmark)
+        {
+            const TemporaryFolder folder(L"StreamingPreviewBenchmark");
+
+            constexpr uint64_t size = 1024ull * 1024 * 1024;
+            constexpr size_t firstPage = 100;
+            const auto firstPageBudget = std::chrono::milliseconds(100);
+
+            std::string markdown;
+            while (markdown.size() < 1024 * 1024)
+            {
+                markdown += "# Heading\n\nSome text with a [link](https://aka.ms/powertoys) and `code`.\n- item\n> quote\n```\nint main() {}\n```\n";
+            }
+
+            const std::pair<const wchar_t*, std::string> inputs[] = {
+                { L"markdown.md", markdown },
+                { L"single line.svg", std::string(1024 * 1024, 'x') },
+            };
+            for (const auto& [name, chunk] : inputs)
+            {
+                const auto path = folder.path / name;
+                WriteFile(path, chunk, size);
+
+                const auto start = std::chrono::steady_clock::now();
+                MappedFile file;
+                Assert::AreEqual(S_OK, file.Open(path.wstring()));
+                StreamingDocument document(file.Data(), file.Size(), true);
+                document.Parse(firstPage, firstPageBudget);
+                const auto lines = document.GetLines(0, firstPage);
+                const auto firstPageTime = std::chrono::steady_clock::now() - start;
+
+                document.Parse(SIZE_MAX, std::chrono::hours(1));
+                const auto indexTime = std::chrono::steady_clock::now() - start;
+
+                Assert::AreEqual(firstPage, lines.size());
+                Assert::IsTrue(firstPageTime < firstPageBudget);
+                Assert::IsTrue(document.IsComplete());
+
+                const auto message = std::wstring(name) + L": first page " +
+                                     std::to_wstring(std::chrono::duration_cast<std::chrono::microseconds>(firstPageTime).count()) + L" us, " +
+                                     std::to_wstring(document.LineCount()) + L" lines indexed in " +
+                                     std::to_wstring(std::chrono::duration_cast<std::chrono::milliseconds>(indexTime).count()) + L" ms\n";
+                Logger::WriteMessage(message.c_str());
+
+                // Don't keep both files on the disk at the same time
+                file.Close();
+                std::filesystem::remove(path);
+            }
+        }
+    };
+}
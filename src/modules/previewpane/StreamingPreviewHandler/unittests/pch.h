@@ -0,0 +1,4 @@
+#pragma once
+
+#include "lib/pch.h"
+#include "CppUnitTest.h"
@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "CachingThumbnailProvider.h"
+#include <ShlObj.h>
+#include <algorithm>
+#include <mutex>
+#include <lib/ThumbnailStore.h>
+#include <powerpreview/CLSID.h>
+
+namespace
+{
+    // Larger files are passed to the managed provider as they are, without going through the store
+    constexpr ULONGLONG maxCachedFileSize = 32 * 1024 * 1024;
+
+    // The disk budget of the store can be changed with a DWORD value, in megabytes, under this key of HKCU
+    const wchar_t settingsSubkey[] = L"Software\\Microsoft\\PowerToys\\File Explorer";
+    const wchar_t diskBudgetValueName[] = L"ThumbnailCacheSizeMB";
+    constexpr DWORD defaultDiskBudgetMB = 256;
+
+    // When the store can't be opened, e.g. because another process held its mutex for too long, it's opened again by a
+    // later request. The delay between the attempts doubles up to the maximum.
+    constexpr ULONGLONG minOpenRetryDelay = 1000;
+    constexpr ULONGLONG maxOpenRetryDelay = 5 * 60 * 1000;
+
+    std::wstring GetStoreFolder()
+    {
+        PWSTR localAppData = nullptr;
+        if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &localAppData)))
+        {
+            return {};
+        }
+
+        std::wstring folder = std::wstring(localAppData) + L"\\Microsoft\\PowerToys\\File Explorer\\ThumbnailCache";
+        CoTaskMemFree(localAppData);
+        return folder;
+    }
+
+    uint64_t GetDiskBudget()
+    {
+        DWORD megabytes = 0;
+        DWORD size = sizeof(megabytes);
+        if (RegGetValueW(HKEY_CURRENT_USER, settingsSubkey, diskBudgetValueName, RRF_RT_REG_DWORD, nullptr, &megabytes, &size) != ERROR_SUCCESS)
+        {
+            megabytes = defaultDiskBudgetMB;
+        }
+        return uint64_t{ megabytes } * 1024 * 1024;
+    }
+
+    // Returns S_FALSE when the file is too large to be cached
+    HRESULT ReadStream(IStream* stream, std::vector<uint8_t>& content)
+    {
+        STATSTG stat = {};
+        HRESULT hr = stream->Stat(&stat, STATFLAG_NONAME);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        if (stat.cbSize.QuadPart > maxCachedFileSize)
+        {
+            return S_FALSE;
+        }
+
+        content.resize(static_cast<size_t>(stat.cbSize.QuadPart));
+        hr = IStream_Reset(stream);
+        if (SUCCEEDED(hr) && !content.empty())
+        {
+            hr = IStream_Read(stream, content.data(), static_cast<ULONG>(content.size()));
+        }
+        return hr;
+    }
+
+    HRESULT ExtractThumbnail(IStream* stream, UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
+    {
+        CComPtr<IInitializeWithStream> initialize;
+        HRESULT hr = CoCreateInstance(CLSID_SvgThumbnailProvider, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&initialize));
+        if (SUCCEEDED(hr))
+        {
+            hr = initialize->Initialize(stream, STGM_READ);
+        }
+
+        CComPtr<IThumbnailProvider> provider;
+        if (SUCCEEDED(hr))
+        {
+            hr = initialize->QueryInterface(IID_PPV_ARGS(&provider));
+        }
+        if (SUCCEEDED(hr))
+        {
+            hr = provider->GetThumbnail(cx, phbmp, pdwAlpha);
+        }
+        return hr;
+    }
+
+    BITMAPINFO GetBitmapInfo(uint32_t width, uint32_t height)
+    {
+        BITMAPINFO info = {};
+        info.bmiHeader.biSize = sizeof(info.bmiHeader);
+        info.bmiHeader.biWidth = static_cast<LONG>(width);
+        // A negative height makes a top-down bitmap
+        info.bmiHeader.biHeight = -static_cast<LONG>(height);
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = 32;
+        info.bmiHeader.biCompression = BI_RGB;
+        return info;
+    }
+
+    HRESULT CreateThumbnailBitmap(const CachedThumbnail& thumbnail, HBITMAP* phbmp)
+    {
+        const BITMAPINFO info = GetBitmapInfo(thumbnail.width, thumbnail.height);
+        void* bits = nullptr;
+        HBITMAP bitmap = CreateDIBSection(nullptr, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (!bitmap)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        std::copy(thumbnail.pixels.begin(), thumbnail.pixels.end(), static_cast<uint8_t*>(bits));
+        *phbmp = bitmap;
+        return S_OK;
+    }
+
+    HRESULT ReadThumbnailBitmap(HBITMAP bitmap, WTS_ALPHATYPE alphaType, CachedThumbnail& thumbnail)
+    {
+        BITMAP properties = {};
+        if (!GetObjectW(bitmap, sizeof(properties), &properties) || properties.bmWidth <= 0 || properties.bmHeight == 0)
+        {
+            return E_INVALIDARG;
+        }
+
+        thumbnail.width = static_cast<uint32_t>(properties.bmWidth);
+        thumbnail.height = static_cast<uint32_t>(std::abs(properties.bmHeight));
+        thumbnail.alphaType = alphaType;
+        thumbnail.pixels.resize(static_cast<size_t>(thumbnail.width) * thumbnail.height * 4);
+
+        BITMAPINFO info = GetBitmapInfo(thumbnail.width, thumbnail.height);
+        HDC dc = GetDC(nullptr);
+        const int lines = GetDIBits(dc, bitmap, 0, thumbnail.height, thumbnail.pixels.data(), &info, DIB_RGB_COLORS);
+        ReleaseDC(nullptr, dc);
+        return lines == static_cast<int>(thumbnail.height) ? S_OK : E_FAIL;
+    }
+}
+
+CCachingThumbnailProvider::CCachingThumbnailProvider()
+{
+    ModuleAddRef();
+}
+
+CCachingThumbnailProvider::~CCachingThumbnailProvider()
+{
+    ModuleRelease();
+}
+
+HRESULT CCachingThumbnailProvider::s_CreateInstance(_In_opt_ IUnknown*, _In_ REFIID riid, _Outptr_ void** ppv)
+{
+    *ppv = nullptr;
+    HRESULT hr = E_OUTOFMEMORY;
+    CCachingThumbnailProvider* provider = new CCachingThumbnailProvider();
+    if (provider)
+    {
+        hr = provider->QueryInterface(riid, ppv);
+        provider->Release();
+    }
+    return hr;
+}
+
+ThumbnailStore* CCachingThumbnailProvider::s_GetStore()
+{
+    static std::atomic<ThumbnailStore*> openedStore = nullptr;
+    static std::mutex mutex;
+    static std::unique_ptr<ThumbnailStore> store;
+    static ULONGLONG nextAttempt = 0;
+    static ULONGLONG retryDelay = minOpenRetryDelay;
+
+    if (ThumbnailStore* opened = openedStore.load())
+    {
+        return opened;
+    }
+
+    // The other threads pass the requests on while one of them opens the store
+    std::unique_lock lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || openedStore.load() || GetTickCount64() < nextAttempt)
+    {
+        return openedStore.load();
+    }
+
+    if (!store)
+    {
+        const std::wstring folder = GetStoreFolder();
+        if (!folder.empty())
+        {
+            store = std::make_unique<ThumbnailStore>(folder, GetDiskBudget());
+        }
+    }
+
+    if (store && SUCCEEDED(store->Open()))
+    {
+        openedStore = store.get();
+        return store.get();
+    }
+
+    nextAttempt = GetTickCount64() + retryDelay;
+    retryDelay = (std::min)(retryDelay * 2, maxOpenRetryDelay);
+    return nullptr;
+}
+
+// IInitializeWithStream
+HRESULT CCachingThumbnailProvider::Initialize(_In_ IStream* pstream, DWORD)
+{
+    if (!pstream)
+    {
+        return E_INVALIDARG;
+    }
+    if (m_stream)
+    {
+        return HRESULT_FROM_WIN32(ERROR_ALREADY_INITIALIZED);
+    }
+
+    m_stream = pstream;
+    return S_OK;
+}
+
+// IThumbnailProvider
+HRESULT CCachingThumbnailProvider::GetThumbnail(UINT cx, _Out_ HBITMAP* phbmp, _Out_ WTS_ALPHATYPE* pdwAlpha)
+{
+    if (!phbmp || !pdwAlpha)
+    {
+        return E_POINTER;
+    }
+    *phbmp = nullptr;
+    *pdwAlpha = WTSAT_UNKNOWN;
+    if (!m_stream)
+    {
+        return E_UNEXPECTED;
+    }
+
+    ThumbnailStore* store = s_GetStore();
+    std::vector<uint8_t> content;
+    ThumbnailKey key;
+    if (!store || ReadStream(m_stream, content) != S_OK || FAILED(ComputeThumbnailKey(content.data(), content.size(), cx, key)))
+    {
+        // Without the store the provider only passes the request on
+        IStream_Reset(m_stream);
+        return ExtractThumbnail(m_stream, cx, phbmp, pdwAlpha);
+    }
+
+    CachedThumbnail thumbnail;
+    if (store->Find(key, thumbnail) == S_OK && SUCCEEDED(CreateThumbnailBitmap(thumbnail, phbmp)))
+    {
+        *pdwAlpha = static_cast<WTS_ALPHATYPE>(thumbnail.alphaType);
+        return S_OK;
+    }
+
+    // The content was already read from the stream, the managed provider gets a copy of it
+    CComPtr<IStream> contentStream;
+    contentStream.Attach(SHCreateMemStream(content.data(), static_cast<UINT>(content.size())));
+    if (!contentStream)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    const HRESULT hr = ExtractThumbnail(contentStream, cx, phbmp, pdwAlpha);
+    if (SUCCEEDED(hr) && *phbmp && SUCCEEDED(ReadThumbnailBitmap(*phbmp, *pdwAlpha, thumbnail)))
+    {
+        // The thumbnail is returned even if it can't be stored
+        store->Add(key, thumbnail);
+    }
+    return hr;
+}
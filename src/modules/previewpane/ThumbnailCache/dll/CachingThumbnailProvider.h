@@ -0,0 +1,60 @@
+#pragma once
+#include "pch.h"
+
+class ThumbnailStore;
+
+// Thumbnail provider for Svg files which serves the thumbnails from a persistent store, keyed by the hash of the file
+// content and the requested size. A thumbnail which isn't in the store is extracted by the managed Svg thumbnail
+// provider and added to the store, so a folder is only rendered once, even across restarts of File Explorer.
+class __declspec(uuid("C225F0D2-6CAF-4278-9F66-7628AFD0066D")) CCachingThumbnailProvider :
+    public IInitializeWithStream,
+    public IThumbnailProvider
+{
+public:
+    CCachingThumbnailProvider();
+
+    // IUnknown
+    IFACEMETHODIMP QueryInterface(_In_ REFIID riid, _COM_Outptr_ void** ppv)
+    {
+        static const QITAB qit[] = {
+            QITABENT(CCachingThumbnailProvider, IInitializeWithStream),
+            QITABENT(CCachingThumbnailProvider, IThumbnailProvider),
+            { 0, 0 },
+        };
+        return QISearch(this, qit, riid, ppv);
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    IFACEMETHODIMP_(ULONG)
+    Release()
+    {
+        LONG refCount = --m_refCount;
+        if (refCount == 0)
+        {
+            delete this;
+        }
+        return refCount;
+    }
+
+    // IInitializeWithStream
+    IFACEMETHODIMP Initialize(_In_ IStream* pstream, DWORD grfMode);
+
+    // IThumbnailProvider
+    IFACEMETHODIMP GetThumbnail(UINT cx, _Out_ HBITMAP* phbmp, _Out_ WTS_ALPHATYPE* pdwAlpha);
+
+    static HRESULT s_CreateInstance(_In_opt_ IUnknown* punkOuter, _In_ REFIID riid, _Outptr_ void** ppv);
+
+private:
+    ~CCachingThumbnailProvider();
+
+    // The store shared by the providers of the process, or nullptr when it isn't open yet
+    static ThumbnailStore* s_GetStore();
+
+    std::atomic<long> m_refCount = 1;
+    CComPtr<IStream> m_stream;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <unknwn.h>
+#include <shlwapi.h>
+#include <atlbase.h>
+#include <Shobjidl.h>
+#include <thumbcache.h>
+#include <winrt/base.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+void ModuleAddRef();
+void ModuleRelease();
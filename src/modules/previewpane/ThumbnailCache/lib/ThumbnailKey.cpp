@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "ThumbnailKey.h"
+
+HRESULT ComputeThumbnailKey(const void* data, size_t length, uint32_t size, ThumbnailKey& key)
+{
+    if (!data && length > 0)
+    {
+        return E_INVALIDARG;
+    }
+
+    BCRYPT_HASH_HANDLE hash = nullptr;
+    NTSTATUS status = BCryptCreateHash(BCRYPT_SHA256_ALG_HANDLE, &hash, nullptr, 0, nullptr, 0, 0);
+    if (!BCRYPT_SUCCESS(status))
+    {
+        return HRESULT_FROM_NT(status);
+    }
+
+    // BCryptHashData takes the length as a ULONG
+    auto bytes = static_cast<const uint8_t*>(data);
+    while (BCRYPT_SUCCESS(status) && length > 0)
+    {
+        const ULONG chunk = static_cast<ULONG>((std::min)(length, size_t{ ULONG_MAX }));
+        status = BCryptHashData(hash, const_cast<PUCHAR>(bytes), chunk, 0);
+        bytes += chunk;
+        length -= chunk;
+    }
+
+    std::array<uint8_t, 32> digest;
+    if (BCRYPT_SUCCESS(status))
+    {
+        status = BCryptFinishHash(hash, digest.data(), static_cast<ULONG>(digest.size()), 0);
+    }
+    BCryptDestroyHash(hash);
+    if (!BCRYPT_SUCCESS(status))
+    {
+        return HRESULT_FROM_NT(status);
+    }
+
+    std::copy_n(digest.begin(), key.hash.size(), key.hash.begin());
+    key.size = size;
+    return S_OK;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// Identifies a thumbnail by the content of the file it is extracted from rather than by its path, so a copy or a
+// renamed file is served from the same entry, and an edited file never gets the thumbnail of its previous content.
+struct ThumbnailKey
+{
+    // The first 128 bits of the SHA-256 hash of the file content
+    std::array<uint8_t, 16> hash{};
+
+    // The size of the thumbnail requested by File Explorer, in pixels
+    uint32_t size = 0;
+
+    bool operator==(const ThumbnailKey& other) const
+    {
+        return hash == other.hash && size == other.size;
+    }
+
+    bool operator!=(const ThumbnailKey& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+HRESULT ComputeThumbnailKey(const void* data, size_t length, uint32_t size, ThumbnailKey& key);
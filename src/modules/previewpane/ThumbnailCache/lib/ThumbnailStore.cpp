@@ -0,0 +1,533 @@
+#include "pch.h"
+#include "ThumbnailStore.h"
+#include <cwctype>
+#include <unordered_set>
+
+struct ThumbnailStore::Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t usedBytes;
+
+    // Incremented by every lookup, each slot keeps the value of its last use
+    uint64_t clock;
+};
+
+struct ThumbnailStore::Slot
+{
+    std::array<uint8_t, 16> hash;
+    uint32_t size;
+
+    // Size of the file of the thumbnail
+    uint32_t bytes;
+
+    // Zero when the slot is empty
+    uint64_t lastUse;
+};
+
+namespace
+{
+    constexpr uint32_t indexMagic = 0x58444E49; // "INDX"
+    constexpr uint32_t thumbnailMagic = 0x424D4854; // "THMB"
+    constexpr uint32_t indexVersion = 1;
+    constexpr uint32_t notFound = UINT32_MAX;
+
+    // Explorer extracts thumbnails on several threads, an operation which waits longer than this is skipped
+    constexpr DWORD lockTimeout = 1000;
+
+    const wchar_t indexFileName[] = L"index.bin";
+    const wchar_t thumbnailExtension[] = L".thumb";
+    const wchar_t temporaryExtension[] = L".tmp";
+
+    // Header of the file of a thumbnail, followed by its pixels
+    struct ThumbnailFileHeader
+    {
+        uint32_t magic;
+        std::array<uint8_t, 16> hash;
+        uint32_t size;
+        uint32_t width;
+        uint32_t height;
+        uint32_t alphaType;
+    };
+
+    // Holds the named mutex of the store for the duration of an operation
+    class StoreLock
+    {
+    public:
+        explicit StoreLock(HANDLE mutex) :
+            mutex(mutex)
+        {
+            // The index is still consistent when a process ended while it held the mutex: the file of a thumbnail is
+            // written before its slot, and a slot whose file is missing is removed by the next lookup.
+            const DWORD result = WaitForSingleObject(mutex, lockTimeout);
+            locked = result == WAIT_OBJECT_0 || result == WAIT_ABANDONED;
+        }
+
+        ~StoreLock()
+        {
+            if (locked)
+            {
+                ReleaseMutex(mutex);
+            }
+        }
+
+        bool IsLocked() const
+        {
+            return locked;
+        }
+
+    private:
+        HANDLE mutex;
+        bool locked;
+    };
+
+    // The name of a mutex can't contain backslashes, so the stores are told apart by a hash of their folder
+    std::wstring MutexName(const std::wstring& folder)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (wchar_t c : folder)
+        {
+            hash ^= std::towlower(c);
+            hash *= 1099511628211ull;
+        }
+
+        wchar_t name[64];
+        swprintf_s(name, L"Local\\PowerToys_ThumbnailStore_%016llx", hash);
+        return name;
+    }
+
+    ThumbnailKey KeyOf(const std::array<uint8_t, 16>& hash, uint32_t size)
+    {
+        ThumbnailKey key;
+        key.hash = hash;
+        key.size = size;
+        return key;
+    }
+
+    std::wstring ThumbnailFileName(const ThumbnailKey& key)
+    {
+        static const wchar_t digits[] = L"0123456789abcdef";
+        std::wstring name;
+        for (uint8_t byte : key.hash)
+        {
+            name += digits[byte >> 4];
+            name += digits[byte & 0xF];
+        }
+        return name + L"_" + std::to_wstring(key.size) + thumbnailExtension;
+    }
+
+    bool IsPowerOfTwo(uint32_t value)
+    {
+        return value >= 2 && (value & (value - 1)) == 0;
+    }
+
+    HRESULT ReadThumbnailFile(const std::wstring& path, const ThumbnailKey& key, uint32_t bytes, CachedThumbnail& thumbnail)
+    {
+        winrt::file_handle file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+        if (!file)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        ThumbnailFileHeader fileHeader;
+        DWORD read = 0;
+        if (!ReadFile(file.get(), &fileHeader, sizeof(fileHeader), &read, nullptr))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        const uint64_t pixelBytes = uint64_t{ fileHeader.width } * fileHeader.height * 4;
+        if (read != sizeof(fileHeader) || fileHeader.magic != thumbnailMagic || fileHeader.hash != key.hash || fileHeader.size != key.size || sizeof(fileHeader) + pixelBytes != bytes)
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+        }
+
+        thumbnail.pixels.resize(static_cast<size_t>(pixelBytes));
+        if (!ReadFile(file.get(), thumbnail.pixels.data(), static_cast<DWORD>(pixelBytes), &read, nullptr))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+        if (read != pixelBytes)
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+        }
+
+        thumbnail.width = fileHeader.width;
+        thumbnail.height = fileHeader.height;
+        thumbnail.alphaType = fileHeader.alphaType;
+        return S_OK;
+    }
+
+    // Writes a temporary file which is renamed once complete, so a thumbnail file is never seen half written
+    HRESULT WriteThumbnailFile(const std::wstring& path, const ThumbnailKey& key, const CachedThumbnail& thumbnail)
+    {
+        const std::wstring temporaryPath = path + temporaryExtension;
+        HRESULT hr = S_OK;
+        {
+            winrt::file_handle file{ CreateFileW(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            if (!file)
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            const ThumbnailFileHeader fileHeader = { thumbnailMagic, key.hash, key.size, thumbnail.width, thumbnail.height, thumbnail.alphaType };
+            DWORD written = 0;
+            if (!WriteFile(file.get(), &fileHeader, sizeof(fileHeader), &written, nullptr) ||
+                !WriteFile(file.get(), thumbnail.pixels.data(), static_cast<DWORD>(thumbnail.pixels.size()), &written, nullptr))
+            {
+                hr = HRESULT_FROM_WIN32(GetLastError());
+            }
+        }
+
+        if (SUCCEEDED(hr) && !MoveFileExW(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        if (FAILED(hr))
+        {
+            DeleteFileW(temporaryPath.c_str());
+        }
+        return hr;
+    }
+}
+
+ThumbnailStore::ThumbnailStore(std::wstring folder, uint64_t diskBudget, uint32_t capacity) :
+    folder(std::move(folder)),
+    diskBudget(diskBudget),
+    requestedCapacity(capacity)
+{
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    Close();
+}
+
+HRESULT ThumbnailStore::Open()
+{
+    Close();
+    if (!IsPowerOfTwo(requestedCapacity))
+    {
+        return E_INVALIDARG;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(folder, error);
+    if (error)
+    {
+        return HRESULT_FROM_WIN32(error.value());
+    }
+
+    mutex.attach(CreateMutexW(nullptr, FALSE, MutexName(folder).c_str()));
+    if (!mutex)
+    {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        Close();
+        return hr;
+    }
+
+    HRESULT hr;
+    {
+        StoreLock lock(mutex.get());
+        hr = lock.IsLocked() ? OpenIndex() : HRESULT_FROM_WIN32(WAIT_TIMEOUT);
+    }
+    if (FAILED(hr))
+    {
+        Close();
+    }
+    return hr;
+}
+
+HRESULT ThumbnailStore::OpenIndex()
+{
+    // The layout of the index is shared by every process which maps it
+    static_assert(sizeof(Header) == 32 && sizeof(Slot) == 32);
+
+    const std::wstring indexPath = folder + L"\\" + indexFileName;
+    indexFile.attach(CreateFileW(indexPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!indexFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    LARGE_INTEGER length{};
+    if (!GetFileSizeEx(indexFile.get(), &length))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // An index which is already there keeps its capacity, it can't be resized while other processes have it mapped
+    uint32_t capacity = requestedCapacity;
+    bool valid = false;
+    Header existing{};
+    DWORD read = 0;
+    if (static_cast<uint64_t>(length.QuadPart) >= sizeof(Header) && ReadFile(indexFile.get(), &existing, sizeof(existing), &read, nullptr) && read == sizeof(existing))
+    {
+        valid = existing.magic == indexMagic && existing.version == indexVersion && IsPowerOfTwo(existing.capacity) &&
+                static_cast<uint64_t>(length.QuadPart) == sizeof(Header) + uint64_t{ existing.capacity } * sizeof(Slot);
+        if (valid)
+        {
+            capacity = existing.capacity;
+        }
+    }
+
+    if (!valid)
+    {
+        // The thumbnail files can't be found without their index, start over with an empty store. The file is truncated
+        // first, so the slots read as zeros, which is an empty slot.
+        for (const uint64_t size : { uint64_t{ 0 }, sizeof(Header) + uint64_t{ capacity } * sizeof(Slot) })
+        {
+            LARGE_INTEGER position{};
+            position.QuadPart = static_cast<LONGLONG>(size);
+            if (!SetFilePointerEx(indexFile.get(), position, nullptr, FILE_BEGIN) || !SetEndOfFile(indexFile.get()))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+        }
+    }
+
+    mapping.attach(CreateFileMappingW(indexFile.get(), nullptr, PAGE_READWRITE, 0, 0, nullptr));
+    if (!mapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    void* view = MapViewOfFile(mapping.get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+    if (!view)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    header = static_cast<Header*>(view);
+    slots = reinterpret_cast<Slot*>(header + 1);
+    mask = capacity - 1;
+    if (!valid)
+    {
+        *header = { indexMagic, indexVersion, capacity, 0, 0, 0 };
+    }
+    RemoveUnindexedFiles();
+    return S_OK;
+}
+
+void ThumbnailStore::Close()
+{
+    if (header)
+    {
+        UnmapViewOfFile(header);
+        header = nullptr;
+        slots = nullptr;
+    }
+    mask = 0;
+    mapping.close();
+    indexFile.close();
+    mutex.close();
+}
+
+HRESULT ThumbnailStore::Find(const ThumbnailKey& key, CachedThumbnail& thumbnail)
+{
+    if (!header)
+    {
+        return E_UNEXPECTED;
+    }
+
+    StoreLock lock(mutex.get());
+    if (!lock.IsLocked())
+    {
+        return HRESULT_FROM_WIN32(WAIT_TIMEOUT);
+    }
+
+    const uint32_t index = FindSlot(key);
+    if (index == notFound)
+    {
+        return S_FALSE;
+    }
+
+    if (ReadThumbnailFile(ThumbnailPath(key), key, slots[index].bytes, thumbnail) != S_OK)
+    {
+        // The file was removed or damaged outside of the store
+        RemoveSlot(index);
+        return S_FALSE;
+    }
+
+    slots[index].lastUse = ++header->clock;
+    return S_OK;
+}
+
+HRESULT ThumbnailStore::Add(const ThumbnailKey& key, const CachedThumbnail& thumbnail)
+{
+    if (!header)
+    {
+        return E_UNEXPECTED;
+    }
+
+    const uint64_t pixelBytes = uint64_t{ thumbnail.width } * thumbnail.height * 4;
+    if (pixelBytes == 0 || thumbnail.pixels.size() != pixelBytes)
+    {
+        return E_INVALIDARG;
+    }
+
+    const uint64_t bytes = sizeof(ThumbnailFileHeader) + pixelBytes;
+    if (bytes > diskBudget || bytes > UINT32_MAX)
+    {
+        return S_FALSE;
+    }
+
+    StoreLock lock(mutex.get());
+    if (!lock.IsLocked())
+    {
+        return HRESULT_FROM_WIN32(WAIT_TIMEOUT);
+    }
+
+    // Another process may have added the same thumbnail in the meantime
+    const uint32_t existing = FindSlot(key);
+    if (existing != notFound)
+    {
+        RemoveSlot(existing);
+    }
+    MakeRoom(bytes);
+
+    const HRESULT hr = WriteThumbnailFile(ThumbnailPath(key), key, thumbnail);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    uint32_t index = Home(key);
+    while (slots[index].lastUse != 0)
+    {
+        index = (index + 1) & mask;
+    }
+    slots[index] = { key.hash, key.size, static_cast<uint32_t>(bytes), ++header->clock };
+    header->count++;
+    header->usedBytes += bytes;
+    return S_OK;
+}
+
+uint32_t ThumbnailStore::EntryCount()
+{
+    return header ? header->count : 0;
+}
+
+uint64_t ThumbnailStore::DiskUsage()
+{
+    return header ? header->usedBytes : 0;
+}
+
+void ThumbnailStore::RemoveUnindexedFiles()
+{
+    // A process which ended in the middle of Add leaves a file without a slot, which would take disk space outside of
+    // the budget forever. Every file is written and indexed while the mutex is held, so none is in progress here.
+    std::unordered_set<std::wstring> indexed;
+    indexed.reserve(header->count);
+    for (uint32_t i = 0; i <= mask; i++)
+    {
+        if (slots[i].lastUse != 0)
+        {
+            indexed.insert(ThumbnailFileName(KeyOf(slots[i].hash, slots[i].size)));
+        }
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+    {
+        const auto extension = entry.path().extension();
+        if (extension == temporaryExtension || (extension == thumbnailExtension && indexed.count(entry.path().filename().wstring()) == 0))
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+uint32_t ThumbnailStore::Home(const ThumbnailKey& key) const
+{
+    uint64_t value;
+    std::memcpy(&value, key.hash.data(), sizeof(value));
+    return static_cast<uint32_t>((value ^ key.size * 0x9E3779B97F4A7C15ull) & mask);
+}
+
+uint32_t ThumbnailStore::FindSlot(const ThumbnailKey& key) const
+{
+    // Linear probing, a key is in the run of occupied slots which starts at its home
+    uint32_t index = Home(key);
+    for (uint32_t probe = 0; probe <= mask && slots[index].lastUse != 0; probe++)
+    {
+        if (slots[index].hash == key.hash && slots[index].size == key.size)
+        {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return notFound;
+}
+
+void ThumbnailStore::RemoveSlot(uint32_t index)
+{
+    DeleteFileW(ThumbnailPath(KeyOf(slots[index].hash, slots[index].size)).c_str());
+    header->count--;
+    header->usedBytes -= (std::min)(header->usedBytes, uint64_t{ slots[index].bytes });
+
+    // Backward shift deletion: the following slots of the run are moved back over the removed one when their home is
+    // at or before it, since a lookup stops at the first empty slot. There are no tombstones to clean up this way.
+    uint32_t empty = index;
+    uint32_t next = (index + 1) & mask;
+    for (uint32_t probe = 0; probe < mask && slots[next].lastUse != 0; probe++)
+    {
+        const uint32_t home = Home(KeyOf(slots[next].hash, slots[next].size));
+        if (((next - home) & mask) >= ((next - empty) & mask))
+        {
+            slots[empty] = slots[next];
+            empty = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[empty] = {};
+}
+
+void ThumbnailStore::MakeRoom(uint64_t bytes)
+{
+    const uint32_t maxCount = (mask + 1) / 4 * 3;
+    if (header->usedBytes + bytes <= diskBudget && header->count < maxCount)
+    {
+        return;
+    }
+
+    // Remove the least recently used thumbnails until an eighth of the budget and of the slots is free, so that the
+    // next additions don't have to go through the whole index again
+    const uint64_t targetBytes = diskBudget - diskBudget / 8;
+    const uint32_t targetCount = maxCount - maxCount / 8;
+
+    std::vector<std::pair<uint64_t, ThumbnailKey>> entries;
+    entries.reserve(header->count);
+    for (uint32_t i = 0; i <= mask; i++)
+    {
+        if (slots[i].lastUse != 0)
+        {
+            entries.emplace_back(slots[i].lastUse, KeyOf(slots[i].hash, slots[i].size));
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& left, const auto& right) {
+        return left.first < right.first;
+    });
+
+    for (const auto& [lastUse, key] : entries)
+    {
+        if (header->usedBytes + bytes <= targetBytes && header->count < targetCount)
+        {
+            break;
+        }
+
+        // Slots move when others are removed, so each one is looked up again
+        const uint32_t index = FindSlot(key);
+        if (index != notFound)
+        {
+            RemoveSlot(index);
+        }
+    }
+}
+
+std::wstring ThumbnailStore::ThumbnailPath(const ThumbnailKey& key) const
+{
+    return folder + L"\\" + ThumbnailFileName(key);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ThumbnailKey.h"
+
+// A thumbnail as it is kept in the store: 32 bpp BGRA pixels, top-down and without padding
+struct CachedThumbnail
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // The WTS_ALPHATYPE returned along with the bitmap
+    uint32_t alphaType = 0;
+
+    std::vector<uint8_t> pixels;
+};
+
+// A persistent store of thumbnails, shared by all the processes which extract thumbnails for File Explorer.
+// Each thumbnail is kept in its own file in the folder of the store, and the index of these files is a hash table in a
+// file mapped in memory, so a lookup reads nothing but the thumbnail itself. When the files take more than the disk
+// budget, the least recently used thumbnails are removed. The operations are serialized between processes by a named mutex.
+class ThumbnailStore
+{
+public:
+    // Number of slots of a new index, a power of two. Only three quarters of them are used, to keep the probes short.
+    static constexpr uint32_t DefaultCapacity = 1 << 16;
+
+    ThumbnailStore(std::wstring folder, uint64_t diskBudget, uint32_t capacity = DefaultCapacity);
+    ~ThumbnailStore();
+
+    ThumbnailStore(const ThumbnailStore&) = delete;
+    ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+
+    // Creates the folder and the index if they don't exist. An index which can't be read is discarded along with the thumbnails,
+    // and the thumbnail files which aren't in the index are removed.
+    HRESULT Open();
+    void Close();
+
+    // Returns S_FALSE when the thumbnail is not in the store
+    HRESULT Find(const ThumbnailKey& key, CachedThumbnail& thumbnail);
+
+    // Returns S_FALSE when the thumbnail doesn't fit in the disk budget
+    HRESULT Add(const ThumbnailKey& key, const CachedThumbnail& thumbnail);
+
+    uint32_t EntryCount();
+    uint64_t DiskUsage();
+
+private:
+    struct Header;
+    struct Slot;
+
+    HRESULT OpenIndex();
+    void RemoveUnindexedFiles();
+    uint32_t Home(const ThumbnailKey& key) const;
+    uint32_t FindSlot(const ThumbnailKey& key) const;
+    void RemoveSlot(uint32_t index);
+    void MakeRoom(uint64_t bytes);
+    std::wstring ThumbnailPath(const ThumbnailKey& key) const;
+
+    std::wstring folder;
+    uint64_t diskBudget;
+    uint32_t requestedCapacity;
+
+    winrt::handle mutex;
+    winrt::file_handle indexFile;
+    winrt::handle mapping;
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    uint32_t mask = 0;
+};
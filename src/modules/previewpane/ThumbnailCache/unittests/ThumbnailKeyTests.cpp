@@ -0,0 +1,47 @@
+#include "pch.h"
+#include "lib/ThumbnailKey.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThumbnailCacheUnitTests
+{
+    TEST_CLASS (ThumbnailKeyTests)
+    {
+    public:
+        TEST_METHOD (ComputeThumbnailKey_ShouldUseSha256OfContent)
+        {
+            const std::string content = "abc";
+            ThumbnailKey key;
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(content.data(), content.size(), 256, key));
+
+            const std::array<uint8_t, 16> expected = { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23 };
+            Assert::IsTrue(expected == key.hash);
+            Assert::AreEqual(256u, key.size);
+        }
+
+        TEST_METHOD (ComputeThumbnailKey_ShouldDependOnContentAndSize)
+        {
+            const std::string content = "<svg></svg>";
+            const std::string edited = "<svg> </svg>";
+            ThumbnailKey key;
+            ThumbnailKey sameContent;
+            ThumbnailKey otherSize;
+            ThumbnailKey otherContent;
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(content.data(), content.size(), 96, key));
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(content.data(), content.size(), 96, sameContent));
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(content.data(), content.size(), 256, otherSize));
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(edited.data(), edited.size(), 96, otherContent));
+
+            Assert::IsTrue(key == sameContent);
+            Assert::IsTrue(key != otherSize);
+            Assert::IsTrue(key != otherContent);
+        }
+
+        TEST_METHOD (ComputeThumbnailKey_ShouldAcceptEmptyContent)
+        {
+            ThumbnailKey key;
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(nullptr, 0, 32, key));
+            Assert::AreEqual(E_INVALIDARG, ComputeThumbnailKey(nullptr, 1, 32, key));
+        }
+    };
+}
@@ -0,0 +1,276 @@
+#include "pch.h"
+#include "lib/ThumbnailStore.h"
+#include <chrono>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThumbnailCacheUnitTests
+{
+    namespace
+    {
+        ThumbnailKey MakeKey(int file, uint32_t size = 96)
+        {
+            const std::string content = "<svg id=\"" + std::to_string(file) + "\"></svg>";
+            ThumbnailKey key;
+            Assert::AreEqual(S_OK, ComputeThumbnailKey(content.data(), content.size(), size, key));
+            return key;
+        }
+
+        CachedThumbnail MakeThumbnail(uint32_t width, uint32_t height, uint8_t value)
+        {
+            CachedThumbnail thumbnail;
+            thumbnail.width = width;
+            thumbnail.height = height;
+            thumbnail.alphaType = 2;
+            thumbnail.pixels.assign(static_cast<size_t>(width) * height * 4, value);
+            return thumbnail;
+        }
+
+        bool Contains(ThumbnailStore& store, const ThumbnailKey& key)
+        {
+            CachedThumbnail thumbnail;
+            return store.Find(key, thumbnail) == S_OK;
+        }
+
+        size_t CountThumbnailFiles(const std::filesystem::path& folder)
+        {
+            size_t count = 0;
+            for (const auto& entry : std::filesystem::directory_iterator(folder))
+            {
+                count += entry.path().extension() == L".thumb";
+            }
+            return count;
+        }
+    }
+
+    TEST_CLASS (ThumbnailStoreTests)
+    {
+        std::filesystem::path folder;
+
+        // Size of the file of a 10x10 thumbnail, header included
+        static constexpr uint64_t smallThumbnailBytes = 36 + 10 * 10 * 4;
+
+    public:
+        TEST_METHOD_INITIALIZE(Initialize)
+        {
+            folder = std::filesystem::temp_directory_path() / L"ThumbnailCacheUnitTests";
+            std::filesystem::remove_all(folder);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::filesystem::remove_all(folder);
+        }
+
+        TEST_METHOD (Find_ShouldReturnAddedThumbnail)
+        {
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            CachedThumbnail found;
+            Assert::AreEqual(S_FALSE, store.Find(MakeKey(1), found));
+
+            const auto added = MakeThumbnail(32, 16, 0x7F);
+            Assert::AreEqual(S_OK, store.Add(MakeKey(1), added));
+
+            Assert::AreEqual(S_OK, store.Find(MakeKey(1), found));
+            Assert::AreEqual(32u, found.width);
+            Assert::AreEqual(16u, found.height);
+            Assert::AreEqual(2u, found.alphaType);
+            Assert::IsTrue(added.pixels == found.pixels);
+
+            // Same file, another size
+            Assert::AreEqual(S_FALSE, store.Find(MakeKey(1, 256), found));
+            Assert::AreEqual(1u, store.EntryCount());
+        }
+
+        TEST_METHOD (Find_ShouldReturnThumbnail_AfterStoreIsReopened)
+        {
+            {
+                ThumbnailStore store(folder.wstring(), 1024 * 1024);
+                Assert::AreEqual(S_OK, store.Open());
+                for (int i = 0; i < 20; i++)
+                {
+                    Assert::AreEqual(S_OK, store.Add(MakeKey(i), MakeThumbnail(10, 10, static_cast<uint8_t>(i))));
+                }
+            }
+
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(20u, store.EntryCount());
+            Assert::AreEqual(20 * smallThumbnailBytes, store.DiskUsage());
+            for (int i = 0; i < 20; i++)
+            {
+                CachedThumbnail found;
+                Assert::AreEqual(S_OK, store.Find(MakeKey(i), found));
+                Assert::AreEqual(static_cast<uint8_t>(i), found.pixels[0]);
+            }
+        }
+
+        TEST_METHOD (Find_ShouldSeeThumbnailsAdded_ByAnotherStoreOnSameFolder)
+        {
+            ThumbnailStore first(folder.wstring(), 1024 * 1024);
+            ThumbnailStore second(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, first.Open());
+            Assert::AreEqual(S_OK, second.Open());
+
+            Assert::AreEqual(S_OK, first.Add(MakeKey(1), MakeThumbnail(10, 10, 1)));
+            Assert::IsTrue(Contains(second, MakeKey(1)));
+            Assert::AreEqual(1u, second.EntryCount());
+        }
+
+        TEST_METHOD (Add_ShouldRemoveLeastRecentlyUsed_WhenOverBudget)
+        {
+            ThumbnailStore store(folder.wstring(), smallThumbnailBytes * 4);
+            Assert::AreEqual(S_OK, store.Open());
+            for (int i = 0; i < 4; i++)
+            {
+                Assert::AreEqual(S_OK, store.Add(MakeKey(i), MakeThumbnail(10, 10, 0)));
+            }
+            Assert::IsTrue(Contains(store, MakeKey(0)));
+
+            // Makes room for an eighth of the budget besides the new thumbnail, so the two least recently used go
+            Assert::AreEqual(S_OK, store.Add(MakeKey(4), MakeThumbnail(10, 10, 0)));
+            Assert::AreEqual(3u, store.EntryCount());
+            Assert::IsTrue(store.DiskUsage() <= smallThumbnailBytes * 4);
+            Assert::AreEqual(size_t{ 3 }, CountThumbnailFiles(folder));
+
+            Assert::IsTrue(Contains(store, MakeKey(0)));
+            Assert::IsFalse(Contains(store, MakeKey(1)));
+            Assert::IsFalse(Contains(store, MakeKey(2)));
+            Assert::IsTrue(Contains(store, MakeKey(3)));
+            Assert::IsTrue(Contains(store, MakeKey(4)));
+        }
+
+        TEST_METHOD (Add_ShouldRemoveLeastRecentlyUsed_WhenIndexIsFull)
+        {
+            // Three quarters of the 8 slots can be used
+            ThumbnailStore store(folder.wstring(), 1024 * 1024, 8);
+            Assert::AreEqual(S_OK, store.Open());
+            for (int i = 0; i < 100; i++)
+            {
+                Assert::AreEqual(S_OK, store.Add(MakeKey(i), MakeThumbnail(10, 10, 0)));
+                Assert::IsTrue(store.EntryCount() <= 6);
+                Assert::IsTrue(Contains(store, MakeKey(i)));
+            }
+
+            // The entries which were moved back when others were removed can still be found
+            for (int i = 99; i > 99 - static_cast<int>(store.EntryCount()); i--)
+            {
+                Assert::IsTrue(Contains(store, MakeKey(i)));
+            }
+        }
+
+        TEST_METHOD (Add_ShouldReplaceThumbnail_WhenKeyExists)
+        {
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(S_OK, store.Add(MakeKey(1), MakeThumbnail(10, 10, 1)));
+            Assert::AreEqual(S_OK, store.Add(MakeKey(1), MakeThumbnail(20, 20, 2)));
+
+            CachedThumbnail found;
+            Assert::AreEqual(S_OK, store.Find(MakeKey(1), found));
+            Assert::AreEqual(20u, found.width);
+            Assert::AreEqual(1u, store.EntryCount());
+            Assert::AreEqual(36 + 20 * 20 * 4ull, store.DiskUsage());
+        }
+
+        TEST_METHOD (Add_ShouldSkipThumbnail_WhenLargerThanBudget)
+        {
+            ThumbnailStore store(folder.wstring(), smallThumbnailBytes - 1);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(S_FALSE, store.Add(MakeKey(1), MakeThumbnail(10, 10, 0)));
+            Assert::AreEqual(E_INVALIDARG, store.Add(MakeKey(1), CachedThumbnail{ 10, 10, 0, {} }));
+            Assert::AreEqual(0u, store.EntryCount());
+        }
+
+        TEST_METHOD (Find_ShouldRemoveEntry_WhenFileIsMissing)
+        {
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(S_OK, store.Add(MakeKey(1), MakeThumbnail(10, 10, 0)));
+            for (const auto& entry : std::filesystem::directory_iterator(folder))
+            {
+                if (entry.path().extension() == L".thumb")
+                {
+                    std::filesystem::remove(entry.path());
+                }
+            }
+
+            Assert::IsFalse(Contains(store, MakeKey(1)));
+            Assert::AreEqual(0u, store.EntryCount());
+            Assert::AreEqual(0ull, store.DiskUsage());
+        }
+
+        TEST_METHOD (Open_ShouldStartOver_WhenIndexIsDamaged)
+        {
+            {
+                ThumbnailStore store(folder.wstring(), 1024 * 1024);
+                Assert::AreEqual(S_OK, store.Open());
+                Assert::AreEqual(S_OK, store.Add(MakeKey(1), MakeThumbnail(10, 10, 0)));
+            }
+            std::ofstream(folder / L"index.bin", std::ios::binary) << "not an index";
+
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(0u, store.EntryCount());
+            Assert::AreEqual(size_t{ 0 }, CountThumbnailFiles(folder));
+            Assert::IsFalse(Contains(store, MakeKey(1)));
+        }
+
+        TEST_METHOD (Open_ShouldRemoveThumbnailFiles_WhichAreNotIndexed)
+        {
+            {
+                ThumbnailStore store(folder.wstring(), 1024 * 1024);
+                Assert::AreEqual(S_OK, store.Open());
+                Assert::AreEqual(S_OK, store.Add(MakeKey(1), MakeThumbnail(10, 10, 0)));
+            }
+
+            // Files left by a process which ended in the middle of an addition
+            std::ofstream(folder / L"0123456789abcdef0123456789abcdef_96.thumb", std::ios::binary) << "orphaned";
+            std::ofstream(folder / L"0123456789abcdef0123456789abcdef_96.thumb.tmp", std::ios::binary) << "orphaned";
+
+            ThumbnailStore store(folder.wstring(), 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            Assert::AreEqual(size_t{ 1 }, CountThumbnailFiles(folder));
+            Assert::IsFalse(std::filesystem::exists(folder / L"0123456789abcdef0123456789abcdef_96.thumb.tmp"));
+            Assert::IsTrue(Contains(store, MakeKey(1)));
+        }
+
+        TEST_METHOD (Open_ShouldFail_WhenCapacityIsNotPowerOfTwo)
+        {
+            ThumbnailStore store(folder.wstring(), 1024 * 1024, 100);
+            Assert::AreEqual(E_INVALIDARG, store.Open());
+            CachedThumbnail found;
+            Assert::AreEqual(E_UNEXPECTED, store.Find(MakeKey(1), found));
+        }
+
+        // Not a correctness test, prints the time it takes to look up the thumbnails of a folder of Svg icons which are
+        // all in the store, as File Explorer does when it shows the folder again. It's ignored unless it's run on purpose.
+        BEGIN_TEST_METHOD_ATTRIBUTE(ThumbnailStore_Benchmark)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (ThumbnailStore_Benchmark)
+        {
+            const int files = 2000;
+            ThumbnailStore store(folder.wstring(), 1024ull * 1024 * 1024);
+            Assert::AreEqual(S_OK, store.Open());
+            for (int i = 0; i < files; i++)
+            {
+                store.Add(MakeKey(i), MakeThumbnail(96, 96, 0));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            CachedThumbnail found;
+            for (int i = 0; i < files; i++)
+            {
+                Assert::AreEqual(S_OK, store.Find(MakeKey(i), found));
+            }
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            const auto message = std::to_wstring(files) + L" thumbnails found in " + std::to_wstring(elapsed.count() / 1000) + L" ms, " +
+                                 std::to_wstring(elapsed.count() / files) + L" us per thumbnail\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
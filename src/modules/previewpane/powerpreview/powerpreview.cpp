@@ -12,7 +12,8 @@
 // Constructor
 PowerPreviewModule::PowerPreviewModule() :
     m_moduleName(GET_RESOURCE_STRING(IDS_MODULE_NAME)),
-    app_key(powerpreviewConstants::ModuleKey)
+    app_key(powerpreviewConstants::ModuleKey),
+    m_registryReconciler(m_fileExplorerModules)
 {
     // Initialize the toggle states for each module
     init_settings();
@@ -33,15 +34,28 @@ PowerPreviewModule::PowerPreviewModule() :
         L"Markdown Preview Handler",
         std::make_unique<RegistryWrapper>()));
 
+    // The caching provider is associated with Svg files, it extracts the thumbnails which aren't in its store with the managed Svg Thumbnail Provider
     m_fileExplorerModules.emplace_back(std::make_unique<ThumbnailProviderSettings>(
         true,
         L"svg-thumbnail-toggle-setting",
         GET_RESOURCE_STRING(IDS_SVG_THUMBNAIL_PROVIDER_SETTINGS_DESCRIPTION),
-        L"{36B27788-A8BB-4698-A756-DF9F11F64F84}",
+        L"{C225F0D2-6CAF-4278-9F66-7628AFD0066D}",
         L"Svg Thumbnail Provider",
         std::make_unique<RegistryWrapper>(),
         L".svg\\shellex\\{E357FCCD-A995-4576-B01F-234630154E96}"));
 
+    // Added after the managed preview handlers, so it takes over their file types when both are enabled
+    m_fileExplorerModules.emplace_back(std::make_unique<StreamingPreviewHandlerSettings>(
+        false,
+        L"streaming-previewer-toggle-setting",
+        GET_RESOURCE_STRING(IDS_PREVPANE_STREAMING_SETTINGS_DESCRIPTION),
+        L"{7da28b95-99a7-4077-9c25-ef2b4f709e3c}",
+        L"Streaming Preview Handler",
+        std::make_unique<RegistryWrapper>(),
+        std::vector<std::pair<std::wstring, std::wstring>>{
+            { L".md\\shellex\\{8895b1c6-b41f-4c1c-a562-0d564250836f}", L"{45769bcc-e8fd-42d0-947e-02beef77a1f5}" },
+            { L".svg\\shellex\\{8895b1c6-b41f-4c1c-a562-0d564250836f}", L"{ddee2b8a-6807-48a6-bb20-2338174ff779}" } }));
+
     // If the user is on the new settings interface, File Explorer might be disabled if they updated from old to new settings, so initialize the registry state in the constructor as PowerPreviewModule::enable/disable will not be called on startup
     if (UseNewSettings())
     {
@@ -70,6 +84,17 @@ const wchar_t* PowerPreviewModule::get_key()
 
 // Return JSON with the configuration options.
 bool PowerPreviewModule::get_config(_Out_ wchar_t* buffer, _Out_ int* buffer_size)
+{
+    return get_settings().serialize_to_buffer(buffer, buffer_size);
+}
+
+bool PowerPreviewModule::write_config(ConfigWriter writer, void* context)
+{
+    return get_settings().serialize_to_writer(writer, context);
+}
+
+// Create the Settings object with the configuration options.
+PowerToysSettings::Settings PowerPreviewModule::get_settings()
 {
     HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -95,7 +120,7 @@ bool PowerPreviewModule::get_config(_Out_ wchar_t* buffer, _Out_ int* buffer_siz
             fileExplorerModule->GetToggleSettingState());
     }
 
-    return settings.serialize_to_buffer(buffer, buffer_size);
+    return settings;
 }
 
 // Called by the runner to pass the updated settings values as a serialized JSON.
@@ -105,17 +130,30 @@ void PowerPreviewModule::set_config(const wchar_t* config)
     {
         PowerToysSettings::PowerToyValues settings = PowerToysSettings::PowerToyValues::from_json_string(config, get_key());
 
-        bool updateSuccess = true;
-        bool isElevated = is_process_elevated(false);
-        for (auto& fileExplorerModule : m_fileExplorerModules)
+        // If the user is using the new settings interface, as it does not have a toggle to modify enabled consider File Explorer to always be enabled
+        bool enabled = this->m_enabled || UseNewSettings();
+        std::vector<size_t> toggledModules;
+        for (size_t i = 0; i < m_fileExplorerModules.size(); i++)
         {
-            // If the user is using the new settings interface, as it does not have a toggle to modify enabled consider File Explorer to always be enabled
-            updateSuccess = updateSuccess && fileExplorerModule->UpdateState(settings, this->m_enabled || UseNewSettings(), isElevated);
+            auto& fileExplorerModule = m_fileExplorerModules[i];
+            auto toggle = settings.get_bool_value(fileExplorerModule->GetToggleSettingName());
+            if (toggle && *toggle != fileExplorerModule->GetToggleSettingState())
+            {
+                fileExplorerModule->UpdateToggleSettingState(*toggle);
+                toggledModules.push_back(i);
+
+                // The registry is only modified when File Explorer is enabled, otherwise just change the UI and save the updated config.
+                if (!enabled)
+                {
+                    Trace::PowerPreviewSettingsUpdated(fileExplorerModule->GetToggleSettingName().c_str(), !*toggle, *toggle, enabled);
+                }
+            }
         }
 
-        if (!updateSuccess)
+        // The modules whose toggle didn't change are left alone, even if their registry state drifted
+        if (enabled && !toggledModules.empty())
         {
-            show_update_warning_message();
+            apply_registry_changes(m_registryReconciler.ComputeChanges(toggledModules));
         }
 
         settings.save_to_settings_file();
@@ -153,6 +191,9 @@ void PowerPreviewModule::disable()
         }
     });
 
+    // The modules were disabled without the reconciler, their registry state has to be read again
+    m_registryReconciler.Invalidate();
+
     if (this->m_enabled)
     {
         Trace::EnabledPowerPreview(false);
@@ -188,20 +229,6 @@ void PowerPreviewModule::init_settings()
     }
 }
 
-// Function to check if the registry states need to be updated
-bool PowerPreviewModule::is_registry_update_required()
-{
-    for (auto& fileExplorerModule : m_fileExplorerModules)
-    {
-        if (fileExplorerModule->GetToggleSettingState() != fileExplorerModule->CheckRegistryState())
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 // Function to warn the user that PowerToys needs to run as administrator for changes to take effect
 void PowerPreviewModule::show_update_warning_message()
 {
@@ -221,16 +248,6 @@ void PowerPreviewModule::show_update_warning_message()
     }
 }
 
-// Function that checks if a registry method is required and if so checks if the process is elevated and accordingly executes the method or shows a warning
-void PowerPreviewModule::registry_and_elevation_check_wrapper(std::function<void()> method)
-{
-    // Check if a registry update is required
-    if (is_registry_update_required())
-    {
-        elevation_check_wrapper(method);
-    }
-}
-
 // Function that checks if the process is elevated and accordingly executes the method or shows a warning
 void PowerPreviewModule::elevation_check_wrapper(std::function<void()> method)
 {
@@ -249,18 +266,19 @@ void PowerPreviewModule::elevation_check_wrapper(std::function<void()> method)
 // Function that updates the registry state to match the toggle states
 void PowerPreviewModule::update_registry_to_match_toggles()
 {
-    registry_and_elevation_check_wrapper([this]() {
-        for (auto& fileExplorerModule : m_fileExplorerModules)
-        {
-            if (fileExplorerModule->GetToggleSettingState())
-            {
-                // Enable all the modules with initial state set as true.
-                fileExplorerModule->Enable();
-            }
-            else
+    apply_registry_changes(m_registryReconciler.ComputeChanges());
+}
+
+// Function that updates the registry state of the given modules in a single elevation check
+void PowerPreviewModule::apply_registry_changes(const std::vector<size_t>& changes)
+{
+    if (!changes.empty())
+    {
+        elevation_check_wrapper([this, &changes]() {
+            if (!m_registryReconciler.ApplyChanges(changes))
             {
-                fileExplorerModule->Disable();
+                show_update_warning_message();
             }
-        }
-    });
+        });
+    }
 }
@@ -5,7 +5,9 @@
 #include "settings.h"
 #include "thumbnail_provider.h"
 #include "preview_handler.h"
+#include "streaming_preview_handler.h"
 #include "registry_wrapper.h"
+#include "registry_reconciler.h"
 #include <powerpreview\powerpreviewConstants.h>
 
 using namespace PowerPreviewSettings;
@@ -23,21 +25,24 @@ private:
     std::wstring app_key;
     std::vector<std::unique_ptr<FileExplorerPreviewSettings>> m_fileExplorerModules;
 
-    // Function to check if the registry states need to be updated
-    bool is_registry_update_required();
+    // Keeps the registry state of the modules, so only the modules whose toggle changed are written
+    RegistryReconciler m_registryReconciler;
 
     // Function to warn the user that PowerToys needs to run as administrator for changes to take effect
     void show_update_warning_message();
 
-    // Function that checks if a registry method is required and if so checks if the process is elevated and accordingly executes the method or shows a warning
-    void registry_and_elevation_check_wrapper(std::function<void()> method);
-
     // Function that checks if the process is elevated and accordingly executes the method or shows a warning
     void elevation_check_wrapper(std::function<void()> method);
 
     // Function that updates the registry state to match the toggle states
     void update_registry_to_match_toggles();
 
+    // Function that updates the registry state of the given modules in a single elevation check
+    void apply_registry_changes(const std::vector<size_t>& changes);
+
+    // Function that creates the Settings object with the configuration options
+    PowerToysSettings::Settings get_settings();
+
 public:
     PowerPreviewModule();
 
@@ -45,6 +50,7 @@ public:
     virtual const wchar_t* get_name();
     virtual const wchar_t* get_key();
     virtual bool get_config(_Out_ wchar_t* buffer, _Out_ int* buffer_size);
+    virtual bool write_config(ConfigWriter writer, void* context);
     virtual void set_config(const wchar_t* config);
     virtual void enable();
     virtual void disable();
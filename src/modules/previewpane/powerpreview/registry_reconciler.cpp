@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "registry_reconciler.h"
+#include "trace.h"
+#include <numeric>
+
+namespace PowerPreviewSettings
+{
+    RegistryReconciler::RegistryReconciler(const std::vector<std::unique_ptr<FileExplorerPreviewSettings>>& modules) :
+        m_modules(modules)
+    {
+    }
+
+    std::vector<size_t> RegistryReconciler::ComputeChanges()
+    {
+        std::vector<size_t> modules(m_modules.size());
+        std::iota(modules.begin(), modules.end(), size_t{ 0 });
+        return ComputeChanges(modules);
+    }
+
+    std::vector<size_t> RegistryReconciler::ComputeChanges(const std::vector<size_t>& modules)
+    {
+        // Modules are only added after the reconciler is created
+        m_registryStates.resize(m_modules.size());
+
+        std::vector<size_t> changes;
+        for (size_t i : modules)
+        {
+            if (!m_registryStates[i])
+            {
+                m_registryStates[i] = m_modules[i]->CheckRegistryState();
+            }
+
+            if (*m_registryStates[i] != m_modules[i]->GetToggleSettingState())
+            {
+                changes.push_back(i);
+            }
+        }
+
+        return changes;
+    }
+
+    bool RegistryReconciler::ApplyChanges(const std::vector<size_t>& changes)
+    {
+        m_registryStates.resize(m_modules.size());
+
+        bool updateSuccess = true;
+        for (size_t i : changes)
+        {
+            auto& fileExplorerModule = m_modules[i];
+            bool newState = fileExplorerModule->GetToggleSettingState();
+            LONG err = newState ? fileExplorerModule->Enable() : fileExplorerModule->Disable();
+            if (err == ERROR_SUCCESS)
+            {
+                m_registryStates[i] = newState;
+                Trace::PowerPreviewSettingsUpdated(fileExplorerModule->GetToggleSettingName().c_str(), !newState, newState, true);
+            }
+            else
+            {
+                // The module may have been partially updated, so its state is read again on the next reconciliation
+                m_registryStates[i].reset();
+                Trace::PowerPreviewSettingsUpdateFailed(fileExplorerModule->GetToggleSettingName().c_str(), !newState, newState, true);
+                updateSuccess = false;
+            }
+        }
+
+        return updateSuccess;
+    }
+
+    void RegistryReconciler::Invalidate()
+    {
+        m_registryStates.clear();
+    }
+}
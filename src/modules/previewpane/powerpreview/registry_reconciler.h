@@ -0,0 +1,33 @@
+#pragma once
+#include <optional>
+#include "settings.h"
+
+namespace PowerPreviewSettings
+{
+    // Brings the registry state of the file explorer modules to the state of their toggles.
+    // The registry state of each module is read once and kept in a snapshot, which is updated with the result of every write,
+    // so a change of the settings only touches the registry for the modules whose state changed.
+    class RegistryReconciler
+    {
+    private:
+        const std::vector<std::unique_ptr<FileExplorerPreviewSettings>>& m_modules;
+
+        // The last known registry state of each module, empty when it has to be read again
+        std::vector<std::optional<bool>> m_registryStates;
+
+    public:
+        RegistryReconciler(const std::vector<std::unique_ptr<FileExplorerPreviewSettings>>& modules);
+
+        // Returns the indices of the modules whose registry state doesn't match their toggle, only the states missing from the snapshot are read
+        std::vector<size_t> ComputeChanges();
+
+        // Same as ComputeChanges, restricted to the modules at the given indices
+        std::vector<size_t> ComputeChanges(const std::vector<size_t>& modules);
+
+        // Enables or disables the given modules to match their toggles. Returns false if any of the registry updates failed.
+        bool ApplyChanges(const std::vector<size_t>& changes);
+
+        // Drops the snapshot, to be called after the registry is modified without the reconciler
+        void Invalidate();
+    };
+}
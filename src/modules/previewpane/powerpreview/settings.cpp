@@ -62,61 +62,4 @@ namespace PowerPreviewSettings
             this->UpdateToggleSettingState(*toggle);
         }
     }
-
-    // Manage change in state of file explorer module settings.
-    bool FileExplorerPreviewSettings::UpdateState(PowerToysSettings::PowerToyValues& settings, bool enabled, bool isElevated)
-    {
-        auto toggle = settings.get_bool_value(this->GetToggleSettingName());
-        if (toggle)
-        {
-            auto lastState = this->GetToggleSettingState();
-            auto newState = *toggle;
-            if (lastState != newState)
-            {
-                this->UpdateToggleSettingState(newState);
-
-                // If global setting is enable. Add or remove the file explorer module otherwise just change the UI and save the updated config.
-                if (enabled)
-                {
-                    // Check if the registry state does not match the new state, registry needs to be modified
-                    if (this->CheckRegistryState() != newState)
-                    {
-                        if (isElevated)
-                        {
-                            LONG err;
-                            if (lastState)
-                            {
-                                err = this->Disable();
-                            }
-                            else
-                            {
-                                err = this->Enable();
-                            }
-
-                            if (err == ERROR_SUCCESS)
-                            {
-                                Trace::PowerPreviewSettingsUpdated(this->GetToggleSettingName().c_str(), lastState, newState, enabled);
-                            }
-                            else
-                            {
-                                Trace::PowerPreviewSettingsUpdateFailed(this->GetToggleSettingName().c_str(), lastState, newState, enabled);
-                            }
-                        }
-                        // If process is not elevated, return false as it is not possible to update the registry
-                        else
-                        {
-                            return false;
-                        }
-                    }
-                    // If it matches the new state, no update to registry is required
-                }
-                else
-                {
-                    Trace::PowerPreviewSettingsUpdated(this->GetToggleSettingName().c_str(), lastState, newState, enabled);
-                }
-            }
-        }
-
-        return true;
-    }
 }
@@ -22,6 +22,7 @@ namespace PowerPreviewSettings
 
     public:
         FileExplorerPreviewSettings(bool toggleSettingEnabled, const std::wstring& toggleSettingName, const std::wstring& toggleSettingDescription, LPCWSTR clsid, const std::wstring& registryValueData, std::unique_ptr<RegistryWrapperIface>);
+        virtual ~FileExplorerPreviewSettings() = default;
 
         virtual bool GetToggleSettingState() const;
         virtual void UpdateToggleSettingState(bool state);
@@ -30,7 +31,6 @@ namespace PowerPreviewSettings
         virtual LPCWSTR GetCLSID() const;
         virtual std::wstring GetRegistryValueData() const;
         virtual void LoadState(PowerToysSettings::PowerToyValues& settings);
-        virtual bool UpdateState(PowerToysSettings::PowerToyValues& settings, bool enabled, bool isElevated);
         virtual LONG Enable() = 0;
         virtual LONG Disable() = 0;
         virtual bool CheckRegistryState() = 0;
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "streaming_preview_handler.h"
+
+namespace PowerPreviewSettings
+{
+    // Function to enable the preview handler and associate it with its file types in registry
+    LONG StreamingPreviewHandlerSettings::Enable()
+    {
+        LONG result = PreviewHandlerSettings::Enable();
+        for (const auto& [subkey, managedClsid] : m_associations)
+        {
+            // Set the default value of the association to the CLSID of the handler, keep the first error.
+            LONG errorCode = this->m_registryWrapper->SetRegistryValue(HKEY_CLASSES_ROOT, subkey.c_str(), nullptr, REG_SZ, (LPBYTE)this->GetCLSID(), (DWORD)(wcslen(this->GetCLSID()) * sizeof(wchar_t)));
+            if (result == ERROR_SUCCESS)
+            {
+                result = errorCode;
+            }
+        }
+
+        return result;
+    }
+
+    // Function to disable the preview handler and restore the associations of its file types in registry
+    LONG StreamingPreviewHandlerSettings::Disable()
+    {
+        LONG result = PreviewHandlerSettings::Disable();
+        for (const auto& [subkey, managedClsid] : m_associations)
+        {
+            // Give the file type back to its managed preview handler.
+            LONG errorCode = this->m_registryWrapper->SetRegistryValue(HKEY_CLASSES_ROOT, subkey.c_str(), nullptr, REG_SZ, (LPBYTE)managedClsid.c_str(), (DWORD)(managedClsid.length() * sizeof(wchar_t)));
+            if (result == ERROR_SUCCESS)
+            {
+                result = errorCode;
+            }
+        }
+
+        return result;
+    }
+
+    // Function to check if the preview handler is enabled and associated with its file types in registry
+    bool StreamingPreviewHandlerSettings::CheckRegistryState()
+    {
+        if (!PreviewHandlerSettings::CheckRegistryState())
+        {
+            return false;
+        }
+
+        for (const auto& [subkey, managedClsid] : m_associations)
+        {
+            DWORD dataType;
+            DWORD byteCount = 255;
+            wchar_t regValue[255] = { 0 };
+
+            LONG errorCode = this->m_registryWrapper->GetRegistryValue(HKEY_CLASSES_ROOT, subkey.c_str(), nullptr, &dataType, regValue, &byteCount);
+
+            // Check if the file type is associated with the handler
+            if (errorCode != ERROR_SUCCESS || dataType != REG_SZ || wcscmp(regValue, this->GetCLSID()) != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Function to retrieve the association sub keys and the CLSIDs they are restored to
+    const std::vector<std::pair<std::wstring, std::wstring>>& StreamingPreviewHandlerSettings::GetAssociations() const
+    {
+        return m_associations;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "preview_handler.h"
+
+namespace PowerPreviewSettings
+{
+    // Settings of the native preview handler for large files. Besides being added to the Preview Handlers list, it takes over the preview handler association of the file types it previews, and gives them back to their managed handlers when it is disabled.
+    class StreamingPreviewHandlerSettings :
+        public PreviewHandlerSettings
+    {
+    private:
+        // Pairs of relative HKCR sub key of a preview handler association (generally HKCR\fileExtension\shellex\{8895b1c6-b41f-4c1c-a562-0d564250836f}) vs CLSID of the managed handler it is restored to
+        std::vector<std::pair<std::wstring, std::wstring>> m_associations;
+
+    public:
+        StreamingPreviewHandlerSettings(bool toggleSettingEnabled, const std::wstring& toggleSettingName, const std::wstring& toggleSettingDescription, LPCWSTR clsid, const std::wstring& registryValueData, std::unique_ptr<RegistryWrapperIface> registryWrapper, std::vector<std::pair<std::wstring, std::wstring>> associations) :
+            PreviewHandlerSettings(toggleSettingEnabled, toggleSettingName, toggleSettingDescription, clsid, registryValueData, std::move(registryWrapper)), m_associations(std::move(associations))
+        {
+        }
+
+        // Function to enable the preview handler and associate it with its file types in registry
+        LONG Enable();
+
+        // Function to disable the preview handler and restore the associations of its file types in registry
+        LONG Disable();
+
+        // Function to check if the preview handler is enabled and associated with its file types in registry
+        bool CheckRegistryState();
+
+        // Function to retrieve the association sub keys and the CLSIDs they are restored to
+        const std::vector<std::pair<std::wstring, std::wstring>>& GetAssociations() const;
+    };
+}
@@ -7,6 +7,8 @@
 #include <powerpreview/registry_wrapper.h>
 #include <powerpreview/preview_handler.cpp>
 #include <powerpreview/thumbnail_provider.cpp>
+#include <powerpreview/streaming_preview_handler.cpp>
+#include <powerpreview/registry_reconciler.cpp>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace PowerToysSettings;
@@ -106,307 +108,260 @@ namespace FileExplorerPreviewSettingsTest
             Assert::AreEqual(previewSettings.GetToggleSettingState(), defaultState);
         }
 
-        TEST_METHOD (PreviewHandlerSettingsUpdateState_ShouldDisableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsFalseAndPowerToysIsElevatedAndRegistryContainsThePreview)
-        {
-            // Arrange
-            bool enabled = true;
-            bool elevated = true;
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(true);
-            // Add expected data in registry
-            mockRegistryWrapper->SetMockData(previewSettings.GetRegistryValueData());
-
-            // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
-
-            // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
-        }
-
-        TEST_METHOD (ThumbnailProviderSettingsUpdateState_ShouldDisableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsFalseAndPowerToysIsElevatedAndRegistryContainsThePreview)
+        TEST_METHOD (UpdateToggleSettingState_ShouldUpdateState_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = true;
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            ThumbnailProviderSettings thumbnailSettings = GetThumbnailProviderSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(thumbnailSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
-            thumbnailSettings.UpdateToggleSettingState(true);
-            // Add expected data in registry
-            mockRegistryWrapper->SetMockData(thumbnailSettings.GetCLSID());
+            bool updatedState = false;
+            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, new RegistryMock());
 
             // Act
-            thumbnailSettings.UpdateState(settings, enabled, elevated);
+            previewSettings.UpdateToggleSettingState(updatedState);
 
             // Assert
-            Assert::IsFalse(thumbnailSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(previewSettings.GetToggleSettingState(), updatedState);
         }
 
-        TEST_METHOD (UpdateState_ShouldNotDisableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsFalseAndPowerToysIsElevatedAndRegistryDoesNotContainThePreview)
+        TEST_METHOD (PreviewHandlerSettingsEnable_ShouldCallSetRegistryValueWithValidArguments_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = true;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
             PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(true);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            previewSettings.Enable();
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, PreviewHandlerSettings::GetSubkey());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueName, previewSettings.GetCLSID());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, previewSettings.GetRegistryValueData().c_str());
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_LOCAL_MACHINE));
         }
 
-        TEST_METHOD (UpdateState_ShouldNotDisableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsFalseAndPowerToysIsNotElevated)
+        TEST_METHOD (PreviewHandlerDisable_ShouldCallDeleteRegistryValueWithValidArguments_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = false;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
             PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(true);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            previewSettings.Disable();
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.SubKey, PreviewHandlerSettings::GetSubkey());
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.ValueName, previewSettings.GetCLSID());
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->DeleteRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_LOCAL_MACHINE));
         }
 
-        TEST_METHOD (UpdateState_ShouldEnableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsTrueAndPowerToysIsElevatedAndRegistryDoesNotContainThePreview)
+        TEST_METHOD (ThumbnailProviderSettingsEnable_ShouldCallSetRegistryValueWithValidArguments_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = true;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"true"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(false);
+            ThumbnailProviderSettings thumbnailSettings = GetThumbnailProviderSettingsObject(true, mockRegistryWrapper);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            thumbnailSettings.Enable();
 
             // Assert
             Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
-        }
-
-        TEST_METHOD (PreviewHandlerSettingsUpdateState_ShouldNotEnableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsTrueAndPowerToysIsElevatedAndRegistryContainsThePreview)
-        {
-            // Arrange
-            bool enabled = true;
-            bool elevated = true;
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"true"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(false);
-            // Add expected data in registry
-            mockRegistryWrapper->SetMockData(previewSettings.GetRegistryValueData());
-
-            // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
-
-            // Assert
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, thumbnailSettings.GetSubkey());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueName, nullptr);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, thumbnailSettings.GetCLSID());
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
         }
 
-        TEST_METHOD (ThumbnailProviderSettingsUpdateState_ShouldNotEnableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsTrueAndPowerToysIsElevatedAndRegistryContainsThePreview)
+        TEST_METHOD (ThumbnailProviderSettingsDisable_ShouldCallDeleteRegistryValueWithValidArguments_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = true;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
             ThumbnailProviderSettings thumbnailSettings = GetThumbnailProviderSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(thumbnailSettings.GetToggleSettingName(), L"true"), L"FileExplorerPreviewTests");
-            thumbnailSettings.UpdateToggleSettingState(false);
-            // Add expected data in registry
-            mockRegistryWrapper->SetMockData(thumbnailSettings.GetCLSID());
 
             // Act
-            thumbnailSettings.UpdateState(settings, enabled, elevated);
+            thumbnailSettings.Disable();
 
             // Assert
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.SubKey, thumbnailSettings.GetSubkey());
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.ValueName, nullptr);
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->DeleteRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
         }
 
-        TEST_METHOD (UpdateState_ShouldNotEnableInRegistry_IfPreviewsAreEnabledAndNewSettingsStateIsTrueAndPowerToysIsNotElevated)
+        TEST_METHOD (StreamingPreviewHandlerSettingsEnable_ShouldAssociateFileTypesWithHandler_WhenCalled)
         {
             // Arrange
-            bool enabled = true;
-            bool elevated = false;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"true"), L"FileExplorerPreviewTests");
-            previewSettings.UpdateToggleSettingState(false);
+            StreamingPreviewHandlerSettings streamingSettings = GetStreamingPreviewHandlerSettingsObject(false, mockRegistryWrapper);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            streamingSettings.Enable();
 
             // Assert
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 3);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, streamingSettings.GetAssociations().back().first.c_str());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueName, nullptr);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, streamingSettings.GetCLSID());
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
         }
 
-        TEST_METHOD (UpdateState_ShouldUpdateToggleSettingState_IfPreviewsAreEnabledAndPowerToysIsElevated)
+        TEST_METHOD (StreamingPreviewHandlerSettingsDisable_ShouldRestoreManagedHandlerAssociations_WhenCalled)
         {
             // Arrange
-            bool enabled = false;
-            bool elevated = true;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
+            StreamingPreviewHandlerSettings streamingSettings = GetStreamingPreviewHandlerSettingsObject(false, mockRegistryWrapper);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            streamingSettings.Disable();
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.SubKey, PreviewHandlerSettings::GetSubkey());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 2);
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, streamingSettings.GetAssociations().back().first.c_str());
+            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, streamingSettings.GetAssociations().back().second.c_str());
+            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
         }
 
-        TEST_METHOD (UpdateState_ShouldUpdateToggleSettingState_IfPreviewsAreEnabledAndPowerToysIsNotElevated)
+        TEST_METHOD (StreamingPreviewHandlerSettingsCheckRegistryState_ShouldReturnFalse_IfFileTypesAreNotAssociatedWithHandler)
         {
             // Arrange
-            bool enabled = false;
-            bool elevated = false;
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
+            StreamingPreviewHandlerSettings streamingSettings = GetStreamingPreviewHandlerSettingsObject(true, mockRegistryWrapper);
+            // The handler is in the Preview Handlers list, but the file types are associated with another handler
+            mockRegistryWrapper->SetMockData(streamingSettings.GetRegistryValueData());
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            bool registryState = streamingSettings.CheckRegistryState();
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
+            Assert::IsFalse(registryState);
+            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 2);
+            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.SubKey, streamingSettings.GetAssociations().front().first.c_str());
         }
 
-        TEST_METHOD (UpdateState_ShouldOnlyUpdateToggleSettingState_IfPreviewsAreDisabledAndPowerToysIsElevated)
+        TEST_METHOD (RegistryReconcilerComputeChanges_ShouldReadRegistryOnlyOnce_WhenCalledRepeatedly)
         {
             // Arrange
-            bool enabled = false;
-            bool elevated = true;
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
+            RegistryMock* previewMock = new RegistryMock();
+            RegistryMock* thumbnailMock = new RegistryMock();
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, previewMock)));
+            modules.push_back(std::make_unique<ThumbnailProviderSettings>(GetThumbnailProviderSettingsObject(true, thumbnailMock)));
+            RegistryReconciler reconciler(modules);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            auto changes = reconciler.ComputeChanges();
+            reconciler.ComputeChanges();
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 0);
+            Assert::AreEqual(changes.size(), (size_t)2);
+            Assert::AreEqual(previewMock->GetRegistryMockProperties.NumOfCalls, 1);
+            Assert::AreEqual(thumbnailMock->GetRegistryMockProperties.NumOfCalls, 1);
         }
 
-        TEST_METHOD (UpdateState_ShouldOnlyUpdateToggleSettingState_IfPreviewsAreDisabledAndPowerToysIsNotElevated)
+        TEST_METHOD (RegistryReconcilerComputeChanges_ShouldOnlyCheckGivenModules_WhenModulesAreGiven)
         {
             // Arrange
-            bool enabled = false;
-            bool elevated = false;
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-            auto settings = PowerToyValues::from_json_string(GetJSONSettings(previewSettings.GetToggleSettingName(), L"false"), L"FileExplorerPreviewTests");
+            RegistryMock* previewMock = new RegistryMock();
+            RegistryMock* thumbnailMock = new RegistryMock();
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, previewMock)));
+            modules.push_back(std::make_unique<ThumbnailProviderSettings>(GetThumbnailProviderSettingsObject(true, thumbnailMock)));
+            RegistryReconciler reconciler(modules);
 
             // Act
-            previewSettings.UpdateState(settings, enabled, elevated);
+            auto changes = reconciler.ComputeChanges({ 1 });
 
             // Assert
-            Assert::IsFalse(previewSettings.GetToggleSettingState());
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 0);
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 0);
+            Assert::AreEqual(changes.size(), (size_t)1);
+            Assert::AreEqual(changes[0], (size_t)1);
+            Assert::AreEqual(previewMock->GetRegistryMockProperties.NumOfCalls, 0);
+            Assert::AreEqual(thumbnailMock->GetRegistryMockProperties.NumOfCalls, 1);
         }
 
-        TEST_METHOD (UpdateToggleSettingState_ShouldUpdateState_WhenCalled)
+        TEST_METHOD (RegistryReconcilerApplyChanges_ShouldOnlyUpdateModulesWhoseRegistryStateDiffersFromToggle)
         {
             // Arrange
-            bool updatedState = false;
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, new RegistryMock());
+            RegistryMock* enabledMock = new RegistryMock();
+            RegistryMock* disabledMock = new RegistryMock();
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, enabledMock)));
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, disabledMock)));
+            // Only the first module is already enabled in registry
+            enabledMock->SetMockData(modules[0]->GetRegistryValueData());
+            RegistryReconciler reconciler(modules);
 
             // Act
-            previewSettings.UpdateToggleSettingState(updatedState);
+            auto changes = reconciler.ComputeChanges();
+            bool updateSuccess = reconciler.ApplyChanges(changes);
 
             // Assert
-            Assert::AreEqual(previewSettings.GetToggleSettingState(), updatedState);
+            Assert::IsTrue(updateSuccess);
+            Assert::AreEqual(changes.size(), (size_t)1);
+            Assert::AreEqual(changes[0], (size_t)1);
+            Assert::AreEqual(enabledMock->SetRegistryMockProperties.NumOfCalls, 0);
+            Assert::AreEqual(disabledMock->SetRegistryMockProperties.NumOfCalls, 1);
         }
 
-        TEST_METHOD (PreviewHandlerSettingsEnable_ShouldCallSetRegistryValueWithValidArguments_WhenCalled)
+        TEST_METHOD (RegistryReconcilerComputeChanges_ShouldNotReadRegistry_AfterChangesAreApplied)
         {
             // Arrange
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, mockRegistryWrapper)));
+            RegistryReconciler reconciler(modules);
+            reconciler.ApplyChanges(reconciler.ComputeChanges());
+            modules[0]->UpdateToggleSettingState(false);
 
             // Act
-            previewSettings.Enable();
+            auto changes = reconciler.ComputeChanges();
+            reconciler.ApplyChanges(changes);
 
             // Assert
+            Assert::AreEqual(changes.size(), (size_t)1);
+            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 1);
             Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, PreviewHandlerSettings::GetSubkey());
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueName, previewSettings.GetCLSID());
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, previewSettings.GetRegistryValueData().c_str());
-            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_LOCAL_MACHINE));
-        }
-
-        TEST_METHOD (PreviewHandlerDisable_ShouldCallDeleteRegistryValueWithValidArguments_WhenCalled)
-        {
-            // Arrange
-            RegistryMock* mockRegistryWrapper = new RegistryMock();
-            PreviewHandlerSettings previewSettings = GetPreviewHandlerSettingsObject(true, mockRegistryWrapper);
-
-            // Act
-            previewSettings.Disable();
-
-            // Assert
             Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.SubKey, PreviewHandlerSettings::GetSubkey());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.ValueName, previewSettings.GetCLSID());
-            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->DeleteRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_LOCAL_MACHINE));
+            Assert::IsTrue(reconciler.ComputeChanges().empty());
         }
 
-        TEST_METHOD (ThumbnailProviderSettingsEnable_ShouldCallSetRegistryValueWithValidArguments_WhenCalled)
+        TEST_METHOD (RegistryReconcilerApplyChanges_ShouldReadRegistryAgain_IfUpdateFailed)
         {
             // Arrange
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            ThumbnailProviderSettings thumbnailSettings = GetThumbnailProviderSettingsObject(true, mockRegistryWrapper);
+            mockRegistryWrapper->SetRegistryMockProperties.ReturnValue = ERROR_ACCESS_DENIED;
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, mockRegistryWrapper)));
+            RegistryReconciler reconciler(modules);
 
             // Act
-            thumbnailSettings.Enable();
+            bool updateSuccess = reconciler.ApplyChanges(reconciler.ComputeChanges());
+            auto changes = reconciler.ComputeChanges();
 
             // Assert
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.SubKey, thumbnailSettings.GetSubkey());
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueName, nullptr);
-            Assert::AreEqual(mockRegistryWrapper->SetRegistryMockProperties.ValueData, thumbnailSettings.GetCLSID());
-            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->SetRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
+            Assert::IsFalse(updateSuccess);
+            Assert::AreEqual(changes.size(), (size_t)1);
+            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 2);
         }
 
-        TEST_METHOD (ThumbnailProviderSettingsDisable_ShouldCallDeleteRegistryValueWithValidArguments_WhenCalled)
+        TEST_METHOD (RegistryReconcilerInvalidate_ShouldReadRegistryAgain_WhenCalled)
         {
             // Arrange
             RegistryMock* mockRegistryWrapper = new RegistryMock();
-            ThumbnailProviderSettings thumbnailSettings = GetThumbnailProviderSettingsObject(true, mockRegistryWrapper);
+            std::vector<std::unique_ptr<FileExplorerPreviewSettings>> modules;
+            modules.push_back(std::make_unique<PreviewHandlerSettings>(GetPreviewHandlerSettingsObject(true, mockRegistryWrapper)));
+            RegistryReconciler reconciler(modules);
+            reconciler.ComputeChanges();
+            // The handler is enabled in registry without the reconciler
+            mockRegistryWrapper->SetMockData(modules[0]->GetRegistryValueData());
 
             // Act
-            thumbnailSettings.Disable();
+            reconciler.Invalidate();
+            auto changes = reconciler.ComputeChanges();
 
             // Assert
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.NumOfCalls, 1);
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.SubKey, thumbnailSettings.GetSubkey());
-            Assert::AreEqual(mockRegistryWrapper->DeleteRegistryMockProperties.ValueName, nullptr);
-            Assert::AreEqual((ULONG_PTR)(mockRegistryWrapper->DeleteRegistryMockProperties.Scope), (ULONG_PTR)(HKEY_CLASSES_ROOT));
+            Assert::IsTrue(changes.empty());
+            Assert::AreEqual(mockRegistryWrapper->GetRegistryMockProperties.NumOfCalls, 2);
         }
 
         PreviewHandlerSettings GetPreviewHandlerSettingsObject(bool defaultState, RegistryWrapperIface* registryMock)
@@ -432,6 +387,18 @@ namespace FileExplorerPreviewSettingsTest
                 L"valid-subkey");
         }
 
+        StreamingPreviewHandlerSettings GetStreamingPreviewHandlerSettingsObject(bool defaultState, RegistryWrapperIface* registryMock)
+        {
+            return StreamingPreviewHandlerSettings(
+                defaultState,
+                L"valid-name",
+                L"valid-description",
+                L"valid-guid",
+                L"valid-handler",
+                std::unique_ptr<RegistryWrapperIface>(registryMock),
+                { { L"valid-subkey", L"valid-managed-guid" }, { L"other-valid-subkey", L"other-valid-managed-guid" } });
+        }
+
         std::wstring GetJSONSettings(const std::wstring& _settingsNameId, const std::wstring& _value) const
         {
             return L"{\"name\":\"Module Name\",\"properties\" : {\"" + _settingsNameId + L"\":{\"value\":" + _value + L"}},\"version\" : \"1.0\" }";
@@ -7,20 +7,25 @@
 class D2DSVG
 {
 public:
-    D2DSVG& load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc);
+    // The document is shared with the SvgAssetCache it comes from
+    D2DSVG& load(winrt::com_ptr<ID2D1SvgDocument> document);
     D2DSVG& resize(int x, int y, int width, int height, float fill, float max_scale = -1.0f);
     D2DSVG& render(ID2D1DeviceContext5* d2d_dc);
-    D2DSVG& recolor(uint32_t oldcolor, uint32_t newcolor);
     float get_scale() const { return used_scale; }
     int width() const { return svg_width; }
     int height() const { return svg_height; }
     D2DSVG& toggle_element(const wchar_t* id, bool visible);
+    D2DSVG& set_element_attribute(const wchar_t* id, const wchar_t* name, float value);
     winrt::com_ptr<ID2D1SvgElement> find_element(const std::wstring& id);
     D2D1_RECT_F rescale(D2D1_RECT_F rect);
+    // Must be called after changing the document through an element returned by find_element
+    D2DSVG& invalidate();
 
 protected:
     float used_scale = 1.0f;
     winrt::com_ptr<ID2D1SvgDocument> svg;
     int svg_width = -1, svg_height = -1;
     D2D1::Matrix3x2F transform;
+    // The document drawn with the transform, recorded on the first render after a change
+    winrt::com_ptr<ID2D1CommandList> commands;
 };
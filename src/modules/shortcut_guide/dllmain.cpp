@@ -33,4 +33,9 @@ extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
     {
         return nullptr;
     }
+}
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "keyboard_state.h"
+#include <array>
+#include <atomic>
 
 bool winkey_held()
 {
@@ -78,16 +80,89 @@ constexpr bool should_check(int vk)
     return false;
 }
 
+namespace
+{
+    using KeyMask = std::array<uint64_t, 4>;
+
+    constexpr KeyMask make_checked_keys_mask()
+    {
+        KeyMask mask{};
+        for (int vk = VK_CANCEL; vk <= VK_OEM_CLEAR; vk++)
+        {
+            if (should_check(vk))
+            {
+                mask[vk / 64] |= 1ull << (vk % 64);
+            }
+        }
+        return mask;
+    }
+
+    constexpr KeyMask checked_keys_mask = make_checked_keys_mask();
+
+    // The hook may miss key events, e.g. when a key is pressed before Shortcut Guide is enabled or released on the
+    // secure desktop, so the tracked state is periodically rebuilt from GetAsyncKeyState.
+    constexpr ULONGLONG reconcile_interval_ms = 1000;
+
+    // Set and cleared by the low level hook
+    std::array<std::atomic<uint64_t>, 4> pressed_keys;
+    std::atomic<ULONGLONG> last_reconcile = 0;
+
+    void reconcile_pressed_keys()
+    {
+        for (int vk = VK_CANCEL; vk <= VK_OEM_CLEAR; vk++)
+        {
+            if (should_check(vk))
+            {
+                update_key_state(vk, GetAsyncKeyState(vk) & 0x8000);
+            }
+        }
+    }
+}
+
+void update_key_state(unsigned vk_code, bool key_down)
+{
+    if (vk_code > 0xFF)
+    {
+        return;
+    }
+
+    const uint64_t bit = 1ull << (vk_code % 64);
+    if (key_down)
+    {
+        pressed_keys[vk_code / 64].fetch_or(bit);
+    }
+    else
+    {
+        pressed_keys[vk_code / 64].fetch_and(~bit);
+    }
+}
+
 bool only_winkey_key_held()
 {
-    for (int vk = VK_CANCEL; vk <= VK_OEM_CLEAR; vk++)
+    const auto now = GetTickCount64();
+    if (now - last_reconcile >= reconcile_interval_ms)
+    {
+        last_reconcile = now;
+        reconcile_pressed_keys();
+    }
+
+    for (size_t i = 0; i < pressed_keys.size(); i++)
     {
-        if (should_check(vk))
+        uint64_t held = pressed_keys[i] & checked_keys_mask[i];
+
+        // Confirm the tracked keys, a missed key release must not keep the overlay from showing
+        while (held != 0)
         {
+            unsigned long bit;
+            _BitScanForward64(&bit, held);
+            held &= held - 1;
+
+            const auto vk = static_cast<int>(i * 64 + bit);
             if (GetAsyncKeyState(vk) & 0x8000)
             {
                 return false;
             }
+            update_key_state(vk, false);
         }
     }
     return true;
@@ -1,3 +1,6 @@
 #pragma once
 bool winkey_held();
 bool only_winkey_key_held();
+
+// Tracks the pressed keys for only_winkey_key_held. Must be called with every key event from the low level hook.
+void update_key_state(unsigned vk_code, bool key_down);
@@ -11,10 +11,32 @@
 
 extern "C" IMAGE_DOS_HEADER __ImageBase;
 
-D2DOverlaySVG& D2DOverlaySVG::load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
+namespace
 {
-    D2DSVG::load(filename, d2d_dc);
+    const std::chrono::milliseconds active_window_refresh_interval(100);
+
+    // Recolored for the theme
+    const wchar_t* themed_svgs[] = {
+        L"svgs\\overlay.svg",
+        L"svgs\\overlay_portrait.svg",
+        L"svgs\\1.svg",
+        L"svgs\\2.svg",
+        L"svgs\\3.svg",
+        L"svgs\\4.svg",
+        L"svgs\\5.svg",
+        L"svgs\\6.svg",
+        L"svgs\\7.svg",
+        L"svgs\\8.svg",
+        L"svgs\\9.svg",
+        L"svgs\\0.svg",
+    };
+}
+
+D2DOverlaySVG& D2DOverlaySVG::load(winrt::com_ptr<ID2D1SvgDocument> document)
+{
+    D2DSVG::load(std::move(document));
     window_group = nullptr;
+    window_group_active = std::nullopt;
     thumbnail_top_left = {};
     thumbnail_bottom_right = {};
     thumbnail_scaled_rect = {};
@@ -92,9 +114,11 @@ winrt::com_ptr<ID2D1SvgElement> D2DOverlaySVG::find_element(const std::wstring&
 
 D2DOverlaySVG& D2DOverlaySVG::toggle_window_group(bool active)
 {
-    if (window_group)
+    if (window_group && window_group_active != active)
     {
         window_group->SetAttributeValue(L"fill-opacity", active ? 1.0f : 0.3f);
+        window_group_active = active;
+        invalidate();
     }
     return *this;
 }
@@ -187,27 +211,6 @@ D2D1_RECT_F D2DOverlaySVG::get_snap_right() const
 D2DOverlayWindow::D2DOverlayWindow(std::optional<std::function<std::remove_pointer_t<WNDPROC>>> pre_wnd_proc) :
     total_screen({}), animation(0.3), D2DWindow(std::move(pre_wnd_proc))
 {
-    tasklist_thread = std::thread([&] {
-        while (running)
-        {
-            // Removing <std::mutex> causes C3538 on std::unique_lock lock(mutex); in show(..)
-            std::unique_lock<std::mutex> lock(tasklist_cv_mutex);
-            tasklist_cv.wait(lock, [&] { return !running || tasklist_update; });
-            if (!running)
-                return;
-            lock.unlock();
-            while (running && tasklist_update)
-            {
-                std::vector<TasklistButton> buttons;
-                if (tasklist.update_buttons(buttons))
-                {
-                    std::unique_lock lock(mutex);
-                    tasklist_buttons.swap(buttons);
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            }
-        }
-    });
 }
 
 void D2DOverlayWindow::show(HWND active_window, bool snappable)
@@ -217,37 +220,14 @@ void D2DOverlayWindow::show(HWND active_window, bool snappable)
     tasklist_buttons.clear();
     this->active_window = active_window;
     this->active_window_snappable = snappable;
-    auto old_bck = colors.start_color_menu;
     auto colors_updated = colors.update();
     auto new_light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
     if (initialized && (colors_updated || light_mode != new_light_mode))
     {
-        // update background colors
-        landscape.recolor(old_bck, colors.start_color_menu);
-        portrait.recolor(old_bck, colors.start_color_menu);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(old_bck, colors.start_color_menu);
-        }
+        // The documents are usually ready, prepared in the background by start_warm_up()
         light_mode = new_light_mode;
-        if (light_mode)
-        {
-            landscape.recolor(0xDDDDDD, 0x222222);
-            portrait.recolor(0xDDDDDD, 0x222222);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0xDDDDDD, 0x222222);
-            }
-        }
-        else
-        {
-            landscape.recolor(0x222222, 0xDDDDDD);
-            portrait.recolor(0x222222, 0xDDDDDD);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0x222222, 0xDDDDDD);
-            }
-        }
+        load_themed_svgs();
+        start_warm_up();
     }
     monitors = MonitorInfo::GetMonitors(true);
     // calculate the rect covering all the screens
@@ -266,7 +246,13 @@ void D2DOverlayWindow::show(HWND active_window, bool snappable)
     total_screen.rect.right += monitor_dx;
     total_screen.rect.top += monitor_dy;
     total_screen.rect.bottom += monitor_dy;
-    tasklist.update();
+    // Check if taskbar is auto-hidden. If so, don't display the number arrows
+    APPBARDATA param = {};
+    param.cbSize = sizeof(APPBARDATA);
+    tasklist_update = (UINT)SHAppBarMessage(ABM_GETSTATE, &param) != ABS_AUTOHIDE;
+    // The buttons are tracked in the background, render() reads them
+    tasklist_version = 0;
+    active_window_layout_expiry = {};
     if (active_window)
     {
         // Ignore errors, if this fails we will just not show the thumbnail
@@ -278,16 +264,6 @@ void D2DOverlayWindow::show(HWND active_window, bool snappable)
     lock.unlock();
     D2DWindow::show(primary_screen.left(), primary_screen.top(), primary_screen.width(), primary_screen.height());
     key_pressed.clear();
-    // Check if taskbar is auto-hidden. If so, don't display the number arrows
-    APPBARDATA param = {};
-    param.cbSize = sizeof(APPBARDATA);
-    if ((UINT)SHAppBarMessage(ABM_GETSTATE, &param) != ABS_AUTOHIDE)
-    {
-        tasklist_cv_mutex.lock();
-        tasklist_update = true;
-        tasklist_cv_mutex.unlock();
-        tasklist_cv.notify_one();
-    }
 }
 
 void D2DOverlayWindow::animate(int vk_code)
@@ -397,6 +373,8 @@ void D2DOverlayWindow::animate(int vk_code, int offset)
     animation.animation.reset(0.1, 0, 1);
     key_animations.push_back(animation);
     key_pressed.push_back(vk_code);
+    // The key may move the active window
+    active_window_layout_expiry = {};
 }
 
 void D2DOverlayWindow::on_show()
@@ -406,10 +384,7 @@ void D2DOverlayWindow::on_show()
 
 void D2DOverlayWindow::on_hide()
 {
-    tasklist_cv_mutex.lock();
     tasklist_update = false;
-    tasklist_cv_mutex.unlock();
-    tasklist_cv.notify_one();
     if (thumbnail)
     {
         DwmUnregisterThumbnail(thumbnail);
@@ -426,11 +401,7 @@ void D2DOverlayWindow::on_hide()
 
 D2DOverlayWindow::~D2DOverlayWindow()
 {
-    tasklist_cv_mutex.lock();
-    running = false;
-    tasklist_cv_mutex.unlock();
-    tasklist_cv.notify_one();
-    tasklist_thread.join();
+    stop_warm_up();
 }
 
 void D2DOverlayWindow::apply_overlay_opacity(float opacity)
@@ -486,30 +457,65 @@ float D2DOverlayWindow::get_overlay_opacity()
 
 void D2DOverlayWindow::init()
 {
+    // The brushes and the documents belong to the previous device
+    background_brush = nullptr;
+    monitors_brush = nullptr;
+    stop_warm_up();
+    svg_assets.clear_documents();
     colors.update();
-    landscape.load(L"svgs\\overlay.svg", d2d_dc.get())
+    light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
+    load_themed_svgs();
+    no_active.load(svg_assets.get(L"svgs\\no_active_window.svg", d2d_dc.get()));
+    start_warm_up();
+}
+
+void D2DOverlayWindow::load_themed_svgs()
+{
+    landscape.load(svg_assets.get_themed(L"svgs\\overlay.svg", colors.start_color_menu, light_mode, d2d_dc.get()))
         .find_thumbnail(L"path-1")
-        .find_window_group(L"Group-1")
-        .recolor(0x000000, colors.start_color_menu);
-    portrait.load(L"svgs\\overlay_portrait.svg", d2d_dc.get())
+        .find_window_group(L"Group-1");
+    portrait.load(svg_assets.get_themed(L"svgs\\overlay_portrait.svg", colors.start_color_menu, light_mode, d2d_dc.get()))
         .find_thumbnail(L"path-1")
-        .find_window_group(L"Group-1")
-        .recolor(0x000000, colors.start_color_menu);
-    no_active.load(L"svgs\\no_active_window.svg", d2d_dc.get());
+        .find_window_group(L"Group-1");
     arrows.resize(10);
     for (unsigned i = 0; i < arrows.size(); ++i)
     {
-        arrows[i].load(L"svgs\\" + std::to_wstring((i + 1) % 10) + L".svg", d2d_dc.get()).recolor(0x000000, colors.start_color_menu);
+        arrows[i].load(svg_assets.get_themed(L"svgs\\" + std::to_wstring((i + 1) % 10) + L".svg", colors.start_color_menu, light_mode, d2d_dc.get()));
     }
-    light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
-    if (!light_mode)
-    {
-        landscape.recolor(0x222222, 0xDDDDDD);
-        portrait.recolor(0x222222, 0xDDDDDD);
-        for (auto& arrow : arrows)
+}
+
+void D2DOverlayWindow::start_warm_up()
+{
+    stop_warm_up();
+    stop_warm_up_requested = false;
+    warm_up_thread = std::thread([this, device = d2d_device, accent_color = colors.start_color_menu, other_light_mode = !light_mode] {
+        try
         {
-            arrow.recolor(0x222222, 0xDDDDDD);
+            // The documents can be used by any context of the device
+            winrt::com_ptr<ID2D1DeviceContext5> warm_up_dc;
+            winrt::check_hresult(device->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, warm_up_dc.put()));
+            for (auto filename : themed_svgs)
+            {
+                if (stop_warm_up_requested)
+                {
+                    return;
+                }
+                svg_assets.get_themed(filename, accent_color, other_light_mode, warm_up_dc.get());
+            }
         }
+        catch (...)
+        {
+            // The documents will be created when they are needed
+        }
+    });
+}
+
+void D2DOverlayWindow::stop_warm_up()
+{
+    stop_warm_up_requested = true;
+    if (warm_up_thread.joinable())
+    {
+        warm_up_thread.join();
     }
 }
 
@@ -542,30 +548,30 @@ void D2DOverlayWindow::resize()
 void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_scale, ID2D1DeviceContext5* d2d_dc)
 {
     int dx = 0, dy = 0;
-    // Calculate taskbar orientation
-    arrow.toggle_element(L"left", false);
-    arrow.toggle_element(L"right", false);
-    arrow.toggle_element(L"top", false);
-    arrow.toggle_element(L"bottom", false);
-    if (button.x <= window.left)
-    { // taskbar on left
+    // Calculate taskbar orientation. Each element is toggled once, so the arrow is recorded again only when it changes
+    bool taskbar_left = button.x <= window.left;
+    bool taskbar_right = button.x >= window.right;
+    bool taskbar_top = button.y <= window.top;
+    bool taskbar_bottom = button.y >= window.bottom;
+    arrow.toggle_element(L"left", taskbar_left);
+    arrow.toggle_element(L"right", taskbar_right);
+    arrow.toggle_element(L"top", taskbar_top);
+    arrow.toggle_element(L"bottom", taskbar_bottom);
+    if (taskbar_left)
+    {
         dx = 1;
-        arrow.toggle_element(L"left", true);
     }
-    if (button.x >= window.right)
-    { // taskbar on right
+    if (taskbar_right)
+    {
         dx = -1;
-        arrow.toggle_element(L"right", true);
     }
-    if (button.y <= window.top)
-    { // taskbar on top
+    if (taskbar_top)
+    {
         dy = 1;
-        arrow.toggle_element(L"top", true);
     }
-    if (button.y >= window.bottom)
-    { // taskbar on bottom
+    if (taskbar_bottom)
+    {
         dy = -1;
-        arrow.toggle_element(L"bottom", true);
     }
     double arrow_ratio = (double)arrow.height() / arrow.width();
     if (dy != 0)
@@ -623,6 +629,51 @@ void D2DOverlayWindow::hide_thumbnail()
     DwmUpdateThumbnailProperties(thumbnail, &thumb_properties);
 }
 
+void D2DOverlayWindow::update_active_window_layout()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now < active_window_layout_expiry)
+    {
+        return;
+    }
+    active_window_layout_expiry = now + active_window_refresh_interval;
+
+    auto& layout = active_window_layout;
+    layout.state = get_window_state(active_window);
+    layout.rect = get_window_pos(active_window);
+    auto& thumb_window = layout.rect;
+    RECT client_rect;
+    if (thumb_window && GetClientRect(active_window, &client_rect))
+    {
+        int dx = ((thumb_window->right - thumb_window->left) - (client_rect.right - client_rect.left)) / 2;
+        int dy = ((thumb_window->bottom - thumb_window->top) - (client_rect.bottom - client_rect.top)) / 2;
+        thumb_window->left += dx;
+        thumb_window->right -= dx;
+        thumb_window->top += dy;
+        thumb_window->bottom -= dy;
+    }
+    layout.render_monitors = true;
+    layout.total_monitor_with_screen = total_screen;
+    auto& total_monitor_with_screen = layout.total_monitor_with_screen;
+    if (thumb_window)
+    {
+        total_monitor_with_screen.rect.left = std::min(total_monitor_with_screen.rect.left, thumb_window->left + monitor_dx);
+        total_monitor_with_screen.rect.top = std::min(total_monitor_with_screen.rect.top, thumb_window->top + monitor_dy);
+        total_monitor_with_screen.rect.right = std::max(total_monitor_with_screen.rect.right, thumb_window->right + monitor_dx);
+        total_monitor_with_screen.rect.bottom = std::max(total_monitor_with_screen.rect.bottom, thumb_window->bottom + monitor_dy);
+        // Only allow the new rect being slight bigger.
+        if (total_monitor_with_screen.width() - total_screen.width() > (thumb_window->right - thumb_window->left) / 2 ||
+            total_monitor_with_screen.height() - total_screen.height() > (thumb_window->bottom - thumb_window->top) / 2)
+        {
+            layout.render_monitors = false;
+        }
+    }
+    if (layout.state == MINIMIZED)
+    {
+        total_monitor_with_screen = total_screen;
+    }
+}
+
 void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
 {
     if (!hidden && !instance->overlay_visible())
@@ -636,6 +687,10 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
     auto current_anim_value = (float)animation.value(Animation::AnimFunctions::LINEAR);
     SetLayeredWindowAttributes(hwnd, 0, (int)(255 * current_anim_value), LWA_ALPHA);
     double pos_anim_value = 1 - animation.value(Animation::AnimFunctions::EASE_OUT_EXPO);
+    if (tasklist_update)
+    {
+        tasklist.get_buttons(tasklist_buttons, tasklist_version);
+    }
     if (!tasklist_buttons.empty())
     {
         if (tasklist_buttons[0].x <= window_rect.left)
@@ -661,53 +716,30 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         y_offset = (int)(pos_anim_value * use_overlay->height() * use_overlay->get_scale());
     }
     // Draw background
-    winrt::com_ptr<ID2D1SolidColorBrush> brush;
     float brush_opacity = get_overlay_opacity();
     D2D1_COLOR_F brushColor = light_mode ? D2D1::ColorF(1.0f, 1.0f, 1.0f, brush_opacity) : D2D1::ColorF(0, 0, 0, brush_opacity);
-    winrt::check_hresult(d2d_dc->CreateSolidColorBrush(brushColor, brush.put()));
+    if (!background_brush)
+    {
+        winrt::check_hresult(d2d_dc->CreateSolidColorBrush(brushColor, background_brush.put()));
+    }
+    background_brush->SetColor(brushColor);
     D2D1_RECT_F background_rect = {};
     background_rect.bottom = (float)window_height;
     background_rect.right = (float)window_width;
     d2d_dc->SetTransform(D2D1::Matrix3x2F::Identity());
-    d2d_dc->FillRectangle(background_rect, brush.get());
+    d2d_dc->FillRectangle(background_rect, background_brush.get());
 
     // Thumbnail logic:
-    auto window_state = get_window_state(active_window);
-    auto thumb_window = get_window_pos(active_window);
+    update_active_window_layout();
+    auto window_state = active_window_layout.state;
+    const auto& thumb_window = active_window_layout.rect;
     bool miniature_shown = active_window != nullptr && thumbnail != nullptr && thumb_window && window_state != MINIMIZED;
-    RECT client_rect;
-    if (thumb_window && GetClientRect(active_window, &client_rect))
-    {
-        int dx = ((thumb_window->right - thumb_window->left) - (client_rect.right - client_rect.left)) / 2;
-        int dy = ((thumb_window->bottom - thumb_window->top) - (client_rect.bottom - client_rect.top)) / 2;
-        thumb_window->left += dx;
-        thumb_window->right -= dx;
-        thumb_window->top += dy;
-        thumb_window->bottom -= dy;
-    }
-    if (miniature_shown && thumb_window->right - thumb_window->left <= 0 || thumb_window->bottom - thumb_window->top <= 0)
+    if (miniature_shown && (thumb_window->right - thumb_window->left <= 0 || thumb_window->bottom - thumb_window->top <= 0))
     {
         miniature_shown = false;
     }
-    bool render_monitors = true;
-    auto total_monitor_with_screen = total_screen;
-    if (thumb_window)
-    {
-        total_monitor_with_screen.rect.left = std::min(total_monitor_with_screen.rect.left, thumb_window->left + monitor_dx);
-        total_monitor_with_screen.rect.top = std::min(total_monitor_with_screen.rect.top, thumb_window->top + monitor_dy);
-        total_monitor_with_screen.rect.right = std::max(total_monitor_with_screen.rect.right, thumb_window->right + monitor_dx);
-        total_monitor_with_screen.rect.bottom = std::max(total_monitor_with_screen.rect.bottom, thumb_window->bottom + monitor_dy);
-    }
-    // Only allow the new rect being slight bigger.
-    if (total_monitor_with_screen.width() - total_screen.width() > (thumb_window->right - thumb_window->left) / 2 ||
-        total_monitor_with_screen.height() - total_screen.height() > (thumb_window->bottom - thumb_window->top) / 2)
-    {
-        render_monitors = false;
-    }
-    if (window_state == MINIMIZED)
-    {
-        total_monitor_with_screen = total_screen;
-    }
+    bool render_monitors = active_window_layout.render_monitors;
+    const auto& total_monitor_with_screen = active_window_layout.total_monitor_with_screen;
     auto rect_and_scale = use_overlay->get_thumbnail_rect_and_scale(0, 0, total_monitor_with_screen.width(), total_monitor_with_screen.height(), 1);
     if (miniature_shown)
     {
@@ -739,8 +771,11 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
     if (render_monitors)
     {
         brushColor = D2D1::ColorF(colors.desktop_fill_color, miniature_shown ? current_anim_value : current_anim_value * 0.3f);
-        brush = nullptr;
-        winrt::check_hresult(d2d_dc->CreateSolidColorBrush(brushColor, brush.put()));
+        if (!monitors_brush)
+        {
+            winrt::check_hresult(d2d_dc->CreateSolidColorBrush(brushColor, monitors_brush.put()));
+        }
+        monitors_brush->SetColor(brushColor);
         for (auto& monitor : monitors)
         {
             D2D1_RECT_F monitor_rect;
@@ -749,7 +784,7 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
             monitor_rect.right = (float)((monitor.rect.right + monitor_dx) * rect_and_scale.scale + rect_and_scale.rect.left);
             monitor_rect.bottom = (float)((monitor.rect.bottom + monitor_dy) * rect_and_scale.scale + rect_and_scale.rect.top);
             d2d_dc->SetTransform(D2D1::Matrix3x2F::Identity());
-            d2d_dc->FillRectangle(monitor_rect, brush.get());
+            d2d_dc->FillRectangle(monitor_rect, monitors_brush.get());
         }
     }
     // Finalize the overlay - dimm the buttons if no thumbnail is present and show "No active window"
@@ -775,6 +810,7 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         color.g = animation.original.g + (1.0f - animation.original.g) * value;
         color.b = animation.original.b + (1.0f - animation.original.b) * value;
         animation.button->SetAttributeValue(L"fill", color);
+        use_overlay->invalidate();
         if (animation.animation.done())
         {
             if (value == 1)
@@ -790,8 +826,6 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         }
         ++id;
     }
-    // Finally: render the overlay...
-    use_overlay->render(d2d_dc);
     // ... window arrows texts ...
     std::wstring left, right, up, down;
     bool left_disabled = false;
@@ -869,13 +903,16 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         down_disabled = true;
     }
     auto text_color = D2D1::ColorF(light_mode ? 0x222222 : 0xDDDDDD, active_window_snappable && (miniature_shown || window_state == MINIMIZED) ? 1.0f : 0.3f);
-    use_overlay->find_element(L"KeyUpGroup")->SetAttributeValue(L"fill-opacity", up_disabled ? 0.3f : 1.0f);
+    use_overlay->set_element_attribute(L"KeyUpGroup", L"fill-opacity", up_disabled ? 0.3f : 1.0f);
+    use_overlay->set_element_attribute(L"KeyDownGroup", L"fill-opacity", down_disabled ? 0.3f : 1.0f);
+    use_overlay->set_element_attribute(L"KeyLeftGroup", L"fill-opacity", left_disabled ? 0.3f : 1.0f);
+    use_overlay->set_element_attribute(L"KeyRightGroup", L"fill-opacity", right_disabled ? 0.3f : 1.0f);
+    // Finally: render the overlay...
+    use_overlay->render(d2d_dc);
+    // ... the texts ...
     text.set_alignment_center().write(d2d_dc, text_color, use_overlay->get_maximize_label(), up);
-    use_overlay->find_element(L"KeyDownGroup")->SetAttributeValue(L"fill-opacity", down_disabled ? 0.3f : 1.0f);
     text.write(d2d_dc, text_color, use_overlay->get_minimize_label(), down);
-    use_overlay->find_element(L"KeyLeftGroup")->SetAttributeValue(L"fill-opacity", left_disabled ? 0.3f : 1.0f);
     text.set_alignment_right().write(d2d_dc, text_color, use_overlay->get_snap_left(), left);
-    use_overlay->find_element(L"KeyRightGroup")->SetAttributeValue(L"fill-opacity", right_disabled ? 0.3f : 1.0f);
     text.set_alignment_left().write(d2d_dc, text_color, use_overlay->get_snap_right(), right);
     // ... and the arrows with numbers
     for (auto&& button : tasklist_buttons)
@@ -2,10 +2,13 @@
 #include "d2d_svg.h"
 #include "d2d_window.h"
 #include "d2d_text.h"
+#include "svg_asset_cache.h"
 #include "common/monitors.h"
 #include "common/animation.h"
 #include "common/windows_colors.h"
 #include "common/tasklist_positions.h"
+#include "common/common.h"
+#include <atomic>
 
 struct ScaleResult
 {
@@ -16,7 +19,7 @@ struct ScaleResult
 class D2DOverlaySVG : public D2DSVG
 {
 public:
-    D2DOverlaySVG& load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc);
+    D2DOverlaySVG& load(winrt::com_ptr<ID2D1SvgDocument> document);
     D2DOverlaySVG& resize(int x, int y, int width, int height, float fill, float max_scale = -1.0f);
     D2DOverlaySVG& find_thumbnail(const std::wstring& id);
     D2DOverlaySVG& find_window_group(const std::wstring& id);
@@ -33,6 +36,16 @@ private:
     D2D1_POINT_2F thumbnail_bottom_right = {};
     RECT thumbnail_scaled_rect = {};
     winrt::com_ptr<ID2D1SvgElement> window_group;
+    std::optional<bool> window_group_active;
+};
+
+// Position of the active window, in the coordinates of the monitors
+struct ActiveWindowLayout
+{
+    WindowState state = UNKNOWN;
+    std::optional<RECT> rect;
+    ScreenSize total_monitor_with_screen{ {} };
+    bool render_monitors = true;
 };
 
 struct AnimateKeys
@@ -60,6 +73,10 @@ private:
     void animate(int vk_code, int offset);
     bool show_thumbnail(const RECT& rect, double alpha);
     void hide_thumbnail();
+    void update_active_window_layout();
+    void load_themed_svgs();
+    void start_warm_up();
+    void stop_warm_up();
     virtual void init() override;
     virtual void resize() override;
     virtual void render(ID2D1DeviceContext5* d2d_dc) override;
@@ -67,7 +84,6 @@ private:
     virtual void on_hide() override;
     float get_overlay_opacity();
 
-    bool running = true;
     std::vector<AnimateKeys> key_animations;
     std::vector<int> key_pressed;
     std::vector<MonitorInfo> monitors;
@@ -77,16 +93,23 @@ private:
     WindowsColors colors;
     Animation animation;
     RECT window_rect = {};
-    Tasklist tasklist;
+    TasklistTracker tasklist;
     std::vector<TasklistButton> tasklist_buttons;
-    std::thread tasklist_thread;
+    uint64_t tasklist_version = 0;
     bool tasklist_update = false;
-    std::mutex tasklist_cv_mutex;
-    std::condition_variable tasklist_cv;
 
     HTHUMBNAIL thumbnail;
     HWND active_window = nullptr;
     bool active_window_snappable = false;
+    // The active window is queried at most once per active_window_refresh_interval, not on every frame
+    ActiveWindowLayout active_window_layout;
+    std::chrono::steady_clock::time_point active_window_layout_expiry;
+    winrt::com_ptr<ID2D1SolidColorBrush> background_brush;
+    winrt::com_ptr<ID2D1SolidColorBrush> monitors_brush;
+    SvgAssetCache svg_assets;
+    // Prepares the documents of the other theme in the background
+    std::thread warm_up_thread;
+    std::atomic<bool> stop_warm_up_requested = false;
     D2DOverlaySVG landscape, portrait;
     D2DOverlaySVG* use_overlay = nullptr;
     D2DSVG no_active;
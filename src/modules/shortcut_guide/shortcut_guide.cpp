@@ -5,12 +5,12 @@
 
 #include <common/common.h>
 #include <common/settings_objects.h>
-#include <common/debug_control.h>
 #include <sstream>
 #include <modules/shortcut_guide/ShortcutGuideConstants.h>
 
 #include <common/settings_helpers.cpp>
 #include <common/logger/logger.h>
+#include <common/process_path_cache.h>
 
 
 extern "C" IMAGE_DOS_HEADER __ImageBase;
@@ -20,21 +20,6 @@ OverlayWindow* instance = nullptr;
 
 namespace
 {
-    LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
-    {
-        LowlevelKeyboardEvent event;
-        if (nCode == HC_ACTION)
-        {
-            event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-            event.wParam = wParam;
-            if (instance->signal_event(&event) != 0)
-            {
-                return 1;
-            }
-        }
-        return CallNextHookEx(NULL, nCode, wParam, lParam);
-    }
-
     // Window properties relevant to ShortcutGuide
     struct ShortcutGuideWindowInfo
     {
@@ -120,6 +105,16 @@ const wchar_t* OverlayWindow::get_key()
 }
 
 bool OverlayWindow::get_config(wchar_t* buffer, int* buffer_size)
+{
+    return get_settings().serialize_to_buffer(buffer, buffer_size);
+}
+
+bool OverlayWindow::write_config(ConfigWriter writer, void* context)
+{
+    return get_settings().serialize_to_writer(writer, context);
+}
+
+PowerToysSettings::Settings OverlayWindow::get_settings()
 {
     HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -150,7 +145,7 @@ bool OverlayWindow::get_config(wchar_t* buffer, int* buffer_size)
         theme.value,
         theme.keys_and_texts);
 
-    return settings.serialize_to_buffer(buffer, buffer_size);
+    return settings;
 }
 
 void OverlayWindow::set_config(const wchar_t* config)
@@ -207,6 +202,10 @@ void OverlayWindow::enable()
     Logger::info("Shortcut Guide is enabling");
 
     auto switcher = [&](HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) -> LRESULT {
+        if (instance->target_state && instance->target_state->handle_window_message(msg, wparam))
+        {
+            return 0;
+        }
         if (msg == WM_KEYDOWN && wparam == VK_ESCAPE && instance->target_state->active())
         {
             instance->target_state->toggle_force_shown();
@@ -232,7 +231,7 @@ void OverlayWindow::enable()
         winkey_popup = std::make_unique<D2DOverlayWindow>(std::move(switcher));
         winkey_popup->apply_overlay_opacity(((float)overlayOpacity.value) / 100.0f);
         winkey_popup->set_theme(theme.value);
-        target_state = std::make_unique<TargetState>(pressTime.value);
+        target_state = std::make_unique<TargetState>(pressTime.value, winkey_popup->get_window_handle());
         try
         {
             winkey_popup->initialize();
@@ -242,23 +241,7 @@ void OverlayWindow::enable()
             Logger::critical("Winkey popup failed to initialize");
             return;
         }
-        
-#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
-        const bool hook_disabled = IsDebuggerPresent();
-#else
-        const bool hook_disabled = false;
-#endif
-        if (!hook_disabled)
-        {
-            hook_handle = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), NULL);
-            if (!hook_handle)
-            {
-                DWORD errorCode = GetLastError();
-                show_last_error_message(L"SetWindowsHookEx", errorCode, L"PowerToys - Shortcut Guide");
-                auto errorMessage = get_last_error_message(errorCode);
-                Trace::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"OverlayWindow.enable.SetWindowsHookEx");
-            }
-        }
+
         RegisterHotKey(winkey_popup->get_window_handle(), alternative_switch_hotkey_id, alternative_switch_modifier_mask, alternative_switch_vk_code);
     }
     _enabled = true;
@@ -280,14 +263,6 @@ void OverlayWindow::disable(bool trace_event)
         target_state->exit();
         target_state.reset();
         winkey_popup.reset();
-        if (hook_handle)
-        {
-            bool success = UnhookWindowsHookEx(hook_handle);
-            if (success)
-            {
-                hook_handle = nullptr;
-            }
-        }
     }
 }
 
@@ -301,6 +276,21 @@ bool OverlayWindow::is_enabled()
     return _enabled;
 }
 
+int OverlayWindow::get_keyboard_event_priority()
+{
+    // Lower than Keyboard Manager, so the remapped Win key is tracked
+    return 50;
+}
+
+PowertoyModuleIface::KeyboardEventDecision OverlayWindow::on_keyboard_event(LowlevelKeyboardEvent* event)
+{
+    if (signal_event(event) != 0)
+    {
+        return { KeyboardEventDecision::Type::Suppress };
+    }
+    return {};
+}
+
 intptr_t OverlayWindow::signal_event(LowlevelKeyboardEvent* event)
 {
     if (!_enabled)
@@ -349,6 +339,9 @@ void OverlayWindow::destroy()
     this->disable(false);
     delete this;
     instance = nullptr;
+    // Stop the process exit notifications and the logger before the runner unloads the DLL
+    ProcessPathCache::shutdown();
+    Logger::shutdown();
 }
 
 bool OverlayWindow::overlay_visible() const
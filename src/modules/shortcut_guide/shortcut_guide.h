@@ -5,6 +5,7 @@
 #include "Generated Files/resource.h"
 
 #include <common/LowlevelKeyboardEvent.h>
+#include <common/settings_objects.h>
 
 // We support only one instance of the overlay
 extern class OverlayWindow* instance;
@@ -19,11 +20,14 @@ public:
     virtual const wchar_t* get_name() override;
     virtual const wchar_t* get_key() override;
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override;
+    virtual bool write_config(ConfigWriter writer, void* context) override;
 
     virtual void set_config(const wchar_t* config) override;
     virtual void enable() override;
     virtual void disable() override;
     virtual bool is_enabled() override;
+    virtual int get_keyboard_event_priority() override;
+    virtual KeyboardEventDecision on_keyboard_event(LowlevelKeyboardEvent* event) override;
 
     void on_held();
     void on_held_press(DWORD vkCode);
@@ -43,9 +47,9 @@ private:
     std::unique_ptr<TargetState> target_state;
     std::unique_ptr<D2DOverlayWindow> winkey_popup;
     bool _enabled = false;
-    HHOOK hook_handle;
 
     void init_settings();
+    PowerToysSettings::Settings get_settings();
     void disable(bool trace_event);
 
     struct PressTime
@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "svg_asset_cache.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Replaces the fill colors of all the elements in a single walk of the document
+    void recolor(ID2D1SvgDocument* svg, const std::vector<std::pair<uint32_t, uint32_t>>& replacements)
+    {
+        std::vector<std::pair<D2D1_COLOR_F, D2D1_COLOR_F>> colors;
+        for (const auto& [old_color, new_color] : replacements)
+        {
+            colors.emplace_back(D2D1::ColorF(old_color & 0xFFFFFF, 1), D2D1::ColorF(new_color & 0xFFFFFF, 1));
+        }
+
+        std::vector<winrt::com_ptr<ID2D1SvgElement>> pending;
+        pending.emplace_back();
+        svg->GetRoot(pending.back().put());
+        while (!pending.empty())
+        {
+            auto element = std::move(pending.back());
+            pending.pop_back();
+            if (!element)
+            {
+                continue;
+            }
+            if (element->IsAttributeSpecified(L"fill"))
+            {
+                D2D1_COLOR_F elem_fill;
+                winrt::com_ptr<ID2D1SvgPaint> paint;
+                element->GetAttributeValue(L"fill", paint.put());
+                paint->GetColor(&elem_fill);
+                for (const auto& [old_color, new_color] : colors)
+                {
+                    if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
+                    {
+                        winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
+                        break;
+                    }
+                }
+            }
+            winrt::com_ptr<ID2D1SvgElement> sub;
+            element->GetFirstChild(sub.put());
+            while (sub)
+            {
+                winrt::com_ptr<ID2D1SvgElement> next;
+                element->GetNextChild(sub.get(), next.put());
+                pending.push_back(std::move(sub));
+                sub = std::move(next);
+            }
+        }
+    }
+}
+
+winrt::com_ptr<ID2D1SvgDocument> SvgAssetCache::get(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
+{
+    return get({ filename, false, 0, true }, d2d_dc);
+}
+
+winrt::com_ptr<ID2D1SvgDocument> SvgAssetCache::get_themed(const std::wstring& filename, uint32_t accent_color, bool light_mode, ID2D1DeviceContext5* d2d_dc)
+{
+    return get({ filename, true, accent_color & 0xFFFFFF, light_mode }, d2d_dc);
+}
+
+void SvgAssetCache::clear_documents()
+{
+    std::unique_lock lock(mutex);
+    documents.clear();
+}
+
+winrt::com_ptr<ID2D1SvgDocument> SvgAssetCache::get(const DocumentKey& key, ID2D1DeviceContext5* d2d_dc)
+{
+    {
+        std::unique_lock lock(mutex);
+        if (auto it = documents.find(key); it != documents.end())
+        {
+            return it->second;
+        }
+    }
+
+    const auto& [filename, themed, accent_color, light_mode] = key;
+    auto content = read_file(filename);
+    winrt::com_ptr<IStream> svg_stream;
+    svg_stream.attach(SHCreateMemStream(reinterpret_cast<const BYTE*>(content.data()), static_cast<UINT>(content.size())));
+    if (!svg_stream)
+    {
+        winrt::throw_hresult(E_OUTOFMEMORY);
+    }
+
+    winrt::com_ptr<ID2D1SvgDocument> svg;
+    winrt::check_hresult(d2d_dc->CreateSvgDocument(
+        svg_stream.get(),
+        D2D1::SizeF(1, 1),
+        svg.put()));
+
+    if (themed)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> replacements{ { 0x000000, accent_color } };
+        if (!light_mode)
+        {
+            replacements.emplace_back(0x222222, 0xDDDDDD);
+        }
+        recolor(svg.get(), replacements);
+    }
+
+    std::unique_lock lock(mutex);
+    // Another thread may have created it in the meantime, keep the first one
+    return documents.emplace(key, std::move(svg)).first->second;
+}
+
+std::string SvgAssetCache::read_file(const std::wstring& filename)
+{
+    {
+        std::unique_lock lock(mutex);
+        if (auto it = files.find(filename); it != files.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        winrt::throw_hresult(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::unique_lock lock(mutex);
+    return files.emplace(filename, content.str()).first->second;
+}
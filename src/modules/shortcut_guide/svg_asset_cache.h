@@ -0,0 +1,33 @@
+#pragma once
+#include <d2d1_3.h>
+#include <winrt/base.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+// Keeps the SVG files in memory and the documents parsed from them, so loading an SVG again doesn't touch the disk.
+// Themed documents are recolored once for each accent color and light/dark mode, switching the theme only switches
+// the document. Safe to use from several threads, e.g. to warm up the documents of the other theme in the background.
+class SvgAssetCache
+{
+public:
+    // The document as it is in the file
+    winrt::com_ptr<ID2D1SvgDocument> get(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc);
+    // The document with black replaced by the accent color, and the light theme colors replaced by the dark theme ones
+    winrt::com_ptr<ID2D1SvgDocument> get_themed(const std::wstring& filename, uint32_t accent_color, bool light_mode, ID2D1DeviceContext5* d2d_dc);
+    // The documents belong to the D2D device, they must be dropped when it's recreated
+    void clear_documents();
+
+private:
+    // Accent color and light mode, if the document is themed
+    using DocumentKey = std::tuple<std::wstring, bool, uint32_t, bool>;
+
+    winrt::com_ptr<ID2D1SvgDocument> get(const DocumentKey& key, ID2D1DeviceContext5* d2d_dc);
+    std::string read_file(const std::wstring& filename);
+
+    std::mutex mutex;
+    std::unordered_map<std::wstring, std::string> files;
+    std::map<DocumentKey, winrt::com_ptr<ID2D1SvgDocument>> documents;
+};
@@ -5,11 +5,16 @@
 #include "common/shared_constants.h"
 #include <common\logger\logger.h>
 
-TargetState::TargetState(int ms_delay) :
-    // TODO: All this processing should be done w/o a separate thread etc. in pre_wnd_proc of winkey_popup to avoid
-    //       multithreading. Use SetTimer for delayed events
-    delay(std::chrono::milliseconds(ms_delay)),
-    thread(&TargetState::thread_proc, this)
+namespace
+{
+    // Posted to the window by signal_event when there are queued events
+    constexpr UINT WM_PROCESS_KEY_EVENTS = WM_APP + 1;
+    constexpr UINT_PTR press_delay_timer_id = 1;
+}
+
+TargetState::TargetState(int ms_delay, HWND window) :
+    window(window),
+    delay(std::chrono::milliseconds(ms_delay))
 {
 }
 
@@ -17,9 +22,10 @@ constexpr unsigned VK_S = 0x53;
 
 bool TargetState::signal_event(unsigned vk_code, bool key_down)
 {
-    std::unique_lock lock(mutex);
+    update_key_state(vk_code, key_down);
+
     // Ignore repeated key presses
-    if (!events.empty() && events.back().key_down == key_down && events.back().vk_code == vk_code)
+    if (!events.empty() && last_event.key_down == key_down && last_event.vk_code == vk_code)
     {
         return false;
     }
@@ -32,12 +38,14 @@ bool TargetState::signal_event(unsigned vk_code, bool key_down)
     }
     const bool win_key_released = !key_down && (vk_code == VK_LWIN || vk_code == VK_RWIN);
     constexpr auto overlay_fade_in_animation_time = std::chrono::milliseconds(300);
-    const auto overlay_active = state == Shown && (std::chrono::system_clock::now() - signal_timestamp > overlay_fade_in_animation_time);
+    const auto overlay_active = state == Shown && (std::chrono::steady_clock::now() - signal_timestamp.load() > overlay_fade_in_animation_time);
     const bool suppress_win_release = win_key_released && (state == ForceShown || overlay_active) && !nonwin_key_was_pressed_during_shown;
 
-    events.push_back({ key_down, vk_code });
-    lock.unlock();
-    cv.notify_one();
+    last_event = { key_down, vk_code };
+    if (events.push(last_event) && !processing_posted.exchange(true))
+    {
+        PostMessageW(window, WM_PROCESS_KEY_EVENTS, 0, 0);
+    }
     if (suppress_win_release)
     {
         // Send a 0xFF VK code, which is outside of the VK code range, to prevent
@@ -59,94 +67,63 @@ bool TargetState::signal_event(unsigned vk_code, bool key_down)
     return suppress_win_release;
 }
 
+bool TargetState::handle_window_message(UINT msg, WPARAM wparam)
+{
+    if (msg == WM_PROCESS_KEY_EVENTS)
+    {
+        process_events();
+        return true;
+    }
+    if (msg == WM_TIMER && wparam == press_delay_timer_id)
+    {
+        stop_timer();
+        try
+        {
+            handle_timer();
+        }
+        catch (...)
+        {
+            Logger::critical("Timeout, handle_timer failed.");
+        }
+        return true;
+    }
+    return false;
+}
+
 void TargetState::was_hidden()
 {
-    std::unique_lock<std::recursive_mutex> lock(mutex);
     // Ignore callbacks from the D2DOverlayWindow
     if (state == ForceShown)
     {
         return;
     }
+    stop_timer();
     state = Hidden;
-    events.clear();
-    lock.unlock();
-    cv.notify_one();
+    clear_events();
 }
 
 void TargetState::exit()
 {
-    std::unique_lock lock(mutex);
-    events.clear();
+    stop_timer();
     state = Exiting;
-    lock.unlock();
-    cv.notify_one();
-    thread.join();
-}
-
-KeyEvent TargetState::next()
-{
-    auto e = events.front();
-    events.pop_front();
-    return e;
-}
-
-void TargetState::handle_hidden()
-{
-    std::unique_lock lock(mutex);
-    if (events.empty())
-        cv.wait(lock);
-    if (events.empty() || state == Exiting)
-        return;
-    auto event = next();
-    if (event.key_down && (event.vk_code == VK_LWIN || event.vk_code == VK_RWIN))
-    {
-        state = Timeout;
-        winkey_timestamp = std::chrono::system_clock::now();
-    }
-}
-
-void TargetState::handle_shown(const bool forced)
-{
-    std::unique_lock lock(mutex);
-    if (events.empty())
-    {
-        cv.wait(lock);
-    }
-    if (events.empty() || state == Exiting)
-    {
-        return;
-    }
-    auto event = next();
-    if (event.vk_code == VK_LWIN || event.vk_code == VK_RWIN)
-    {
-        if (!forced && (!event.key_down || !winkey_held()))
-        {
-            state = Hidden;
-        }
-        return;
-    }
-
-    if (event.key_down)
-    {
-        nonwin_key_was_pressed_during_shown = true;
-        lock.unlock();
-        instance->on_held_press(event.vk_code);
-    }
+    clear_events();
 }
 
-void TargetState::thread_proc()
+void TargetState::process_events()
 {
-    while (true)
+    // Cleared before the queue is drained, so an event which is queued in the meantime posts a new message
+    processing_posted = false;
+    while (auto event = events.pop())
     {
         switch (state)
         {
         case Hidden:
-            handle_hidden();
+            handle_hidden(*event);
             break;
         case Timeout:
             try
             {
-                handle_timeout();
+                handle_timeout(*event);
             }
             catch (...)
             {
@@ -156,24 +133,22 @@ void TargetState::thread_proc()
         case Shown:
             try
             {
-                handle_shown(false);
+                handle_shown(*event, false);
             }
             catch (...)
             {
                 Logger::critical("Shown, handle_shown failed.");
             }
-            
             break;
         case ForceShown:
             try
             {
-                handle_shown(true);
+                handle_shown(*event, true);
             }
             catch (...)
             {
                 Logger::critical("ForceShown, handle_shown failed.");
             }
-            
             break;
         case Exiting:
         default:
@@ -182,57 +157,117 @@ void TargetState::thread_proc()
     }
 }
 
-void TargetState::handle_timeout()
+void TargetState::clear_events()
 {
-    std::unique_lock lock(mutex);
-    auto wait_time = delay - (std::chrono::system_clock::now() - winkey_timestamp);
-    if (events.empty())
+    while (events.pop())
     {
-        cv.wait_for(lock, wait_time);
     }
-    if (state == Exiting)
+}
+
+void TargetState::handle_hidden(const KeyEvent& event)
+{
+    if (event.key_down && (event.vk_code == VK_LWIN || event.vk_code == VK_RWIN))
     {
+        state = Timeout;
+        winkey_timestamp = std::chrono::steady_clock::now();
+        start_timer(delay);
+    }
+}
+
+void TargetState::handle_shown(const KeyEvent& event, const bool forced)
+{
+    if (event.vk_code == VK_LWIN || event.vk_code == VK_RWIN)
+    {
+        if (!forced && (!event.key_down || !winkey_held()))
+        {
+            state = Hidden;
+        }
         return;
     }
 
-    // Skip all VK_*WIN-down events
-    while (!events.empty())
+    if (event.key_down)
     {
-        auto event = events.front();
-        if (event.key_down && (event.vk_code == VK_LWIN || event.vk_code == VK_RWIN))
-            events.pop_front();
-        else
-            break;
+        nonwin_key_was_pressed_during_shown = true;
+        instance->on_held_press(event.vk_code);
     }
-    // If we've detected that a user is holding anything other than VK_*WIN or start menu is visible, we should hide
-    if (!events.empty() || !only_winkey_key_held() || is_start_visible())
+}
+
+void TargetState::handle_timeout(const KeyEvent& event)
+{
+    // Skip all VK_*WIN-down events. If we've detected that a user is pressing anything other than VK_*WIN or start menu
+    // is visible, we should hide. The event is then handled as if the overlay was hidden, e.g. the WinKey release.
+    if (!event.key_down || (event.vk_code != VK_LWIN && event.vk_code != VK_RWIN))
     {
+        stop_timer();
         state = Hidden;
+        handle_hidden(event);
         return;
     }
 
-    if (std::chrono::system_clock::now() - winkey_timestamp < delay)
+    if (!only_winkey_key_held() || is_start_visible())
     {
+        stop_timer();
+        state = Hidden;
+    }
+}
+
+void TargetState::handle_timer()
+{
+    if (state != Timeout)
+    {
+        return;
+    }
+
+    // The events which are still queued are handled first, they may cancel the timeout
+    process_events();
+    if (state != Timeout)
+    {
+        return;
+    }
+
+    if (!only_winkey_key_held() || is_start_visible())
+    {
+        state = Hidden;
         return;
     }
 
-    signal_timestamp = std::chrono::system_clock::now();
+    // The delay may have been changed in the meantime
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - winkey_timestamp);
+    if (elapsed < delay.load())
+    {
+        start_timer(delay.load() - elapsed);
+        return;
+    }
+
+    signal_timestamp = std::chrono::steady_clock::now();
     nonwin_key_was_pressed_during_shown = false;
     state = Shown;
-    lock.unlock();
     instance->on_held();
 }
 
+void TargetState::start_timer(std::chrono::milliseconds wait_time)
+{
+    timer_active = SetTimer(window, press_delay_timer_id, static_cast<UINT>(wait_time.count()), nullptr) != 0;
+}
+
+void TargetState::stop_timer()
+{
+    if (timer_active)
+    {
+        KillTimer(window, press_delay_timer_id);
+        timer_active = false;
+    }
+}
+
 void TargetState::set_delay(int ms_delay)
 {
-    std::unique_lock lock(mutex);
     delay = std::chrono::milliseconds(ms_delay);
 }
 
 void TargetState::toggle_force_shown()
 {
-    std::unique_lock lock(mutex);
-    events.clear();
+    stop_timer();
+    clear_events();
     if (state != ForceShown)
     {
         state = ForceShown;
@@ -1,9 +1,7 @@
 #pragma once
-#include <deque>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include <chrono>
+#include "common/spsc_queue.h"
 #include "shortcut_guide.h"
 
 struct KeyEvent
@@ -12,29 +10,46 @@ struct KeyEvent
     unsigned vk_code;
 };
 
+// Decides when the overlay should be shown and hidden. The key events are handed over from the low level hook through
+// a lock-free queue and processed by the message loop of the overlay window, the press delay is handled with a timer
+// of the same window. All methods but signal_event must be called on the thread of the window.
 class TargetState
 {
 public:
-    TargetState(int ms_delay);
+    TargetState(int ms_delay, HWND window);
     bool signal_event(unsigned vk_code, bool key_down);
     void was_hidden();
     void exit();
     void set_delay(int ms_delay);
 
+    // Handles the messages posted to the window by signal_event and its timer. Returns true if the message was handled.
+    bool handle_window_message(UINT msg, WPARAM wparam);
+
     void toggle_force_shown();
     bool active() const;
 
 private:
-    KeyEvent next();
-    void handle_hidden();
-    void handle_timeout();
-    void handle_shown(const bool forced);
-    void thread_proc();
-    std::recursive_mutex mutex;
-    std::condition_variable_any cv;
-    std::chrono::system_clock::time_point winkey_timestamp, signal_timestamp;
-    std::chrono::milliseconds delay;
-    std::deque<KeyEvent> events;
+    void process_events();
+    void clear_events();
+    void handle_hidden(const KeyEvent& event);
+    void handle_timeout(const KeyEvent& event);
+    void handle_timer();
+    void handle_shown(const KeyEvent& event, const bool forced);
+    void start_timer(std::chrono::milliseconds wait_time);
+    void stop_timer();
+
+    HWND window;
+    std::chrono::steady_clock::time_point winkey_timestamp;
+    std::atomic<std::chrono::steady_clock::time_point> signal_timestamp;
+    std::atomic<std::chrono::milliseconds> delay;
+
+    SpscQueue<KeyEvent, 64> events;
+    // Only used by signal_event, to ignore the repeated key presses which are still queued
+    KeyEvent last_event{};
+    // Set when a message is posted to process the queued events, so only the first of a burst of events posts one
+    std::atomic<bool> processing_posted = false;
+    bool timer_active = false;
+
     enum State
     {
         Hidden,
@@ -45,6 +60,5 @@ private:
     };
     std::atomic<State> state = Hidden;
 
-    bool nonwin_key_was_pressed_during_shown = false;
-    std::thread thread;
+    std::atomic<bool> nonwin_key_was_pressed_during_shown = false;
 };
@@ -2,6 +2,11 @@
 #include "centralized_kb_hook.h"
 #include <common/common.h>
 #include <common/debug_control.h>
+#include <common/LowlevelKeyboardEvent.h>
+#include <common/shared_constants.h>
+#include <common/logger/logger.h>
+#include <array>
+#include <atomic>
 
 namespace CentralizedKeyboardHook
 {
@@ -18,8 +23,39 @@ namespace CentralizedKeyboardHook
 
     };
 
+    struct SubscriberDescriptor
+    {
+        PowertoyModuleIface* module;
+        int priority;
+    };
+
+    // Modules which subscribe to all the keyboard events. There are only a handful of them, so a fixed array is enough.
+    constexpr size_t MaxKeyboardEventSubscribers = 16;
+
+    // Flat copy of hotkeyDescriptors and subscriberDescriptors which is read by the hook without taking the lock. A table
+    // is never modified after it's published, the setters build a new one and swap the pointer.
+    struct HotkeyTable
+    {
+        struct Binding
+        {
+            uint8_t modifiers;
+            std::function<bool()> action;
+        };
+
+        // Bit i is set if the key is bound with the modifiers i, see GetModifiers. A key without any binding costs a single load.
+        std::array<uint16_t, 256> modifierMasks{};
+        std::array<std::vector<Binding>, 256> bindings;
+
+        // Sorted by descending priority
+        std::array<PowertoyModuleIface*, MaxKeyboardEventSubscribers> subscribers{};
+        size_t subscriberCount = 0;
+    };
+
     std::multiset<HotkeyDescriptor> hotkeyDescriptors;
+    std::map<std::wstring, SubscriberDescriptor> subscriberDescriptors;
     std::mutex mutex;
+    std::atomic<HotkeyTable*> hotkeyTable{ nullptr };
+    std::atomic<int> hookReaders{ 0 };
     HHOOK hHook{};
 
     struct DestroyOnExit
@@ -27,36 +63,183 @@ namespace CentralizedKeyboardHook
         ~DestroyOnExit()
         {
             Stop();
+            delete hotkeyTable.exchange(nullptr);
         }
     } destroyOnExitObj;
 
+    uint8_t GetModifiers(bool win, bool ctrl, bool shift, bool alt)
+    {
+        return (win ? 1 : 0) | (ctrl ? 2 : 0) | (shift ? 4 : 0) | (alt ? 8 : 0);
+    }
+
+    // Must be called with the lock held
+    void PublishHotkeyTable()
+    {
+        auto table = new HotkeyTable();
+        for (const auto& descriptor : hotkeyDescriptors)
+        {
+            const auto& hotkey = descriptor.hotkey;
+            const uint8_t modifiers = GetModifiers(hotkey.win, hotkey.ctrl, hotkey.shift, hotkey.alt);
+
+            // Like hotkeyDescriptors.find, the first hotkey which was set wins
+            if (!(table->modifierMasks[hotkey.key] & (1 << modifiers)))
+            {
+                table->modifierMasks[hotkey.key] |= 1 << modifiers;
+                table->bindings[hotkey.key].push_back({ modifiers, descriptor.action });
+            }
+        }
+
+        std::vector<SubscriberDescriptor> subscribers;
+        for (const auto& [moduleName, subscriber] : subscriberDescriptors)
+        {
+            subscribers.push_back(subscriber);
+        }
+
+        // Modules with the same priority are called in the order of their names, so the order doesn't depend on the load order
+        std::stable_sort(subscribers.begin(), subscribers.end(), [](const SubscriberDescriptor& lhs, const SubscriberDescriptor& rhs) {
+            return lhs.priority > rhs.priority;
+        });
+
+        for (const auto& subscriber : subscribers)
+        {
+            if (table->subscriberCount == table->subscribers.size())
+            {
+                Logger::error(L"Too many keyboard event subscribers, the ones with the lowest priority are ignored");
+                break;
+            }
+            table->subscribers[table->subscriberCount++] = subscriber.module;
+        }
+
+        HotkeyTable* previous = hotkeyTable.exchange(table);
+
+        // Wait until the hook is done with the previous table. It doesn't call anything while it holds it, so this is short.
+        while (hookReaders.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        delete previous;
+    }
+
+    // Sends the replacement key of a subscriber, with the same key up/down state as the original event
+    void SendReplacementKey(const LowlevelKeyboardEvent& event, unsigned short replacementKey)
+    {
+        INPUT replacement[1] = {};
+        replacement[0].type = INPUT_KEYBOARD;
+        replacement[0].ki.wVk = replacementKey;
+        // Some applications only look at the scan code, e.g. Windows Terminal ignores non-character input without one
+        replacement[0].ki.wScan = static_cast<WORD>(MapVirtualKey(replacementKey, MAPVK_VK_TO_VSC));
+        replacement[0].ki.dwExtraInfo = CommonSharedConstants::RUNNER_REPLACEMENT_KEY_FLAG;
+        if (event.wParam == WM_KEYUP || event.wParam == WM_SYSKEYUP)
+        {
+            replacement[0].ki.dwFlags = KEYEVENTF_KEYUP;
+        }
+        SendInput(1, replacement, sizeof(INPUT));
+    }
+
+    // Returns true if a subscriber swallowed the event
+    bool DispatchToSubscribers(WPARAM wParam, LPARAM lParam)
+    {
+        // A replacement key isn't dispatched again, a subscriber which replaces a key with one it also handles would loop forever
+        if (reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam)->dwExtraInfo == CommonSharedConstants::RUNNER_REPLACEMENT_KEY_FLAG)
+        {
+            return false;
+        }
+
+        std::array<PowertoyModuleIface*, MaxKeyboardEventSubscribers> subscribers;
+        size_t subscriberCount = 0;
+        {
+            hookReaders++;
+            const HotkeyTable* table = hotkeyTable.load();
+            if (table)
+            {
+                subscribers = table->subscribers;
+                subscriberCount = table->subscriberCount;
+            }
+            hookReaders--;
+        }
+
+        if (subscriberCount == 0)
+        {
+            return false;
+        }
+
+        LowlevelKeyboardEvent event;
+        event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        event.wParam = wParam;
+
+        for (size_t i = 0; i < subscriberCount; i++)
+        {
+            if (!subscribers[i]->is_enabled())
+            {
+                continue;
+            }
+
+            const auto decision = subscribers[i]->on_keyboard_event(&event);
+            switch (decision.type)
+            {
+            case PowertoyModuleIface::KeyboardEventDecision::Type::Suppress:
+                return true;
+            case PowertoyModuleIface::KeyboardEventDecision::Type::Replace:
+                SendReplacementKey(event, decision.replacement_key);
+                return true;
+            default:
+                break;
+            }
+        }
+
+        return false;
+    }
+
     LRESULT CALLBACK KeyboardHookProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
     {
-        if (nCode < 0 || ((wParam != WM_KEYDOWN) && (wParam != WM_SYSKEYDOWN)))
+        if (nCode < 0)
         {
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
-        const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        // The subscribers get all the events, and before the hotkeys, since they may remap the keys
+        if (DispatchToSubscribers(wParam, lParam))
+        {
+            return 1;
+        }
 
-        Hotkey hotkey{
-            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
-            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
-            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
-            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
-        };
+        if ((wParam != WM_KEYDOWN) && (wParam != WM_SYSKEYDOWN))
+        {
+            return CallNextHookEx(hHook, nCode, wParam, lParam);
+        }
+
+        const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        const auto key = static_cast<unsigned char>(keyPressInfo.vkCode);
 
         std::function<bool()> action;
         {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
+            // Hold the table for the shortest possible duration, the action is called after it's released
+            hookReaders++;
+            const HotkeyTable* table = hotkeyTable.load();
+            const uint16_t modifierMask = table ? table->modifierMasks[key] : 0;
+
+            // The modifier state is only queried if the key is bound
+            if (modifierMask != 0)
             {
-                action = it->action;
+                const uint8_t modifiers = GetModifiers(
+                    (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
+                    static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
+                    static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
+                    static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000));
+
+                if (modifierMask & (1 << modifiers))
+                {
+                    for (const auto& binding : table->bindings[key])
+                    {
+                        if (binding.modifiers == modifiers)
+                        {
+                            action = binding.action;
+                            break;
+                        }
+                    }
+                }
             }
+            hookReaders--;
         }
 
         if (action)
@@ -82,6 +265,7 @@ namespace CentralizedKeyboardHook
     {
         std::unique_lock lock{ mutex };
         hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        PublishHotkeyTable();
     }
 
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept
@@ -99,6 +283,28 @@ namespace CentralizedKeyboardHook
                 ++it;
             }
         }
+        PublishHotkeyTable();
+    }
+
+    void SetKeyboardEventSubscriber(const std::wstring& moduleName, PowertoyModuleIface* module, int priority) noexcept
+    {
+        std::unique_lock lock{ mutex };
+        if (priority < 0)
+        {
+            subscriberDescriptors.erase(moduleName);
+        }
+        else
+        {
+            subscriberDescriptors[moduleName] = { .module = module, .priority = priority };
+        }
+        PublishHotkeyTable();
+    }
+
+    void ClearKeyboardEventSubscriber(const std::wstring& moduleName) noexcept
+    {
+        std::unique_lock lock{ mutex };
+        subscriberDescriptors.erase(moduleName);
+        PublishHotkeyTable();
     }
 
     void Start() noexcept
@@ -10,4 +10,9 @@ namespace CentralizedKeyboardHook
     void Stop() noexcept;
     void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& action) noexcept;
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept;
+
+    // Subscribes the module to all the keyboard events, see PowertoyModuleIface::on_keyboard_event.
+    // A negative priority removes the subscription.
+    void SetKeyboardEventSubscriber(const std::wstring& moduleName, PowertoyModuleIface* module, int priority) noexcept;
+    void ClearKeyboardEventSubscriber(const std::wstring& moduleName) noexcept;
 };
@@ -10,6 +10,7 @@
 #include <common/winstore.h>
 
 #include "trace.h"
+#include <common/logger/logger.h>
 
 // TODO: would be nice to get rid of these globals, since they're basically cached json settings
 static std::wstring settings_theme = L"system";
@@ -103,7 +104,7 @@ GeneralSettings get_general_settings()
 
     for (auto& [name, powertoy] : modules())
     {
-        settings.isModulesEnabledMap[name] = powertoy->is_enabled();
+        settings.isModulesEnabledMap[name] = powertoy.is_enabled();
     }
 
     return settings;
@@ -168,19 +169,27 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             {
                 continue;
             }
-            const bool module_inst_enabled = modules().at(name)->is_enabled();
+            const bool module_inst_enabled = modules().at(name).is_enabled();
             const bool target_enabled = value.GetBoolean();
             if (module_inst_enabled == target_enabled)
             {
                 continue;
             }
-            if (target_enabled)
+            try
             {
-                modules().at(name)->enable();
+                if (target_enabled)
+                {
+                    modules().at(name)->enable();
+                }
+                else
+                {
+                    modules().at(name)->disable();
+                }
             }
-            else
+            catch (...)
             {
-                modules().at(name)->disable();
+                // A deferred module whose DLL fails to load stays disabled
+                Logger::error(L"Failed to {} {}", target_enabled ? L"enable" : L"disable", name);
             }
         }
     }
@@ -198,14 +207,13 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
     }
 }
 
-void start_initial_powertoys()
+std::unordered_set<std::wstring> get_disabled_powertoys()
 {
     std::unordered_set<std::wstring> powertoys_to_disable;
 
-    json::JsonObject general_settings;
     try
     {
-        general_settings = load_general_settings();
+        json::JsonObject general_settings = load_general_settings();
         if (general_settings.HasKey(L"enabled"))
         {
             json::JsonObject enabled = general_settings.GetNamedObject(L"enabled");
@@ -222,21 +230,19 @@ void start_initial_powertoys()
     {
     }
 
-    if (powertoys_to_disable.empty())
+    return powertoys_to_disable;
+}
+
+void start_initial_powertoys(const std::unordered_set<std::wstring>& powertoys_to_disable)
+{
+    for (auto& [name, powertoy] : modules())
     {
-        for (auto& [name, powertoy] : modules())
+        if (powertoys_to_disable.find(name) == powertoys_to_disable.end())
         {
+            const auto start = std::chrono::steady_clock::now();
             powertoy->enable();
-        }
-    }
-    else
-    {
-        for (auto& [name, powertoy] : modules())
-        {
-            if (powertoys_to_disable.find(name) == powertoys_to_disable.end())
-            {
-                powertoy->enable();
-            }
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            Logger::info(L"Enabled {} in {} ms", name, duration.count());
         }
     }
 }
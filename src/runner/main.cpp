@@ -79,6 +79,7 @@ int runner(bool isProcessElevated)
     std::filesystem::path logFilePath(PTSettingsHelper::get_root_save_folder_location());
     logFilePath.append(LogSettings::runnerLogPath);
     Logger::init(LogSettings::runnerLoggerName, logFilePath.wstring(), PTSettingsHelper::get_log_settings_file_location());
+    Logger::installCrashHandler();
 
     Logger::info("Runner is starting. Elevated={}", isProcessElevated);
     DPIAware::EnableDPIAwarenessForThisProcess();
@@ -120,36 +121,32 @@ int runner(bool isProcessElevated)
         chdir_current_executable();
         // Load Powertoys DLLs
 
-        const std::array<std::wstring_view, 8> knownModules = {
-            L"modules/FancyZones/fancyzones.dll",
-            L"modules/FileExplorerPreview/powerpreview.dll",
-            L"modules/ImageResizer/ImageResizerExt.dll",
-            L"modules/KeyboardManager/KeyboardManager.dll",
-            L"modules/Launcher/Microsoft.Launcher.dll",
-            L"modules/PowerRename/PowerRenameExt.dll",
-            L"modules/ShortcutGuide/ShortcutGuide.dll",
-            L"modules/ColorPicker/ColorPicker.dll",
+        const std::vector<PowertoyModuleInfo> knownModules = {
+            { L"FancyZones", L"modules/FancyZones/fancyzones.dll" },
+            { L"File Explorer", L"modules/FileExplorerPreview/powerpreview.dll" },
+            { L"Image Resizer", L"modules/ImageResizer/ImageResizerExt.dll" },
+            { L"Keyboard Manager", L"modules/KeyboardManager/KeyboardManager.dll" },
+            { L"PowerToys Run", L"modules/Launcher/Microsoft.Launcher.dll" },
+            { L"PowerRename", L"modules/PowerRename/PowerRenameExt.dll" },
+            { L"Shortcut Guide", L"modules/ShortcutGuide/ShortcutGuide.dll" },
+            { L"ColorPicker", L"modules/ColorPicker/ColorPicker.dll" },
         };
 
-        for (const auto& moduleSubdir : knownModules)
+        // Disabled modules are only loaded when they're enabled
+        const auto powertoysToDisable = get_disabled_powertoys();
+        const auto loadStart = std::chrono::steady_clock::now();
+        for (const auto& moduleSubdir : load_powertoys(knownModules, powertoysToDisable))
         {
-            try
-            {
-                auto module = load_powertoy(moduleSubdir);
-                modules().emplace(module->get_key(), std::move(module));
-            }
-            catch (...)
-            {
-                std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
-                errorMessage += moduleSubdir;
-                MessageBoxW(NULL,
-                            errorMessage.c_str(),
-                            L"PowerToys",
-                            MB_OK | MB_ICONERROR);
-            }
+            std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
+            errorMessage += moduleSubdir;
+            MessageBoxW(NULL,
+                        errorMessage.c_str(),
+                        L"PowerToys",
+                        MB_OK | MB_ICONERROR);
         }
         // Start initial powertoys
-        start_initial_powertoys();
+        start_initial_powertoys(powertoysToDisable);
+        Logger::info("Modules loaded and started in {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - loadStart).count());
 
         Trace::EventLaunch(get_product_version(), isProcessElevated);
 
@@ -162,6 +159,7 @@ int runner(bool isProcessElevated)
         result = -1;
     }
     Trace::UnregisterProvider();
+    Logger::shutdown();
     return result;
 }
 
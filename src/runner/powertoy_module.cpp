@@ -1,6 +1,54 @@
 #include "pch.h"
 #include "powertoy_module.h"
 #include "centralized_kb_hook.h"
+#include <common/logger/logger.h>
+#include <future>
+
+namespace
+{
+    struct CreatedPowertoy
+    {
+        PowertoyModuleIface* module;
+        HMODULE handle;
+        int interface_version;
+        std::chrono::milliseconds duration;
+    };
+
+    // Loads the DLL and creates the module. Doesn't touch any runner state, so it can run on any thread.
+    CreatedPowertoy create_powertoy(const std::wstring_view filename)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
+        auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
+        if (!create)
+        {
+            FreeLibrary(handle);
+            winrt::throw_last_error();
+        }
+        // DLLs built before the export was added only have the methods of version 0 in their vtable
+        auto get_interface_version = reinterpret_cast<powertoy_interface_version_func>(GetProcAddress(handle, "powertoy_interface_version"));
+        const int interface_version = get_interface_version ? get_interface_version() : 0;
+        auto module = create();
+        if (!module)
+        {
+            FreeLibrary(handle);
+            winrt::throw_hresult(winrt::hresult(E_POINTER));
+        }
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        return { module, handle, interface_version, duration };
+    }
+}
+
+void PowertoyModuleDeleter::operator()(PowertoyModuleIface* module) const
+{
+    if (module)
+    {
+        const std::wstring key{ module->get_key() };
+        CentralizedKeyboardHook::ClearKeyboardEventSubscriber(key);
+        CentralizedKeyboardHook::ClearModuleHotkeys(key);
+        module->destroy();
+    }
+}
 
 std::map<std::wstring, PowertoyModule>& modules()
 {
@@ -10,34 +58,98 @@ std::map<std::wstring, PowertoyModule>& modules()
 
 PowertoyModule load_powertoy(const std::wstring_view filename)
 {
-    auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
-    auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
-    if (!create)
+    auto created = create_powertoy(filename);
+    return PowertoyModule(created.module, created.handle, created.interface_version);
+}
+
+std::vector<std::wstring_view> load_powertoys(const std::vector<PowertoyModuleInfo>& known_modules, const std::unordered_set<std::wstring>& disabled_modules)
+{
+    std::vector<std::wstring_view> failed_modules;
+    std::vector<std::pair<const PowertoyModuleInfo*, std::future<CreatedPowertoy>>> pending_modules;
+    std::vector<std::thread> loader_threads;
+
+    for (const auto& info : known_modules)
     {
-        FreeLibrary(handle);
-        winrt::throw_last_error();
+        const std::wstring key{ info.key };
+        if (disabled_modules.find(key) != disabled_modules.end())
+        {
+            Logger::info(L"Deferred loading {} since it's disabled", key);
+            modules().emplace(key, PowertoyModule(info.filename));
+            continue;
+        }
+
+        // Module constructors read their settings synchronously, so each module is created on its own thread
+        std::packaged_task<CreatedPowertoy()> task([filename = info.filename] {
+            return create_powertoy(filename);
+        });
+        pending_modules.emplace_back(&info, task.get_future());
+        loader_threads.emplace_back(std::move(task));
     }
-    auto module = create();
-    if (!module)
+
+    // Hotkeys are registered on this thread, in the order of known_modules
+    for (auto& [info, created_future] : pending_modules)
     {
-        FreeLibrary(handle);
-        winrt::throw_hresult(winrt::hresult(E_POINTER));
+        try
+        {
+            auto created = created_future.get();
+            PowertoyModule module(created.module, created.handle, created.interface_version);
+            std::wstring key{ module->get_key() };
+            if (key != info->key)
+            {
+                Logger::warn(L"Module {} has key {}, it will always be loaded on startup", info->filename, key);
+            }
+            Logger::info(L"Loaded {} in {} ms", key, created.duration.count());
+            modules().emplace(std::move(key), std::move(module));
+        }
+        catch (...)
+        {
+            Logger::error(L"Failed to load {}", info->filename);
+            failed_modules.push_back(info->filename);
+        }
     }
-    return PowertoyModule(module, handle);
+
+    for (auto& thread : loader_threads)
+    {
+        thread.join();
+    }
+
+    return failed_modules;
 }
 
-json::JsonObject PowertoyModule::json_config() const
+std::wstring PowertoyModule::config_string()
 {
+    std::wstring result;
+    const auto writer = [](void* context, const wchar_t* config, size_t length) {
+        static_cast<std::wstring*>(context)->assign(config, length);
+    };
+    if (!module)
+    {
+        throw std::logic_error("Module not loaded");
+    }
+    if (interface_version >= 1 && module->write_config(writer, &result))
+    {
+        return result;
+    }
+
+    // The module only implements the legacy protocol, which needs a call to get the size
     int size = 0;
     module->get_config(nullptr, &size);
-    std::wstring result;
+    if (size <= 0)
+    {
+        throw std::runtime_error("Module returned an invalid config size");
+    }
     result.resize(size - 1);
     module->get_config(result.data(), &size);
-    return json::JsonObject::Parse(result);
+    return result;
+}
+
+json::JsonObject PowertoyModule::json_config()
+{
+    return json::JsonObject::Parse(config_string());
 }
 
-PowertoyModule::PowertoyModule(PowertoyModuleIface* module, HMODULE handle) :
-    handle(handle), module(module)
+PowertoyModule::PowertoyModule(PowertoyModuleIface* module, HMODULE handle, int interface_version) :
+    handle(handle), module(module), interface_version(interface_version)
 {
     if (!module)
     {
@@ -45,6 +157,53 @@ PowertoyModule::PowertoyModule(PowertoyModuleIface* module, HMODULE handle) :
     }
 
     update_hotkeys();
+    update_keyboard_event_subscriber();
+}
+
+PowertoyModule::PowertoyModule(const std::wstring_view filename) :
+    filename(filename)
+{
+}
+
+bool PowertoyModule::is_loaded() const
+{
+    return module != nullptr;
+}
+
+bool PowertoyModule::is_enabled() const
+{
+    return module && module->is_enabled();
+}
+
+void PowertoyModule::load()
+{
+    if (module)
+    {
+        return;
+    }
+    if (load_failed)
+    {
+        throw std::runtime_error("Module failed to load");
+    }
+
+    try
+    {
+        auto created = create_powertoy(filename);
+        handle.reset(created.handle);
+        module.reset(created.module);
+        interface_version = created.interface_version;
+        Logger::info(L"Loaded {} on demand in {} ms", module->get_key(), created.duration.count());
+    }
+    catch (...)
+    {
+        // Only the first failure is logged, the module stays unloaded until the runner restarts
+        load_failed = true;
+        Logger::error(L"Failed to load {}", filename);
+        throw;
+    }
+
+    update_hotkeys();
+    update_keyboard_event_subscriber();
 }
 
 void PowertoyModule::update_hotkeys()
@@ -64,3 +223,9 @@ void PowertoyModule::update_hotkeys()
         });
     }
 }
+
+void PowertoyModule::update_keyboard_event_subscriber()
+{
+    const int priority = interface_version >= 1 ? module->get_keyboard_event_priority() : -1;
+    CentralizedKeyboardHook::SetKeyboardEventSubscriber(module->get_key(), module.get(), priority);
+}
@@ -5,18 +5,14 @@
 #include <mutex>
 #include <vector>
 #include <functional>
+#include <unordered_set>
 
 #include <common/json.h>
 
 struct PowertoyModuleDeleter
 {
-    void operator()(PowertoyModuleIface* module) const
-    {
-        if (module)
-        {
-            module->destroy();
-        }
-    }
+    // Removes the hotkeys and the keyboard event subscription of the module before destroying it, so the hook never calls a destroyed module
+    void operator()(PowertoyModuleIface* module) const;
 };
 
 struct PowertoyModuleDLLDeleter
@@ -31,21 +27,57 @@ struct PowertoyModuleDLLDeleter
 class PowertoyModule
 {
 public:
-    PowertoyModule(PowertoyModuleIface* module, HMODULE handle);
+    PowertoyModule(PowertoyModuleIface* module, HMODULE handle, int interface_version);
 
+    // Creates a module which is only loaded from its DLL the first time it's accessed
+    PowertoyModule(const std::wstring_view filename);
+
+    // Loads a deferred module, throws if its DLL can't be loaded
     inline PowertoyModuleIface* operator->()
     {
+        load();
         return module.get();
     }
 
-    json::JsonObject json_config() const;
+    bool is_loaded() const;
+
+    // Doesn't load the module, a module which hasn't been loaded yet is disabled
+    bool is_enabled() const;
+
+    // Must only be called on a loaded module, it doesn't load deferred modules
+    std::wstring config_string();
+
+    json::JsonObject json_config();
 
     void update_hotkeys();
 
+    void update_keyboard_event_subscriber();
+
 private:
+    void load();
+
+    std::wstring filename;
     std::unique_ptr<HMODULE, PowertoyModuleDLLDeleter> handle;
     std::unique_ptr<PowertoyModuleIface, PowertoyModuleDeleter> module;
+
+    // POWERTOY_INTERFACE_VERSION the DLL is built against, the methods it doesn't have must not be called
+    int interface_version = 0;
+
+    // Set when loading the deferred module failed, so the DLL isn't loaded again on every access
+    bool load_failed = false;
+};
+
+struct PowertoyModuleInfo
+{
+    // Must match get_key() of the module, so that a disabled module can be registered without loading it
+    std::wstring_view key;
+    std::wstring_view filename;
 };
 
 PowertoyModule load_powertoy(const std::wstring_view filename);
+
+// Loads and creates the modules concurrently and adds them to modules(). Modules in disabled_modules are added
+// without being loaded, they're loaded the first time they're accessed, e.g. when they're enabled.
+// Returns the file names of the modules which failed to load.
+std::vector<std::wstring_view> load_powertoys(const std::vector<PowertoyModuleInfo>& known_modules, const std::unordered_set<std::wstring>& disabled_modules);
 std::map<std::wstring, PowertoyModule>& modules();
@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "settings_store.h"
+#include "general_settings.h"
+#include "powertoy_module.h"
+#include <common/logger/logger.h>
+
+void SettingsStore::invalidate_module(const std::wstring& key)
+{
+    stale_modules.insert(key);
+}
+
+SettingsStore::ModuleConfig* SettingsStore::get_module_config(const std::wstring& key, bool reload)
+{
+    auto config_it = module_configs.find(key);
+    ModuleConfig* cached = config_it != module_configs.end() ? &config_it->second : nullptr;
+    if (cached && !reload && stale_modules.find(key) == stale_modules.end())
+    {
+        return cached;
+    }
+
+    // Deferred modules aren't loaded to get their config, it's sent once they're enabled
+    auto module_it = modules().find(key);
+    if (module_it == modules().end() || !module_it->second.is_loaded())
+    {
+        return cached;
+    }
+    stale_modules.erase(key);
+
+    std::wstring config_string;
+    try
+    {
+        config_string = module_it->second.config_string();
+    }
+    catch (...)
+    {
+        Logger::error(L"Failed to get the config of {}", key);
+        return cached;
+    }
+
+    if (cached && cached->config_string == config_string)
+    {
+        return cached;
+    }
+
+    json::JsonObject config;
+    if (!json::JsonObject::TryParse(config_string, config))
+    {
+        // The settings process keeps the config it was last sent
+        Logger::error(L"{} returned a malformed config", key);
+        return cached;
+    }
+
+    ModuleConfig& module_config = module_configs[key];
+    module_config.config = std::move(config);
+    module_config.config_string = std::move(config_string);
+    module_config.revision = ++revision;
+    return &module_config;
+}
+
+json::JsonObject SettingsStore::get_settings(bool reload, bool delta)
+{
+    json::JsonObject powertoys;
+    for (const auto& [name, powertoy] : modules())
+    {
+        auto module_config = get_module_config(name, reload);
+        if (module_config && (!delta || module_config->revision != module_config->sent_revision))
+        {
+            powertoys.SetNamedValue(name, module_config->config);
+            module_config->sent_revision = module_config->revision;
+        }
+    }
+
+    json::JsonObject result;
+    result.SetNamedValue(L"general", get_general_settings().to_json());
+    result.SetNamedValue(L"powertoys", powertoys);
+    result.SetNamedValue(L"revision", json::value(revision));
+    return result;
+}
+
+json::JsonObject SettingsStore::get_all_settings()
+{
+    return get_settings(true, false);
+}
+
+json::JsonObject SettingsStore::get_settings_snapshot()
+{
+    return get_settings(false, false);
+}
+
+json::JsonObject SettingsStore::get_settings_delta()
+{
+    return get_settings(false, true);
+}
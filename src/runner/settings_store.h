@@ -0,0 +1,49 @@
+#pragma once
+#include <common/json.h>
+#include <map>
+#include <string>
+#include <unordered_set>
+
+// Caches the settings which are sent to the settings process, so that after a change only the sections which
+// changed have to be sent. Each module config is kept both as the string returned by the module, which is used to
+// detect changes without parsing, and as the parsed JSON object. Every change of a module config bumps its revision.
+// A cached config is only read from its module again once it's invalidated, i.e. after the settings process sent it a
+// new config or enabled or disabled it, or when the settings process asks for everything with a refresh. A change a
+// module makes on its own, e.g. from the Keyboard Manager or FancyZones editors, is sent with the next refresh.
+// NOTE: the store is only used from the main thread.
+class SettingsStore
+{
+public:
+    // Function to mark the config of a module as possibly changed, it's read from the module again when the settings are next sent
+    void invalidate_module(const std::wstring& key);
+
+    // Function to read the config of every loaded module again and get all the settings. Everything is marked as sent.
+    json::JsonObject get_all_settings();
+
+    // Function to get all the settings, only the invalidated configs are read again. Everything is marked as sent.
+    json::JsonObject get_settings_snapshot();
+
+    // Function to get the general settings and the configs of the modules which changed since they were last sent.
+    // Only the invalidated configs are read again.
+    json::JsonObject get_settings_delta();
+
+private:
+    struct ModuleConfig
+    {
+        std::wstring config_string;
+        json::JsonObject config;
+        uint64_t revision = 0;
+        uint64_t sent_revision = 0;
+    };
+
+    // Function to get the config of a module, it's read from the module first if it's invalidated, if it was never
+    // read or if reload is set. If the module isn't loaded or can't return a valid config, returns the config which
+    // was last read, or nullptr if there is none.
+    ModuleConfig* get_module_config(const std::wstring& key, bool reload);
+
+    json::JsonObject get_settings(bool reload, bool delta);
+
+    std::map<std::wstring, ModuleConfig> module_configs;
+    std::unordered_set<std::wstring> stale_modules;
+    uint64_t revision = 0;
+};
@@ -13,6 +13,7 @@
 #include "restart_elevated.h"
 #include "update_utils.h"
 #include "centralized_kb_hook.h"
+#include "settings_store.h"
 
 #include <common/json.h>
 #include <common\settings_helpers.cpp>
@@ -26,30 +27,13 @@
 TwoWayPipeMessageIPC* current_settings_ipc = NULL;
 std::atomic_bool g_isLaunchInProgress = false;
 
-json::JsonObject get_power_toys_settings()
-{
-    json::JsonObject result;
-    for (const auto& [name, powertoy] : modules())
-    {
-        try
-        {
-            result.SetNamedValue(name, powertoy.json_config());
-        }
-        catch (...)
-        {
-            // TODO: handle malformed JSON.
-        }
-    }
-    return result;
-}
+// The legacy settings host replaces all its settings with each reply, only the new Settings UI is sent the changed modules
+std::atomic_bool g_settingsAcceptsDelta = false;
 
-json::JsonObject get_all_settings()
+SettingsStore& settings_store()
 {
-    json::JsonObject result;
-
-    result.SetNamedValue(L"general", get_general_settings().to_json());
-    result.SetNamedValue(L"powertoys", get_power_toys_settings());
-    return result;
+    static SettingsStore store;
+    return store;
 }
 
 std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObject& powertoys_configs)
@@ -100,7 +84,14 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
         else if (modules().find(name) != modules().end())
         {
             const auto element = powertoy_element.Value().Stringify();
-            modules().at(name)->call_custom_action(element.c_str());
+            try
+            {
+                modules().at(name)->call_custom_action(element.c_str());
+            }
+            catch (...)
+            {
+                Logger::error(L"Failed to call a custom action of {}", name);
+            }
         }
     }
 
@@ -112,8 +103,26 @@ void send_json_config_to_module(const std::wstring& module_key, const std::wstri
     auto moduleIt = modules().find(module_key);
     if (moduleIt != modules().end())
     {
-        moduleIt->second->set_config(settings.c_str());
-        moduleIt->second.update_hotkeys();
+        try
+        {
+            moduleIt->second->set_config(settings.c_str());
+            moduleIt->second.update_hotkeys();
+        }
+        catch (...)
+        {
+            Logger::error(L"Failed to send the config to {}", module_key);
+        }
+        settings_store().invalidate_module(module_key);
+    }
+}
+
+void send_settings_reply()
+{
+    if (current_settings_ipc != nullptr)
+    {
+        auto& store = settings_store();
+        const auto settings = g_settingsAcceptsDelta ? store.get_settings_delta() : store.get_settings_snapshot();
+        current_settings_ipc->send(std::wstring{ settings.Stringify().c_str() });
     }
 }
 
@@ -136,27 +145,32 @@ void dispatch_received_json(const std::wstring& json_to_parse)
 
         if (name == L"general")
         {
+            // The config of a module may change when it's enabled or disabled
+            std::map<std::wstring, bool> modules_enabled;
+            for (const auto& [module_name, powertoy] : modules())
+            {
+                modules_enabled[module_name] = powertoy.is_enabled();
+            }
             apply_general_settings(value.GetObjectW());
-            if (current_settings_ipc != nullptr)
+            for (const auto& [module_name, powertoy] : modules())
             {
-                const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-                current_settings_ipc->send(settings_string);
+                if (powertoy.is_enabled() != modules_enabled[module_name])
+                {
+                    settings_store().invalidate_module(module_name);
+                }
             }
+            send_settings_reply();
         }
         else if (name == L"powertoys")
         {
             dispatch_json_config_to_modules(value.GetObjectW());
-            if (current_settings_ipc != nullptr)
-            {
-                const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-                current_settings_ipc->send(settings_string);
-            }
+            send_settings_reply();
         }
         else if (name == L"refresh")
         {
             if (current_settings_ipc != nullptr)
             {
-                const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
+                const std::wstring settings_string{ settings_store().get_all_settings().Stringify().c_str() };
                 current_settings_ipc->send(settings_string);
             }
         }
@@ -268,10 +282,12 @@ void run_settings_window()
     if (UseNewSettings())
     {
         executable_path.append(L"\\SettingsUIRunner\\Microsoft.PowerToys.Settings.UI.Runner.exe");
+        g_settingsAcceptsDelta = true;
     }
     else
     {
         executable_path.append(L"\\PowerToysSettings.exe");
+        g_settingsAcceptsDelta = false;
     }
 
     // Arg 2: pipe server. Generate unique names for the pipes, if getting a UUID is possible.
@@ -80,6 +80,18 @@ public:
 
     // Return JSON with the configuration options.
     virtual bool get_config(wchar_t* buffer, int* buffer_size) override
+    {
+        return get_settings().serialize_to_buffer(buffer, buffer_size);
+    }
+
+    // Same JSON as get_config(), the runner uses it instead when it is implemented.
+    virtual bool write_config(ConfigWriter writer, void* context) override
+    {
+        return get_settings().serialize_to_writer(writer, context);
+    }
+
+    // Create the Settings object with the configuration options.
+    PowerToysSettings::Settings get_settings()
     {
         HINSTANCE hinstance = reinterpret_cast<HINSTANCE>(&__ImageBase);
 
@@ -133,7 +145,7 @@ public:
         //  L"Press the button to call a custom action." // display values / extended info.
         //);
 
-        return settings.serialize_to_buffer(buffer, buffer_size);
+        return settings;
     }
 
     // Signal from the Settings editor to call a custom action.
@@ -294,4 +306,9 @@ void $safeprojectname$::init_settings()
 extern "C" __declspec(dllexport) PowertoyModuleIface* __cdecl powertoy_create()
 {
     return new $safeprojectname$();
+}
+
+extern "C" __declspec(dllexport) int __cdecl powertoy_interface_version()
+{
+    return POWERTOY_INTERFACE_VERSION;
 }
\ No newline at end of file